@@ -219,3 +219,11 @@ typedef struct aas_predictroute_s
 	int numareas;			//number of areas predicted ahead
 	int time;				//time predicted ahead (in hundredths of a sec)
 } aas_predictroute_t;
+
+//route to calculate in advance
+typedef struct aas_routequery_s
+{
+	int areanum;			//start area
+	int goalareanum;		//goal area
+	int travelflags;		//travel flags
+} aas_routequery_t;
@@ -35,7 +35,6 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "l_precomp.h"
 #include "l_struct.h"
 #include "l_log.h"
-#include "l_memory.h"
 #include "l_libvar.h"
 #include "aasfile.h"
 #include "botlib.h"
@@ -1291,7 +1290,7 @@ void AAS_AddTeleporterPortals(void)
 			VectorSubtract(mins, bbmaxs, mins);
 			VectorSubtract(maxs, bbmins, maxs);
 			//link an invalid (-1) entity
-			areas = AAS_AASLinkEntity(mins, maxs, -1);
+			areas = AAS_AASLinkEntity(mins, maxs, -1, NULL);
 			//
 			for (link = areas; link; link = link->next_area)
 			{
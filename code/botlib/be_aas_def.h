@@ -74,6 +74,10 @@ typedef struct aas_entity_s
 	aas_entityinfo_t i;
 	//links into the AAS areas
 	aas_link_t *areas;
+	//box the entity was linked into the AAS areas with
+	vec3_t linkmins, linkmaxs;
+	//distance the box can move without crossing a node plane, negative if unknown
+	float linkslack;
 	//links into the BSP leaves
 	bsp_link_t *leaves;
 } aas_entity_t;
@@ -218,6 +222,14 @@ typedef struct aas_s
 	//nodes of the bsp tree
 	int numnodes;
 	aas_node_t *nodes;
+	//parent and depth of every node in the bsp tree
+	int *nodeparents;
+	int *nodedepths;
+	//uniform grid with the deepest node that contains each grid cell
+	int *nodegrid;
+	int nodegridsize[3];
+	vec3_t nodegridorigin;
+	float nodegridcellsize;
 	//cluster portals
 	int numportals;
 	aas_portal_t *portals;
@@ -235,6 +247,7 @@ typedef struct aas_s
 	int linkheapsize;							//size of the link heap
 	aas_link_t *freelinks;						//first free link
 	aas_link_t **arealinkedentities;			//entities linked into areas
+	byte *areaoccupied;							//bit set for areas with linked entities
 	//entities
 	int maxentities;
 	int maxclients;
@@ -246,6 +259,27 @@ typedef struct aas_s
 	//routing update
 	aas_routingupdate_t *areaupdate;
 	aas_routingupdate_t *portalupdate;
+	//routing update fields for each worker thread used by AAS_PrecalculateRoutes
+	aas_routingupdate_t *threadareaupdate[BOTLIB_MAX_THREADS];
+	aas_routingupdate_t *threadportalupdate[BOTLIB_MAX_THREADS];
+	//protects the routing caches while routes are calculated on worker threads
+	void *routingmutex;
+	//caches created by worker threads, linked through time_next until added to the time sorted list
+	aas_routingcache_t *threadcaches;
+	//slab pools for the routing caches, one for every routing cache size
+	struct memorypool_s **routingcachepools;
+	int numroutingcachepools;
+	//precomputed routing tables for one set of travel flags, stored in the route cache file
+	void *routingtable;							//all tables in one block
+	int routingtablesize;
+	int routingtabletravelflags;
+	unsigned short int **clustertraveltimes;	//per cluster travel times for every goal area (row) from every area
+	unsigned char **clusterreachabilities;		//per cluster reachabilities for the travel times above
+	unsigned short int *portaltraveltimes;		//travel times for every goal area (row) from every portal
+	//AREA_DISABLED flag of every area when routing was initialized
+	byte *initialareadisabled;
+	//number of areas with a different AREA_DISABLED flag, the routing tables are only used while zero
+	int numchangedroutingareas;
 	//number of routing updates during a frame (reset every frame)
 	int frameroutingupdates;
 	//reversed reachability links
@@ -67,6 +67,33 @@ enum {
 #endif
 };
 
+//cost of the entity updates
+typedef struct aas_entityprofile_s
+{
+	int maxframes;				//number of frames to profile
+	int frames;					//number of frames profiled
+	int updates;				//number of entity updates
+	int relinks;				//number of entities relinked into the areas
+	int skippedrelinks;			//number of moved entities that didn't have to be relinked
+	int links;					//number of area links created
+	int64_t time;				//time spent updating and unlinking entities
+} aas_entityprofile_t;
+
+static aas_entityprofile_t entityprofile;
+
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static int64_t AAS_EntityProfileTime(void)
+{
+	if (!entityprofile.maxframes) return 0;
+	if (!botimport.Microseconds) return 0;
+	return botimport.Microseconds();
+} //end of the function AAS_EntityProfileTime
+
 //===========================================================================
 //
 // Parameter:				-
@@ -75,8 +102,10 @@ enum {
 //===========================================================================
 int AAS_UpdateEntity(int entnum, bot_entitystate_t *state)
 {
-	int relink;
+	int relink, forcerelink, i;
+	int64_t starttime;
 	aas_entity_t *ent;
+	aas_link_t *link;
 	vec3_t absmins, absmaxs;
 
 	if (!aasworld.loaded)
@@ -86,6 +115,7 @@ int AAS_UpdateEntity(int entnum, bot_entitystate_t *state)
 	} //end if
 
 	ent = &aasworld.entities[entnum];
+	starttime = AAS_EntityProfileTime();
 
 	if (!state) {
 		//unlink the entity
@@ -94,10 +124,13 @@ int AAS_UpdateEntity(int entnum, bot_entitystate_t *state)
 		AAS_UnlinkFromBSPLeaves(ent->leaves);
 		//
 		ent->areas = NULL;
+		ent->linkslack = -1;
 		//
 		ent->leaves = NULL;
+		entityprofile.time += AAS_EntityProfileTime() - starttime;
 		return BLERR_NOERROR;
 	}
+	entityprofile.updates++;
 
 	ent->i.update_time = AAS_Time() - ent->i.ltime;
 	ent->i.type = state->type;
@@ -123,6 +156,7 @@ int AAS_UpdateEntity(int entnum, bot_entitystate_t *state)
 	//link everything the first frame
 	if (aasworld.numframes == 1) relink = qtrue;
 	else relink = qfalse;
+	forcerelink = relink;
 	//
 	if (ent->i.solid == SOLID_BSP)
 	{
@@ -163,16 +197,45 @@ int AAS_UpdateEntity(int entnum, bot_entitystate_t *state)
 			//absolute mins and maxs
 			VectorAdd(ent->i.mins, ent->i.origin, absmins);
 			VectorAdd(ent->i.maxs, ent->i.origin, absmaxs);
+			//if the box didn't move far enough from where it was linked
+			//to cross any of the node planes the areas stay the same
+			if (!forcerelink && ent->linkslack > 0)
+			{
+				for (i = 0; i < 3; i++)
+				{
+					if (fabs(absmins[i] - ent->linkmins[i]) >= ent->linkslack) break;
+					if (fabs(absmaxs[i] - ent->linkmaxs[i]) >= ent->linkslack) break;
+				} //end for
+				if (i >= 3)
+				{
+					entityprofile.skippedrelinks++;
+					entityprofile.time += AAS_EntityProfileTime() - starttime;
+					return BLERR_NOERROR;
+				} //end if
+			} //end if
 			//unlink the entity
 			AAS_UnlinkFromAreas(ent->areas);
 			//relink the entity to the AAS areas (use the larges bbox)
-			ent->areas = AAS_LinkEntityClientBBox(absmins, absmaxs, entnum, PRESENCE_NORMAL);
+			ent->areas = AAS_LinkEntityClientBBox(absmins, absmaxs, entnum,
+													PRESENCE_NORMAL, &ent->linkslack);
+			VectorCopy(absmins, ent->linkmins);
+			VectorCopy(absmaxs, ent->linkmaxs);
 			//unlink the entity from the BSP leaves
 			AAS_UnlinkFromBSPLeaves(ent->leaves);
 			//link the entity to the world BSP tree
 			ent->leaves = AAS_BSPLinkEntity(absmins, absmaxs, entnum, 0);
+			//
+			entityprofile.relinks++;
+			if (entityprofile.maxframes)
+			{
+				for (link = ent->areas; link; link = link->next_area)
+				{
+					entityprofile.links++;
+				} //end for
+			} //end if
 		} //end if
 	} //end if
+	entityprofile.time += AAS_EntityProfileTime() - starttime;
 	return BLERR_NOERROR;
 } //end of the function AAS_UpdateEntity
 //===========================================================================
@@ -342,6 +405,7 @@ void AAS_ResetEntityLinks(void)
 	for (i = 0; i < aasworld.maxentities; i++)
 	{
 		aasworld.entities[i].areas = NULL;
+		aasworld.entities[i].linkslack = -1;
 		aasworld.entities[i].leaves = NULL;
 	} //end for
 } //end of the function AAS_ResetEntityLinks
@@ -369,8 +433,10 @@ void AAS_InvalidateEntities(void)
 void AAS_UnlinkInvalidEntities(void)
 {
 	int i;
+	int64_t starttime;
 	aas_entity_t *ent;
 
+	starttime = AAS_EntityProfileTime();
 	for (i = 0; i < aasworld.maxentities; i++)
 	{
 		ent = &aasworld.entities[i];
@@ -378,10 +444,12 @@ void AAS_UnlinkInvalidEntities(void)
 		{
 			AAS_UnlinkFromAreas( ent->areas );
 			ent->areas = NULL;
+			ent->linkslack = -1;
 			AAS_UnlinkFromBSPLeaves( ent->leaves );
 			ent->leaves = NULL;
 		} //end for
 	} //end for
+	entityprofile.time += AAS_EntityProfileTime() - starttime;
 } //end of the function AAS_UnlinkInvalidEntities
 //===========================================================================
 //
@@ -448,3 +516,44 @@ int AAS_NextEntity(int entnum)
 	} //end while
 	return 0;
 } //end of the function AAS_NextEntity
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_StartEntityProfile(int frames)
+{
+	Com_Memset(&entityprofile, 0, sizeof(aas_entityprofile_t));
+	entityprofile.maxframes = frames;
+	botimport.Print(PRT_MESSAGE, "profiling AAS entity updates for %d frames\n", frames);
+} //end of the function AAS_StartEntityProfile
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_EntityProfileFrame(void)
+{
+	int i, numoccupied;
+	float frames;
+
+	if (!entityprofile.maxframes) return;
+	if (++entityprofile.frames < entityprofile.maxframes) return;
+	//count the areas with entities linked into them
+	numoccupied = 0;
+	for (i = 1; i < aasworld.numareas; i++)
+	{
+		if (AAS_AreaOccupied(i)) numoccupied++;
+	} //end for
+	frames = entityprofile.frames;
+	botimport.Print(PRT_MESSAGE, "AAS entity profile over %d frames:\n", entityprofile.frames);
+	botimport.Print(PRT_MESSAGE, "%8.1f entity updates per frame\n", entityprofile.updates / frames);
+	botimport.Print(PRT_MESSAGE, "%8.1f relinks per frame\n", entityprofile.relinks / frames);
+	botimport.Print(PRT_MESSAGE, "%8.1f relinks skipped per frame\n", entityprofile.skippedrelinks / frames);
+	botimport.Print(PRT_MESSAGE, "%8.1f area links created per frame\n", entityprofile.links / frames);
+	botimport.Print(PRT_MESSAGE, "%8.1f usec per frame\n", entityprofile.time / frames);
+	botimport.Print(PRT_MESSAGE, "%d of %d areas occupied\n", numoccupied, aasworld.numareas - 1);
+	entityprofile.maxframes = 0;
+} //end of the function AAS_EntityProfileFrame
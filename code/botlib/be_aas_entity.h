@@ -40,6 +40,10 @@ void AAS_ResetEntityLinks(void);
 int AAS_UpdateEntity(int ent, bot_entitystate_t *state);
 //gives the entity data used for collision detection
 void AAS_EntityBSPData(int entnum, bsp_entdata_t *entdata);
+//profile the entity updates during the given number of frames
+void AAS_StartEntityProfile(int frames);
+//called every frame, prints the entity profile when done
+void AAS_EntityProfileFrame(void);
 #endif //AASINTERN
 
 //returns the size of the entity bounding box in mins and maxs
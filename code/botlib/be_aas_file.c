@@ -215,6 +215,8 @@ void AAS_DumpAASData(void)
 	aasworld.numnodes = 0;
 	if (aasworld.nodes) FreeMemory(aasworld.nodes);
 	aasworld.nodes = NULL;
+	//the node grid is created from the nodes
+	AAS_FreeNodeGrid();
 	aasworld.numportals = 0;
 	if (aasworld.portals) FreeMemory(aasworld.portals);
 	aasworld.portals = NULL;
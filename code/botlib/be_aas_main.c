@@ -47,6 +47,9 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 aas_t aasworld;
 
 libvar_t *saveroutingcache;
+libvar_t *precomputeroutes;
+libvar_t *aasbenchmark;
+libvar_t *aasentityprofile;
 
 //===========================================================================
 //
@@ -148,6 +151,8 @@ void AAS_ContinueInit(float time)
 int AAS_StartFrame(float time)
 {
 	aasworld.time = time;
+	//the entity updates of the previous frame are done
+	AAS_EntityProfileFrame();
 	//unlink all entities that were not updated last frame
 	AAS_UnlinkInvalidEntities();
 	//invalidate the entities
@@ -182,6 +187,24 @@ int AAS_StartFrame(float time)
 		LibVarSet("saveroutingcache", "0");
 	} //end if
 	//
+	if (precomputeroutes->value)
+	{
+		AAS_PrecomputeRoutingTables();
+		LibVarSet("precomputeroutes", "0");
+	} //end if
+	//
+	if (aasbenchmark->value)
+	{
+		AAS_BenchmarkSampling();
+		LibVarSet("aasbenchmark", "0");
+	} //end if
+	//
+	if (aasentityprofile->value)
+	{
+		AAS_StartEntityProfile((int) aasentityprofile->value);
+		LibVarSet("aasentityprofile", "0");
+	} //end if
+	//
 	aasworld.numframes++;
 	return BLERR_NOERROR;
 } //end of the function AAS_StartFrame
@@ -277,6 +300,8 @@ int AAS_LoadMap(const char *mapname)
 		aasworld.loaded = qfalse;
 		return errnum;
 	} //end if
+	//create the grid used to speed up point and trace queries
+	AAS_InitNodeGrid();
 	//
 	AAS_InitSettings();
 	//initialize the AAS link heap for the new map
@@ -303,6 +328,12 @@ int AAS_Setup(void)
 	aasworld.maxentities = (int) LibVarValue("maxentities", "1024");
 	// as soon as it's set to 1 the routing cache will be saved
 	saveroutingcache = LibVar("saveroutingcache", "0");
+	// as soon as it's set to 1 the routing tables will be calculated and saved
+	precomputeroutes = LibVar("precomputeroutes", "0");
+	// as soon as it's set to 1 the AAS point, trace and movement queries are benchmarked
+	aasbenchmark = LibVar("aasbenchmark", "0");
+	// number of frames to profile the entity updates for
+	aasentityprofile = LibVar("aasentityprofile", "0");
 	//allocate memory for the entities
 	if (aasworld.entities) FreeMemory(aasworld.entities);
 	aasworld.entities = (aas_entity_t *) GetClearedHunkMemory(aasworld.maxentities * sizeof(aas_entity_t));
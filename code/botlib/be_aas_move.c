@@ -975,6 +975,698 @@ int AAS_ClientMovementPrediction(struct aas_clientmove_s *move,
 	return qtrue;
 } //end of the function AAS_ClientMovementPrediction
 //===========================================================================
+// movement of several candidates is predicted in lock step, the origins
+// and velocities are stored per component so the gravity, friction and
+// acceleration of all candidates are calculated in plain loops the
+// compiler can vectorize, collision is done per candidate
+//===========================================================================
+#define MAX_PREDICTCANDIDATES		16
+//prediction state of a candidate
+#define PREDICT_MOVING				0
+#define PREDICT_STOPPED				1
+#define PREDICT_FAILED				2
+
+typedef struct aas_movebatch_s
+{
+	int numcandidates;
+	aas_clientmove_t *moves;
+	//prediction input shared by all candidates
+	int entnum;
+	int stopevent;
+	int stopareanum;
+	float frametime;
+	float *mins, *maxs;
+	int visualize;
+	//origin of the candidates
+	float orgx[MAX_PREDICTCANDIDATES];
+	float orgy[MAX_PREDICTCANDIDATES];
+	float orgz[MAX_PREDICTCANDIDATES];
+	//velocity to test for the current frame
+	float velx[MAX_PREDICTCANDIDATES];
+	float vely[MAX_PREDICTCANDIDATES];
+	float velz[MAX_PREDICTCANDIDATES];
+	//command movement direction, speed and acceleration
+	float wishx[MAX_PREDICTCANDIDATES];
+	float wishy[MAX_PREDICTCANDIDATES];
+	float wishz[MAX_PREDICTCANDIDATES];
+	float wishspeed[MAX_PREDICTCANDIDATES];
+	float accelerate[MAX_PREDICTCANDIDATES];
+	//gravity and friction of the current frame
+	float gravity[MAX_PREDICTCANDIDATES];
+	float frictionscale[MAX_PREDICTCANDIDATES];
+	//per candidate state
+	int presencetype[MAX_PREDICTCANDIDATES];
+	int onground[MAX_PREDICTCANDIDATES];
+	int swimming[MAX_PREDICTCANDIDATES];
+	int crouch[MAX_PREDICTCANDIDATES];
+	int jumpframe[MAX_PREDICTCANDIDATES];
+	int state[MAX_PREDICTCANDIDATES];
+} aas_movebatch_t;
+
+//===========================================================================
+// moves a candidate through the world for one frame after the physics
+// of the frame have been applied to its velocity
+//
+// Parameter:			batch		: candidates being predicted
+//						c			: candidate to move
+//						n			: frame number
+// Returns:				state of the candidate after the frame
+// Changes Globals:		-
+//===========================================================================
+static int AAS_PredictMovementFrame(aas_movebatch_t *batch, int c, int n)
+{
+	int i, j, pc, step, event, areanum, presencetype, onground, stopevent;
+	int areas[20], numareas;
+	float frametime, delta;
+	vec3_t points[20];
+	vec3_t org, end, feet, start, stepend, lastorg;
+	vec3_t frame_test_vel, old_frame_test_vel, left_test_vel;
+	vec3_t up = {0, 0, 1};
+	aas_plane_t *plane, *plane2;
+	aas_trace_t trace, steptrace;
+	aas_clientmove_t *move;
+
+	move = &batch->moves[c];
+	stopevent = batch->stopevent;
+	frametime = batch->frametime;
+	presencetype = batch->presencetype[c];
+	onground = batch->onground[c];
+	VectorSet(org, batch->orgx[c], batch->orgy[c], batch->orgz[c]);
+	VectorSet(frame_test_vel, batch->velx[c], batch->vely[c], batch->velz[c]);
+	//
+	if (batch->crouch[c])
+	{
+		presencetype = PRESENCE_CROUCH;
+	} //end if
+	else if (presencetype == PRESENCE_CROUCH)
+	{
+		if (AAS_PointPresenceType(org) & PRESENCE_NORMAL)
+		{
+			presencetype = PRESENCE_NORMAL;
+		} //end if
+	} //end else
+	//save the current origin
+	VectorCopy(org, lastorg);
+	//move linear during one frame
+	VectorCopy(frame_test_vel, left_test_vel);
+	j = 0;
+	do
+	{
+		VectorAdd(org, left_test_vel, end);
+		//trace a bounding box
+		trace = AAS_TraceClientBBox(org, end, presencetype, batch->entnum);
+		//
+//#ifdef AAS_MOVE_DEBUG
+		if (batch->visualize)
+		{
+			if (trace.startsolid) botimport.Print(PRT_MESSAGE, "PredictMovement: start solid\n");
+			AAS_DebugLine(org, trace.endpos, LINECOLOR_RED);
+		} //end if
+//#endif //AAS_MOVE_DEBUG
+		//
+		if (stopevent & (SE_ENTERAREA|SE_TOUCHJUMPPAD|SE_TOUCHTELEPORTER|SE_TOUCHCLUSTERPORTAL))
+		{
+			numareas = AAS_TraceAreas(org, trace.endpos, areas, points, 20);
+			for (i = 0; i < numareas; i++)
+			{
+				if (stopevent & SE_ENTERAREA)
+				{
+					if (areas[i] == batch->stopareanum)
+					{
+						VectorCopy(points[i], move->endpos);
+						VectorScale(frame_test_vel, 1/frametime, move->velocity);
+						move->endarea = areas[i];
+						move->trace = trace;
+						move->stopevent = SE_ENTERAREA;
+						move->presencetype = presencetype;
+						move->endcontents = 0;
+						move->time = n * frametime;
+						move->frames = n;
+						return PREDICT_STOPPED;
+					} //end if
+				} //end if
+				//NOTE: if not the first frame
+				if ((stopevent & SE_TOUCHJUMPPAD) && n)
+				{
+					if (aasworld.areasettings[areas[i]].contents & AREACONTENTS_JUMPPAD)
+					{
+						VectorCopy(points[i], move->endpos);
+						VectorScale(frame_test_vel, 1/frametime, move->velocity);
+						move->endarea = areas[i];
+						move->trace = trace;
+						move->stopevent = SE_TOUCHJUMPPAD;
+						move->presencetype = presencetype;
+						move->endcontents = 0;
+						move->time = n * frametime;
+						move->frames = n;
+						return PREDICT_STOPPED;
+					} //end if
+				} //end if
+				if (stopevent & SE_TOUCHTELEPORTER)
+				{
+					if (aasworld.areasettings[areas[i]].contents & AREACONTENTS_TELEPORTER)
+					{
+						VectorCopy(points[i], move->endpos);
+						move->endarea = areas[i];
+						VectorScale(frame_test_vel, 1/frametime, move->velocity);
+						move->trace = trace;
+						move->stopevent = SE_TOUCHTELEPORTER;
+						move->presencetype = presencetype;
+						move->endcontents = 0;
+						move->time = n * frametime;
+						move->frames = n;
+						return PREDICT_STOPPED;
+					} //end if
+				} //end if
+				if (stopevent & SE_TOUCHCLUSTERPORTAL)
+				{
+					if (aasworld.areasettings[areas[i]].contents & AREACONTENTS_CLUSTERPORTAL)
+					{
+						VectorCopy(points[i], move->endpos);
+						move->endarea = areas[i];
+						VectorScale(frame_test_vel, 1/frametime, move->velocity);
+						move->trace = trace;
+						move->stopevent = SE_TOUCHCLUSTERPORTAL;
+						move->presencetype = presencetype;
+						move->endcontents = 0;
+						move->time = n * frametime;
+						move->frames = n;
+						return PREDICT_STOPPED;
+					} //end if
+				} //end if
+			} //end for
+		} //end if
+		//
+		if (stopevent & SE_HITBOUNDINGBOX)
+		{
+			if (AAS_ClipToBBox(&trace, org, trace.endpos, presencetype, batch->mins, batch->maxs))
+			{
+				VectorCopy(trace.endpos, move->endpos);
+				move->endarea = AAS_PointAreaNum(move->endpos);
+				VectorScale(frame_test_vel, 1/frametime, move->velocity);
+				move->trace = trace;
+				move->stopevent = SE_HITBOUNDINGBOX;
+				move->presencetype = presencetype;
+				move->endcontents = 0;
+				move->time = n * frametime;
+				move->frames = n;
+				return PREDICT_STOPPED;
+			} //end if
+		} //end if
+		//move the entity to the trace end point
+		VectorCopy(trace.endpos, org);
+		//if there was a collision
+		if (trace.fraction < 1.0)
+		{
+			//get the plane the bounding box collided with
+			plane = AAS_PlaneFromNum(trace.planenum);
+			//
+			if (stopevent & SE_HITGROUNDAREA)
+			{
+				if (DotProduct(plane->normal, up) > aassettings.phys_maxsteepness)
+				{
+					VectorCopy(org, start);
+					start[2] += 0.5;
+					if (AAS_PointAreaNum(start) == batch->stopareanum)
+					{
+						VectorCopy(start, move->endpos);
+						move->endarea = batch->stopareanum;
+						VectorScale(frame_test_vel, 1/frametime, move->velocity);
+						move->trace = trace;
+						move->stopevent = SE_HITGROUNDAREA;
+						move->presencetype = presencetype;
+						move->endcontents = 0;
+						move->time = n * frametime;
+						move->frames = n;
+						return PREDICT_STOPPED;
+					} //end if
+				} //end if
+			} //end if
+			//assume there's no step
+			step = qfalse;
+			//if it is a vertical plane and the bot didn't jump recently
+			if (plane->normal[2] == 0 && (batch->jumpframe[c] < 0 || n - batch->jumpframe[c] > 2))
+			{
+				//check for a step
+				VectorMA(org, -0.25, plane->normal, start);
+				VectorCopy(start, stepend);
+				start[2] += aassettings.phys_maxstep;
+				steptrace = AAS_TraceClientBBox(start, stepend, presencetype, batch->entnum);
+				//
+				if (!steptrace.startsolid)
+				{
+					plane2 = AAS_PlaneFromNum(steptrace.planenum);
+					if (DotProduct(plane2->normal, up) > aassettings.phys_maxsteepness)
+					{
+						VectorSubtract(end, steptrace.endpos, left_test_vel);
+						left_test_vel[2] = 0;
+						frame_test_vel[2] = 0;
+//#ifdef AAS_MOVE_DEBUG
+						if (batch->visualize)
+						{
+							if (steptrace.endpos[2] - org[2] > 0.125)
+							{
+								VectorCopy(org, start);
+								start[2] = steptrace.endpos[2];
+								AAS_DebugLine(org, start, LINECOLOR_BLUE);
+							} //end if
+						} //end if
+//#endif //AAS_MOVE_DEBUG
+						org[2] = steptrace.endpos[2];
+						step = qtrue;
+					} //end if
+				} //end if
+			} //end if
+			//
+			if (!step)
+			{
+				//velocity left to test for this frame is the projection
+				//of the current test velocity into the hit plane
+				VectorMA(left_test_vel, -DotProduct(left_test_vel, plane->normal),
+									plane->normal, left_test_vel);
+				//store the old velocity for landing check
+				VectorCopy(frame_test_vel, old_frame_test_vel);
+				//test velocity for the next frame is the projection
+				//of the velocity of the current frame into the hit plane
+				VectorMA(frame_test_vel, -DotProduct(frame_test_vel, plane->normal),
+									plane->normal, frame_test_vel);
+				//check for a landing on an almost horizontal floor
+				if (DotProduct(plane->normal, up) > aassettings.phys_maxsteepness)
+				{
+					onground = qtrue;
+				} //end if
+				if (stopevent & SE_HITGROUNDDAMAGE)
+				{
+					delta = 0;
+					if (old_frame_test_vel[2] < 0 &&
+							frame_test_vel[2] > old_frame_test_vel[2] &&
+							!onground)
+					{
+						delta = old_frame_test_vel[2];
+					} //end if
+					else if (onground)
+					{
+						delta = frame_test_vel[2] - old_frame_test_vel[2];
+					} //end else
+					if (delta)
+					{
+						delta = delta * 10;
+						delta = delta * delta * 0.0001;
+						if (batch->swimming[c]) delta = 0;
+						// never take falling damage if completely underwater
+						/*
+						if (ent->waterlevel == 3) return;
+						if (ent->waterlevel == 2) delta *= 0.25;
+						if (ent->waterlevel == 1) delta *= 0.5;
+						*/
+						if (delta > 40)
+						{
+							VectorCopy(org, move->endpos);
+							move->endarea = AAS_PointAreaNum(org);
+							VectorCopy(frame_test_vel, move->velocity);
+							move->trace = trace;
+							move->stopevent = SE_HITGROUNDDAMAGE;
+							move->presencetype = presencetype;
+							move->endcontents = 0;
+							move->time = n * frametime;
+							move->frames = n;
+							return PREDICT_STOPPED;
+						} //end if
+					} //end if
+				} //end if
+			} //end if
+		} //end if
+		//extra check to prevent endless loop
+		if (++j > 20) return PREDICT_FAILED;
+	//while there is a plane hit
+	} while(trace.fraction < 1.0);
+	//if going down
+	if (frame_test_vel[2] <= 10)
+	{
+		//check for a liquid at the feet of the bot
+		VectorCopy(org, feet);
+		feet[2] -= 22;
+		pc = AAS_PointContents(feet);
+		//get event from pc
+		event = SE_NONE;
+		if (pc & CONTENTS_LAVA) event |= SE_ENTERLAVA;
+		if (pc & CONTENTS_SLIME) event |= SE_ENTERSLIME;
+		if (pc & CONTENTS_WATER) event |= SE_ENTERWATER;
+		//
+		areanum = AAS_PointAreaNum(org);
+		if (aasworld.areasettings[areanum].contents & AREACONTENTS_LAVA)
+			event |= SE_ENTERLAVA;
+		if (aasworld.areasettings[areanum].contents & AREACONTENTS_SLIME)
+			event |= SE_ENTERSLIME;
+		if (aasworld.areasettings[areanum].contents & AREACONTENTS_WATER)
+			event |= SE_ENTERWATER;
+		//if in lava or slime
+		if (event & stopevent)
+		{
+			VectorCopy(org, move->endpos);
+			move->endarea = areanum;
+			VectorScale(frame_test_vel, 1/frametime, move->velocity);
+			move->stopevent = event & stopevent;
+			move->presencetype = presencetype;
+			move->endcontents = pc;
+			move->time = n * frametime;
+			move->frames = n;
+			return PREDICT_STOPPED;
+		} //end if
+	} //end if
+	//
+	onground = AAS_OnGround(org, presencetype, batch->entnum);
+	//if onground and on the ground for at least one whole frame
+	if (onground)
+	{
+		if (stopevent & SE_HITGROUND)
+		{
+			VectorCopy(org, move->endpos);
+			move->endarea = AAS_PointAreaNum(org);
+			VectorScale(frame_test_vel, 1/frametime, move->velocity);
+			move->trace = trace;
+			move->stopevent = SE_HITGROUND;
+			move->presencetype = presencetype;
+			move->endcontents = 0;
+			move->time = n * frametime;
+			move->frames = n;
+			return PREDICT_STOPPED;
+		} //end if
+	} //end if
+	else if (stopevent & SE_LEAVEGROUND)
+	{
+		VectorCopy(org, move->endpos);
+		move->endarea = AAS_PointAreaNum(org);
+		VectorScale(frame_test_vel, 1/frametime, move->velocity);
+		move->trace = trace;
+		move->stopevent = SE_LEAVEGROUND;
+		move->presencetype = presencetype;
+		move->endcontents = 0;
+		move->time = n * frametime;
+		move->frames = n;
+		return PREDICT_STOPPED;
+	} //end else if
+	else if (stopevent & SE_GAP)
+	{
+		aas_trace_t gaptrace;
+
+		VectorCopy(org, start);
+		VectorCopy(start, end);
+		end[2] -= 48 + aassettings.phys_maxbarrier;
+		gaptrace = AAS_TraceClientBBox(start, end, PRESENCE_CROUCH, -1);
+		//if solid is found the bot cannot walk any further and will not fall into a gap
+		if (!gaptrace.startsolid)
+		{
+			//if it is a gap (lower than one step height)
+			if (gaptrace.endpos[2] < org[2] - aassettings.phys_maxstep - 1)
+			{
+				if (!(AAS_PointContents(end) & CONTENTS_WATER))
+				{
+					VectorCopy(lastorg, move->endpos);
+					move->endarea = AAS_PointAreaNum(lastorg);
+					VectorScale(frame_test_vel, 1/frametime, move->velocity);
+					move->trace = trace;
+					move->stopevent = SE_GAP;
+					move->presencetype = presencetype;
+					move->endcontents = 0;
+					move->time = n * frametime;
+					move->frames = n;
+					return PREDICT_STOPPED;
+				} //end if
+			} //end if
+		} //end if
+	} //end else if
+	//store the state for the next frame
+	batch->orgx[c] = org[0];
+	batch->orgy[c] = org[1];
+	batch->orgz[c] = org[2];
+	batch->velx[c] = frame_test_vel[0];
+	batch->vely[c] = frame_test_vel[1];
+	batch->velz[c] = frame_test_vel[2];
+	batch->presencetype[c] = presencetype;
+	batch->onground[c] = onground;
+	return PREDICT_MOVING;
+} //end of the function AAS_PredictMovementFrame
+//===========================================================================
+// predicts the movement of a batch of at most MAX_PREDICTCANDIDATES
+// candidates
+//
+// Parameter:			batch		: candidates to predict
+//						origin		: origin to start with
+//						velocities	: velocity of each candidate to start with
+//						cmdmoves	: client command movement of each candidate
+//						cmdframes	: number of frame cmdmove is valid
+//						maxframes	: maximum number of predicted frames
+// Returns:				number of candidates predicted
+// Changes Globals:		-
+//===========================================================================
+static int AAS_PredictMovementBatch(aas_movebatch_t *batch, vec3_t origin,
+										vec3_t *velocities, vec3_t *cmdmoves,
+										int cmdframes, int maxframes)
+{
+	float phys_friction, phys_stopspeed, phys_gravity, phys_waterfriction;
+	float phys_watergravity;
+	float phys_walkaccelerate, phys_airaccelerate, phys_swimaccelerate;
+	float phys_maxwalkvelocity, phys_maxcrouchvelocity, phys_maxswimvelocity;
+	float phys_jumpvel, frametime, invframetime, friction;
+	float maxvel, speed, control, newspeed, scale;
+	float currentspeed, addspeed, accelspeed, velx, vely, velz;
+	int n, c, numcandidates, nummoving, predicted, apply;
+	vec3_t org, wishdir;
+
+	numcandidates = batch->numcandidates;
+	frametime = batch->frametime;
+	invframetime = 1 / frametime;
+	//
+	phys_friction = aassettings.phys_friction;
+	phys_stopspeed = aassettings.phys_stopspeed;
+	phys_gravity = aassettings.phys_gravity;
+	phys_waterfriction = aassettings.phys_waterfriction;
+	phys_watergravity = aassettings.phys_watergravity;
+	phys_maxwalkvelocity = aassettings.phys_maxwalkvelocity;// * frametime;
+	phys_maxcrouchvelocity = aassettings.phys_maxcrouchvelocity;// * frametime;
+	phys_maxswimvelocity = aassettings.phys_maxswimvelocity;// * frametime;
+	phys_walkaccelerate = aassettings.phys_walkaccelerate;
+	phys_airaccelerate = aassettings.phys_airaccelerate;
+	phys_swimaccelerate = aassettings.phys_swimaccelerate;
+	phys_jumpvel = aassettings.phys_jumpvel * frametime;
+	//
+	for (c = 0; c < numcandidates; c++)
+	{
+		Com_Memset(&batch->moves[c], 0, sizeof(aas_clientmove_t));
+		//start at the current origin
+		batch->orgx[c] = origin[0];
+		batch->orgy[c] = origin[1];
+		batch->orgz[c] = origin[2] + 0.25;
+		//velocity to test for the first frame
+		batch->velx[c] = velocities[c][0] * frametime;
+		batch->vely[c] = velocities[c][1] * frametime;
+		batch->velz[c] = velocities[c][2] * frametime;
+		batch->jumpframe[c] = -1;
+		batch->state[c] = PREDICT_MOVING;
+	} //end for
+	nummoving = numcandidates;
+	//predict a maximum of 'maxframes' ahead
+	for (n = 0; n < maxframes && nummoving; n++)
+	{
+		for (c = 0; c < numcandidates; c++)
+		{
+			if (batch->state[c] != PREDICT_MOVING) continue;
+			VectorSet(org, batch->orgx[c], batch->orgy[c], batch->orgz[c]);
+			batch->swimming[c] = AAS_Swimming(org);
+			//get gravity depending on swimming or not
+			batch->gravity[c] = batch->swimming[c] ? phys_watergravity : phys_gravity;
+			friction = batch->swimming[c] ? phys_waterfriction : phys_friction;
+			//the friction scale is calculated here because vectorized square
+			//roots and divisions may be approximated with -ffast-math which
+			//would make the prediction depend on the number of candidates
+			velx = batch->velx[c] * invframetime;
+			vely = batch->vely[c] * invframetime;
+			//horizontal speed
+			speed = sqrt(velx * velx + vely * vely);
+			control = speed < phys_stopspeed ? phys_stopspeed : speed;
+			newspeed = speed - frametime * control * friction;
+			if (newspeed < 0) newspeed = 0;
+			batch->frictionscale[c] = speed ? newspeed / speed : 1;
+		} //end for
+		//apply gravity at the START of the frame
+		for (c = 0; c < numcandidates; c++)
+		{
+			batch->velz[c] = batch->velz[c] - (batch->gravity[c] * 0.1 * frametime);
+		} //end for
+		//apply friction if on the ground or swimming
+		for (c = 0; c < numcandidates; c++)
+		{
+			velx = batch->velx[c] * invframetime;
+			vely = batch->vely[c] * invframetime;
+			velz = batch->velz[c] * invframetime;
+			scale = batch->frictionscale[c];
+			//select instead of branch so the loop stays vectorizable
+			apply = batch->onground[c] | batch->swimming[c];
+			batch->velx[c] = apply ? velx * scale * frametime : batch->velx[c];
+			batch->vely[c] = apply ? vely * scale * frametime : batch->vely[c];
+			batch->velz[c] = apply ? velz * frametime : batch->velz[c];
+		} //end for
+		//apply command movement
+		if (n < cmdframes)
+		{
+			for (c = 0; c < numcandidates; c++)
+			{
+				batch->crouch[c] = qfalse;
+				maxvel = phys_maxwalkvelocity;
+				batch->accelerate[c] = phys_airaccelerate;
+				VectorCopy(cmdmoves[c], wishdir);
+				if (batch->onground[c])
+				{
+					if (cmdmoves[c][2] < -300)
+					{
+						batch->crouch[c] = qtrue;
+						maxvel = phys_maxcrouchvelocity;
+					} //end if
+					//if not swimming and upmove is positive then jump
+					if (!batch->swimming[c] && cmdmoves[c][2] > 1)
+					{
+						//jump velocity minus the gravity for one frame + 5 for safety
+						batch->velz[c] = phys_jumpvel - (phys_gravity * 0.1 * frametime) + 5;
+						batch->jumpframe[c] = n;
+						//jumping so air accelerate
+						batch->accelerate[c] = phys_airaccelerate;
+					} //end if
+					else
+					{
+						batch->accelerate[c] = phys_walkaccelerate;
+					} //end else
+				} //end if
+				if (batch->swimming[c])
+				{
+					maxvel = phys_maxswimvelocity;
+					batch->accelerate[c] = phys_swimaccelerate;
+				} //end if
+				else
+				{
+					wishdir[2] = 0;
+				} //end else
+				//
+				batch->wishspeed[c] = VectorNormalize(wishdir);
+				if (batch->wishspeed[c] > maxvel) batch->wishspeed[c] = maxvel;
+				batch->wishx[c] = wishdir[0];
+				batch->wishy[c] = wishdir[1];
+				batch->wishz[c] = wishdir[2];
+			} //end for
+			//accelerate q2 style
+			for (c = 0; c < numcandidates; c++)
+			{
+				velx = batch->velx[c] * invframetime;
+				vely = batch->vely[c] * invframetime;
+				velz = batch->velz[c] * invframetime;
+				currentspeed = velx * batch->wishx[c] + vely * batch->wishy[c] + velz * batch->wishz[c];
+				addspeed = batch->wishspeed[c] - currentspeed;
+				accelspeed = batch->accelerate[c] * frametime * batch->wishspeed[c];
+				if (accelspeed > addspeed) accelspeed = addspeed;
+				if (addspeed > 0)
+				{
+					velx = velx + accelspeed * batch->wishx[c];
+					vely = vely + accelspeed * batch->wishy[c];
+					velz = velz + accelspeed * batch->wishz[c];
+				} //end if
+				batch->velx[c] = velx * frametime;
+				batch->vely[c] = vely * frametime;
+				batch->velz[c] = velz * frametime;
+			} //end for
+		} //end if
+		else
+		{
+			for (c = 0; c < numcandidates; c++) batch->crouch[c] = qfalse;
+		} //end else
+		//move the candidates through the world
+		for (c = 0; c < numcandidates; c++)
+		{
+			if (batch->state[c] != PREDICT_MOVING) continue;
+			batch->state[c] = AAS_PredictMovementFrame(batch, c, n);
+			if (batch->state[c] != PREDICT_MOVING) nummoving--;
+		} //end for
+	} //end for
+	//
+	predicted = 0;
+	for (c = 0; c < numcandidates; c++)
+	{
+		if (batch->state[c] == PREDICT_FAILED) continue;
+		predicted++;
+		if (batch->state[c] != PREDICT_MOVING) continue;
+		VectorSet(org, batch->orgx[c], batch->orgy[c], batch->orgz[c]);
+		VectorCopy(org, batch->moves[c].endpos);
+		batch->moves[c].endarea = AAS_PointAreaNum(org);
+		batch->moves[c].velocity[0] = batch->velx[c] * invframetime;
+		batch->moves[c].velocity[1] = batch->vely[c] * invframetime;
+		batch->moves[c].velocity[2] = batch->velz[c] * invframetime;
+		batch->moves[c].stopevent = SE_NONE;
+		batch->moves[c].presencetype = batch->presencetype[c];
+		batch->moves[c].endcontents = 0;
+		batch->moves[c].time = n * frametime;
+		batch->moves[c].frames = n;
+	} //end for
+	return predicted;
+} //end of the function AAS_PredictMovementBatch
+//===========================================================================
+// predicts the movement of several candidates starting at the same origin
+// assumes regular bounding box sizes
+// NOTE: out of water jumping is not included
+// NOTE: grappling hook is not included
+//
+// Parameter:			moves			: prediction of each candidate
+//						numcandidates	: number of candidates
+//						origin			: origin to start with
+//						presencetype	: presence type to start with
+//						velocities		: velocity of each candidate to start with
+//						cmdmoves		: client command movement of each candidate
+//						cmdframes		: number of frame cmdmove is valid
+//						maxframes		: maximum number of predicted frames
+//						frametime		: duration of one predicted frame
+//						stopevent		: events that stop the prediction
+//						stopareanum		: stop as soon as entered this area
+// Returns:				number of candidates predicted, the aas_clientmove_t
+//						of a candidate that could not be predicted is cleared
+// Changes Globals:		-
+//===========================================================================
+int AAS_ClientMovementPredictions(struct aas_clientmove_s *moves, int numcandidates,
+								int entnum, vec3_t origin,
+								int presencetype, int onground,
+								vec3_t *velocities, vec3_t *cmdmoves,
+								int cmdframes,
+								int maxframes, float frametime,
+								int stopevent, int stopareanum,
+								vec3_t mins, vec3_t maxs, int visualize)
+{
+	aas_movebatch_t batch;
+	int i, c, predicted;
+
+	if (frametime <= 0) frametime = 0.1f;
+	//
+	batch.entnum = entnum;
+	batch.stopevent = stopevent;
+	batch.stopareanum = stopareanum;
+	batch.frametime = frametime;
+	batch.mins = mins;
+	batch.maxs = maxs;
+	batch.visualize = visualize;
+	//
+	predicted = 0;
+	for (i = 0; i < numcandidates; i += MAX_PREDICTCANDIDATES)
+	{
+		batch.numcandidates = numcandidates - i;
+		if (batch.numcandidates > MAX_PREDICTCANDIDATES) batch.numcandidates = MAX_PREDICTCANDIDATES;
+		batch.moves = &moves[i];
+		for (c = 0; c < batch.numcandidates; c++)
+		{
+			batch.presencetype[c] = presencetype;
+			batch.onground[c] = onground;
+		} //end for
+		predicted += AAS_PredictMovementBatch(&batch, origin, &velocities[i],
+												&cmdmoves[i], cmdframes, maxframes);
+	} //end for
+	return predicted;
+} //end of the function AAS_ClientMovementPredictions
+//===========================================================================
 //
 // Parameter:			-
 // Returns:				-
@@ -995,6 +1687,28 @@ int AAS_PredictClientMovement(struct aas_clientmove_s *move,
 										mins, maxs, visualize);
 } //end of the function AAS_PredictClientMovement
 //===========================================================================
+// predicts the movement of several candidate velocities and command
+// movements of a client at once
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+int AAS_PredictClientMovements(struct aas_clientmove_s *moves, int numcandidates,
+								int entnum, vec3_t origin,
+								int presencetype, int onground,
+								vec3_t *velocities, vec3_t *cmdmoves,
+								int cmdframes,
+								int maxframes, float frametime,
+								int stopevent, int stopareanum, int visualize)
+{
+	vec3_t mins, maxs;
+	return AAS_ClientMovementPredictions(moves, numcandidates, entnum, origin,
+										presencetype, onground, velocities, cmdmoves,
+										cmdframes, maxframes, frametime, stopevent,
+										stopareanum, mins, maxs, visualize);
+} //end of the function AAS_PredictClientMovements
+//===========================================================================
 //
 // Parameter:			-
 // Returns:				-
@@ -41,6 +41,15 @@ int AAS_PredictClientMovement(struct aas_clientmove_s *move,
 							int cmdframes,
 							int maxframes, float frametime,
 							int stopevent, int stopareanum, int visualize);
+//predict the movement of several candidate velocities and command movements
+//starting at the same origin, returns the number of candidates predicted
+int AAS_PredictClientMovements(struct aas_clientmove_s *moves, int numcandidates,
+							int entnum, vec3_t origin,
+							int presencetype, int onground,
+							vec3_t *velocities, vec3_t *cmdmoves,
+							int cmdframes,
+							int maxframes, float frametime,
+							int stopevent, int stopareanum, int visualize);
 //predict movement until bounding box is hit
 int AAS_ClientMovementHitBBox(struct aas_clientmove_s *move,
 								int entnum, vec3_t origin,
@@ -61,6 +61,8 @@ extern botlib_import_t botimport;
 #define INSIDEUNITS_WATERJUMP				15
 //area flag used for weapon jumping
 #define AREA_WEAPONJUMP						8192	//valid area to weapon jump to
+//maximum number of jump pad landing faces predicted in one batch
+#define MAX_JUMPPAD_CANDIDATES				16
 //number of reachabilities of each type
 int reach_swim;			//swim
 int reach_equalfloor;	//walk on floors with equal height
@@ -311,7 +313,7 @@ int AAS_BestReachableFromJumpPadArea(vec3_t origin, vec3_t mins, vec3_t maxs)
 		//
 		if (!AAS_GetJumpPadInfo(ent, areastart, absmins, absmaxs, velocity)) continue;
 		//get the areas the jump pad brush is in
-		areas = AAS_LinkEntityClientBBox(absmins, absmaxs, -1, PRESENCE_CROUCH);
+		areas = AAS_LinkEntityClientBBox(absmins, absmaxs, -1, PRESENCE_CROUCH, NULL);
 		for (link = areas; link; link = link->next_area)
 		{
 			if (AAS_AreaJumpPad(link->areanum)) break;
@@ -438,7 +440,7 @@ int AAS_BestReachableArea(vec3_t origin, vec3_t mins, vec3_t maxs, vec3_t goalor
 	//VectorSubtract(absmins, bbmaxs, absmins);
 	//VectorSubtract(absmaxs, bbmins, absmaxs);
 	//link an invalid (-1) entity
-	areas = AAS_LinkEntityClientBBox(absmins, absmaxs, -1, PRESENCE_CROUCH);
+	areas = AAS_LinkEntityClientBBox(absmins, absmaxs, -1, PRESENCE_CROUCH, NULL);
 	//get the reachable link area
 	areanum = AAS_BestReachableLinkArea(areas);
 	//unlink the invalid entity
@@ -2894,7 +2896,7 @@ void AAS_Reachability_Teleport(void)
 		VectorAdd(mins, maxs, mid);
 		VectorScale(mid, 0.5, mid);
 		//link an invalid (-1) entity
-		areas = AAS_LinkEntityClientBBox(mins, maxs, -1, PRESENCE_CROUCH);
+		areas = AAS_LinkEntityClientBBox(mins, maxs, -1, PRESENCE_CROUCH, NULL);
 		if (!areas) botimport.Print(PRT_MESSAGE, "trigger_multiple not in any area\n");
 		//
 		for (link = areas; link; link = link->next_area)
@@ -3486,7 +3488,8 @@ void AAS_Reachability_FuncBobbing(void)
 //===========================================================================
 void AAS_Reachability_JumpPad(void)
 {
-	int face2num, i, ret, area2num, visualize, ent, bot_visualizejumppads;
+	int face2num, i, j, ret, area2num, visualize, ent, bot_visualizejumppads;
+	int numcandidates;
 	//int modelnum, ent2;
 	//float dist, time, height, gravity, forward;
 	float speed, zvel;
@@ -3497,7 +3500,9 @@ void AAS_Reachability_JumpPad(void)
 	vec3_t areastart, facecenter, dir, cmdmove;
 	vec3_t velocity, absmins, absmaxs;
 	//vec3_t origin, ent2origin, angles, teststart;
-	aas_clientmove_t move;
+	vec3_t velocities[MAX_JUMPPAD_CANDIDATES], cmdmoves[MAX_JUMPPAD_CANDIDATES];
+	vec3_t facecenters[MAX_JUMPPAD_CANDIDATES];
+	aas_clientmove_t move, moves[MAX_JUMPPAD_CANDIDATES];
 	//aas_trace_t trace;
 	aas_link_t *areas, *link;
 	//char target[MAX_EPAIRKEY], targetname[MAX_EPAIRKEY], model[MAX_EPAIRKEY];
@@ -3585,7 +3590,7 @@ void AAS_Reachability_JumpPad(void)
 		velocity[2] = time * gravity;
 		*/
 		//get the areas the jump pad brush is in
-		areas = AAS_LinkEntityClientBBox(absmins, absmaxs, -1, PRESENCE_CROUCH);
+		areas = AAS_LinkEntityClientBBox(absmins, absmaxs, -1, PRESENCE_CROUCH, NULL);
 		/*
 		for (link = areas; link; link = link->next_area)
 		{
@@ -3692,78 +3697,90 @@ void AAS_Reachability_JumpPad(void)
 			if (link) continue;
 			//
 			area2 = &aasworld.areas[area2num];
-			for (i = 0; i < area2->numfaces; i++)
+			//predict the air controlled jumps towards the ground faces of area2 in batches
+			for (i = 0; i < area2->numfaces;)
 			{
-				face2num = aasworld.faceindex[area2->firstface + i];
-				face2 = &aasworld.faces[abs(face2num)];
-				//if it is not a ground face
-				if (!(face2->faceflags & FACE_GROUND)) continue;
-				//get the center of the face
-				AAS_FaceCenter(face2num, facecenter);
-				//only go higher up
-				if (facecenter[2] < areastart[2]) continue;
-				//get the jumppad jump z velocity
-				zvel = velocity[2];
-				//get the horizontal speed for the jump, if it isn't possible to calculate this
-				//speed
-				ret = AAS_HorizontalVelocityForJump(zvel, areastart, facecenter, &speed);
-				if (ret && speed < 150)
+				numcandidates = 0;
+				for (; i < area2->numfaces && numcandidates < MAX_JUMPPAD_CANDIDATES; i++)
 				{
-					//direction towards the face center
-					VectorSubtract(facecenter, areastart, dir);
-					dir[2] = 0;
-					//hordist = VectorNormalize(dir);
-					//if (hordist < 1.6 * facecenter[2] - areastart[2])
+					face2num = aasworld.faceindex[area2->firstface + i];
+					face2 = &aasworld.faces[abs(face2num)];
+					//if it is not a ground face
+					if (!(face2->faceflags & FACE_GROUND)) continue;
+					//get the center of the face
+					AAS_FaceCenter(face2num, facecenter);
+					//only go higher up
+					if (facecenter[2] < areastart[2]) continue;
+					//get the jumppad jump z velocity
+					zvel = velocity[2];
+					//get the horizontal speed for the jump, if it isn't possible to calculate this
+					//speed
+					ret = AAS_HorizontalVelocityForJump(zvel, areastart, facecenter, &speed);
+					if (ret && speed < 150)
 					{
-						//get command movement
-						VectorScale(dir, speed, cmdmove);
-						//
-						AAS_PredictClientMovement(&move, -1, areastart, PRESENCE_NORMAL, qfalse,
-													velocity, cmdmove, 30, 30, 0.1f,
-													SE_ENTERWATER|SE_ENTERSLIME|
-													SE_ENTERLAVA|SE_HITGROUNDDAMAGE|
-													SE_TOUCHJUMPPAD|SE_TOUCHTELEPORTER|SE_HITGROUNDAREA, area2num, visualize);
-						//if prediction time wasn't enough to fully predict the movement
-						//don't enter slime or lava and don't fall from too high
-						if (move.frames < 30 && 
-								!(move.stopevent & (SE_ENTERSLIME|SE_ENTERLAVA|SE_HITGROUNDDAMAGE))
-								&& (move.stopevent & (SE_HITGROUNDAREA|SE_TOUCHJUMPPAD|SE_TOUCHTELEPORTER)))
+						//direction towards the face center
+						VectorSubtract(facecenter, areastart, dir);
+						dir[2] = 0;
+						//hordist = VectorNormalize(dir);
+						//if (hordist < 1.6 * facecenter[2] - areastart[2])
+						{
+							//get command movement
+							VectorScale(dir, speed, cmdmoves[numcandidates]);
+							VectorCopy(velocity, velocities[numcandidates]);
+							VectorCopy(facecenter, facecenters[numcandidates]);
+							numcandidates++;
+						} //end if
+					} //end if
+				} //end for
+				if (!numcandidates) continue;
+				//
+				AAS_PredictClientMovements(moves, numcandidates, -1, areastart, PRESENCE_NORMAL, qfalse,
+											velocities, cmdmoves, 30, 30, 0.1f,
+											SE_ENTERWATER|SE_ENTERSLIME|
+											SE_ENTERLAVA|SE_HITGROUNDDAMAGE|
+											SE_TOUCHJUMPPAD|SE_TOUCHTELEPORTER|SE_HITGROUNDAREA, area2num, visualize);
+				for (j = 0; j < numcandidates; j++)
+				{
+					//if prediction time wasn't enough to fully predict the movement
+					//don't enter slime or lava and don't fall from too high
+					if (moves[j].frames < 30 &&
+							!(moves[j].stopevent & (SE_ENTERSLIME|SE_ENTERLAVA|SE_HITGROUNDDAMAGE))
+							&& (moves[j].stopevent & (SE_HITGROUNDAREA|SE_TOUCHJUMPPAD|SE_TOUCHTELEPORTER)))
+					{
+						//never go back to the same jumppad
+						for (link = areas; link; link = link->next_area)
+						{
+							if (link->areanum == moves[j].endarea) break;
+						}
+						if (!link)
 						{
-							//never go back to the same jumppad
 							for (link = areas; link; link = link->next_area)
 							{
-								if (link->areanum == move.endarea) break;
-							}
-							if (!link)
-							{
-								for (link = areas; link; link = link->next_area)
+								if (!AAS_AreaJumpPad(link->areanum)) continue;
+								if (AAS_ReachabilityExists(link->areanum, area2num)) continue;
+								//create a jumppad reachability from area1 to area2
+								lreach = AAS_AllocReachability();
+								if (!lreach)
 								{
-									if (!AAS_AreaJumpPad(link->areanum)) continue;
-									if (AAS_ReachabilityExists(link->areanum, area2num)) continue;
-									//create a jumppad reachability from area1 to area2
-									lreach = AAS_AllocReachability();
-									if (!lreach)
-									{
-										AAS_UnlinkFromAreas(areas);
-										return;
-									} //end if
-									lreach->areanum = move.endarea;
-									//NOTE: the facenum is the Z velocity
-									lreach->facenum = velocity[2];
-									//NOTE: the edgenum is the horizontal velocity
-									lreach->edgenum = sqrt(cmdmove[0] * cmdmove[0] + cmdmove[1] * cmdmove[1]);
-									VectorCopy(areastart, lreach->start);
-									VectorCopy(facecenter, lreach->end);
-									lreach->traveltype = TRAVEL_JUMPPAD;
-									lreach->traveltype |= AAS_TravelFlagsForTeam(ent);
-									lreach->traveltime = aassettings.rs_aircontrolledjumppad;
-									lreach->next = areareachability[link->areanum];
-									areareachability[link->areanum] = lreach;
-									//
-									reach_jumppad++;
-								} //end for
-							}
-						} //end if
+									AAS_UnlinkFromAreas(areas);
+									return;
+								} //end if
+								lreach->areanum = moves[j].endarea;
+								//NOTE: the facenum is the Z velocity
+								lreach->facenum = velocity[2];
+								//NOTE: the edgenum is the horizontal velocity
+								lreach->edgenum = sqrt(cmdmoves[j][0] * cmdmoves[j][0] + cmdmoves[j][1] * cmdmoves[j][1]);
+								VectorCopy(areastart, lreach->start);
+								VectorCopy(facecenters[j], lreach->end);
+								lreach->traveltype = TRAVEL_JUMPPAD;
+								lreach->traveltype |= AAS_TravelFlagsForTeam(ent);
+								lreach->traveltime = aassettings.rs_aircontrolledjumppad;
+								lreach->next = areareachability[link->areanum];
+								areareachability[link->areanum] = lreach;
+								//
+								reach_jumppad++;
+							} //end for
+						}
 					} //end if
 				} //end for
 			} //end for
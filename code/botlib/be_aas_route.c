@@ -58,6 +58,9 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 //maximum number of routing updates each frame
 #define MAX_FRAMEROUTINGUPDATES		10
 
+//stop evicting after this many freed slabs in a row gave no memory back
+#define MAX_CACHEEVICTIONMISSES		8
+
 
 /*
 
@@ -83,6 +86,8 @@ int numportalcacheupdates;
 
 int routingcachesize;
 int max_routingcachesize;
+//crc of the area settings when routing was initialized
+int routingsettingscrc;
 
 //===========================================================================
 //
@@ -236,7 +241,7 @@ void AAS_FreeRoutingCache(aas_routingcache_t *cache)
 {
 	AAS_UnlinkCache(cache);
 	routingcachesize -= cache->size;
-	FreeMemory(cache);
+	FreePoolMemory(cache);
 } //end of the function AAS_FreeRoutingCache
 //===========================================================================
 //
@@ -329,6 +334,12 @@ int AAS_EnableRoutingArea(int areanum, int enable)
 	{
 		//remove all routing cache involving this area
 		AAS_RemoveRoutingCacheUsingArea( areanum );
+		//the routing tables are only valid while all areas have their initial state
+		if (aasworld.initialareadisabled)
+		{
+			if ((flags != AREA_DISABLED) != aasworld.initialareadisabled[areanum]) aasworld.numchangedroutingareas++;
+			else aasworld.numchangedroutingareas--;
+		} //end if
 	} //end if
 	return !flags;
 } //end of the function AAS_EnableRoutingArea
@@ -694,39 +705,161 @@ int AAS_FreeOldestCache(void)
 // Returns:				-
 // Changes Globals:		-
 //===========================================================================
-int AAS_FreeOldestCache(void)
+static int AAS_CacheFreeable(aas_routingcache_t *cache)
+{
+	// never free area cache leading towards a portal
+	return !(cache->type == CACHETYPE_AREA && aasworld.areasettings[cache->areanum].cluster < 0);
+} //end of the function AAS_CacheFreeable
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_RemoveCache(aas_routingcache_t *cache)
 {
 	int clusterareanum;
-	aas_routingcache_t *cache;
+
+	if (cache->type == CACHETYPE_AREA) {
+		//number of the area in the cluster
+		clusterareanum = AAS_ClusterAreaNum(cache->cluster, cache->areanum);
+		// unlink from cluster area cache
+		if (cache->prev) cache->prev->next = cache->next;
+		else aasworld.clusterareacache[cache->cluster][clusterareanum] = cache->next;
+		if (cache->next) cache->next->prev = cache->prev;
+	}
+	else {
+		// unlink from portal cache
+		if (cache->prev) cache->prev->next = cache->next;
+		else aasworld.portalcache[cache->areanum] = cache->next;
+		if (cache->next) cache->next->prev = cache->prev;
+	}
+	AAS_FreeRoutingCache(cache);
+} //end of the function AAS_RemoveCache
+//===========================================================================
+// frees the oldest cache together with all other freeable caches in the
+// same pool slab, freeing a single block of a partly used slab doesn't give
+// any memory back
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+int AAS_FreeOldestCacheSlab(void)
+{
+	aas_routingcache_t *cache, *nextcache;
+	memoryslab_t *slab;
+	memorypool_t *pool;
 
 	for (cache = aasworld.oldestcache; cache; cache = cache->time_next) {
-		// never free area cache leading towards a portal
-		if (cache->type == CACHETYPE_AREA && aasworld.areasettings[cache->areanum].cluster < 0) {
+		if (AAS_CacheFreeable(cache)) break;
+	}
+	if (!cache) {
+		return qfalse;
+	}
+	slab = PoolMemorySlab(cache);
+	pool = slab->pool;
+	// newer caches in the same slab follow the oldest one in the time list
+	for (; cache; cache = nextcache) {
+		nextcache = cache->time_next;
+		if (PoolMemorySlab(cache) != slab || !AAS_CacheFreeable(cache)) {
 			continue;
 		}
-		break;
+		AAS_RemoveCache(cache);
+	}
+	// the pool keeps the emptied slab around for reuse, release it right away
+	TrimMemoryPool(pool);
+	return qtrue;
+} //end of the function AAS_FreeOldestCacheSlab
+//===========================================================================
+// frees the oldest caches until there's at least the given amount of
+// memory available
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_FreeCacheMemory(int size)
+{
+	int i, available, misses;
+
+	if (AvailableMemory() >= size) {
+		return;
 	}
-	if (cache) {
-		// unlink the cache
-		if (cache->type == CACHETYPE_AREA) {
-			//number of the area in the cluster
-			clusterareanum = AAS_ClusterAreaNum(cache->cluster, cache->areanum);
-			// unlink from cluster area cache
-			if (cache->prev) cache->prev->next = cache->next;
-			else aasworld.clusterareacache[cache->cluster][clusterareanum] = cache->next;
-			if (cache->next) cache->next->prev = cache->prev;
+	// empty slabs cached by the pools don't hold any cache
+	for (i = 0; i < aasworld.numroutingcachepools; i++) {
+		TrimMemoryPool(aasworld.routingcachepools[i]);
+	}
+	misses = 0;
+	while ((available = AvailableMemory()) < size) {
+		if (!AAS_FreeOldestCacheSlab()) {
+			break;
 		}
-		else {
-			// unlink from portal cache
-			if (cache->prev) cache->prev->next = cache->next;
-			else aasworld.portalcache[cache->areanum] = cache->next;
-			if (cache->next) cache->next->prev = cache->prev;
+		// the slab is still in use when caches leading towards a portal are left in it
+		if (AvailableMemory() > available) {
+			misses = 0;
+		}
+		else if (++misses >= MAX_CACHEEVICTIONMISSES) {
+			if (botDeveloper) {
+				botimport.Print(PRT_MESSAGE, "AAS_FreeCacheMemory: evicting routing cache gives no memory back\n");
+			}
+			break;
 		}
-		AAS_FreeRoutingCache(cache);
-		return qtrue;
 	}
-	return qfalse;
-} //end of the function AAS_FreeOldestCache
+} //end of the function AAS_FreeCacheMemory
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+memorypool_t *AAS_RoutingCachePool(int size)
+{
+	int i, blocksperslab;
+
+	for (i = 0; i < aasworld.numroutingcachepools; i++)
+	{
+		if (aasworld.routingcachepools[i]->blocksize == size) return aasworld.routingcachepools[i];
+	} //end for
+	//there's a cache size for the portals, every cluster and the routing table calculation
+	if (aasworld.numroutingcachepools >= aasworld.numclusters + 2) return NULL;
+	//slabs of about 64 KB
+	blocksperslab = 65536 / size;
+	if (blocksperslab < 1) blocksperslab = 1;
+	if (blocksperslab > 64) blocksperslab = 64;
+	aasworld.routingcachepools[aasworld.numroutingcachepools] = GetMemoryPool("routing cache", size, blocksperslab);
+	return aasworld.routingcachepools[aasworld.numroutingcachepools++];
+} //end of the function AAS_RoutingCachePool
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_InitRoutingCachePools(void)
+{
+	if (aasworld.routingcachepools) FreeMemory(aasworld.routingcachepools);
+	aasworld.routingcachepools = (memorypool_t **) GetClearedMemory((aasworld.numclusters + 2) * sizeof(memorypool_t *));
+	aasworld.numroutingcachepools = 0;
+} //end of the function AAS_InitRoutingCachePools
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_FreeRoutingCachePools(void)
+{
+	int i;
+
+	for (i = 0; i < aasworld.numroutingcachepools; i++)
+	{
+		FreeMemoryPool(aasworld.routingcachepools[i]);
+	} //end for
+	if (aasworld.routingcachepools) FreeMemory(aasworld.routingcachepools);
+	aasworld.routingcachepools = NULL;
+	aasworld.numroutingcachepools = 0;
+} //end of the function AAS_FreeRoutingCachePools
 //===========================================================================
 //
 // Parameter:			-
@@ -745,7 +878,7 @@ aas_routingcache_t *AAS_AllocRoutingCache(int numtraveltimes)
 	//
 	routingcachesize += size;
 	//
-	cache = (aas_routingcache_t *) GetClearedMemory(size);
+	cache = (aas_routingcache_t *) GetClearedPoolMemory(AAS_RoutingCachePool(size));
 	cache->reachabilities = (unsigned char *) cache + sizeof(aas_routingcache_t)
 								+ numtraveltimes * sizeof(unsigned short int);
 	cache->size = size;
@@ -908,6 +1041,95 @@ void AAS_CreateAllRoutingCache(void)
 	aasworld.initialized = qfalse;
 } //end of the function AAS_CreateAllRoutingCache
 //===========================================================================
+// the routing tables store the area routing cache of every area in every
+// cluster and the portal routing cache of every area for one set of travel
+// flags, the tables are laid out in one block:
+// for every cluster numreachabilityareas * numreachabilityareas travel times
+// numareas * numportals portal travel times
+// for every cluster numreachabilityareas * numreachabilityareas reachabilities
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+int AAS_RoutingTableSize(void)
+{
+	int i, n, size;
+
+	size = 0;
+	for (i = 0; i < aasworld.numclusters; i++)
+	{
+		n = aasworld.clusters[i].numreachabilityareas;
+		size += n * n * (sizeof(unsigned short int) + sizeof(unsigned char));
+	} //end for
+	size += aasworld.numareas * aasworld.numportals * sizeof(unsigned short int);
+	return size;
+} //end of the function AAS_RoutingTableSize
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_FreeRoutingTables(void)
+{
+	//the table block itself is hunk memory
+	if (aasworld.clustertraveltimes) FreeMemory(aasworld.clustertraveltimes);
+	aasworld.clustertraveltimes = NULL;
+	if (aasworld.clusterreachabilities) FreeMemory(aasworld.clusterreachabilities);
+	aasworld.clusterreachabilities = NULL;
+	aasworld.portaltraveltimes = NULL;
+	aasworld.routingtable = NULL;
+	aasworld.routingtablesize = 0;
+} //end of the function AAS_FreeRoutingTables
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_SetRoutingTable(void *table, int size, int travelflags)
+{
+	int i, n;
+	unsigned short int *traveltimes;
+	unsigned char *reachabilities;
+
+	AAS_FreeRoutingTables();
+	aasworld.clustertraveltimes = (unsigned short int **) GetClearedMemory(aasworld.numclusters * sizeof(unsigned short int *));
+	aasworld.clusterreachabilities = (unsigned char **) GetClearedMemory(aasworld.numclusters * sizeof(unsigned char *));
+	//
+	traveltimes = (unsigned short int *) table;
+	for (i = 0; i < aasworld.numclusters; i++)
+	{
+		n = aasworld.clusters[i].numreachabilityareas;
+		aasworld.clustertraveltimes[i] = traveltimes;
+		traveltimes += n * n;
+	} //end for
+	aasworld.portaltraveltimes = traveltimes;
+	reachabilities = (unsigned char *) (traveltimes + aasworld.numareas * aasworld.numportals);
+	for (i = 0; i < aasworld.numclusters; i++)
+	{
+		n = aasworld.clusters[i].numreachabilityareas;
+		aasworld.clusterreachabilities[i] = reachabilities;
+		reachabilities += n * n;
+	} //end for
+	//
+	aasworld.routingtable = table;
+	aasworld.routingtablesize = size;
+	aasworld.routingtabletravelflags = travelflags;
+} //end of the function AAS_SetRoutingTable
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static ID_INLINE int AAS_RoutingTableValid(int travelflags)
+{
+	return aasworld.routingtable && travelflags == aasworld.routingtabletravelflags &&
+				!aasworld.numchangedroutingareas;
+} //end of the function AAS_RoutingTableValid
+//===========================================================================
 //
 // Parameter:			-
 // Returns:				-
@@ -916,7 +1138,8 @@ void AAS_CreateAllRoutingCache(void)
 
 //the route cache header
 //this header is followed by numportalcache + numareacache aas_routingcache_t
-//structures that store routing cache
+//structures that store routing cache, and since version 3 by tablesize bytes
+//of routing tables
 typedef struct routecacheheader_s
 {
 	int ident;
@@ -927,10 +1150,16 @@ typedef struct routecacheheader_s
 	int clustercrc;
 	int numportalcache;
 	int numareacache;
+	//version 3
+	int settingscrc;
+	int tabletravelflags;
+	int tablesize;
 } routecacheheader_t;
 
 #define RCID						(('C'<<24)+('R'<<16)+('E'<<8)+'M')
-#define RCVERSION					2
+#define RCVERSION					3
+//size of the version 2 header
+#define RCHEADERSIZE_V2				(8 * sizeof(int))
 
 //void AAS_DecompressVis(byte *in, int numareas, byte *decompressed);
 //int AAS_CompressVis(byte *vis, int numareas, byte *dest);
@@ -981,6 +1210,9 @@ void AAS_WriteRouteCache(void)
 	routecacheheader.clustercrc = CRC_ProcessString( (unsigned char *)aasworld.clusters, sizeof(aas_cluster_t) * aasworld.numclusters );
 	routecacheheader.numportalcache = numportalcache;
 	routecacheheader.numareacache = numareacache;
+	routecacheheader.settingscrc = routingsettingscrc;
+	routecacheheader.tabletravelflags = aasworld.routingtabletravelflags;
+	routecacheheader.tablesize = aasworld.routingtablesize;
 	//write the header
 	botimport.FS_Write(&routecacheheader, sizeof(routecacheheader_t), fp);
 	//
@@ -1006,6 +1238,12 @@ void AAS_WriteRouteCache(void)
 			} //end for
 		} //end for
 	} //end for
+	//write the routing tables
+	if (aasworld.routingtable)
+	{
+		botimport.FS_Write(aasworld.routingtable, aasworld.routingtablesize, fp);
+		totalsize += aasworld.routingtablesize;
+	} //end if
 	// write the visareas
 	/*
 	for (i = 0; i < aasworld.numareas; i++)
@@ -1036,9 +1274,16 @@ aas_routingcache_t *AAS_ReadCache(fileHandle_t fp)
 {
 	int size;
 	aas_routingcache_t *cache;
+	memorypool_t *pool;
 
 	botimport.FS_Read(&size, sizeof(size), fp);
-	cache = (aas_routingcache_t *) GetMemory(size);
+	pool = AAS_RoutingCachePool(size);
+	if (!pool)
+	{
+		botimport.Print(PRT_WARNING, "route cache dump has a routing cache with invalid size %d\n", size);
+		return NULL;
+	} //end if
+	cache = (aas_routingcache_t *) GetPoolMemory(pool);
 	cache->size = size;
 	botimport.FS_Read((unsigned char *)cache + sizeof(size), size - sizeof(size), fp);
 	cache->reachabilities = (unsigned char *) cache + sizeof(aas_routingcache_t) - sizeof(unsigned short) +
@@ -1058,6 +1303,7 @@ int AAS_ReadRouteCache(void)
 	char filename[MAX_QPATH];
 	routecacheheader_t routecacheheader;
 	aas_routingcache_t *cache;
+	void *table;
 
 	Com_sprintf(filename, MAX_QPATH, "maps/%s.rcd", aasworld.mapname);
 	botimport.FS_FOpenFile( filename, &fp, FS_READ );
@@ -1065,13 +1311,18 @@ int AAS_ReadRouteCache(void)
 	{
 		return qfalse;
 	} //end if
-	botimport.FS_Read(&routecacheheader, sizeof(routecacheheader_t), fp );
+	Com_Memset(&routecacheheader, 0, sizeof(routecacheheader_t));
+	botimport.FS_Read(&routecacheheader, RCHEADERSIZE_V2, fp );
 	if (routecacheheader.ident != RCID)
 	{
 		AAS_Error("%s is not a route cache dump\n", filename);
 		return qfalse;
 	} //end if
-	if (routecacheheader.version != RCVERSION)
+	if (routecacheheader.version == RCVERSION)
+	{
+		botimport.FS_Read(&routecacheheader.settingscrc, sizeof(routecacheheader_t) - RCHEADERSIZE_V2, fp );
+	} //end if
+	else if (routecacheheader.version != 2)
 	{
 		AAS_Error("route cache dump has wrong version %d, should be %d\n", routecacheheader.version, RCVERSION);
 		return qfalse;
@@ -1102,6 +1353,11 @@ int AAS_ReadRouteCache(void)
 	for (i = 0; i < routecacheheader.numportalcache; i++)
 	{
 		cache = AAS_ReadCache(fp);
+		if (!cache)
+		{
+			botimport.FS_FCloseFile(fp);
+			return qfalse;
+		} //end if
 		cache->next = aasworld.portalcache[cache->areanum];
 		cache->prev = NULL;
 		if (aasworld.portalcache[cache->areanum])
@@ -1112,6 +1368,11 @@ int AAS_ReadRouteCache(void)
 	for (i = 0; i < routecacheheader.numareacache; i++)
 	{
 		cache = AAS_ReadCache(fp);
+		if (!cache)
+		{
+			botimport.FS_FCloseFile(fp);
+			return qfalse;
+		} //end if
 		clusterareanum = AAS_ClusterAreaNum(cache->cluster, cache->areanum);
 		cache->next = aasworld.clusterareacache[cache->cluster][clusterareanum];
 		cache->prev = NULL;
@@ -1119,6 +1380,22 @@ int AAS_ReadRouteCache(void)
 			aasworld.clusterareacache[cache->cluster][clusterareanum]->prev = cache;
 		aasworld.clusterareacache[cache->cluster][clusterareanum] = cache;
 	} //end for
+	//read the routing tables
+	if (routecacheheader.tablesize)
+	{
+		if (routecacheheader.tablesize == AAS_RoutingTableSize() &&
+				routecacheheader.settingscrc == routingsettingscrc)
+		{
+			table = GetHunkMemory(routecacheheader.tablesize);
+			botimport.FS_Read(table, routecacheheader.tablesize, fp);
+			AAS_SetRoutingTable(table, routecacheheader.tablesize, routecacheheader.tabletravelflags);
+			botimport.Print(PRT_MESSAGE, "loaded %d KB of routing tables\n", routecacheheader.tablesize >> 10);
+		} //end if
+		else
+		{
+			botimport.Print(PRT_WARNING, "%s: routing tables don't match the area settings\n", filename);
+		} //end else
+	} //end if
 	// read the visareas
 	/*
 	aasworld.areavisibility = (byte **) GetClearedMemory(aasworld.numareas * sizeof(byte *));
@@ -1216,6 +1493,25 @@ void AAS_InitReachabilityAreas(void)
 // Returns:				-
 // Changes Globals:		-
 //===========================================================================
+void AAS_InitRoutingTableState(void)
+{
+	int i;
+
+	if (aasworld.initialareadisabled) FreeMemory(aasworld.initialareadisabled);
+	aasworld.initialareadisabled = (byte *) GetClearedMemory(aasworld.numareas * sizeof(byte));
+	for (i = 0; i < aasworld.numareas; i++)
+	{
+		aasworld.initialareadisabled[i] = (aasworld.areasettings[i].areaflags & AREA_DISABLED) != 0;
+	} //end for
+	aasworld.numchangedroutingareas = 0;
+	routingsettingscrc = CRC_ProcessString( (unsigned char *)aasworld.areasettings, sizeof(aas_areasettings_t) * aasworld.numareas );
+} //end of the function AAS_InitRoutingTableState
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
 void AAS_InitRouting(void)
 {
 	AAS_InitTravelFlagFromType();
@@ -1229,6 +1525,8 @@ void AAS_InitRouting(void)
 	AAS_InitClusterAreaCache();
 	//initialize portal cache
 	AAS_InitPortalCache();
+	//initialize the routing cache memory pools
+	AAS_InitRoutingCachePools();
 	//initialize the area travel times
 	AAS_CalculateAreaTravelTimes();
 	//calculate the maximum travel times through portals
@@ -1243,10 +1541,161 @@ void AAS_InitRouting(void)
 	//
 	routingcachesize = 0;
 	max_routingcachesize = 1024 * (int) LibVarValue("max_routingcache", "4096");
+	//remember the initial area state the routing tables are valid for
+	AAS_InitRoutingTableState();
 	// read any routing cache if available
 	AAS_ReadRouteCache();
 } //end of the function AAS_InitRouting
 //===========================================================================
+// routing caches are calculated on worker threads by AAS_PrecalculateRoutes
+// while the main thread waits for them, caches are never freed meanwhile
+// and new caches are only added to the time sorted list afterwards
+//===========================================================================
+void AAS_UpdateAreaRoutingCache(aas_routingcache_t *areacache, aas_routingupdate_t *areaupdate);
+void AAS_UpdatePortalRoutingCache(int thread, aas_routingcache_t *portalcache);
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_InitThreadRouting(void)
+{
+	int i, maxreachabilityareas;
+
+	if (!aasworld.routingmutex)
+	{
+		aasworld.routingmutex = botimport.MutexCreate();
+	} //end if
+	if (aasworld.threadareaupdate[0]) return;
+	//
+	maxreachabilityareas = 0;
+	for (i = 0; i < aasworld.numclusters; i++)
+	{
+		if (aasworld.clusters[i].numreachabilityareas > maxreachabilityareas)
+		{
+			maxreachabilityareas = aasworld.clusters[i].numreachabilityareas;
+		} //end if
+	} //end for
+	//allocate routing update fields for every worker thread
+	for (i = 0; i < BOTLIB_MAX_THREADS; i++)
+	{
+		aasworld.threadareaupdate[i] = (aas_routingupdate_t *) GetClearedMemory(
+									maxreachabilityareas * sizeof(aas_routingupdate_t));
+		aasworld.threadportalupdate[i] = (aas_routingupdate_t *) GetClearedMemory(
+									(aasworld.numportals+1) * sizeof(aas_routingupdate_t));
+	} //end for
+} //end of the function AAS_InitThreadRouting
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_FreeThreadRouting(void)
+{
+	int i;
+
+	for (i = 0; i < BOTLIB_MAX_THREADS; i++)
+	{
+		if (aasworld.threadareaupdate[i]) FreeMemory(aasworld.threadareaupdate[i]);
+		aasworld.threadareaupdate[i] = NULL;
+		if (aasworld.threadportalupdate[i]) FreeMemory(aasworld.threadportalupdate[i]);
+		aasworld.threadportalupdate[i] = NULL;
+	} //end for
+	if (aasworld.routingmutex) botimport.MutexDestroy(aasworld.routingmutex);
+	aasworld.routingmutex = NULL;
+	aasworld.threadcaches = NULL;
+} //end of the function AAS_FreeThreadRouting
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static aas_routingcache_t **AAS_RoutingCacheList(int type, int clusternum, int areanum)
+{
+	if (type == CACHETYPE_AREA)
+	{
+		return &aasworld.clusterareacache[clusternum][AAS_ClusterAreaNum(clusternum, areanum)];
+	} //end if
+	return &aasworld.portalcache[areanum];
+} //end of the function AAS_RoutingCacheList
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static aas_routingcache_t *AAS_FindRoutingCache(aas_routingcache_t *list, int travelflags)
+{
+	aas_routingcache_t *cache;
+
+	for (cache = list; cache; cache = cache->next)
+	{
+		if (cache->travelflags == travelflags) return cache;
+	} //end for
+	return NULL;
+} //end of the function AAS_FindRoutingCache
+//===========================================================================
+// returns the routing cache of the given type, calculating it on the
+// calling worker thread if it doesn't exist yet
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+aas_routingcache_t *AAS_GetThreadRoutingCache(int thread, int type, int clusternum, int areanum, int travelflags)
+{
+	aas_routingcache_t **list, *cache, *newcache;
+
+	list = AAS_RoutingCacheList(type, clusternum, areanum);
+	botimport.MutexLock(aasworld.routingmutex);
+	cache = AAS_FindRoutingCache(*list, travelflags);
+	if (cache)
+	{
+		botimport.MutexUnlock(aasworld.routingmutex);
+		return cache;
+	} //end if
+	//the memory allocation isn't thread safe
+	if (type == CACHETYPE_AREA) newcache = AAS_AllocRoutingCache(aasworld.clusters[clusternum].numreachabilityareas);
+	else newcache = AAS_AllocRoutingCache(aasworld.numportals);
+	botimport.MutexUnlock(aasworld.routingmutex);
+	//
+	newcache->cluster = clusternum;
+	newcache->areanum = areanum;
+	VectorCopy(aasworld.areas[areanum].center, newcache->origin);
+	newcache->starttraveltime = 1;
+	newcache->travelflags = travelflags;
+	newcache->type = type;
+	newcache->time = AAS_RoutingTime();
+	//calculate the cache without holding the lock
+	if (type == CACHETYPE_AREA) AAS_UpdateAreaRoutingCache(newcache, aasworld.threadareaupdate[thread]);
+	else AAS_UpdatePortalRoutingCache(thread, newcache);
+	//
+	botimport.MutexLock(aasworld.routingmutex);
+	//another thread might have calculated the same cache in the mean time
+	cache = AAS_FindRoutingCache(*list, travelflags);
+	if (cache)
+	{
+		routingcachesize -= newcache->size;
+		FreePoolMemory(newcache);
+	} //end if
+	else
+	{
+		cache = newcache;
+		cache->prev = NULL;
+		cache->next = *list;
+		if (*list) (*list)->prev = cache;
+		*list = cache;
+		cache->time_next = aasworld.threadcaches;
+		aasworld.threadcaches = cache;
+		aasworld.frameroutingupdates++;
+	} //end else
+	botimport.MutexUnlock(aasworld.routingmutex);
+	return cache;
+} //end of the function AAS_GetThreadRoutingCache
+//===========================================================================
 //
 // Parameter:			-
 // Returns:				-
@@ -1258,6 +1707,8 @@ void AAS_FreeRoutingCaches(void)
 	AAS_FreeAllClusterAreaCache();
 	// free all the existing portal cache
 	AAS_FreeAllPortalCache();
+	// free the routing cache memory pools
+	AAS_FreeRoutingCachePools();
 	// free cached travel times within areas
 	if (aasworld.areatraveltimes) FreeMemory(aasworld.areatraveltimes);
 	aasworld.areatraveltimes = NULL;
@@ -1272,6 +1723,12 @@ void AAS_FreeRoutingCaches(void)
 	aasworld.areaupdate = NULL;
 	if (aasworld.portalupdate) FreeMemory(aasworld.portalupdate);
 	aasworld.portalupdate = NULL;
+	// free worker thread routing memory
+	AAS_FreeThreadRouting();
+	// free the routing tables
+	AAS_FreeRoutingTables();
+	if (aasworld.initialareadisabled) FreeMemory(aasworld.initialareadisabled);
+	aasworld.initialareadisabled = NULL;
 	// free lists with areas the reachabilities go through
 	if (aasworld.reachabilityareas) FreeMemory(aasworld.reachabilityareas);
 	aasworld.reachabilityareas = NULL;
@@ -1286,10 +1743,11 @@ void AAS_FreeRoutingCaches(void)
 // update the given routing cache
 //
 // Parameter:			areacache		: routing cache to update
+//						areaupdate		: routing update fields to use
 // Returns:				-
 // Changes Globals:		-
 //===========================================================================
-void AAS_UpdateAreaRoutingCache(aas_routingcache_t *areacache)
+void AAS_UpdateAreaRoutingCache(aas_routingcache_t *areacache, aas_routingupdate_t *areaupdate)
 {
 	int i, nextareanum, cluster, badtravelflags, clusterareanum, linknum;
 	int numreachabilityareas;
@@ -1304,8 +1762,6 @@ void AAS_UpdateAreaRoutingCache(aas_routingcache_t *areacache)
 #endif //ROUTING_DEBUG
 	//number of reachability areas within this cluster
 	numreachabilityareas = aasworld.clusters[areacache->cluster].numreachabilityareas;
-	//
-	aasworld.frameroutingupdates++;
 	//clear the routing update fields
 //	Com_Memset(aasworld.areaupdate, 0, aasworld.numareas * sizeof(aas_routingupdate_t));
 	//
@@ -1316,7 +1772,7 @@ void AAS_UpdateAreaRoutingCache(aas_routingcache_t *areacache)
 	//
 	Com_Memset(startareatraveltimes, 0, sizeof(startareatraveltimes));
 	//
-	curupdate = &aasworld.areaupdate[clusterareanum];
+	curupdate = &areaupdate[clusterareanum];
 	curupdate->areanum = areacache->areanum;
 	//VectorCopy(areacache->origin, curupdate->start);
 	curupdate->areatraveltimes = startareatraveltimes;
@@ -1372,7 +1828,7 @@ void AAS_UpdateAreaRoutingCache(aas_routingcache_t *areacache)
 			{
 				areacache->traveltimes[clusterareanum] = t;
 				areacache->reachabilities[clusterareanum] = linknum - aasworld.areasettings[nextareanum].firstreachablearea;
-				nextupdate = &aasworld.areaupdate[clusterareanum];
+				nextupdate = &areaupdate[clusterareanum];
 				nextupdate->areanum = nextareanum;
 				nextupdate->tmptraveltime = t;
 				//VectorCopy(reach->start, nextupdate->start);
@@ -1400,11 +1856,15 @@ void AAS_UpdateAreaRoutingCache(aas_routingcache_t *areacache)
 // Returns:				-
 // Changes Globals:		-
 //===========================================================================
-aas_routingcache_t *AAS_GetAreaRoutingCache(int clusternum, int areanum, int travelflags)
+aas_routingcache_t *AAS_GetAreaRoutingCache(int thread, int clusternum, int areanum, int travelflags)
 {
 	int clusterareanum;
 	aas_routingcache_t *cache, *clustercache;
 
+	if (thread >= 0)
+	{
+		return AAS_GetThreadRoutingCache(thread, CACHETYPE_AREA, clusternum, areanum, travelflags);
+	} //end if
 	//number of the area in the cluster
 	clusterareanum = AAS_ClusterAreaNum(clusternum, areanum);
 	//pointer to the cache for the area in the cluster
@@ -1428,7 +1888,8 @@ aas_routingcache_t *AAS_GetAreaRoutingCache(int clusternum, int areanum, int tra
 		cache->next = clustercache;
 		if (clustercache) clustercache->prev = cache;
 		aasworld.clusterareacache[clusternum][clusterareanum] = cache;
-		AAS_UpdateAreaRoutingCache(cache);
+		aasworld.frameroutingupdates++;
+		AAS_UpdateAreaRoutingCache(cache, aasworld.areaupdate);
 	} //end if
 	else
 	{
@@ -1441,19 +1902,48 @@ aas_routingcache_t *AAS_GetAreaRoutingCache(int clusternum, int areanum, int tra
 	return cache;
 } //end of the function AAS_GetAreaRoutingCache
 //===========================================================================
+// returns the travel times and reachabilities towards the given area from
+// all reachability areas in the cluster, from the routing tables if possible
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static unsigned short int *AAS_AreaRoutingTimes(int thread, int clusternum, int areanum, int travelflags, unsigned char **reachabilities)
+{
+	int clusterareanum, numreachabilityareas;
+	aas_routingcache_t *cache;
+
+	if (AAS_RoutingTableValid(travelflags))
+	{
+		clusterareanum = AAS_ClusterAreaNum(clusternum, areanum);
+		numreachabilityareas = aasworld.clusters[clusternum].numreachabilityareas;
+		if (clusterareanum < numreachabilityareas)
+		{
+			if (reachabilities)
+			{
+				*reachabilities = aasworld.clusterreachabilities[clusternum] + clusterareanum * numreachabilityareas;
+			} //end if
+			return aasworld.clustertraveltimes[clusternum] + clusterareanum * numreachabilityareas;
+		} //end if
+	} //end if
+	cache = AAS_GetAreaRoutingCache(thread, clusternum, areanum, travelflags);
+	if (reachabilities) *reachabilities = cache->reachabilities;
+	return cache->traveltimes;
+} //end of the function AAS_AreaRoutingTimes
+//===========================================================================
 //
 // Parameter:			-
 // Returns:				-
 // Changes Globals:		-
 //===========================================================================
-void AAS_UpdatePortalRoutingCache(aas_routingcache_t *portalcache)
+void AAS_UpdatePortalRoutingCache(int thread, aas_routingcache_t *portalcache)
 {
 	int i, portalnum, clusterareanum, clusternum;
-	unsigned short int t;
+	unsigned short int t, *traveltimes;
 	aas_portal_t *portal;
 	aas_cluster_t *cluster;
-	aas_routingcache_t *cache;
-	aas_routingupdate_t *updateliststart, *updatelistend, *curupdate, *nextupdate;
+	aas_routingupdate_t *portalupdate, *updateliststart, *updatelistend, *curupdate, *nextupdate;
 
 #ifdef ROUTING_DEBUG
 	numportalcacheupdates++;
@@ -1461,7 +1951,8 @@ void AAS_UpdatePortalRoutingCache(aas_routingcache_t *portalcache)
 	//clear the routing update fields
 //	Com_Memset(aasworld.portalupdate, 0, (aasworld.numportals+1) * sizeof(aas_routingupdate_t));
 	//
-	curupdate = &aasworld.portalupdate[aasworld.numportals];
+	portalupdate = thread >= 0 ? aasworld.threadportalupdate[thread] : aasworld.portalupdate;
+	curupdate = &portalupdate[aasworld.numportals];
 	curupdate->cluster = portalcache->cluster;
 	curupdate->areanum = portalcache->areanum;
 	curupdate->tmptraveltime = portalcache->starttraveltime;
@@ -1489,8 +1980,8 @@ void AAS_UpdatePortalRoutingCache(aas_routingcache_t *portalcache)
 		//
 		cluster = &aasworld.clusters[curupdate->cluster];
 		//
-		cache = AAS_GetAreaRoutingCache(curupdate->cluster,
-								curupdate->areanum, portalcache->travelflags);
+		traveltimes = AAS_AreaRoutingTimes(thread, curupdate->cluster,
+								curupdate->areanum, portalcache->travelflags, NULL);
 		//take all portals of the cluster
 		for (i = 0; i < cluster->numportals; i++)
 		{
@@ -1502,7 +1993,7 @@ void AAS_UpdatePortalRoutingCache(aas_routingcache_t *portalcache)
 			clusterareanum = AAS_ClusterAreaNum(curupdate->cluster, portal->areanum);
 			if (clusterareanum >= cluster->numreachabilityareas) continue;
 			//
-			t = cache->traveltimes[clusterareanum];
+			t = traveltimes[clusterareanum];
 			if (!t) continue;
 			t += curupdate->tmptraveltime;
 			//
@@ -1510,7 +2001,7 @@ void AAS_UpdatePortalRoutingCache(aas_routingcache_t *portalcache)
 					portalcache->traveltimes[portalnum] > t)
 			{
 				portalcache->traveltimes[portalnum] = t;
-				nextupdate = &aasworld.portalupdate[portalnum];
+				nextupdate = &portalupdate[portalnum];
 				if (portal->frontcluster == curupdate->cluster)
 				{
 					nextupdate->cluster = portal->backcluster;
@@ -1544,10 +2035,14 @@ void AAS_UpdatePortalRoutingCache(aas_routingcache_t *portalcache)
 // Returns:				-
 // Changes Globals:		-
 //===========================================================================
-aas_routingcache_t *AAS_GetPortalRoutingCache(int clusternum, int areanum, int travelflags)
+aas_routingcache_t *AAS_GetPortalRoutingCache(int thread, int clusternum, int areanum, int travelflags)
 {
 	aas_routingcache_t *cache;
 
+	if (thread >= 0)
+	{
+		return AAS_GetThreadRoutingCache(thread, CACHETYPE_PORTAL, clusternum, areanum, travelflags);
+	} //end if
 	//find the cached portal routing if existing
 	for (cache = aasworld.portalcache[areanum]; cache; cache = cache->next)
 	{
@@ -1568,7 +2063,7 @@ aas_routingcache_t *AAS_GetPortalRoutingCache(int clusternum, int areanum, int t
 		if (aasworld.portalcache[areanum]) aasworld.portalcache[areanum]->prev = cache;
 		aasworld.portalcache[areanum] = cache;
 		//update the cache
-		AAS_UpdatePortalRoutingCache(cache);
+		AAS_UpdatePortalRoutingCache(-1, cache);
 	} //end if
 	else
 	{
@@ -1581,18 +2076,34 @@ aas_routingcache_t *AAS_GetPortalRoutingCache(int clusternum, int areanum, int t
 	return cache;
 } //end of the function AAS_GetPortalRoutingCache
 //===========================================================================
+// returns the travel times towards the given area from all cluster portals,
+// from the routing tables if possible
 //
 // Parameter:			-
 // Returns:				-
 // Changes Globals:		-
 //===========================================================================
-int AAS_AreaRouteToGoalArea(int areanum, vec3_t origin, int goalareanum, int travelflags, int *traveltime, int *reachnum)
+static unsigned short int *AAS_PortalRoutingTimes(int thread, int clusternum, int areanum, int travelflags)
+{
+	if (AAS_RoutingTableValid(travelflags))
+	{
+		return aasworld.portaltraveltimes + areanum * aasworld.numportals;
+	} //end if
+	return AAS_GetPortalRoutingCache(thread, clusternum, areanum, travelflags)->traveltimes;
+} //end of the function AAS_PortalRoutingTimes
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static int AAS_RouteToGoalArea(int thread, int areanum, vec3_t origin, int goalareanum, int travelflags, int *traveltime, int *reachnum)
 {
 	int clusternum, goalclusternum, portalnum, i, clusterareanum, bestreachnum;
-	unsigned short int t, besttime;
+	unsigned short int t, besttime, *areatimes, *portaltimes;
+	unsigned char *areareachabilities;
 	aas_portal_t *portal;
 	aas_cluster_t *cluster;
-	aas_routingcache_t *areacache, *portalcache;
 	aas_reachability_t *reach;
 
 	if (!aasworld.initialized) return qfalse;
@@ -1625,9 +2136,8 @@ int AAS_AreaRouteToGoalArea(int areanum, vec3_t origin, int goalareanum, int tra
 		return qfalse;
 	} //end if
 	// make sure the routing cache doesn't grow to large
-	while(AvailableMemory() < 1 * 1024 * 1024) {
-		if (!AAS_FreeOldestCache()) break;
-	}
+	// worker threads can't free caches other threads might be using, AAS_PrecalculateRoutes does it up front
+	if (thread < 0) AAS_FreeCacheMemory(1 * 1024 * 1024);
 	//
 	if (AAS_AreaDoNotEnter(areanum) || AAS_AreaDoNotEnter(goalareanum))
 	{
@@ -1671,7 +2181,7 @@ int AAS_AreaRouteToGoalArea(int areanum, vec3_t origin, int goalareanum, int tra
 	if (clusternum > 0 && goalclusternum > 0 && clusternum == goalclusternum)
 	{
 		//
-		areacache = AAS_GetAreaRoutingCache(clusternum, goalareanum, travelflags);
+		areatimes = AAS_AreaRoutingTimes(thread, clusternum, goalareanum, travelflags, &areareachabilities);
 		//the number of the area in the cluster
 		clusterareanum = AAS_ClusterAreaNum(clusternum, areanum);
 		//the cluster the area is in
@@ -1679,16 +2189,16 @@ int AAS_AreaRouteToGoalArea(int areanum, vec3_t origin, int goalareanum, int tra
 		//if the area is NOT a reachability area
 		if (clusterareanum >= cluster->numreachabilityareas) return 0;
 		//if it is possible to travel to the goal area through this cluster
-		if (areacache->traveltimes[clusterareanum] != 0)
+		if (areatimes[clusterareanum] != 0)
 		{
 			*reachnum = aasworld.areasettings[areanum].firstreachablearea +
-							areacache->reachabilities[clusterareanum];
+							areareachabilities[clusterareanum];
 			if (!origin) {
-				*traveltime = areacache->traveltimes[clusterareanum];
+				*traveltime = areatimes[clusterareanum];
 				return qtrue;
 			}
 			reach = &aasworld.reachability[*reachnum];
-			*traveltime = areacache->traveltimes[clusterareanum] +
+			*traveltime = areatimes[clusterareanum] +
 							AAS_AreaTravelTime(areanum, origin, reach->start);
 			//
 			return qtrue;
@@ -1705,13 +2215,14 @@ int AAS_AreaRouteToGoalArea(int areanum, vec3_t origin, int goalareanum, int tra
 		goalclusternum = portal->frontcluster;
 	} //end if
 	//get the portal routing cache
-	portalcache = AAS_GetPortalRoutingCache(goalclusternum, goalareanum, travelflags);
+	portaltimes = AAS_PortalRoutingTimes(thread, goalclusternum, goalareanum, travelflags);
 	//if the area is a cluster portal, read directly from the portal cache
+	//NOTE: the portal routing never stores reachabilities so this is always
+	//		the first reachability of the portal area
 	if (clusternum < 0)
 	{
-		*traveltime = portalcache->traveltimes[-clusternum];
-		*reachnum = aasworld.areasettings[areanum].firstreachablearea +
-						portalcache->reachabilities[-clusternum];
+		*traveltime = portaltimes[-clusternum];
+		*reachnum = aasworld.areasettings[areanum].firstreachablearea;
 		return qtrue;
 	} //end if
 	//
@@ -1724,20 +2235,20 @@ int AAS_AreaRouteToGoalArea(int areanum, vec3_t origin, int goalareanum, int tra
 	{
 		portalnum = aasworld.portalindex[cluster->firstportal + i];
 		//if the goal area isn't reachable from the portal
-		if (!portalcache->traveltimes[portalnum]) continue;
+		if (!portaltimes[portalnum]) continue;
 		//
 		portal = &aasworld.portals[portalnum];
 		//get the cache of the portal area
-		areacache = AAS_GetAreaRoutingCache(clusternum, portal->areanum, travelflags);
+		areatimes = AAS_AreaRoutingTimes(thread, clusternum, portal->areanum, travelflags, &areareachabilities);
 		//current area inside the current cluster
 		clusterareanum = AAS_ClusterAreaNum(clusternum, areanum);
 		//if the area is NOT a reachability area
 		if (clusterareanum >= cluster->numreachabilityareas) continue;
 		//if the portal is NOT reachable from this area
-		if (!areacache->traveltimes[clusterareanum]) continue;
+		if (!areatimes[clusterareanum]) continue;
 		//total travel time is the travel time the portal area is from
 		//the goal area plus the travel time towards the portal area
-		t = portalcache->traveltimes[portalnum] + areacache->traveltimes[clusterareanum];
+		t = portaltimes[portalnum] + areatimes[clusterareanum];
 		//FIXME: add the exact travel time through the actual portal area
 		//NOTE: for now we just add the largest travel time through the portal area
 		//		because we can't directly calculate the exact travel time
@@ -1748,7 +2259,7 @@ int AAS_AreaRouteToGoalArea(int areanum, vec3_t origin, int goalareanum, int tra
 		if (origin)
 		{
 			*reachnum = aasworld.areasettings[areanum].firstreachablearea +
-							areacache->reachabilities[clusterareanum];
+							areareachabilities[clusterareanum];
 			reach = aasworld.reachability + *reachnum;
 			t += AAS_AreaTravelTime(areanum, origin, reach->start);
 		} //end if
@@ -1765,6 +2276,16 @@ int AAS_AreaRouteToGoalArea(int areanum, vec3_t origin, int goalareanum, int tra
 	*reachnum = bestreachnum;
 	*traveltime = besttime;
 	return qtrue;
+} //end of the function AAS_RouteToGoalArea
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+int AAS_AreaRouteToGoalArea(int areanum, vec3_t origin, int goalareanum, int travelflags, int *traveltime, int *reachnum)
+{
+	return AAS_RouteToGoalArea(-1, areanum, origin, goalareanum, travelflags, traveltime, reachnum);
 } //end of the function AAS_AreaRouteToGoalArea
 //===========================================================================
 //
@@ -1799,6 +2320,361 @@ int AAS_AreaReachabilityToGoalArea(int areanum, vec3_t origin, int goalareanum,
 	return 0;
 } //end of the function AAS_AreaReachabilityToGoalArea
 //===========================================================================
+// returns qtrue if all routing caches needed for the route already exist
+// or if there's nothing to route
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static int AAS_RouteCached(int areanum, int goalareanum, int travelflags)
+{
+	int clusternum, goalclusternum, portalnum, i, clusterareanum;
+	aas_portal_t *portal;
+	aas_cluster_t *cluster;
+	aas_routingcache_t *areacache, *portalcache;
+
+	if (areanum == goalareanum) return qtrue;
+	if (areanum <= 0 || areanum >= aasworld.numareas) return qtrue;
+	if (goalareanum <= 0 || goalareanum >= aasworld.numareas) return qtrue;
+	if (!aasworld.areasettings[areanum].numreachableareas || !aasworld.areasettings[goalareanum].numreachableareas)
+	{
+		return qtrue;
+	} //end if
+	//the routing tables store all routes
+	if (AAS_RoutingTableValid(travelflags)) return qtrue;
+	//same cluster selection as AAS_RouteToGoalArea
+	clusternum = aasworld.areasettings[areanum].cluster;
+	goalclusternum = aasworld.areasettings[goalareanum].cluster;
+	if (clusternum < 0 && goalclusternum > 0)
+	{
+		portal = &aasworld.portals[-clusternum];
+		if (portal->frontcluster == goalclusternum ||
+				portal->backcluster == goalclusternum)
+		{
+			clusternum = goalclusternum;
+		} //end if
+	} //end if
+	else if (clusternum > 0 && goalclusternum < 0)
+	{
+		portal = &aasworld.portals[-goalclusternum];
+		if (portal->frontcluster == clusternum ||
+				portal->backcluster == clusternum)
+		{
+			goalclusternum = clusternum;
+		} //end if
+	} //end if
+	if (clusternum > 0 && goalclusternum > 0 && clusternum == goalclusternum)
+	{
+		areacache = AAS_FindRoutingCache(*AAS_RoutingCacheList(CACHETYPE_AREA, clusternum, goalareanum), travelflags);
+		if (!areacache) return qfalse;
+		clusterareanum = AAS_ClusterAreaNum(clusternum, areanum);
+		if (clusterareanum >= aasworld.clusters[clusternum].numreachabilityareas) return qtrue;
+		if (areacache->traveltimes[clusterareanum] != 0) return qtrue;
+	} //end if
+	//
+	clusternum = aasworld.areasettings[areanum].cluster;
+	goalclusternum = aasworld.areasettings[goalareanum].cluster;
+	if (goalclusternum < 0)
+	{
+		goalclusternum = aasworld.portals[-goalclusternum].frontcluster;
+	} //end if
+	portalcache = AAS_FindRoutingCache(aasworld.portalcache[goalareanum], travelflags);
+	if (!portalcache) return qfalse;
+	if (clusternum < 0) return qtrue;
+	//
+	cluster = &aasworld.clusters[clusternum];
+	for (i = 0; i < cluster->numportals; i++)
+	{
+		portalnum = aasworld.portalindex[cluster->firstportal + i];
+		if (!portalcache->traveltimes[portalnum]) continue;
+		portal = &aasworld.portals[portalnum];
+		if (!AAS_FindRoutingCache(*AAS_RoutingCacheList(CACHETYPE_AREA, clusternum, portal->areanum), travelflags))
+		{
+			return qfalse;
+		} //end if
+	} //end for
+	return qtrue;
+} //end of the function AAS_RouteCached
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static int AAS_CompareRouteQueries(const void *arg1, const void *arg2)
+{
+	const aas_routequery_t *query1 = (const aas_routequery_t *) arg1;
+	const aas_routequery_t *query2 = (const aas_routequery_t *) arg2;
+	int cluster1, cluster2;
+
+	//routes from the same cluster use the same routing caches
+	cluster1 = aasworld.areasettings[query1->areanum].cluster;
+	cluster2 = aasworld.areasettings[query2->areanum].cluster;
+	if (cluster1 != cluster2) return cluster1 - cluster2;
+	if (query1->goalareanum != query2->goalareanum) return query1->goalareanum - query2->goalareanum;
+	return query1->travelflags - query2->travelflags;
+} //end of the function AAS_CompareRouteQueries
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static int AAS_CompareRoutingCaches(const void *arg1, const void *arg2)
+{
+	const aas_routingcache_t *cache1 = *(const aas_routingcache_t **) arg1;
+	const aas_routingcache_t *cache2 = *(const aas_routingcache_t **) arg2;
+
+	if (cache1->type != cache2->type) return cache1->type - cache2->type;
+	if (cache1->cluster != cache2->cluster) return cache1->cluster - cache2->cluster;
+	if (cache1->areanum != cache2->areanum) return cache1->areanum - cache2->areanum;
+	return cache1->travelflags - cache2->travelflags;
+} //end of the function AAS_CompareRoutingCaches
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_PrecalculateRouteJob(int index, int thread, void *arg)
+{
+	aas_routequery_t *query = (aas_routequery_t *) arg + index;
+	int traveltime, reachnum = 0;
+
+	AAS_RouteToGoalArea(thread, query->areanum, NULL, query->goalareanum, query->travelflags, &traveltime, &reachnum);
+} //end of the function AAS_PrecalculateRouteJob
+//===========================================================================
+// add the caches calculated on the worker threads to the time sorted list
+// in a fixed order so cache eviction doesn't depend on the timing of the
+// worker threads
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_LinkThreadCaches(void)
+{
+	int i, numcaches;
+	aas_routingcache_t *cache, **caches;
+
+	numcaches = 0;
+	for (cache = aasworld.threadcaches; cache; cache = cache->time_next) numcaches++;
+	if (!numcaches) return;
+	caches = (aas_routingcache_t **) GetMemory(numcaches * sizeof(aas_routingcache_t *));
+	for (i = 0, cache = aasworld.threadcaches; cache; cache = cache->time_next) caches[i++] = cache;
+	qsort(caches, numcaches, sizeof(aas_routingcache_t *), AAS_CompareRoutingCaches);
+	for (i = 0; i < numcaches; i++) AAS_LinkCache(caches[i]);
+	FreeMemory(caches);
+	aasworld.threadcaches = NULL;
+} //end of the function AAS_LinkThreadCaches
+//===========================================================================
+// calculates the routing caches needed for the given routes on the worker
+// threads, so later route queries on the main thread find them cached
+// the queries array is reordered
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_PrecalculateRoutes(aas_routequery_t *queries, int numqueries)
+{
+	int i, numjobs;
+
+	if (!aasworld.initialized || !numqueries) return;
+	if (!botimport.RunJobs || !botimport.MutexCreate) return;
+	//
+	for (i = 0; i < numqueries; i++)
+	{
+		if (AAS_AreaDoNotEnter(queries[i].areanum) || AAS_AreaDoNotEnter(queries[i].goalareanum))
+		{
+			queries[i].travelflags |= TFL_DONOTENTER;
+		} //end if
+	} //end for
+	//skip duplicate routes and routes that are already cached
+	qsort(queries, numqueries, sizeof(aas_routequery_t), AAS_CompareRouteQueries);
+	numjobs = 0;
+	for (i = 0; i < numqueries; i++)
+	{
+		if (numjobs && !AAS_CompareRouteQueries(&queries[numjobs-1], &queries[i])) continue;
+		if (AAS_RouteCached(queries[i].areanum, queries[i].goalareanum, queries[i].travelflags)) continue;
+		queries[numjobs++] = queries[i];
+	} //end for
+	if (!numjobs) return;
+	//make sure the routing cache doesn't grow to large before the worker threads start
+	AAS_FreeCacheMemory(1 * 1024 * 1024);
+	AAS_InitThreadRouting();
+	if (!botimport.RunJobs(AAS_PrecalculateRouteJob, queries, numjobs)) return;
+	AAS_LinkThreadCaches();
+} //end of the function AAS_PrecalculateRoutes
+//===========================================================================
+// state shared by the routing table jobs
+//===========================================================================
+typedef struct aas_routingtablejobs_s
+{
+	int *clusterareas[BOTLIB_MAX_THREADS+1];		//area number of every cluster area number
+	aas_routingcache_t *caches[BOTLIB_MAX_THREADS+1];	//scratch routing cache for every thread
+} aas_routingtablejobs_t;
+//===========================================================================
+// calculates the travel times from all reachability areas in a cluster
+// towards every reachability area in that cluster
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_ClusterRoutingTableJob(int index, int thread, void *arg)
+{
+	aas_routingtablejobs_t *jobs = (aas_routingtablejobs_t *) arg;
+	int clusternum, i, j, n, areanum;
+	aas_routingcache_t *cache;
+	aas_routingupdate_t *areaupdate;
+
+	clusternum = index + 1;
+	n = aasworld.clusters[clusternum].numreachabilityareas;
+	cache = jobs->caches[thread + 1];
+	areaupdate = thread >= 0 ? aasworld.threadareaupdate[thread] : aasworld.areaupdate;
+	//find the area number of every reachability area in the cluster
+	for (i = 0; i < n; i++) jobs->clusterareas[thread + 1][i] = 0;
+	for (areanum = 1; areanum < aasworld.numareas; areanum++)
+	{
+		i = aasworld.areasettings[areanum].cluster;
+		if (i > 0 && i != clusternum) continue;
+		if (i < 0 && aasworld.portals[-i].frontcluster != clusternum &&
+				aasworld.portals[-i].backcluster != clusternum) continue;
+		i = AAS_ClusterAreaNum(clusternum, areanum);
+		if (i < n) jobs->clusterareas[thread + 1][i] = areanum;
+	} //end for
+	//
+	for (j = 0; j < n; j++)
+	{
+		Com_Memset(cache->traveltimes, 0, n * sizeof(unsigned short int));
+		cache->cluster = clusternum;
+		cache->areanum = jobs->clusterareas[thread + 1][j];
+		cache->starttraveltime = 1;
+		cache->travelflags = aasworld.routingtabletravelflags;
+		if (cache->areanum) AAS_UpdateAreaRoutingCache(cache, areaupdate);
+		//
+		for (i = 0; i < n; i++)
+		{
+			aasworld.clustertraveltimes[clusternum][j * n + i] = cache->traveltimes[i];
+			aasworld.clusterreachabilities[clusternum][j * n + i] = cache->reachabilities[i];
+		} //end for
+	} //end for
+} //end of the function AAS_ClusterRoutingTableJob
+//===========================================================================
+// calculates the travel times from all portals towards an area
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_PortalRoutingTableJob(int index, int thread, void *arg)
+{
+	aas_routingtablejobs_t *jobs = (aas_routingtablejobs_t *) arg;
+	int areanum, clusternum;
+	aas_routingcache_t *cache;
+
+	areanum = index + 1;
+	if (!aasworld.areasettings[areanum].numreachableareas) return;
+	clusternum = aasworld.areasettings[areanum].cluster;
+	//just assume a portal goal area is part of the front cluster
+	if (clusternum < 0) clusternum = aasworld.portals[-clusternum].frontcluster;
+	//
+	cache = jobs->caches[thread + 1];
+	Com_Memset(cache->traveltimes, 0, aasworld.numportals * sizeof(unsigned short int));
+	cache->cluster = clusternum;
+	cache->areanum = areanum;
+	cache->starttraveltime = 1;
+	cache->travelflags = aasworld.routingtabletravelflags;
+	AAS_UpdatePortalRoutingCache(thread, cache);
+	Com_Memcpy(aasworld.portaltraveltimes + areanum * aasworld.numportals,
+					cache->traveltimes, aasworld.numportals * sizeof(unsigned short int));
+} //end of the function AAS_PortalRoutingTableJob
+//===========================================================================
+// calculates the routing tables for the default travel flags and writes
+// them to the route cache file, the tables are only used as long as no
+// area is enabled or disabled for routing
+//
+// Parameter:			-
+// Returns:				qtrue if the routing tables were calculated
+// Changes Globals:		-
+//===========================================================================
+int AAS_PrecomputeRoutingTables(void)
+{
+	int i, size, maxsize, numtraveltimes, maxreachabilityareas, starttime;
+	aas_routingtablejobs_t jobs;
+	void *table;
+
+	if (!aasworld.initialized) return qfalse;
+	if (aasworld.numchangedroutingareas)
+	{
+		botimport.Print(PRT_WARNING, "can't precompute routing tables while areas are enabled or disabled\n");
+		return qfalse;
+	} //end if
+	size = AAS_RoutingTableSize();
+	maxsize = 1024 * (int) LibVarValue("max_routingtable", "65536");
+	if (size > maxsize)
+	{
+		botimport.Print(PRT_WARNING, "routing tables need %d KB, max_routingtable is %d KB\n", size >> 10, maxsize >> 10);
+		return qfalse;
+	} //end if
+	starttime = Sys_MilliSeconds();
+	//reuse the table block of the same map, hunk memory can't be freed
+	if (aasworld.routingtable && aasworld.routingtablesize == size)
+	{
+		table = aasworld.routingtable;
+		Com_Memset(table, 0, size);
+	} //end if
+	else
+	{
+		table = GetClearedHunkMemory(size);
+	} //end else
+	//the area routing of the portal jobs only uses the cluster tables once these are set
+	AAS_SetRoutingTable(table, size, TFL_DEFAULT);
+	aasworld.routingtable = NULL;
+	//
+	maxreachabilityareas = 0;
+	for (i = 0; i < aasworld.numclusters; i++)
+	{
+		if (aasworld.clusters[i].numreachabilityareas > maxreachabilityareas)
+		{
+			maxreachabilityareas = aasworld.clusters[i].numreachabilityareas;
+		} //end if
+	} //end for
+	numtraveltimes = maxreachabilityareas > aasworld.numportals ? maxreachabilityareas : aasworld.numportals;
+	for (i = 0; i <= BOTLIB_MAX_THREADS; i++)
+	{
+		jobs.clusterareas[i] = (int *) GetClearedMemory((maxreachabilityareas + 1) * sizeof(int));
+		jobs.caches[i] = AAS_AllocRoutingCache(numtraveltimes);
+	} //end for
+	//
+	if (botimport.RunJobs && botimport.MutexCreate) AAS_InitThreadRouting();
+	if (!botimport.RunJobs || !botimport.MutexCreate ||
+			!botimport.RunJobs(AAS_ClusterRoutingTableJob, &jobs, aasworld.numclusters - 1))
+	{
+		for (i = 0; i < aasworld.numclusters - 1; i++) AAS_ClusterRoutingTableJob(i, -1, &jobs);
+	} //end if
+	aasworld.routingtable = table;
+	if (!botimport.RunJobs || !botimport.MutexCreate ||
+			!botimport.RunJobs(AAS_PortalRoutingTableJob, &jobs, aasworld.numareas - 1))
+	{
+		for (i = 0; i < aasworld.numareas - 1; i++) AAS_PortalRoutingTableJob(i, -1, &jobs);
+	} //end if
+	AAS_LinkThreadCaches();
+	//
+	for (i = 0; i <= BOTLIB_MAX_THREADS; i++)
+	{
+		FreeMemory(jobs.clusterareas[i]);
+		routingcachesize -= jobs.caches[i]->size;
+		FreePoolMemory(jobs.caches[i]);
+	} //end for
+	botimport.Print(PRT_MESSAGE, "%d KB of routing tables calculated in %d msec\n",
+						size >> 10, Sys_MilliSeconds() - starttime);
+	AAS_WriteRouteCache();
+	return qtrue;
+} //end of the function AAS_PrecomputeRoutingTables
+//===========================================================================
 // predict the route and stop on one of the stop events
 //
 // Parameter:			-
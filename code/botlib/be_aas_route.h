@@ -39,6 +39,8 @@ unsigned short int AAS_AreaTravelTime(int areanum, vec3_t start, vec3_t end);
 //
 void AAS_CreateAllRoutingCache(void);
 void AAS_WriteRouteCache(void);
+//calculates the routing tables and saves them with the routing cache
+int AAS_PrecomputeRoutingTables(void);
 //
 void AAS_RoutingInfo(void);
 #endif //AASINTERN
@@ -59,6 +61,8 @@ int AAS_EnableRoutingArea(int areanum, int enable);
 unsigned short int AAS_AreaTravelTime(int areanum, vec3_t start, vec3_t end);
 //returns the travel time from the area to the goal area using the given travel flags
 int AAS_AreaTravelTimeToGoalArea(int areanum, vec3_t origin, int goalareanum, int travelflags);
+//calculates the routing caches for the given routes on worker threads
+void AAS_PrecalculateRoutes(struct aas_routequery_s *queries, int numqueries);
 //predict a route up to a stop event
 int AAS_PredictRoute(struct aas_predictroute_s *route, int areanum, vec3_t origin,
 							int goalareanum, int travelflags, int maxareas, int maxtime,
@@ -53,6 +53,9 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #define TRACEPLANE_EPSILON			0.125
 
+//distance a grid cell must be away from a node plane to be on one side of it
+#define NODEGRID_EPSILON			0.125
+
 typedef struct aas_tracestack_s
 {
 	vec3_t start;		//start point of the piece of line to trace
@@ -190,6 +193,8 @@ void AAS_InitAASLinkedEntities(void)
 	if (aasworld.arealinkedentities) FreeMemory(aasworld.arealinkedentities);
 	aasworld.arealinkedentities = (aas_link_t **) GetClearedHunkMemory(
 						aasworld.numareas * sizeof(aas_link_t *));
+	if (aasworld.areaoccupied) FreeMemory(aasworld.areaoccupied);
+	aasworld.areaoccupied = (byte *) GetClearedHunkMemory((aasworld.numareas + 7) >> 3);
 } //end of the function AAS_InitAASLinkedEntities
 //===========================================================================
 //
@@ -201,8 +206,204 @@ void AAS_FreeAASLinkedEntities(void)
 {
 	if (aasworld.arealinkedentities) FreeMemory(aasworld.arealinkedentities);
 	aasworld.arealinkedentities = NULL;
+	if (aasworld.areaoccupied) FreeMemory(aasworld.areaoccupied);
+	aasworld.areaoccupied = NULL;
 } //end of the function AAS_InitAASLinkedEntities
 //===========================================================================
+// returns true if at least one entity is linked into the area
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int AAS_AreaOccupied(int areanum)
+{
+	if (!aasworld.areaoccupied) return qfalse;
+	if (areanum <= 0 || areanum >= aasworld.numareas) return qfalse;
+	return aasworld.areaoccupied[areanum >> 3] & (1 << (areanum & 7));
+} //end of the function AAS_AreaOccupied
+//===========================================================================
+// returns the deepest node of the bsp tree the grid cell is completely in
+// leafs are never returned so the node parents can be used
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static int AAS_GridCellNode(vec3_t center, float halfsize)
+{
+	int nodenum, child;
+	float dist, radius;
+	aas_node_t *node;
+	aas_plane_t *plane;
+
+	nodenum = 1;
+	while(1)
+	{
+		node = &aasworld.nodes[nodenum];
+		plane = &aasworld.planes[node->planenum];
+		dist = DotProduct(center, plane->normal) - plane->dist;
+		radius = halfsize * (fabs(plane->normal[0]) + fabs(plane->normal[1]) + fabs(plane->normal[2]));
+		if (dist - radius > NODEGRID_EPSILON) child = node->children[0];
+		else if (dist + radius < -NODEGRID_EPSILON) child = node->children[1];
+		else return nodenum;
+		if (child <= 0 || child >= aasworld.numnodes) return nodenum;
+		nodenum = child;
+	} //end while
+} //end of the function AAS_GridCellNode
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_FreeNodeGrid(void)
+{
+	if (aasworld.nodeparents) FreeMemory(aasworld.nodeparents);
+	if (aasworld.nodedepths) FreeMemory(aasworld.nodedepths);
+	if (aasworld.nodegrid) FreeMemory(aasworld.nodegrid);
+	aasworld.nodeparents = NULL;
+	aasworld.nodedepths = NULL;
+	aasworld.nodegrid = NULL;
+	VectorClear(aasworld.nodegridsize);
+} //end of the function AAS_FreeNodeGrid
+//===========================================================================
+// creates a uniform grid over the AAS world with the deepest bsp node
+// every grid cell is in, point and trace queries start at that node
+// instead of the root of the tree
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_InitNodeGrid(void)
+{
+	int i, n, nodenum, stacksize, *stack, x, y, z;
+	int max_cells, cell;
+	double numcells;
+	float cellsize;
+	vec3_t mins, maxs, center;
+	aas_node_t *node;
+	aas_area_t *area;
+
+	AAS_FreeNodeGrid();
+	if (!aasworld.loaded || aasworld.numnodes < 2 || aasworld.numareas < 2) return;
+	//parents and depths of the nodes
+	aasworld.nodeparents = (int *) GetClearedHunkMemory(aasworld.numnodes * sizeof(int));
+	aasworld.nodedepths = (int *) GetClearedHunkMemory(aasworld.numnodes * sizeof(int));
+	stack = (int *) GetMemory(aasworld.numnodes * sizeof(int));
+	stack[0] = 1;
+	stacksize = 1;
+	while(stacksize > 0)
+	{
+		nodenum = stack[--stacksize];
+		node = &aasworld.nodes[nodenum];
+		for (i = 0; i < 2; i++)
+		{
+			n = node->children[i];
+			//every node is visited once
+			if (n <= 1 || n >= aasworld.numnodes || aasworld.nodeparents[n]) continue;
+			aasworld.nodeparents[n] = nodenum;
+			aasworld.nodedepths[n] = aasworld.nodedepths[nodenum] + 1;
+			stack[stacksize++] = n;
+		} //end for
+	} //end while
+	FreeMemory(stack);
+	//bounds of the AAS world
+	ClearBounds(mins, maxs);
+	for (i = 1; i < aasworld.numareas; i++)
+	{
+		area = &aasworld.areas[i];
+		AddPointToBounds(area->mins, mins, maxs);
+		AddPointToBounds(area->maxs, mins, maxs);
+	} //end for
+#ifdef BSPC
+	cellsize = 64;
+	max_cells = 262144;
+#else
+	cellsize = LibVarValue("aasgridcellsize", "64");
+	max_cells = (int) LibVarValue("max_aasgridcells", "262144");
+#endif //BSPC
+	if (max_cells <= 0) return;
+	if (cellsize < 8) cellsize = 8;
+	//grow the cells until the grid fits
+	while(1)
+	{
+		numcells = 1;
+		for (i = 0; i < 3; i++)
+		{
+			aasworld.nodegridsize[i] = (int) ceil((maxs[i] - mins[i] + 2) / cellsize);
+			if (aasworld.nodegridsize[i] < 1) aasworld.nodegridsize[i] = 1;
+			numcells *= aasworld.nodegridsize[i];
+		} //end for
+		if (numcells <= max_cells) break;
+		cellsize *= 2;
+	} //end while
+	VectorSet(aasworld.nodegridorigin, mins[0] - 1, mins[1] - 1, mins[2] - 1);
+	aasworld.nodegridcellsize = cellsize;
+	aasworld.nodegrid = (int *) GetHunkMemory((int) numcells * sizeof(int));
+	cell = 0;
+	for (z = 0; z < aasworld.nodegridsize[2]; z++)
+	{
+		for (y = 0; y < aasworld.nodegridsize[1]; y++)
+		{
+			for (x = 0; x < aasworld.nodegridsize[0]; x++)
+			{
+				center[0] = aasworld.nodegridorigin[0] + (x + 0.5) * cellsize;
+				center[1] = aasworld.nodegridorigin[1] + (y + 0.5) * cellsize;
+				center[2] = aasworld.nodegridorigin[2] + (z + 0.5) * cellsize;
+				aasworld.nodegrid[cell++] = AAS_GridCellNode(center, cellsize * 0.5);
+			} //end for
+		} //end for
+	} //end for
+} //end of the function AAS_InitNodeGrid
+//===========================================================================
+// returns the deepest node of the bsp tree the point is in according
+// to the node grid, the root node if the point is outside the grid
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static ID_INLINE int AAS_PointGridNode(vec3_t point)
+{
+	int i, cell[3];
+	float f;
+
+	if (!aasworld.nodegrid) return 1;
+	for (i = 0; i < 3; i++)
+	{
+		f = (point[i] - aasworld.nodegridorigin[i]) / aasworld.nodegridcellsize;
+		if (!(f >= 0 && f < aasworld.nodegridsize[i])) return 1;
+		cell[i] = (int) f;
+	} //end for
+	return aasworld.nodegrid[(cell[2] * aasworld.nodegridsize[1] + cell[1]) *
+								aasworld.nodegridsize[0] + cell[0]];
+} //end of the function AAS_PointGridNode
+//===========================================================================
+// returns the deepest node of the bsp tree the whole line is in
+// the line is at the same side of every node above the node both
+// end points are in, so a trace can start there instead of at the root
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static int AAS_TraceStartNode(vec3_t start, vec3_t end)
+{
+	int n1, n2;
+
+	n1 = AAS_PointGridNode(start);
+	n2 = AAS_PointGridNode(end);
+	while(n1 != n2)
+	{
+		if (aasworld.nodedepths[n1] >= aasworld.nodedepths[n2]) n1 = aasworld.nodeparents[n1];
+		else n2 = aasworld.nodeparents[n2];
+	} //end while
+	if (n1 <= 0) return 1;
+	return n1;
+} //end of the function AAS_TraceStartNode
+//===========================================================================
 // returns the AAS area the point is in
 //
 // Parameter:				-
@@ -223,7 +424,8 @@ int AAS_PointAreaNum(vec3_t point)
 	} //end if
 
 	//start with node 1 because node zero is a dummy used for solid leafs
-	nodenum = 1;
+	//or with the deepest node of the grid cell the point is in
+	nodenum = AAS_PointGridNode(point);
 	while (nodenum > 0)
 	{
 //		botimport.Print(PRT_MESSAGE, "[%d]", nodenum);
@@ -468,7 +670,8 @@ aas_trace_t AAS_TraceClientBBox(vec3_t start, vec3_t end, int presencetype,
 	VectorCopy(end, tstack_p->end);
 	tstack_p->planenum = 0;
 	//start with node 1 because node zero is a dummy for a solid leaf
-	tstack_p->nodenum = 1;		//starting at the root of the tree
+	//or with the deepest node the whole line is in
+	tstack_p->nodenum = AAS_TraceStartNode(start, end);
 	tstack_p++;
 	
 	while (1)
@@ -538,7 +741,7 @@ aas_trace_t AAS_TraceClientBBox(vec3_t start, vec3_t end, int presencetype,
 			} //end if
 			else
 			{
-				if (passent >= 0)
+				if (passent >= 0 && AAS_AreaOccupied(-nodenum))
 				{
 					if (AAS_AreaEntityCollision(-nodenum, tstack_p->start,
 													tstack_p->end, presencetype, passent,
@@ -743,7 +946,8 @@ int AAS_TraceAreas(vec3_t start, vec3_t end, int *areas, vec3_t *points, int max
 	VectorCopy(end, tstack_p->end);
 	tstack_p->planenum = 0;
 	//start with node 1 because node zero is a dummy for a solid leaf
-	tstack_p->nodenum = 1;		//starting at the root of the tree
+	//or with the deepest node the whole line is in
+	tstack_p->nodenum = AAS_TraceStartNode(start, end);
 	tstack_p++;
 
 	while (1)
@@ -1200,14 +1404,59 @@ void AAS_UnlinkFromAreas(aas_link_t *areas)
 		if (link->prev_ent) link->prev_ent->next_ent = link->next_ent;
 		else aasworld.arealinkedentities[link->areanum] = link->next_ent;
 		if (link->next_ent) link->next_ent->prev_ent = link->prev_ent;
+		//the area is no longer occupied if this was the last entity linked into it
+		if (!aasworld.arealinkedentities[link->areanum])
+		{
+			aasworld.areaoccupied[link->areanum >> 3] &= ~(1 << (link->areanum & 7));
+		} //end if
 		//deallocate the link structure
 		AAS_DeAllocAASLink(link);
 	} //end for
 } //end of the function AAS_UnlinkFromAreas
 //===========================================================================
+// returns how far the box can move along any axis without changing the
+// side(s) of the plane it is situated at
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+#define LINKSLACK_EPSILON		0.125
+
+static float AAS_BoxPlaneSlack(vec3_t absmins, vec3_t absmaxs, aas_plane_t *p)
+{
+	int i;
+	float dist1, dist2, normallength;
+	vec3_t corners[2];
+
+	for (i = 0; i < 3; i++)
+	{
+		if (p->normal[i] < 0)
+		{
+			corners[0][i] = absmins[i];
+			corners[1][i] = absmaxs[i];
+		} //end if
+		else
+		{
+			corners[1][i] = absmins[i];
+			corners[0][i] = absmaxs[i];
+		} //end else
+	} //end for
+	dist1 = fabs(DotProduct(p->normal, corners[0]) - p->dist);
+	dist2 = fabs(DotProduct(p->normal, corners[1]) - p->dist);
+	//moving every side of the box by d changes the plane distances by at most
+	//d * (|normal[0]| + |normal[1]| + |normal[2]|)
+	normallength = fabs(p->normal[0]) + fabs(p->normal[1]) + fabs(p->normal[2]);
+	if (dist2 < dist1) dist1 = dist2;
+	return (dist1 - LINKSLACK_EPSILON) / normallength;
+} //end of the function AAS_BoxPlaneSlack
+//===========================================================================
 // link the entity to the areas the bounding box is totally or partly
 // situated in. This is done with recursion down the tree using the
 // bounding box to test for plane sides
+// if slack is not NULL it is set to how far the sides of the box can move
+// without changing the areas the box is linked into, it's negative if
+// the box has to be relinked after any movement
 //
 // Parameter:				-
 // Returns:					-
@@ -1219,9 +1468,10 @@ typedef struct
 	int nodenum;		//node found after splitting
 } aas_linkstack_t;
 
-aas_link_t *AAS_AASLinkEntity(vec3_t absmins, vec3_t absmaxs, int entnum)
+aas_link_t *AAS_AASLinkEntity(vec3_t absmins, vec3_t absmaxs, int entnum, float *slack)
 {
 	int side, nodenum;
+	float planeslack;
 	aas_linkstack_t linkstack[128];
 	aas_linkstack_t *lstack_p;
 	aas_node_t *aasnode;
@@ -1235,6 +1485,7 @@ aas_link_t *AAS_AASLinkEntity(vec3_t absmins, vec3_t absmaxs, int entnum)
 	} //end if
 
 	areas = NULL;
+	if (slack) *slack = 99999;
 	//
 	lstack_p = linkstack;
 	//we start with the whole line on the stack
@@ -1263,7 +1514,11 @@ aas_link_t *AAS_AASLinkEntity(vec3_t absmins, vec3_t absmaxs, int entnum)
 			if (link) continue;
 			//
 			link = AAS_AllocAASLink();
-			if (!link) return areas;
+			if (!link)
+			{
+				if (slack) *slack = -1;
+				return areas;
+			} //end if
 			link->entnum = entnum;
 			link->areanum = -nodenum;
 			//put the link into the double linked area list of the entity
@@ -1277,6 +1532,7 @@ aas_link_t *AAS_AASLinkEntity(vec3_t absmins, vec3_t absmaxs, int entnum)
 			if (aasworld.arealinkedentities[-nodenum])
 					aasworld.arealinkedentities[-nodenum]->prev_ent = link;
 			aasworld.arealinkedentities[-nodenum] = link;
+			aasworld.areaoccupied[-nodenum >> 3] |= 1 << (-nodenum & 7);
 			//
 			continue;
 		} //end if
@@ -1288,6 +1544,12 @@ aas_link_t *AAS_AASLinkEntity(vec3_t absmins, vec3_t absmaxs, int entnum)
 		plane = &aasworld.planes[aasnode->planenum];
 		//get the side(s) the box is situated relative to the plane
 		side = AAS_BoxOnPlaneSide2(absmins, absmaxs, plane);
+		//the box may not move further than the distance to any of the visited node planes
+		if (slack)
+		{
+			planeslack = AAS_BoxPlaneSlack(absmins, absmaxs, plane);
+			if (planeslack < *slack) *slack = planeslack;
+		} //end if
 		//if on the front side of the node
 		if (side & 1)
 		{
@@ -1297,6 +1559,7 @@ aas_link_t *AAS_AASLinkEntity(vec3_t absmins, vec3_t absmaxs, int entnum)
 		if (lstack_p >= &linkstack[127])
 		{
 			botimport.Print(PRT_ERROR, "AAS_LinkEntity: stack overflow\n");
+			if (slack) *slack = -1;
 			break;
 		} //end if
 		//if on the back side of the node
@@ -1308,6 +1571,7 @@ aas_link_t *AAS_AASLinkEntity(vec3_t absmins, vec3_t absmaxs, int entnum)
 		if (lstack_p >= &linkstack[127])
 		{
 			botimport.Print(PRT_ERROR, "AAS_LinkEntity: stack overflow\n");
+			if (slack) *slack = -1;
 			break;
 		} //end if
 	} //end while
@@ -1319,7 +1583,7 @@ aas_link_t *AAS_AASLinkEntity(vec3_t absmins, vec3_t absmaxs, int entnum)
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
-aas_link_t *AAS_LinkEntityClientBBox(vec3_t absmins, vec3_t absmaxs, int entnum, int presencetype)
+aas_link_t *AAS_LinkEntityClientBBox(vec3_t absmins, vec3_t absmaxs, int entnum, int presencetype, float *slack)
 {
 	vec3_t mins, maxs;
 	vec3_t newabsmins, newabsmaxs;
@@ -1328,7 +1592,7 @@ aas_link_t *AAS_LinkEntityClientBBox(vec3_t absmins, vec3_t absmaxs, int entnum,
 	VectorSubtract(absmins, maxs, newabsmins);
 	VectorSubtract(absmaxs, mins, newabsmaxs);
 	//relink the entity
-	return AAS_AASLinkEntity(newabsmins, newabsmaxs, entnum);
+	return AAS_AASLinkEntity(newabsmins, newabsmaxs, entnum, slack);
 } //end of the function AAS_LinkEntityClientBBox
 //===========================================================================
 //
@@ -1341,7 +1605,7 @@ int AAS_BBoxAreas(vec3_t absmins, vec3_t absmaxs, int *areas, int maxareas)
 	aas_link_t *linkedareas, *link;
 	int num;
 
-	linkedareas = AAS_AASLinkEntity(absmins, absmaxs, -1);
+	linkedareas = AAS_AASLinkEntity(absmins, absmaxs, -1, NULL);
 	num = 0;
 	for (link = linkedareas; link; link = link->next_area)
 	{
@@ -1391,3 +1655,195 @@ aas_plane_t *AAS_PlaneFromNum(int planenum)
 
 	return &aasworld.planes[planenum];
 } //end of the function AAS_PlaneFromNum
+#ifndef BSPC
+
+#define BENCHMARK_POINTS			100000
+#define BENCHMARK_TRACES			20000
+#define BENCHMARK_MOVES				1000
+#define BENCHMARK_CANDIDATES		8
+
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static int64_t AAS_BenchmarkTime(void)
+{
+	if (!botimport.Microseconds) return 0;
+	return botimport.Microseconds();
+} //end of the function AAS_BenchmarkTime
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static unsigned int AAS_BenchmarkHash(unsigned int hash, void *data, int size)
+{
+	int i;
+
+	for (i = 0; i < size; i++)
+	{
+		hash = (hash ^ ((unsigned char *) data)[i]) * 16777619u;
+	} //end for
+	return hash;
+} //end of the function AAS_BenchmarkHash
+//===========================================================================
+// random point in the bounding box of a random area
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_BenchmarkPoint(int *seed, vec3_t point)
+{
+	int areanum, i;
+	aas_area_t *area;
+
+	areanum = 1 + (int) (Q_random(seed) * (aasworld.numareas - 1));
+	if (areanum >= aasworld.numareas) areanum = aasworld.numareas - 1;
+	area = &aasworld.areas[areanum];
+	for (i = 0; i < 3; i++)
+	{
+		point[i] = area->mins[i] + Q_random(seed) * (area->maxs[i] - area->mins[i]);
+	} //end for
+} //end of the function AAS_BenchmarkPoint
+//===========================================================================
+// runs the same point, trace and movement prediction queries without and
+// with the node grid, prints the times and checks the results are equal,
+// also compares batched movement prediction of several candidates with
+// predicting the candidates one by one
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_BenchmarkSampling(void)
+{
+	int i, j, pass, seed, numareas, areas[32], numresults, mismatches[3];
+	int *nodegrid;
+	unsigned int *results[2], *res, hash;
+	int64_t times[2][3], movetimes[2], starttime;
+	int movemismatches;
+	float angle;
+	vec3_t start, end, velocity;
+	vec3_t velocities[BENCHMARK_CANDIDATES], cmdmoves[BENCHMARK_CANDIDATES];
+	aas_trace_t trace;
+	aas_clientmove_t move, moves[BENCHMARK_CANDIDATES];
+
+	if (!aasworld.loaded)
+	{
+		botimport.Print(PRT_ERROR, "AAS_BenchmarkSampling: aas not loaded\n");
+		return;
+	} //end if
+	numresults = BENCHMARK_POINTS + BENCHMARK_TRACES * 2 + BENCHMARK_MOVES;
+	results[0] = (unsigned int *) GetMemory(numresults * sizeof(unsigned int));
+	results[1] = (unsigned int *) GetMemory(numresults * sizeof(unsigned int));
+	nodegrid = aasworld.nodegrid;
+	for (pass = 0; pass < 2; pass++)
+	{
+		//first pass descends the bsp tree from the root
+		aasworld.nodegrid = pass ? nodegrid : NULL;
+		res = results[pass];
+		seed = 1;
+		//point queries
+		times[pass][0] = AAS_BenchmarkTime();
+		for (i = 0; i < BENCHMARK_POINTS; i++)
+		{
+			AAS_BenchmarkPoint(&seed, start);
+			*res++ = AAS_PointAreaNum(start);
+		} //end for
+		times[pass][0] = AAS_BenchmarkTime() - times[pass][0];
+		//short traces like the ones of movement prediction
+		times[pass][1] = AAS_BenchmarkTime();
+		for (i = 0; i < BENCHMARK_TRACES; i++)
+		{
+			AAS_BenchmarkPoint(&seed, start);
+			for (j = 0; j < 3; j++) end[j] = start[j] + Q_crandom(&seed) * 128;
+			numareas = AAS_TraceAreas(start, end, areas, NULL, 32);
+			*res++ = AAS_BenchmarkHash(numareas, areas, numareas * sizeof(int));
+			trace = AAS_TraceClientBBox(start, end, PRESENCE_NORMAL, -1);
+			hash = AAS_BenchmarkHash(trace.startsolid, &trace.fraction, sizeof(float));
+			hash = AAS_BenchmarkHash(hash, trace.endpos, sizeof(vec3_t));
+			hash = AAS_BenchmarkHash(hash, &trace.area, sizeof(int));
+			*res++ = AAS_BenchmarkHash(hash, &trace.lastarea, sizeof(int));
+		} //end for
+		times[pass][1] = AAS_BenchmarkTime() - times[pass][1];
+		//movement prediction in random directions
+		times[pass][2] = AAS_BenchmarkTime();
+		for (i = 0; i < BENCHMARK_MOVES; i++)
+		{
+			AAS_BenchmarkPoint(&seed, start);
+			angle = Q_random(&seed) * 2 * M_PI;
+			VectorSet(velocity, cos(angle) * 320, sin(angle) * 320, 0);
+			AAS_PredictClientMovement(&move, -1, start, PRESENCE_NORMAL, qfalse,
+										velocity, velocity, 10, 30, 0.1f, SE_NONE, 0, qfalse);
+			hash = AAS_BenchmarkHash(move.endarea, move.endpos, sizeof(vec3_t));
+			*res++ = AAS_BenchmarkHash(hash, &move.frames, sizeof(int));
+		} //end for
+		times[pass][2] = AAS_BenchmarkTime() - times[pass][2];
+	} //end for
+	aasworld.nodegrid = nodegrid;
+	//compare the results
+	mismatches[0] = mismatches[1] = mismatches[2] = 0;
+	for (i = 0; i < numresults; i++)
+	{
+		if (results[0][i] == results[1][i]) continue;
+		if (i < BENCHMARK_POINTS) mismatches[0]++;
+		else if (i < BENCHMARK_POINTS + BENCHMARK_TRACES * 2) mismatches[1]++;
+		else mismatches[2]++;
+	} //end for
+	FreeMemory(results[0]);
+	FreeMemory(results[1]);
+	//jump and walk candidates in several directions like the bot movement code tries
+	seed = 1;
+	movetimes[0] = movetimes[1] = 0;
+	movemismatches = 0;
+	for (i = 0; i < BENCHMARK_MOVES; i++)
+	{
+		AAS_BenchmarkPoint(&seed, start);
+		for (j = 0; j < BENCHMARK_CANDIDATES; j++)
+		{
+			angle = (float) j / BENCHMARK_CANDIDATES * 2 * M_PI;
+			VectorSet(cmdmoves[j], cos(angle) * 400, sin(angle) * 400, (j & 1) ? 400 : 0);
+			VectorSet(velocities[j], Q_crandom(&seed) * 320, Q_crandom(&seed) * 320, 0);
+		} //end for
+		starttime = AAS_BenchmarkTime();
+		AAS_PredictClientMovements(moves, BENCHMARK_CANDIDATES, -1, start, PRESENCE_NORMAL, qtrue,
+									velocities, cmdmoves, 1, 30, 0.1f,
+									SE_HITGROUND|SE_HITGROUNDDAMAGE|SE_ENTERWATER|SE_ENTERSLIME|SE_ENTERLAVA,
+									0, qfalse);
+		movetimes[1] += AAS_BenchmarkTime() - starttime;
+		for (j = 0; j < BENCHMARK_CANDIDATES; j++)
+		{
+			starttime = AAS_BenchmarkTime();
+			AAS_PredictClientMovement(&move, -1, start, PRESENCE_NORMAL, qtrue,
+									velocities[j], cmdmoves[j], 1, 30, 0.1f,
+									SE_HITGROUND|SE_HITGROUNDDAMAGE|SE_ENTERWATER|SE_ENTERSLIME|SE_ENTERLAVA,
+									0, qfalse);
+			movetimes[0] += AAS_BenchmarkTime() - starttime;
+			if (memcmp(&move, &moves[j], sizeof(aas_clientmove_t))) movemismatches++;
+		} //end for
+	} //end for
+	//
+	if (nodegrid)
+	{
+		botimport.Print(PRT_MESSAGE, "%d areas, %d nodes, %dx%dx%d node grid with %d unit cells\n",
+							aasworld.numareas, aasworld.numnodes, aasworld.nodegridsize[0],
+							aasworld.nodegridsize[1], aasworld.nodegridsize[2], (int) aasworld.nodegridcellsize);
+	} //end if
+	else
+	{
+		botimport.Print(PRT_MESSAGE, "%d areas, %d nodes, no node grid\n", aasworld.numareas, aasworld.numnodes);
+	} //end else
+	botimport.Print(PRT_MESSAGE, "%6d point queries: %8d usec bsp %8d usec grid, %d mismatches\n",
+						BENCHMARK_POINTS, (int) times[0][0], (int) times[1][0], mismatches[0]);
+	botimport.Print(PRT_MESSAGE, "%6d traces:        %8d usec bsp %8d usec grid, %d mismatches\n",
+						BENCHMARK_TRACES * 2, (int) times[0][1], (int) times[1][1], mismatches[1]);
+	botimport.Print(PRT_MESSAGE, "%6d predictions:   %8d usec bsp %8d usec grid, %d mismatches\n",
+						BENCHMARK_MOVES, (int) times[0][2], (int) times[1][2], mismatches[2]);
+	botimport.Print(PRT_MESSAGE, "%6d candidates:    %8d usec single %8d usec batched, %d mismatches\n",
+						BENCHMARK_MOVES * BENCHMARK_CANDIDATES, (int) movetimes[0], (int) movetimes[1], movemismatches);
+} //end of the function AAS_BenchmarkSampling
+#endif //BSPC
@@ -37,11 +37,14 @@ void AAS_FreeAASLinkedEntities(void);
 aas_face_t *AAS_AreaGroundFace(int areanum, vec3_t point);
 aas_face_t *AAS_TraceEndFace(aas_trace_t *trace);
 aas_plane_t *AAS_PlaneFromNum(int planenum);
-aas_link_t *AAS_AASLinkEntity(vec3_t absmins, vec3_t absmaxs, int entnum);
-aas_link_t *AAS_LinkEntityClientBBox(vec3_t absmins, vec3_t absmaxs, int entnum, int presencetype);
+aas_link_t *AAS_AASLinkEntity(vec3_t absmins, vec3_t absmaxs, int entnum, float *slack);
+aas_link_t *AAS_LinkEntityClientBBox(vec3_t absmins, vec3_t absmaxs, int entnum, int presencetype, float *slack);
 qboolean AAS_PointInsideFace(int facenum, vec3_t point, float epsilon);
 qboolean AAS_InsideFace(aas_face_t *face, vec3_t pnormal, vec3_t point, float epsilon);
 void AAS_UnlinkFromAreas(aas_link_t *areas);
+void AAS_InitNodeGrid(void);
+void AAS_FreeNodeGrid(void);
+void AAS_BenchmarkSampling(void);
 #endif //AASINTERN
 
 //returns the mins and maxs of the bounding box for the given presence type
@@ -58,6 +61,8 @@ aas_trace_t AAS_TraceClientBBox(vec3_t start, vec3_t end, int presencetype, int
 int AAS_TraceAreas(vec3_t start, vec3_t end, int *areas, vec3_t *points, int maxareas);
 //returns the areas the bounding box is in
 int AAS_BBoxAreas(vec3_t absmins, vec3_t absmaxs, int *areas, int maxareas);
+//returns true if at least one entity is linked into the area
+int AAS_AreaOccupied(int areanum);
 //return area information
 int AAS_AreaInfo( int areanum, aas_areainfo_t *info );
 //returns the area the point is in
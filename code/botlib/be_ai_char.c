@@ -37,6 +37,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "l_precomp.h"
 #include "l_struct.h"
 #include "l_libvar.h"
+#include "l_cache.h"
 #include "aasfile.h"
 #include "botlib.h"
 #include "be_aas.h"
@@ -51,6 +52,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define CT_STRING				3
 
 #define DEFAULT_CHARACTER		"bots/default_c.c"
+//version of the compiled characters in the bot cache
+#define CHARACTERCACHE_VERSION	1
 
 //characteristic value
 union cvalue
@@ -71,6 +74,7 @@ typedef struct bot_character_s
 {
 	char filename[MAX_QPATH];
 	float skill;
+	memoryarena_t *arena;			//memory of the character and its strings
 	bot_characteristic_t c[1];		//variable sized
 } bot_character_t;
 
@@ -126,18 +130,28 @@ void BotDumpCharacter(bot_character_t *ch)
 // Returns:				-
 // Changes Globals:		-
 //========================================================================
-void BotFreeCharacterStrings(bot_character_t *ch)
+bot_character_t *BotAllocCharacter(void)
 {
-	int i;
+	memoryarena_t *arena;
+	bot_character_t *ch;
 
-	for (i = 0; i < MAX_CHARACTERISTICS; i++)
-	{
-		if (ch->c[i].type == CT_STRING)
-		{
-			FreeMemory(ch->c[i].value.string);
-		} //end if
-	} //end for
-} //end of the function BotFreeCharacterStrings
+	arena = GetMemoryArena("characters", 2048);
+	ch = (bot_character_t *) GetClearedArenaMemory(arena, sizeof(bot_character_t) +
+					MAX_CHARACTERISTICS * sizeof(bot_characteristic_t));
+	ch->arena = arena;
+	return ch;
+} //end of the function BotAllocCharacter
+//========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//========================================================================
+void BotFreeCharacterMemory(bot_character_t *ch)
+{
+	//the character and all its strings are in the arena
+	FreeMemoryArena(ch->arena);
+} //end of the function BotFreeCharacterMemory
 //========================================================================
 //
 // Parameter:			-
@@ -156,8 +170,7 @@ void BotFreeCharacter2(int handle)
 		botimport.Print(PRT_FATAL, "invalid character %d\n", handle);
 		return;
 	} //end if
-	BotFreeCharacterStrings(botcharacters[handle]);
-	FreeMemory(botcharacters[handle]);
+	BotFreeCharacterMemory(botcharacters[handle]);
 	botcharacters[handle] = NULL;
 } //end of the function BotFreeCharacter2
 //========================================================================
@@ -198,8 +211,7 @@ void BotDefaultCharacteristics(bot_character_t *ch, bot_character_t *defaultch)
 		else if (defaultch->c[i].type == CT_STRING)
 		{
 			ch->c[i].type = CT_STRING;
-			ch->c[i].value.string = (char *) GetMemory(strlen(defaultch->c[i].value.string)+1);
-			strcpy(ch->c[i].value.string, defaultch->c[i].value.string);
+			ch->c[i].value.string = CopyArenaString(ch->arena, defaultch->c[i].value.string);
 		} //end else if
 	} //end for
 } //end of the function BotDefaultCharacteristics
@@ -209,7 +221,7 @@ void BotDefaultCharacteristics(bot_character_t *ch, bot_character_t *defaultch)
 // Returns:				-
 // Changes Globals:		-
 //===========================================================================
-bot_character_t *BotLoadCharacterFromFile(char *charfile, int skill)
+bot_character_t *BotParseCharacterFromFile(char *charfile, int skill)
 {
 	int indent, index, foundcharacter;
 	bot_character_t *ch;
@@ -225,8 +237,7 @@ bot_character_t *BotLoadCharacterFromFile(char *charfile, int skill)
 		botimport.Print(PRT_ERROR, "counldn't load %s\n", charfile);
 		return NULL;
 	} //end if
-	ch = (bot_character_t *) GetClearedMemory(sizeof(bot_character_t) +
-					MAX_CHARACTERISTICS * sizeof(bot_characteristic_t));
+	ch = BotAllocCharacter();
 	strcpy(ch->filename, charfile);
 	while(PC_ReadToken(source, &token))
 	{
@@ -235,15 +246,13 @@ bot_character_t *BotLoadCharacterFromFile(char *charfile, int skill)
 			if (!PC_ExpectTokenType(source, TT_NUMBER, 0, &token))
 			{
 				FreeSource(source);
-				BotFreeCharacterStrings(ch);
-				FreeMemory(ch);
+				BotFreeCharacterMemory(ch);
 				return NULL;
 			} //end if
 			if (!PC_ExpectTokenString(source, "{"))
 			{
 				FreeSource(source);
-				BotFreeCharacterStrings(ch);
-				FreeMemory(ch);
+				BotFreeCharacterMemory(ch);
 				return NULL;
 			} //end if
 			//if it's the correct skill
@@ -258,8 +267,7 @@ bot_character_t *BotLoadCharacterFromFile(char *charfile, int skill)
 					{
 						SourceError(source, "expected integer index, found %s", token.string);
 						FreeSource(source);
-						BotFreeCharacterStrings(ch);
-						FreeMemory(ch);
+						BotFreeCharacterMemory(ch);
 						return NULL;
 					} //end if
 					index = token.intvalue;
@@ -267,23 +275,20 @@ bot_character_t *BotLoadCharacterFromFile(char *charfile, int skill)
 					{
 						SourceError(source, "characteristic index out of range [0, %d]", MAX_CHARACTERISTICS);
 						FreeSource(source);
-						BotFreeCharacterStrings(ch);
-						FreeMemory(ch);
+						BotFreeCharacterMemory(ch);
 						return NULL;
 					} //end if
 					if (ch->c[index].type)
 					{
 						SourceError(source, "characteristic %d already initialized", index);
 						FreeSource(source);
-						BotFreeCharacterStrings(ch);
-						FreeMemory(ch);
+						BotFreeCharacterMemory(ch);
 						return NULL;
 					} //end if
 					if (!PC_ExpectAnyToken(source, &token))
 					{
 						FreeSource(source);
-						BotFreeCharacterStrings(ch);
-						FreeMemory(ch);
+						BotFreeCharacterMemory(ch);
 						return NULL;
 					} //end if
 					if (token.type == TT_NUMBER)
@@ -302,16 +307,14 @@ bot_character_t *BotLoadCharacterFromFile(char *charfile, int skill)
 					else if (token.type == TT_STRING)
 					{
 						StripDoubleQuotes(token.string);
-						ch->c[index].value.string = GetMemory(strlen(token.string)+1);
-						strcpy(ch->c[index].value.string, token.string);
+						ch->c[index].value.string = CopyArenaString(ch->arena, token.string);
 						ch->c[index].type = CT_STRING;
 					} //end else if
 					else
 					{
 						SourceError(source, "expected integer, float or string, found %s", token.string);
 						FreeSource(source);
-						BotFreeCharacterStrings(ch);
-						FreeMemory(ch);
+						BotFreeCharacterMemory(ch);
 						return NULL;
 					} //end else
 				} //end if
@@ -325,8 +328,7 @@ bot_character_t *BotLoadCharacterFromFile(char *charfile, int skill)
 					if (!PC_ExpectAnyToken(source, &token))
 					{
 						FreeSource(source);
-						BotFreeCharacterStrings(ch);
-						FreeMemory(ch);
+						BotFreeCharacterMemory(ch);
 						return NULL;
 					} //end if
 					if (!strcmp(token.string, "{")) indent++;
@@ -338,8 +340,7 @@ bot_character_t *BotLoadCharacterFromFile(char *charfile, int skill)
 		{
 			SourceError(source, "unknown definition %s", token.string);
 			FreeSource(source);
-			BotFreeCharacterStrings(ch);
-			FreeMemory(ch);
+			BotFreeCharacterMemory(ch);
 			return NULL;
 		} //end else
 	} //end while
@@ -347,10 +348,98 @@ bot_character_t *BotLoadCharacterFromFile(char *charfile, int skill)
 	//
 	if (!foundcharacter)
 	{
-		BotFreeCharacterStrings(ch);
-		FreeMemory(ch);
+		BotFreeCharacterMemory(ch);
+		return NULL;
+	} //end if
+	return ch;
+} //end of the function BotParseCharacterFromFile
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void BotWriteCharacterCache(cachefile_t *cf, bot_character_t *ch)
+{
+	int i;
+
+	Cache_WriteFloat(cf, ch->skill);
+	for (i = 0; i < MAX_CHARACTERISTICS; i++)
+	{
+		if (!ch->c[i].type) continue;
+		Cache_WriteInt(cf, i);
+		Cache_WriteInt(cf, ch->c[i].type);
+		if (ch->c[i].type == CT_FLOAT) Cache_WriteFloat(cf, ch->c[i].value._float);
+		else if (ch->c[i].type == CT_INTEGER) Cache_WriteInt(cf, ch->c[i].value.integer);
+		else Cache_WriteString(cf, ch->c[i].value.string);
+	} //end for
+	Cache_WriteInt(cf, -1);
+} //end of the function BotWriteCharacterCache
+//===========================================================================
+// returns the character from the bot cache or NULL if not cached
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+bot_character_t *BotReadCharacterCache(char *name, char *charfile)
+{
+	int index, type;
+	cachefile_t *cf;
+	bot_character_t *ch;
+
+	cf = Cache_OpenRead(name, "bcc", CHARACTERCACHE_VERSION);
+	if (!cf) return NULL;
+	ch = BotAllocCharacter();
+	Q_strncpyz(ch->filename, charfile, sizeof(ch->filename));
+	ch->skill = Cache_ReadFloat(cf);
+	while(!cf->error)
+	{
+		index = Cache_ReadInt(cf);
+		if (index < 0) break;
+		type = Cache_ReadInt(cf);
+		if (index >= MAX_CHARACTERISTICS || ch->c[index].type)
+		{
+			cf->error = qtrue;
+			break;
+		} //end if
+		if (type == CT_FLOAT) ch->c[index].value._float = Cache_ReadFloat(cf);
+		else if (type == CT_INTEGER) ch->c[index].value.integer = Cache_ReadInt(cf);
+		else if (type == CT_STRING) ch->c[index].value.string = CopyArenaString(ch->arena, Cache_ReadString(cf));
+		else cf->error = qtrue;
+		ch->c[index].type = type;
+	} //end while
+	if (cf->error)
+	{
+		botimport.Print(PRT_WARNING, "invalid bot cache for %s\n", charfile);
+		Cache_Close(cf);
+		BotFreeCharacterMemory(ch);
 		return NULL;
 	} //end if
+	Cache_Close(cf);
+	return ch;
+} //end of the function BotReadCharacterCache
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+bot_character_t *BotLoadCharacterFromFile(char *charfile, int skill)
+{
+	char name[MAX_QPATH];
+	cachefile_t *cf;
+	bot_character_t *ch;
+
+	//every skill of a character file is compiled separately
+	Com_sprintf(name, sizeof(name), "%s_%d", charfile, skill);
+	//use the compiled character if the source files didn't change
+	ch = BotReadCharacterCache(name, charfile);
+	if (ch) return ch;
+	cf = Cache_BeginWrite(name, "bcc", CHARACTERCACHE_VERSION);
+	ch = BotParseCharacterFromFile(charfile, skill);
+	if (ch) BotWriteCharacterCache(cf, ch);
+	Cache_EndWrite(cf, ch != NULL);
 	return ch;
 } //end of the function BotLoadCharacterFromFile
 //===========================================================================
@@ -529,8 +618,7 @@ int BotInterpolateCharacters(int handle1, int handle2, float desiredskill)
 		if (!botcharacters[handle]) break;
 	} //end for
 	if (handle > MAX_CLIENTS) return 0;
-	out = (bot_character_t *) GetClearedMemory(sizeof(bot_character_t) +
-					MAX_CHARACTERISTICS * sizeof(bot_characteristic_t));
+	out = BotAllocCharacter();
 	out->skill = desiredskill;
 	strcpy(out->filename, ch1->filename);
 	botcharacters[handle] = out;
@@ -553,8 +641,7 @@ int BotInterpolateCharacters(int handle1, int handle2, float desiredskill)
 		else if (ch1->c[i].type == CT_STRING)
 		{
 			out->c[i].type = CT_STRING;
-			out->c[i].value.string = (char *) GetMemory(strlen(ch1->c[i].value.string)+1);
-			strcpy(out->c[i].value.string, ch1->c[i].value.string);
+			out->c[i].value.string = CopyArenaString(out->arena, ch1->c[i].value.string);
 		} //end else if
 	} //end for
 	return handle;
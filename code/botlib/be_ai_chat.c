@@ -37,6 +37,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "l_struct.h"
 #include "l_utils.h"
 #include "l_log.h"
+#include "l_cache.h"
 #include "aasfile.h"
 #include "botlib.h"
 #include "be_aas.h"
@@ -69,6 +70,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define RCKFL_GENDERLESS			256		//bot must be genderless
 //time to ignore a chat message after using it
 #define CHATMESSAGE_RECENTTIME	20
+//version of the compiled initial chats in the bot cache
+#define CHATCACHE_VERSION		1
 
 //the actuall chat messages
 typedef struct bot_chatmessage_s
@@ -2029,7 +2032,7 @@ void BotDumpInitialChat(bot_chat_t *chat)
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
-bot_chat_t *BotLoadInitialChat(char *chatfile, char *chatname)
+bot_chat_t *BotParseInitialChat(char *chatfile, char *chatname)
 {
 	int pass, foundchat, indent, size;
 	char *ptr = NULL;
@@ -2039,12 +2042,7 @@ bot_chat_t *BotLoadInitialChat(char *chatfile, char *chatname)
 	bot_chat_t *chat = NULL;
 	bot_chattype_t *chattype = NULL;
 	bot_chatmessage_t *chatmessage = NULL;
-#ifdef DEBUG
-	int starttime;
 
-	starttime = Sys_MilliSeconds();
-#endif //DEBUG
-	//
 	size = 0;
 	foundchat = qfalse;
 	//a bot chat is parsed in two phases
@@ -2184,6 +2182,153 @@ bot_chat_t *BotLoadInitialChat(char *chatfile, char *chatname)
 			return NULL;
 		} //end if
 	} //end for
+	//character was read successfully
+	return chat;
+} //end of the function BotParseInitialChat
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void BotWriteInitialChatCache(cachefile_t *cf, bot_chat_t *chat)
+{
+	int size, numtypes;
+	bot_chattype_t *t;
+	bot_chatmessage_t *m;
+
+	size = sizeof(bot_chat_t);
+	numtypes = 0;
+	for (t = chat->types; t; t = t->next)
+	{
+		size += sizeof(bot_chattype_t);
+		for (m = t->firstchatmessage; m; m = m->next)
+		{
+			size += sizeof(bot_chatmessage_t) + PAD(strlen(m->chatmessage) + 1, sizeof(long));
+		} //end for
+		numtypes++;
+	} //end for
+	//the size of the chat block and the types and messages in list order
+	Cache_WriteInt(cf, size);
+	Cache_WriteInt(cf, numtypes);
+	for (t = chat->types; t; t = t->next)
+	{
+		Cache_WriteString(cf, t->name);
+		Cache_WriteInt(cf, t->numchatmessages);
+		for (m = t->firstchatmessage; m; m = m->next)
+		{
+			Cache_WriteString(cf, m->chatmessage);
+		} //end for
+	} //end for
+} //end of the function BotWriteInitialChatCache
+//===========================================================================
+// returns the initial chat from the bot cache or NULL if not cached
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+bot_chat_t *BotReadInitialChatCache(char *name, char *chatfile)
+{
+	int size, numtypes, i, j;
+	size_t len;
+	char *ptr, *end, *string;
+	cachefile_t *cf;
+	bot_chat_t *chat;
+	bot_chattype_t *chattype, **lasttype;
+	bot_chatmessage_t *chatmessage, **lastmessage;
+
+	cf = Cache_OpenRead(name, "bic", CHATCACHE_VERSION);
+	if (!cf) return NULL;
+	size = Cache_ReadInt(cf);
+	numtypes = Cache_ReadInt(cf);
+	//every type and message takes at least a few bytes in the cache
+	if (cf->error || numtypes < 0 || size < (int) sizeof(bot_chat_t) ||
+		size > (int) sizeof(bot_chat_t) + cf->size * (int) (sizeof(bot_chattype_t) + sizeof(bot_chatmessage_t)))
+	{
+		botimport.Print(PRT_WARNING, "invalid bot cache for %s\n", chatfile);
+		Cache_Close(cf);
+		return NULL;
+	} //end if
+	//the chat is stored in one block like BotParseInitialChat does
+	ptr = (char *) GetClearedMemory(size);
+	end = ptr + size;
+	chat = (bot_chat_t *) ptr;
+	ptr += sizeof(bot_chat_t);
+	lasttype = &chat->types;
+	for (i = 0; i < numtypes && !cf->error; i++)
+	{
+		if (end - ptr < (int) sizeof(bot_chattype_t))
+		{
+			cf->error = qtrue;
+			break;
+		} //end if
+		chattype = (bot_chattype_t *) ptr;
+		ptr += sizeof(bot_chattype_t);
+		Q_strncpyz(chattype->name, Cache_ReadString(cf), MAX_CHATTYPE_NAME);
+		chattype->numchatmessages = Cache_ReadInt(cf);
+		//append to keep the order of the parsed list
+		*lasttype = chattype;
+		lasttype = &chattype->next;
+		lastmessage = &chattype->firstchatmessage;
+		for (j = 0; j < chattype->numchatmessages && !cf->error; j++)
+		{
+			string = Cache_ReadString(cf);
+			len = PAD(strlen(string) + 1, sizeof(long));
+			if (end - ptr < (int) (sizeof(bot_chatmessage_t) + len))
+			{
+				cf->error = qtrue;
+				break;
+			} //end if
+			chatmessage = (bot_chatmessage_t *) ptr;
+			chatmessage->time = -2*CHATMESSAGE_RECENTTIME;
+			ptr += sizeof(bot_chatmessage_t);
+			chatmessage->chatmessage = ptr;
+			strcpy(chatmessage->chatmessage, string);
+			ptr += len;
+			*lastmessage = chatmessage;
+			lastmessage = &chatmessage->next;
+		} //end for
+	} //end for
+	if (cf->error)
+	{
+		botimport.Print(PRT_WARNING, "invalid bot cache for %s\n", chatfile);
+		Cache_Close(cf);
+		FreeMemory(chat);
+		return NULL;
+	} //end if
+	Cache_Close(cf);
+	return chat;
+} //end of the function BotReadInitialChatCache
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+bot_chat_t *BotLoadInitialChat(char *chatfile, char *chatname)
+{
+	char name[MAX_QPATH];
+	cachefile_t *cf;
+	bot_chat_t *chat;
+#ifdef DEBUG
+	int starttime;
+
+	starttime = Sys_MilliSeconds();
+#endif //DEBUG
+
+	//every chat in a chat file is compiled separately
+	Com_sprintf(name, sizeof(name), "%s_%s", chatfile, chatname);
+	//use the compiled chat if the source files didn't change
+	chat = BotReadInitialChatCache(name, chatfile);
+	if (!chat)
+	{
+		cf = Cache_BeginWrite(name, "bic", CHATCACHE_VERSION);
+		chat = BotParseInitialChat(chatfile, chatname);
+		if (chat) BotWriteInitialChatCache(cf, chat);
+		Cache_EndWrite(cf, chat != NULL);
+		if (!chat) return NULL;
+	} //end if
 	//
 	botimport.Print(PRT_MESSAGE, "loaded %s from %s\n", chatname, chatfile);
 	//
@@ -2195,7 +2340,6 @@ bot_chat_t *BotLoadInitialChat(char *chatfile, char *chatname)
 #ifdef DEBUG
 	botimport.Print(PRT_MESSAGE, "initial chats loaded in %d msec\n", Sys_MilliSeconds() - starttime);
 #endif //DEBUG
-	//character was read successfully
 	return chat;
 } //end of the function BotLoadInitialChat
 //===========================================================================
@@ -37,6 +37,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "l_script.h"
 #include "l_precomp.h"
 #include "l_struct.h"
+#include "l_cache.h"
 #include "aasfile.h"
 #include "botlib.h"
 #include "be_aas.h"
@@ -57,6 +58,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define AVOID_DEFAULT_TIME		30
 //avoid dropped goal time
 #define AVOID_DROPPED_TIME		10
+//version of the compiled item configs in the bot cache
+#define ITEMCACHE_VERSION		1
 //
 #define TRAVELTIME_SCALE		0.01
 //item flags
@@ -168,6 +171,7 @@ typedef struct bot_goalstate_s
 	//
 	int client;									//client using this goal state
 	int lastreachabilityarea;					//last area with reachabilities the bot was in
+	int lasttravelflags;						//travel flags used when last choosing an item
 	//
 	bot_goal_t goalstack[MAX_GOALSTACK];		//goal stack
 	int goalstacktop;							//the top of the goal stack
@@ -267,23 +271,14 @@ void BotMutateGoalFuzzyLogic(int goalstate, float range)
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
-itemconfig_t *LoadItemConfig(char *filename)
+itemconfig_t *ParseItemConfig(char *filename, int max_iteminfo)
 {
-	int max_iteminfo;
 	token_t token;
 	char path[MAX_QPATH];
 	source_t *source;
 	itemconfig_t *ic;
 	iteminfo_t *ii;
 
-	max_iteminfo = (int) LibVarValue("max_iteminfo", "256");
-	if (max_iteminfo < 0)
-	{
-		botimport.Print(PRT_ERROR, "max_iteminfo = %d\n", max_iteminfo);
-		max_iteminfo = 256;
-		LibVarSet( "max_iteminfo", "256" );
-	}
-
 	Q_strncpyz(path, filename, sizeof(path));
 	PC_SetBaseFolder(BOTFILESBASEFOLDER);
 	source = LoadSourceFile( path );
@@ -340,6 +335,89 @@ itemconfig_t *LoadItemConfig(char *filename)
 	if (!ic->numiteminfo) botimport.Print(PRT_WARNING, "no item info loaded\n");
 	botimport.Print(PRT_MESSAGE, "loaded %s\n", path);
 	return ic;
+} //end of the function ParseItemConfig
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void WriteItemConfigCache(cachefile_t *cf, itemconfig_t *ic)
+{
+	//the item info is plain data
+	Cache_WriteInt(cf, sizeof(iteminfo_t));
+	Cache_WriteInt(cf, ic->numiteminfo);
+	Cache_WriteData(cf, ic->iteminfo, ic->numiteminfo * sizeof(iteminfo_t));
+} //end of the function WriteItemConfigCache
+//===========================================================================
+// returns the item config from the bot cache or NULL if not cached
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+itemconfig_t *ReadItemConfigCache(char *filename, int max_iteminfo)
+{
+	int size, numiteminfo;
+	cachefile_t *cf;
+	itemconfig_t *ic;
+
+	cf = Cache_OpenRead(filename, "bii", ITEMCACHE_VERSION);
+	if (!cf) return NULL;
+	size = Cache_ReadInt(cf);
+	numiteminfo = Cache_ReadInt(cf);
+	//let the parser report too many item infos
+	if (cf->error || size != sizeof(iteminfo_t) ||
+		numiteminfo < 0 || numiteminfo > max_iteminfo)
+	{
+		Cache_Close(cf);
+		return NULL;
+	} //end if
+	ic = (itemconfig_t *) GetClearedHunkMemory(sizeof(itemconfig_t) +
+														max_iteminfo * sizeof(iteminfo_t));
+	ic->iteminfo = (iteminfo_t *) ((char *) ic + sizeof(itemconfig_t));
+	ic->numiteminfo = numiteminfo;
+	Cache_ReadData(cf, ic->iteminfo, numiteminfo * sizeof(iteminfo_t));
+	if (cf->error)
+	{
+		botimport.Print(PRT_WARNING, "invalid bot cache for %s\n", filename);
+		Cache_Close(cf);
+		FreeMemory(ic);
+		return NULL;
+	} //end if
+	Cache_Close(cf);
+	if (!ic->numiteminfo) botimport.Print(PRT_WARNING, "no item info loaded\n");
+	botimport.Print(PRT_MESSAGE, "loaded %s\n", filename);
+	return ic;
+} //end of the function ReadItemConfigCache
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+itemconfig_t *LoadItemConfig(char *filename)
+{
+	int max_iteminfo;
+	cachefile_t *cf;
+	itemconfig_t *ic;
+
+	max_iteminfo = (int) LibVarValue("max_iteminfo", "256");
+	if (max_iteminfo < 0)
+	{
+		botimport.Print(PRT_ERROR, "max_iteminfo = %d\n", max_iteminfo);
+		max_iteminfo = 256;
+		LibVarSet( "max_iteminfo", "256" );
+	}
+
+	//use the compiled item config if the source files didn't change
+	ic = ReadItemConfigCache(filename, max_iteminfo);
+	if (ic) return ic;
+	cf = Cache_BeginWrite(filename, "bii", ITEMCACHE_VERSION);
+	ic = ParseItemConfig(filename, max_iteminfo);
+	if (ic) WriteItemConfigCache(cf, ic);
+	Cache_EndWrite(cf, ic != NULL);
+	return ic;
 } //end of the function LoadItemConfig
 //===========================================================================
 // index to find the weight function of an iteminfo
@@ -1286,6 +1364,80 @@ int BotGetSecondGoal(int goalstate, bot_goal_t *goal)
 	return qtrue;
 } //end of the function BotGetSecondGoal
 //===========================================================================
+// calculates the routes towards the level items and goals bots will most
+// likely look at this frame on the worker threads, the bots themselves
+// still think one after the other and find these routes cached
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void BotPrecalculateGoalRoutes(void)
+{
+	int i, numqueries, maxqueries, numitems, numbots;
+	levelitem_t *li;
+	bot_goalstate_t *gs;
+	aas_routequery_t *queries;
+
+	if (!AAS_Loaded()) return;
+	numbots = 0;
+	for (i = 1; i <= MAX_CLIENTS; i++)
+	{
+		if (botgoalstates[i] && botgoalstates[i]->lastreachabilityarea) numbots++;
+	} //end for
+	if (!numbots) return;
+	numitems = 0;
+	for (li = levelitems; li; li = li->next) numitems++;
+	maxqueries = numbots * (numitems + 1);
+	queries = (aas_routequery_t *) GetMemory(maxqueries * sizeof(aas_routequery_t));
+	numqueries = 0;
+	//
+	for (i = 1; i <= MAX_CLIENTS; i++)
+	{
+		gs = botgoalstates[i];
+		if (!gs || !gs->itemweightconfig) continue;
+		//the bot didn't choose an item yet
+		if (!gs->lastreachabilityarea) continue;
+		//the current goal
+		if (gs->goalstacktop > 0 && gs->goalstack[gs->goalstacktop].areanum)
+		{
+			queries[numqueries].areanum = gs->lastreachabilityarea;
+			queries[numqueries].goalareanum = gs->goalstack[gs->goalstacktop].areanum;
+			queries[numqueries].travelflags = gs->lasttravelflags;
+			numqueries++;
+		} //end if
+		//the items the bot evaluates when choosing a goal
+		for (li = levelitems; li; li = li->next)
+		{
+			if (g_gametype == GT_SINGLE_PLAYER) {
+				if (li->flags & IFL_NOTSINGLE)
+					continue;
+			}
+			else if (g_gametype >= GT_TEAM) {
+				if (li->flags & IFL_NOTTEAM)
+					continue;
+			}
+			else {
+				if (li->flags & IFL_NOTFREE)
+					continue;
+			}
+			if (li->flags & IFL_NOTBOT)
+				continue;
+			if (!li->goalareanum)
+				continue;
+			if (!li->entitynum && !(li->flags & IFL_ROAM))
+				continue;
+			queries[numqueries].areanum = gs->lastreachabilityarea;
+			queries[numqueries].goalareanum = li->goalareanum;
+			queries[numqueries].travelflags = gs->lasttravelflags;
+			numqueries++;
+		} //end for
+	} //end for
+	//
+	AAS_PrecalculateRoutes(queries, numqueries);
+	FreeMemory(queries);
+} //end of the function BotPrecalculateGoalRoutes
+//===========================================================================
 // pops a new long term goal on the goal stack in the goalstate
 //
 // Parameter:				-
@@ -1317,6 +1469,7 @@ int BotChooseLTGItem(int goalstate, vec3_t origin, int *inventory, int travelfla
 	} //end if
 	//remember the last area with reachabilities the bot was in
 	gs->lastreachabilityarea = areanum;
+	gs->lasttravelflags = travelflags;
 	//if still in solid
 	if (!areanum)
 		return qfalse;
@@ -1505,6 +1658,7 @@ int BotChooseNBGItem(int goalstate, vec3_t origin, int *inventory, int travelfla
 	} //end if
 	//remember the last area with reachabilities the bot was in
 	gs->lastreachabilityarea = areanum;
+	gs->lasttravelflags = travelflags;
 	//if still in solid
 	if (!areanum)
 		return qfalse;
@@ -37,6 +37,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "l_precomp.h"
 #include "l_struct.h"
 #include "l_libvar.h"
+#include "l_cache.h"
 #include "aasfile.h"
 #include "botlib.h"
 #include "be_aas.h"
@@ -48,6 +49,10 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define EVALUATERECURSIVELY
 
 #define MAX_WEIGHT_FILES			128
+//version of the compiled weight configs in the bot cache
+#define WEIGHTCACHE_VERSION			1
+//maximum switch depth in a compiled weight config
+#define MAX_WEIGHTCACHE_DEPTH		64
 weightconfig_t	*weightFileList[MAX_WEIGHT_FILES];
 
 //===========================================================================
@@ -116,29 +121,10 @@ int ReadFuzzyWeight(source_t *source, fuzzyseperator_t *fs)
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
-void FreeFuzzySeperators_r(fuzzyseperator_t *fs)
-{
-	if (!fs) return;
-	if (fs->child) FreeFuzzySeperators_r(fs->child);
-	if (fs->next) FreeFuzzySeperators_r(fs->next);
-	FreeMemory(fs);
-} //end of the function FreeFuzzySeperators
-//===========================================================================
-//
-// Parameter:			-
-// Returns:				-
-// Changes Globals:		-
-//===========================================================================
 void FreeWeightConfig2(weightconfig_t *config)
 {
-	int i;
-
-	for (i = 0; i < config->numweights; i++)
-	{
-		FreeFuzzySeperators_r(config->weights[i].firstseperator);
-		if (config->weights[i].name) FreeMemory(config->weights[i].name);
-	} //end for
-	FreeMemory(config);
+	//the config, the weight names and the fuzzy seperators are all in the arena
+	FreeMemoryArena(config->arena);
 } //end of the function FreeWeightConfig2
 //===========================================================================
 //
@@ -157,7 +143,7 @@ void FreeWeightConfig(weightconfig_t *config)
 // Returns:				-
 // Changes Globals:		-
 //===========================================================================
-fuzzyseperator_t *ReadFuzzySeperators_r(source_t *source)
+fuzzyseperator_t *ReadFuzzySeperators_r(source_t *source, memoryarena_t *arena)
 {
 	int newindent, index, def, founddefault;
 	token_t token;
@@ -177,7 +163,7 @@ fuzzyseperator_t *ReadFuzzySeperators_r(source_t *source)
 		def = !strcmp(token.string, "default");
 		if (def || !strcmp(token.string, "case"))
 		{
-			fs = (fuzzyseperator_t *) GetClearedMemory(sizeof(fuzzyseperator_t));
+			fs = (fuzzyseperator_t *) GetClearedArenaMemory(arena, sizeof(fuzzyseperator_t));
 			fs->index = index;
 			if (lastfs) lastfs->next = fs;
 			else firstfs = fs;
@@ -187,7 +173,6 @@ fuzzyseperator_t *ReadFuzzySeperators_r(source_t *source)
 				if (founddefault)
 				{
 					SourceError(source, "switch already has a default");
-					FreeFuzzySeperators_r(firstfs);
 					return NULL;
 				} //end if
 				fs->value = MAX_INVENTORYVALUE;
@@ -197,14 +182,12 @@ fuzzyseperator_t *ReadFuzzySeperators_r(source_t *source)
 			{
 				if (!PC_ExpectTokenType(source, TT_NUMBER, TT_INTEGER, &token))
 				{
-					FreeFuzzySeperators_r(firstfs);
 					return NULL;
 				} //end if
 				fs->value = token.intvalue;
 			} //end else
 			if (!PC_ExpectTokenString(source, ":") || !PC_ExpectAnyToken(source, &token))
 			{
-				FreeFuzzySeperators_r(firstfs);
 				return NULL;
 			} //end if
 			newindent = qfalse;
@@ -213,7 +196,6 @@ fuzzyseperator_t *ReadFuzzySeperators_r(source_t *source)
 				newindent = qtrue;
 				if (!PC_ExpectAnyToken(source, &token))
 				{
-					FreeFuzzySeperators_r(firstfs);
 					return NULL;
 				} //end if
 			} //end if
@@ -221,16 +203,14 @@ fuzzyseperator_t *ReadFuzzySeperators_r(source_t *source)
 			{
 				if (!ReadFuzzyWeight(source, fs))
 				{
-					FreeFuzzySeperators_r(firstfs);
 					return NULL;
 				} //end if
 			} //end if
 			else if (!strcmp(token.string, "switch"))
 			{
-				fs->child = ReadFuzzySeperators_r(source);
+				fs->child = ReadFuzzySeperators_r(source, arena);
 				if (!fs->child)
 				{
-					FreeFuzzySeperators_r(firstfs);
 					return NULL;
 				} //end if
 			} //end else if
@@ -243,20 +223,17 @@ fuzzyseperator_t *ReadFuzzySeperators_r(source_t *source)
 			{
 				if (!PC_ExpectTokenString(source, "}"))
 				{
-					FreeFuzzySeperators_r(firstfs);
 					return NULL;
 				} //end if
 			} //end if
 		} //end if
 		else
 		{
-			FreeFuzzySeperators_r(firstfs);
 			SourceError(source, "invalid name %s", token.string);
 			return NULL;
 		} //end else
 		if (!PC_ExpectAnyToken(source, &token))
 		{
-			FreeFuzzySeperators_r(firstfs);
 			return NULL;
 		} //end if
 	} while(strcmp(token.string, "}"));
@@ -264,7 +241,7 @@ fuzzyseperator_t *ReadFuzzySeperators_r(source_t *source)
 	if (!founddefault)
 	{
 		SourceWarning(source, "switch without default");
-		fs = (fuzzyseperator_t *) GetClearedMemory(sizeof(fuzzyseperator_t));
+		fs = (fuzzyseperator_t *) GetClearedArenaMemory(arena, sizeof(fuzzyseperator_t));
 		fs->index = index;
 		fs->value = MAX_INVENTORYVALUE;
 		fs->weight = 0;
@@ -282,46 +259,14 @@ fuzzyseperator_t *ReadFuzzySeperators_r(source_t *source)
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
-weightconfig_t *ReadWeightConfig(char *filename)
+weightconfig_t *ParseWeightConfig(char *filename)
 {
-	int newindent, avail = 0, n;
+	int newindent;
 	token_t token;
 	source_t *source;
 	fuzzyseperator_t *fs;
-	weightconfig_t *config = NULL;
-#ifdef DEBUG
-	int starttime;
-
-	starttime = Sys_MilliSeconds();
-#endif //DEBUG
-
-	if (!LibVarGetValue("bot_reloadcharacters"))
-	{
-		avail = -1;
-		for( n = 0; n < MAX_WEIGHT_FILES; n++ )
-		{
-			config = weightFileList[n];
-			if( !config )
-			{
-				if( avail == -1 )
-				{
-					avail = n;
-				} //end if
-				continue;
-			} //end if
-			if( strcmp( filename, config->filename ) == 0 )
-			{
-				//botimport.Print( PRT_MESSAGE, "retained %s\n", filename );
-				return config;
-			} //end if
-		} //end for
-
-		if( avail == -1 )
-		{
-			botimport.Print( PRT_ERROR, "weightFileList was full trying to load %s\n", filename );
-			return NULL;
-		} //end if
-	} //end if
+	weightconfig_t *config;
+	memoryarena_t *arena;
 
 	PC_SetBaseFolder(BOTFILESBASEFOLDER);
 	source = LoadSourceFile(filename);
@@ -331,7 +276,10 @@ weightconfig_t *ReadWeightConfig(char *filename)
 		return NULL;
 	} //end if
 	//
-	config = (weightconfig_t *) GetClearedMemory(sizeof(weightconfig_t));
+	//everything loaded from the file is freed at once
+	arena = GetMemoryArena("weights", 8192);
+	config = (weightconfig_t *) GetClearedArenaMemory(arena, sizeof(weightconfig_t));
+	config->arena = arena;
 	config->numweights = 0;
 	Q_strncpyz( config->filename, filename, sizeof(config->filename) );
 	//parse the item config file
@@ -351,8 +299,7 @@ weightconfig_t *ReadWeightConfig(char *filename)
 				return NULL;
 			} //end if
 			StripDoubleQuotes(token.string);
-			config->weights[config->numweights].name = (char *) GetClearedMemory(strlen(token.string) + 1);
-			strcpy(config->weights[config->numweights].name, token.string);
+			config->weights[config->numweights].name = CopyArenaString(config->arena, token.string);
 			if (!PC_ExpectAnyToken(source, &token))
 			{
 				FreeWeightConfig(config);
@@ -372,7 +319,7 @@ weightconfig_t *ReadWeightConfig(char *filename)
 			} //end if
 			if (!strcmp(token.string, "switch"))
 			{
-				fs = ReadFuzzySeperators_r(source);
+				fs = ReadFuzzySeperators_r(source, config->arena);
 				if (!fs)
 				{
 					FreeWeightConfig(config);
@@ -383,14 +330,13 @@ weightconfig_t *ReadWeightConfig(char *filename)
 			} //end if
 			else if (!strcmp(token.string, "return"))
 			{
-				fs = (fuzzyseperator_t *) GetClearedMemory(sizeof(fuzzyseperator_t));
+				fs = (fuzzyseperator_t *) GetClearedArenaMemory(arena, sizeof(fuzzyseperator_t));
 				fs->index = 0;
 				fs->value = MAX_INVENTORYVALUE;
 				fs->next = NULL;
 				fs->child = NULL;
 				if (!ReadFuzzyWeight(source, fs))
 				{
-					FreeMemory(fs);
 					FreeWeightConfig(config);
 					FreeSource(source);
 					return NULL;
@@ -425,6 +371,179 @@ weightconfig_t *ReadWeightConfig(char *filename)
 	} //end while
 	//free the source at the end of a pass
 	FreeSource(source);
+	return config;
+} //end of the function ParseWeightConfig
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void WriteFuzzySeperatorsCache_r(cachefile_t *cf, fuzzyseperator_t *fs)
+{
+	for (; fs; fs = fs->next)
+	{
+		Cache_WriteInt(cf, fs->index);
+		Cache_WriteInt(cf, fs->value);
+		Cache_WriteInt(cf, fs->type);
+		Cache_WriteFloat(cf, fs->weight);
+		Cache_WriteFloat(cf, fs->minweight);
+		Cache_WriteFloat(cf, fs->maxweight);
+		Cache_WriteInt(cf, fs->child != NULL);
+		if (fs->child) WriteFuzzySeperatorsCache_r(cf, fs->child);
+		Cache_WriteInt(cf, fs->next != NULL);
+	} //end for
+} //end of the function WriteFuzzySeperatorsCache_r
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void WriteWeightConfigCache(cachefile_t *cf, weightconfig_t *config)
+{
+	int i;
+
+	Cache_WriteInt(cf, config->numweights);
+	for (i = 0; i < config->numweights; i++)
+	{
+		Cache_WriteString(cf, config->weights[i].name);
+		Cache_WriteInt(cf, config->weights[i].firstseperator != NULL);
+		WriteFuzzySeperatorsCache_r(cf, config->weights[i].firstseperator);
+	} //end for
+} //end of the function WriteWeightConfigCache
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+fuzzyseperator_t *ReadFuzzySeperatorsCache_r(cachefile_t *cf, memoryarena_t *arena, int depth)
+{
+	fuzzyseperator_t *fs, *lastfs, *firstfs;
+
+	if (depth > MAX_WEIGHTCACHE_DEPTH)
+	{
+		cf->error = qtrue;
+		return NULL;
+	} //end if
+	firstfs = NULL;
+	lastfs = NULL;
+	do
+	{
+		fs = (fuzzyseperator_t *) GetClearedArenaMemory(arena, sizeof(fuzzyseperator_t));
+		fs->index = Cache_ReadInt(cf);
+		fs->value = Cache_ReadInt(cf);
+		fs->type = Cache_ReadInt(cf);
+		fs->weight = Cache_ReadFloat(cf);
+		fs->minweight = Cache_ReadFloat(cf);
+		fs->maxweight = Cache_ReadFloat(cf);
+		if (Cache_ReadInt(cf)) fs->child = ReadFuzzySeperatorsCache_r(cf, arena, depth + 1);
+		if (lastfs) lastfs->next = fs;
+		else firstfs = fs;
+		lastfs = fs;
+	} while(Cache_ReadInt(cf));
+	return firstfs;
+} //end of the function ReadFuzzySeperatorsCache_r
+//===========================================================================
+// returns the weight config from the bot cache or NULL if not cached
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+weightconfig_t *ReadWeightConfigCache(char *filename)
+{
+	int i;
+	cachefile_t *cf;
+	weightconfig_t *config;
+	memoryarena_t *arena;
+
+	cf = Cache_OpenRead(filename, "bwc", WEIGHTCACHE_VERSION);
+	if (!cf) return NULL;
+	arena = GetMemoryArena("weights", 8192);
+	config = (weightconfig_t *) GetClearedArenaMemory(arena, sizeof(weightconfig_t));
+	config->arena = arena;
+	Q_strncpyz(config->filename, filename, sizeof(config->filename));
+	config->numweights = Cache_ReadInt(cf);
+	if (config->numweights < 0 || config->numweights > MAX_WEIGHTS)
+	{
+		cf->error = qtrue;
+		config->numweights = 0;
+	} //end if
+	for (i = 0; i < config->numweights && !cf->error; i++)
+	{
+		config->weights[i].name = CopyArenaString(arena, Cache_ReadString(cf));
+		if (Cache_ReadInt(cf))
+		{
+			config->weights[i].firstseperator = ReadFuzzySeperatorsCache_r(cf, arena, 0);
+		} //end if
+	} //end for
+	if (cf->error)
+	{
+		botimport.Print(PRT_WARNING, "invalid bot cache for %s\n", filename);
+		Cache_Close(cf);
+		FreeWeightConfig2(config);
+		return NULL;
+	} //end if
+	Cache_Close(cf);
+	return config;
+} //end of the function ReadWeightConfigCache
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+weightconfig_t *ReadWeightConfig(char *filename)
+{
+	int avail = 0, n;
+	weightconfig_t *config = NULL;
+	cachefile_t *cf;
+#ifdef DEBUG
+	int starttime;
+
+	starttime = Sys_MilliSeconds();
+#endif //DEBUG
+
+	if (!LibVarGetValue("bot_reloadcharacters"))
+	{
+		avail = -1;
+		for( n = 0; n < MAX_WEIGHT_FILES; n++ )
+		{
+			config = weightFileList[n];
+			if( !config )
+			{
+				if( avail == -1 )
+				{
+					avail = n;
+				} //end if
+				continue;
+			} //end if
+			if( strcmp( filename, config->filename ) == 0 )
+			{
+				//botimport.Print( PRT_MESSAGE, "retained %s\n", filename );
+				return config;
+			} //end if
+		} //end for
+
+		if( avail == -1 )
+		{
+			botimport.Print( PRT_ERROR, "weightFileList was full trying to load %s\n", filename );
+			return NULL;
+		} //end if
+	} //end if
+
+	//use the compiled weight config if the source files didn't change
+	config = ReadWeightConfigCache(filename);
+	if (!config)
+	{
+		cf = Cache_BeginWrite(filename, "bwc", WEIGHTCACHE_VERSION);
+		config = ParseWeightConfig(filename);
+		if (config) WriteWeightConfigCache(cf, config);
+		Cache_EndWrite(cf, config != NULL);
+		if (!config) return NULL;
+	} //end if
 	//if the file was located in a pak file
 	botimport.Print(PRT_MESSAGE, "loaded %s\n", filename);
 #ifdef DEBUG
@@ -58,6 +58,7 @@ typedef struct weightconfig_s
 	int numweights;
 	weight_t weights[MAX_WEIGHTS];
 	char		filename[MAX_QPATH];
+	struct memoryarena_s *arena;	//memory of the config
 } weightconfig_t;
 
 //reads a weight configuration
@@ -197,6 +197,7 @@ int Export_BotLibShutdown(void)
 	LibVarDeAllocAll();
 	//remove all global defines from the pre compiler
 	PC_RemoveAllGlobalDefines();
+	PC_ShutdownTokenHeap();
 
 	//dump all allocated memory
 //	DumpMemory();
@@ -247,8 +248,14 @@ int Export_BotLibVarGet(const char *var_name, char *value, int size)
 //===========================================================================
 int Export_BotLibStartFrame(float time)
 {
+	int errnum;
+
 	if (!BotLibSetup("BotStartFrame")) return BLERR_LIBRARYNOTSETUP;
-	return AAS_StartFrame(time);
+	errnum = AAS_StartFrame(time);
+	if (errnum != BLERR_NOERROR) return errnum;
+	//calculate the routes the bots will likely need on the worker threads
+	BotPrecalculateGoalRoutes();
+	return BLERR_NOERROR;
 } //end of the function Export_BotLibStartFrame
 //===========================================================================
 //
@@ -44,6 +44,8 @@ struct bot_initmove_s;
 struct weaponinfo_s;
 
 #define BOTFILESBASEFOLDER		"botfiles"
+//maximum number of worker threads used by the bot library
+#define BOTLIB_MAX_THREADS		8
 //debug line colors
 #define LINECOLOR_NONE			-1
 #define LINECOLOR_RED			1//0xf2f2f0f0L
@@ -225,6 +227,17 @@ typedef struct botlib_import_s
 	//
 	int			(*DebugPolygonCreate)(int color, int numPoints, vec3_t *points);
 	void		(*DebugPolygonDelete)(int id);
+	//worker threads
+	void		*(*MutexCreate)(void);
+	void		(*MutexDestroy)(void *mutex);
+	void		(*MutexLock)(void *mutex);
+	void		(*MutexUnlock)(void *mutex);
+	//calls function for every index below count spread over the worker threads, and returns
+	//when all calls are finished; thread is below BOTLIB_MAX_THREADS and unique among the
+	//calls running at the same time; returns qfalse without calling anything if threads are disabled
+	int			(*RunJobs)(void (*function)(int index, int thread, void *arg), void *arg, int count);
+	//high resolution time in microseconds for profiling
+	int64_t		(*Microseconds)(void);
 } botlib_import_t;
 
 typedef struct aas_export_s
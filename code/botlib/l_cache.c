@@ -0,0 +1,402 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+/*****************************************************************************
+ * name:		l_cache.c
+ *
+ * desc:		compiled bot file cache
+ *
+ * $Archive: /source/code/botlib/l_cache.c $
+ *
+ *****************************************************************************/
+
+//Notes:		bot characters, chats, weights and item configs are stored
+//				in binary form in botcache/ after they've been parsed once.
+//				Every script file read while compiling (including #include
+//				files and files that failed to open) is stored with its
+//				length and MD4 block checksum, the cache is only used if all
+//				of them are unchanged and the global defines are the same.
+
+#include "../qcommon/q_shared.h"
+#include "../qcommon/qcommon.h"
+#include "botlib.h"
+#include "be_interface.h"
+#include "l_memory.h"
+#include "l_libvar.h"
+#include "l_script.h"
+#include "l_precomp.h"
+#include "l_cache.h"
+
+#define CACHE_IDENT			(('C'<<24)+('T'<<16)+('O'<<8)+'B')	//BOTC
+#define CACHE_VERSION		2
+
+//header of a cache file, followed by the dependencies and the data
+typedef struct cacheheader_s
+{
+	int ident;
+	int version;				//CACHE_VERSION
+	int typeversion;			//version of the cached structures
+	int definescrc;				//crc of the global defines
+	int numdependencies;		//number of script files
+	int datasize;				//size of the cached data
+} cacheheader_t;
+
+//stack with caches being compiled
+cachefile_t *cacherecording;
+
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static void Cache_FileName(char *name, char *extension, char *filename, int size)
+{
+	Com_sprintf(filename, size, "botcache/%s.%s", name, extension);
+} //end of the function Cache_FileName
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+cachefile_t *Cache_BeginWrite(char *name, char *extension, int version)
+{
+	cachefile_t *cf;
+
+	if (!LibVarValue("bot_cachefiles", "1")) return NULL;
+	cf = (cachefile_t *) GetClearedMemory(sizeof(cachefile_t));
+	Cache_FileName(name, extension, cf->filename, sizeof(cf->filename));
+	cf->version = version;
+	//record the script files loaded from now on
+	cf->prev = cacherecording;
+	cacherecording = cf;
+	return cf;
+} //end of the function Cache_BeginWrite
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void Cache_EndWrite(cachefile_t *cf, int success)
+{
+	cachefile_t **prev;
+	cacheheader_t header;
+	fileHandle_t fp;
+
+	if (!cf) return;
+	//stop recording script files
+	for (prev = &cacherecording; *prev; prev = &(*prev)->prev)
+	{
+		if (*prev == cf)
+		{
+			*prev = cf->prev;
+			break;
+		} //end if
+	} //end for
+	//
+	if (success && !cf->error)
+	{
+		botimport.FS_FOpenFile(cf->filename, &fp, FS_WRITE);
+		if (fp)
+		{
+			header.ident = CACHE_IDENT;
+			header.version = CACHE_VERSION;
+			header.typeversion = cf->version;
+			header.definescrc = PC_GlobalDefinesCRC();
+			header.numdependencies = cf->numdependencies;
+			header.datasize = cf->size;
+			botimport.FS_Write(&header, sizeof(cacheheader_t), fp);
+			botimport.FS_Write(cf->dependencies, cf->numdependencies * sizeof(cachedependency_t), fp);
+			if (cf->size) botimport.FS_Write(cf->buffer, cf->size, fp);
+			botimport.FS_FCloseFile(fp);
+			if (botDeveloper)
+			{
+				botimport.Print(PRT_MESSAGE, "wrote %s\n", cf->filename);
+			} //end if
+		} //end if
+	} //end if
+	if (cf->buffer) FreeMemory(cf->buffer);
+	FreeMemory(cf);
+} //end of the function Cache_EndWrite
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void Cache_WriteData(cachefile_t *cf, void *data, int size)
+{
+	char *buffer;
+	int maxsize;
+
+	if (!cf || cf->error) return;
+	if (cf->size + size > cf->maxsize)
+	{
+		maxsize = cf->maxsize * 2;
+		if (maxsize < 4096) maxsize = 4096;
+		if (maxsize < cf->size + size) maxsize = cf->size + size;
+		buffer = (char *) GetMemory(maxsize);
+		if (cf->buffer)
+		{
+			Com_Memcpy(buffer, cf->buffer, cf->size);
+			FreeMemory(cf->buffer);
+		} //end if
+		cf->buffer = buffer;
+		cf->maxsize = maxsize;
+	} //end if
+	Com_Memcpy(cf->buffer + cf->size, data, size);
+	cf->size += size;
+} //end of the function Cache_WriteData
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void Cache_WriteInt(cachefile_t *cf, int value)
+{
+	Cache_WriteData(cf, &value, sizeof(int));
+} //end of the function Cache_WriteInt
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void Cache_WriteFloat(cachefile_t *cf, float value)
+{
+	Cache_WriteData(cf, &value, sizeof(float));
+} //end of the function Cache_WriteFloat
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void Cache_WriteString(cachefile_t *cf, char *string)
+{
+	int length;
+
+	length = strlen(string) + 1;
+	Cache_WriteInt(cf, length);
+	Cache_WriteData(cf, string, length);
+} //end of the function Cache_WriteString
+//===========================================================================
+// returns true if the script file didn't change since the cache was written
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static int Cache_DependencyValid(cachedependency_t *dep)
+{
+	fileHandle_t fp;
+	int length, valid;
+	char *buffer;
+
+	length = botimport.FS_FOpenFile(dep->filename, &fp, FS_READ);
+	if (!fp) return dep->length < 0;
+	valid = (length == dep->length);
+	if (valid)
+	{
+		buffer = (char *) GetMemory(length + 1);
+		botimport.FS_Read(buffer, length, fp);
+		valid = (Com_BlockChecksum(buffer, length) == dep->checksum);
+		FreeMemory(buffer);
+	} //end if
+	botimport.FS_FCloseFile(fp);
+	return valid;
+} //end of the function Cache_DependencyValid
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+cachefile_t *Cache_OpenRead(char *name, char *extension, int version)
+{
+	char filename[MAX_QPATH];
+	cacheheader_t header;
+	fileHandle_t fp;
+	cachefile_t *cf;
+	int length, i;
+
+	if (!LibVarValue("bot_cachefiles", "1")) return NULL;
+	Cache_FileName(name, extension, filename, sizeof(filename));
+	length = botimport.FS_FOpenFile(filename, &fp, FS_READ);
+	if (!fp) return NULL;
+	if (length < (int) sizeof(cacheheader_t))
+	{
+		botimport.FS_FCloseFile(fp);
+		return NULL;
+	} //end if
+	botimport.FS_Read(&header, sizeof(cacheheader_t), fp);
+	if (header.ident != CACHE_IDENT ||
+		header.version != CACHE_VERSION ||
+		header.typeversion != version ||
+		header.definescrc != PC_GlobalDefinesCRC() ||
+		header.numdependencies < 0 || header.numdependencies > MAX_CACHEDEPENDENCIES ||
+		header.datasize < 0 ||
+		length != (int) (sizeof(cacheheader_t) + header.numdependencies * sizeof(cachedependency_t)) + header.datasize)
+	{
+		botimport.FS_FCloseFile(fp);
+		return NULL;
+	} //end if
+	//the data is stored directly after the cache
+	cf = (cachefile_t *) GetClearedMemory(sizeof(cachefile_t) + header.datasize + 1);
+	Q_strncpyz(cf->filename, filename, sizeof(cf->filename));
+	cf->version = version;
+	cf->buffer = (char *) cf + sizeof(cachefile_t);
+	cf->size = header.datasize;
+	cf->maxsize = header.datasize;
+	cf->numdependencies = header.numdependencies;
+	botimport.FS_Read(cf->dependencies, cf->numdependencies * sizeof(cachedependency_t), fp);
+	if (cf->size) botimport.FS_Read(cf->buffer, cf->size, fp);
+	botimport.FS_FCloseFile(fp);
+	//the cache is outdated if any of the script files changed
+	for (i = 0; i < cf->numdependencies; i++)
+	{
+		cf->dependencies[i].filename[MAX_QPATH-1] = '\0';
+		if (!Cache_DependencyValid(&cf->dependencies[i]))
+		{
+			if (botDeveloper)
+			{
+				botimport.Print(PRT_MESSAGE, "%s changed, recompiling %s\n", cf->dependencies[i].filename, filename);
+			} //end if
+			FreeMemory(cf);
+			return NULL;
+		} //end if
+	} //end for
+	return cf;
+} //end of the function Cache_OpenRead
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void Cache_ReadData(cachefile_t *cf, void *data, int size)
+{
+	if (cf->error || size < 0 || size > cf->size - cf->offset)
+	{
+		cf->error = qtrue;
+		Com_Memset(data, 0, size > 0 ? size : 0);
+		return;
+	} //end if
+	Com_Memcpy(data, cf->buffer + cf->offset, size);
+	cf->offset += size;
+} //end of the function Cache_ReadData
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int Cache_ReadInt(cachefile_t *cf)
+{
+	int value;
+
+	Cache_ReadData(cf, &value, sizeof(int));
+	return value;
+} //end of the function Cache_ReadInt
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+float Cache_ReadFloat(cachefile_t *cf)
+{
+	float value;
+
+	Cache_ReadData(cf, &value, sizeof(float));
+	return value;
+} //end of the function Cache_ReadFloat
+//===========================================================================
+// returns a pointer in the cache buffer, valid until the cache is closed
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+char *Cache_ReadString(cachefile_t *cf)
+{
+	int length;
+	char *string;
+
+	length = Cache_ReadInt(cf);
+	if (cf->error || length <= 0 || length > cf->size - cf->offset ||
+		cf->buffer[cf->offset + length - 1] != '\0')
+	{
+		cf->error = qtrue;
+		return "";
+	} //end if
+	string = cf->buffer + cf->offset;
+	cf->offset += length;
+	return string;
+} //end of the function Cache_ReadString
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void Cache_Close(cachefile_t *cf)
+{
+	if (!cf) return;
+	FreeMemory(cf);
+} //end of the function Cache_Close
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void Cache_AddDependency(const char *filename, char *buffer, int length)
+{
+	cachefile_t *cf;
+	cachedependency_t *dep;
+	int i;
+
+	for (cf = cacherecording; cf; cf = cf->prev)
+	{
+		for (i = 0; i < cf->numdependencies; i++)
+		{
+			if (!Q_stricmp(cf->dependencies[i].filename, filename)) break;
+		} //end for
+		if (i < cf->numdependencies) continue;
+		//don't write a cache that can't be validated
+		if (cf->numdependencies >= MAX_CACHEDEPENDENCIES ||
+				strlen(filename) >= MAX_QPATH)
+		{
+			cf->error = qtrue;
+			continue;
+		} //end if
+		dep = &cf->dependencies[cf->numdependencies++];
+		Com_Memset(dep, 0, sizeof(cachedependency_t));
+		Q_strncpyz(dep->filename, filename, sizeof(dep->filename));
+		dep->length = length;
+		if (length >= 0) dep->checksum = Com_BlockChecksum(buffer, length);
+	} //end for
+} //end of the function Cache_AddDependency
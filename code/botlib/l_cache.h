@@ -0,0 +1,79 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+/*****************************************************************************
+ * name:		l_cache.h
+ *
+ * desc:		compiled bot file cache
+ *
+ * $Archive: /source/code/botlib/l_cache.h $
+ *
+ *****************************************************************************/
+
+#define MAX_CACHEDEPENDENCIES		16
+
+//script file a cache was compiled from
+typedef struct cachedependency_s
+{
+	char filename[MAX_QPATH];		//path of the script file
+	int length;						//length of the file, -1 if it didn't exist
+	unsigned int checksum;			//MD4 block checksum of the file contents
+} cachedependency_t;
+
+//compiled bot file cache
+typedef struct cachefile_s
+{
+	char filename[MAX_QPATH];		//name of the cache file
+	int version;					//version of the cached structures
+	char *buffer;					//cached data
+	int size;						//size of the cached data
+	int maxsize;					//allocated size of the buffer
+	int offset;						//read offset in the buffer
+	int error;						//true if reading or writing failed
+	int numdependencies;			//number of script files loaded
+	cachedependency_t dependencies[MAX_CACHEDEPENDENCIES];
+	struct cachefile_s *prev;		//previous cache recording script files
+} cachefile_t;
+
+//start compiling a bot file into a cache, every script file loaded
+//before Cache_EndWrite becomes a dependency of the cache
+//returns NULL if caching is disabled
+cachefile_t *Cache_BeginWrite(char *name, char *extension, int version);
+//stop compiling, write the cache file if successful and free the cache
+void Cache_EndWrite(cachefile_t *cf, int success);
+//write data to the cache, the cache may be NULL
+void Cache_WriteInt(cachefile_t *cf, int value);
+void Cache_WriteFloat(cachefile_t *cf, float value);
+void Cache_WriteString(cachefile_t *cf, char *string);
+void Cache_WriteData(cachefile_t *cf, void *data, int size);
+//open the cache of a bot file, returns NULL if there's no cache or
+//one of the script files it was compiled from changed
+cachefile_t *Cache_OpenRead(char *name, char *extension, int version);
+//read data from the cache, sets cf->error when reading past the end
+int Cache_ReadInt(cachefile_t *cf);
+float Cache_ReadFloat(cachefile_t *cf);
+char *Cache_ReadString(cachefile_t *cf);
+void Cache_ReadData(cachefile_t *cf, void *data, int size);
+//close a cache opened for reading
+void Cache_Close(cachefile_t *cf);
+//add a loaded script file to the caches being compiled
+void Cache_AddDependency(const char *filename, char *buffer, int length);
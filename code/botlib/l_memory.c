@@ -280,6 +280,7 @@ void PrintUsedMemorySize(void)
 	botimport.Print(PRT_MESSAGE, "total allocated memory: %d KB\n", allocatedmemory >> 10);
 	botimport.Print(PRT_MESSAGE, "total botlib memory: %d KB\n", totalmemorysize >> 10);
 	botimport.Print(PRT_MESSAGE, "total memory blocks: %d\n", numblocks);
+	PrintMemoryPools();
 } //end of the function PrintUsedMemorySize
 //===========================================================================
 //
@@ -310,6 +311,7 @@ void PrintMemoryLabels(void)
 #endif //MEMDEBUG
 		i++;
 	} //end for
+	LogMemoryPools();
 } //end of the function PrintMemoryLabels
 //===========================================================================
 //
@@ -370,7 +372,7 @@ void *GetClearedMemory(unsigned long size)
 #else
 	ptr = GetMemory(size);
 #endif //MEMDEBUG
-	Com_Memset(ptr, 0, size);
+	if (ptr) Com_Memset(ptr, 0, size);
 	return ptr;
 } //end of the function GetClearedMemory
 //===========================================================================
@@ -450,6 +452,7 @@ int AvailableMemory(void)
 //===========================================================================
 void PrintUsedMemorySize(void)
 {
+	PrintMemoryPools();
 } //end of the function PrintUsedMemorySize
 //===========================================================================
 //
@@ -459,6 +462,471 @@ void PrintUsedMemorySize(void)
 //===========================================================================
 void PrintMemoryLabels(void)
 {
+	PrintMemoryPools();
+	Log_Write("============= Botlib memory log ==============\r\n");
+	Log_Write("\r\n");
+	LogMemoryPools();
 } //end of the function PrintMemoryLabels
 
 #endif
+
+//the header of every pool block points to the slab the block belongs to
+#define POOLBLOCK_HEADER	sizeof(memoryslab_t *)
+//size of slabs without the slab header
+#define POOLSLAB_SIZE(pool)	((pool)->blockstride * (pool)->blocksperslab)
+//memory handed out by arenas is aligned to this size
+#define ARENA_ALIGN			8
+
+memorypool_t *memorypools;
+memoryarena_t *memoryarenas;
+
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static int64_t MemoryTime(void)
+{
+	if (!botimport.Microseconds) return 0;
+	return botimport.Microseconds();
+} //end of the function MemoryTime
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+memorypool_t *GetMemoryPool(char *name, int blocksize, int blocksperslab)
+{
+	memorypool_t *pool;
+
+	pool = (memorypool_t *) GetClearedMemory(sizeof(memorypool_t));
+	if (!pool) return NULL;
+	pool->name = name;
+	pool->blocksize = blocksize;
+	pool->blockstride = (POOLBLOCK_HEADER + blocksize + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+	pool->blocksperslab = blocksperslab > 0 ? blocksperslab : 1;
+	pool->next = memorypools;
+	memorypools = pool;
+	return pool;
+} //end of the function GetMemoryPool
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static void LinkMemorySlab(memorypool_t *pool, memoryslab_t *slab)
+{
+	slab->prev = NULL;
+	slab->next = pool->slabs;
+	if (pool->slabs) pool->slabs->prev = slab;
+	pool->slabs = slab;
+} //end of the function LinkMemorySlab
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static void UnlinkMemorySlab(memorypool_t *pool, memoryslab_t *slab)
+{
+	if (slab->prev) slab->prev->next = slab->next;
+	else pool->slabs = slab->next;
+	if (slab->next) slab->next->prev = slab->prev;
+	slab->prev = NULL;
+	slab->next = NULL;
+} //end of the function UnlinkMemorySlab
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static memoryslab_t *AllocMemorySlab(memorypool_t *pool)
+{
+	memoryslab_t *slab;
+	char *block;
+	int i;
+	int64_t starttime;
+
+	starttime = MemoryTime();
+	slab = (memoryslab_t *) GetMemory(sizeof(memoryslab_t) + POOLSLAB_SIZE(pool));
+	pool->slabtime += MemoryTime() - starttime;
+	if (!slab) return NULL;
+	slab->pool = pool;
+	slab->numfree = pool->blocksperslab;
+	slab->freeblocks = NULL;
+	//put all blocks in the free list, the first block at the start of the list
+	block = (char *) slab + sizeof(memoryslab_t) + POOLSLAB_SIZE(pool);
+	for (i = 0; i < pool->blocksperslab; i++)
+	{
+		block -= pool->blockstride;
+		*(memoryslab_t **) block = slab;
+		*(void **) (block + POOLBLOCK_HEADER) = slab->freeblocks;
+		slab->freeblocks = block + POOLBLOCK_HEADER;
+	} //end for
+	pool->numslabs++;
+	return slab;
+} //end of the function AllocMemorySlab
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static void FreeMemorySlab(memorypool_t *pool, memoryslab_t *slab)
+{
+	pool->numslabs--;
+	FreeMemory(slab);
+} //end of the function FreeMemorySlab
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void *GetPoolMemory(memorypool_t *pool)
+{
+	memoryslab_t *slab;
+	void *ptr;
+
+	slab = pool->slabs;
+	if (!slab)
+	{
+		slab = pool->emptyslab;
+		pool->emptyslab = NULL;
+		if (!slab) slab = AllocMemorySlab(pool);
+		if (!slab) return NULL;
+		LinkMemorySlab(pool, slab);
+	} //end if
+	ptr = slab->freeblocks;
+	slab->freeblocks = *(void **) ptr;
+	//remove full slabs from the list with slabs that have free blocks
+	if (--slab->numfree <= 0) UnlinkMemorySlab(pool, slab);
+	//
+	pool->numallocs++;
+	if (++pool->numblocks > pool->maxblocks) pool->maxblocks = pool->numblocks;
+	return ptr;
+} //end of the function GetPoolMemory
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void *GetClearedPoolMemory(memorypool_t *pool)
+{
+	void *ptr;
+
+	ptr = GetPoolMemory(pool);
+	if (ptr) Com_Memset(ptr, 0, pool->blocksize);
+	return ptr;
+} //end of the function GetClearedPoolMemory
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void FreePoolMemory(void *ptr)
+{
+	memoryslab_t *slab;
+	memorypool_t *pool;
+
+	if (!ptr) return;
+	slab = *(memoryslab_t **) ((char *) ptr - POOLBLOCK_HEADER);
+	pool = slab->pool;
+	//
+	*(void **) ptr = slab->freeblocks;
+	slab->freeblocks = ptr;
+	if (slab->numfree++ <= 0) LinkMemorySlab(pool, slab);
+	//
+	pool->numfrees++;
+	pool->numblocks--;
+	//give slabs without used blocks back, except for one to avoid thrashing
+	if (slab->numfree >= pool->blocksperslab)
+	{
+		UnlinkMemorySlab(pool, slab);
+		if (pool->emptyslab) FreeMemorySlab(pool, pool->emptyslab);
+		pool->emptyslab = slab;
+	} //end if
+} //end of the function FreePoolMemory
+//===========================================================================
+// returns the slab the pool block was allocated from
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+memoryslab_t *PoolMemorySlab(void *ptr)
+{
+	return *(memoryslab_t **) ((char *) ptr - POOLBLOCK_HEADER);
+} //end of the function PoolMemorySlab
+//===========================================================================
+// gives the cached slab without used blocks back
+//
+// Parameter:			-
+// Returns:				number of bytes released
+// Changes Globals:		-
+//===========================================================================
+int TrimMemoryPool(memorypool_t *pool)
+{
+	if (!pool->emptyslab) return 0;
+	FreeMemorySlab(pool, pool->emptyslab);
+	pool->emptyslab = NULL;
+	return sizeof(memoryslab_t) + POOLSLAB_SIZE(pool);
+} //end of the function TrimMemoryPool
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void FreeMemoryPool(memorypool_t *pool)
+{
+	memorypool_t **p;
+	memoryslab_t *slab, *nextslab;
+
+	if (!pool) return;
+	if (pool->numblocks)
+	{
+		botimport.Print(PRT_WARNING, "memory pool %s freed with %d blocks in use\n", pool->name, pool->numblocks);
+	} //end if
+	//blocks still in use are in full slabs which are in no list
+	for (slab = pool->slabs; slab; slab = nextslab)
+	{
+		nextslab = slab->next;
+		FreeMemorySlab(pool, slab);
+	} //end for
+	if (pool->emptyslab) FreeMemorySlab(pool, pool->emptyslab);
+	//
+	for (p = &memorypools; *p; p = &(*p)->next)
+	{
+		if (*p == pool)
+		{
+			*p = pool->next;
+			break;
+		} //end if
+	} //end for
+	FreeMemory(pool);
+} //end of the function FreeMemoryPool
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+memoryarena_t *GetMemoryArena(char *name, int blocksize)
+{
+	memoryarena_t *arena;
+
+	arena = (memoryarena_t *) GetClearedMemory(sizeof(memoryarena_t));
+	if (!arena) return NULL;
+	arena->name = name;
+	arena->blocksize = blocksize;
+	arena->prev = NULL;
+	arena->next = memoryarenas;
+	if (memoryarenas) memoryarenas->prev = arena;
+	memoryarenas = arena;
+	return arena;
+} //end of the function GetMemoryArena
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void *GetArenaMemory(memoryarena_t *arena, unsigned long size)
+{
+	memoryarenablock_t *block;
+	int blocksize;
+	int64_t starttime;
+	void *ptr;
+
+	size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+	block = arena->blocks;
+	if (!block || block->used + size > block->size)
+	{
+		blocksize = size > arena->blocksize ? size : arena->blocksize;
+		starttime = MemoryTime();
+		block = (memoryarenablock_t *) GetMemory(sizeof(memoryarenablock_t) + blocksize);
+		arena->blocktime += MemoryTime() - starttime;
+		if (!block) return NULL;
+		block->size = blocksize;
+		block->used = 0;
+		//keep allocating from the current block when a large allocation gets its own block
+		if (arena->blocks && blocksize > arena->blocksize)
+		{
+			block->next = arena->blocks->next;
+			arena->blocks->next = block;
+		} //end if
+		else
+		{
+			block->next = arena->blocks;
+			arena->blocks = block;
+		} //end else
+		arena->numblocks++;
+		arena->reserved += blocksize;
+	} //end if
+	ptr = (char *) block + sizeof(memoryarenablock_t) + block->used;
+	block->used += size;
+	arena->used += size;
+	arena->numallocs++;
+	return ptr;
+} //end of the function GetArenaMemory
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void *GetClearedArenaMemory(memoryarena_t *arena, unsigned long size)
+{
+	void *ptr;
+
+	ptr = GetArenaMemory(arena, size);
+	if (ptr) Com_Memset(ptr, 0, size);
+	return ptr;
+} //end of the function GetClearedArenaMemory
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+char *CopyArenaString(memoryarena_t *arena, const char *string)
+{
+	char *ptr;
+	int size;
+
+	size = strlen(string) + 1;
+	ptr = (char *) GetArenaMemory(arena, size);
+	if (ptr) Com_Memcpy(ptr, string, size);
+	return ptr;
+} //end of the function CopyArenaString
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void FreeMemoryArena(memoryarena_t *arena)
+{
+	memoryarenablock_t *block, *nextblock;
+
+	if (!arena) return;
+	for (block = arena->blocks; block; block = nextblock)
+	{
+		nextblock = block->next;
+		FreeMemory(block);
+	} //end for
+	if (arena->prev) arena->prev->next = arena->next;
+	else memoryarenas = arena->next;
+	if (arena->next) arena->next->prev = arena->prev;
+	FreeMemory(arena);
+} //end of the function FreeMemoryArena
+//===========================================================================
+// fragmentation is the part of the reserved memory that isn't in use
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static int MemoryFragmentation(int used, int reserved)
+{
+	if (reserved <= 0) return 0;
+	return 100 - (int) ((float) used * 100 / reserved);
+} //end of the function MemoryFragmentation
+//===========================================================================
+// pools and arenas with the same name are summed up
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void PrintMemoryPools(void)
+{
+	memorypool_t *pool, *p;
+	memoryarena_t *arena, *a;
+	int numpools, numslabs, numblocks, numallocs, used, reserved;
+	int64_t time;
+
+	for (pool = memorypools; pool; pool = pool->next)
+	{
+		//only print the first pool with the name
+		for (p = memorypools; p != pool; p = p->next)
+		{
+			if (!strcmp(p->name, pool->name)) break;
+		} //end for
+		if (p != pool) continue;
+		numpools = numslabs = numblocks = numallocs = used = reserved = 0;
+		time = 0;
+		for (p = pool; p; p = p->next)
+		{
+			if (strcmp(p->name, pool->name)) continue;
+			numpools++;
+			numslabs += p->numslabs;
+			numblocks += p->numblocks;
+			numallocs += p->numallocs;
+			used += p->numblocks * p->blocksize;
+			reserved += p->numslabs * (sizeof(memoryslab_t) + POOLSLAB_SIZE(p));
+			time += p->slabtime;
+		} //end for
+		botimport.Print(PRT_MESSAGE, "pool %-16s %3d pools %5d slabs %7d blocks %6d KB %3d%% unused %8d allocs %6d msec\n",
+							pool->name, numpools, numslabs, numblocks, reserved >> 10,
+							MemoryFragmentation(used, reserved), numallocs, (int) (time / 1000));
+	} //end for
+	for (arena = memoryarenas; arena; arena = arena->next)
+	{
+		for (a = memoryarenas; a != arena; a = a->next)
+		{
+			if (!strcmp(a->name, arena->name)) break;
+		} //end for
+		if (a != arena) continue;
+		numpools = numblocks = numallocs = used = reserved = 0;
+		time = 0;
+		for (a = arena; a; a = a->next)
+		{
+			if (strcmp(a->name, arena->name)) continue;
+			numpools++;
+			numblocks += a->numblocks;
+			numallocs += a->numallocs;
+			used += a->used;
+			reserved += a->reserved;
+			time += a->blocktime;
+		} //end for
+		botimport.Print(PRT_MESSAGE, "arena %-15s %3d arenas %4d blocks %6d KB %3d%% unused %8d allocs %6d msec\n",
+							arena->name, numpools, numblocks, reserved >> 10,
+							MemoryFragmentation(used, reserved), numallocs, (int) (time / 1000));
+	} //end for
+} //end of the function PrintMemoryPools
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void LogMemoryPools(void)
+{
+	memorypool_t *pool;
+	memoryarena_t *arena;
+	int reserved;
+
+	for (pool = memorypools; pool; pool = pool->next)
+	{
+		reserved = pool->numslabs * (sizeof(memoryslab_t) + POOLSLAB_SIZE(pool));
+		Log_Write("pool %-16s block %6d, slabs %5d, blocks %7d (peak %7d), %8d bytes, %3d%% unused, %8d allocs, %8d frees, %8d usec\r\n",
+					pool->name, pool->blocksize, pool->numslabs, pool->numblocks, pool->maxblocks, reserved,
+					MemoryFragmentation(pool->numblocks * pool->blocksize, reserved),
+					pool->numallocs, pool->numfrees, (int) pool->slabtime);
+	} //end for
+	for (arena = memoryarenas; arena; arena = arena->next)
+	{
+		Log_Write("arena %-15s blocks %4d, %8d bytes, %3d%% unused, %8d allocs, %8d usec\r\n",
+					arena->name, arena->numblocks, arena->reserved,
+					MemoryFragmentation(arena->used, arena->reserved),
+					arena->numallocs, (int) arena->blocktime);
+	} //end for
+} //end of the function LogMemoryPools
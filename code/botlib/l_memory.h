@@ -74,3 +74,81 @@ void PrintMemoryLabels(void);
 int MemoryByteSize(void *ptr);
 //free all allocated memory
 void DumpMemory(void);
+
+//memory pool slab with fixed size blocks
+typedef struct memoryslab_s
+{
+	struct memorypool_s *pool;
+	int numfree;						//number of free blocks in the slab
+	void *freeblocks;					//list with free blocks
+	struct memoryslab_s *prev, *next;	//slabs with free blocks
+} memoryslab_t;
+
+//memory pool handing out fixed size blocks from slabs
+typedef struct memorypool_s
+{
+	char *name;
+	int blocksize;						//size of the blocks handed out
+	int blockstride;					//size of a block in a slab including header
+	int blocksperslab;
+	memoryslab_t *slabs;				//slabs with free blocks
+	memoryslab_t *emptyslab;			//cached slab without used blocks
+	int numslabs;
+	int numblocks;						//number of blocks in use
+	int maxblocks;						//peak number of blocks in use
+	int numallocs;
+	int numfrees;
+	int64_t slabtime;					//microseconds spent allocating slabs
+	struct memorypool_s *next;
+} memorypool_t;
+
+//memory arena block
+typedef struct memoryarenablock_s
+{
+	int size;
+	int used;
+	struct memoryarenablock_s *next;
+} memoryarenablock_t;
+
+//memory arena handing out memory that is only freed all at once
+typedef struct memoryarena_s
+{
+	char *name;
+	int blocksize;						//minimum size of the blocks
+	memoryarenablock_t *blocks;			//current block first
+	int numblocks;
+	int reserved;						//size of all blocks
+	int used;							//memory handed out
+	int numallocs;
+	int64_t blocktime;					//microseconds spent allocating blocks
+	struct memoryarena_s *prev, *next;
+} memoryarena_t;
+
+//creates a memory pool for blocks of the given size
+memorypool_t *GetMemoryPool(char *name, int blocksize, int blocksperslab);
+//allocate a block from the memory pool
+void *GetPoolMemory(memorypool_t *pool);
+//allocate a block from the memory pool and clear it
+void *GetClearedPoolMemory(memorypool_t *pool);
+//return a block to the memory pool it was allocated from
+void FreePoolMemory(void *ptr);
+//returns the slab the pool block was allocated from
+memoryslab_t *PoolMemorySlab(void *ptr);
+//give the cached slab without used blocks back, returns the number of bytes released
+int TrimMemoryPool(memorypool_t *pool);
+//free the memory pool, all blocks should be returned first
+void FreeMemoryPool(memorypool_t *pool);
+//creates a memory arena with blocks of at least the given size
+memoryarena_t *GetMemoryArena(char *name, int blocksize);
+//allocate memory from the arena
+void *GetArenaMemory(memoryarena_t *arena, unsigned long size);
+//allocate memory from the arena and clear it
+void *GetClearedArenaMemory(memoryarena_t *arena, unsigned long size);
+//copy the string into the arena
+char *CopyArenaString(memoryarena_t *arena, const char *string);
+//free the arena and all memory allocated from it
+void FreeMemoryArena(memoryarena_t *arena);
+//prints the memory pool and arena usage
+void PrintMemoryPools(void);
+//writes the memory pool and arena usage to the log file
+void LogMemoryPools(void);
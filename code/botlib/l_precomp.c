@@ -60,6 +60,7 @@ typedef enum {qfalse, qtrue}	qboolean;
 #include "l_script.h"
 #include "l_precomp.h"
 #include "l_log.h"
+#include "l_crc.h"
 #endif //BOTLIB
 
 #ifdef MEQCC
@@ -110,6 +111,10 @@ typedef struct directive_s
 #define TOKEN_HEAP_SIZE		4096
 
 int numtokens;
+#ifdef BOTLIB
+//tokens are allocated from slabs
+memorypool_t *tokenpool;
+#endif //BOTLIB
 /*
 int tokenheapinitialized;				//true when the token heap is initialized
 token_t token_heap[TOKEN_HEAP_SIZE];	//heap with tokens
@@ -264,7 +269,12 @@ token_t *PC_CopyToken(token_t *token)
 	token_t *t;
 
 //	t = (token_t *) malloc(sizeof(token_t));
+#ifdef BOTLIB
+	if (!tokenpool) tokenpool = GetMemoryPool("tokens", sizeof(token_t), 64);
+	t = (token_t *) GetPoolMemory(tokenpool);
+#else
 	t = (token_t *) GetMemory(sizeof(token_t));
+#endif //BOTLIB
 //	t = freetokens;
 	if (!t)
 	{
@@ -290,7 +300,11 @@ token_t *PC_CopyToken(token_t *token)
 void PC_FreeToken(token_t *token)
 {
 	//free(token);
+#ifdef BOTLIB
+	FreePoolMemory(token);
+#else
 	FreeMemory(token);
+#endif //BOTLIB
 //	token->next = freetokens;
 //	freetokens = token;
 	numtokens--;
@@ -301,6 +315,23 @@ void PC_FreeToken(token_t *token)
 // Returns:					-
 // Changes Globals:		-
 //============================================================================
+void PC_ShutdownTokenHeap(void)
+{
+#ifdef BOTLIB
+	//tokens still in use keep the pool alive
+	if (tokenpool && !numtokens)
+	{
+		FreeMemoryPool(tokenpool);
+		tokenpool = NULL;
+	} //end if
+#endif //BOTLIB
+} //end of the function PC_ShutdownTokenHeap
+//============================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
 int PC_ReadSourceToken(source_t *source, token_t *token)
 {
 	token_t *t;
@@ -1436,6 +1467,39 @@ void PC_RemoveAllGlobalDefines(void)
 	} //end for
 } //end of the function PC_RemoveAllGlobalDefines
 //============================================================================
+// crc of the global defines, they change the meaning of every source
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+int PC_GlobalDefinesCRC(void)
+{
+#ifdef BOTLIB
+	define_t *define;
+	token_t *t;
+	unsigned short crc;
+
+	CRC_Init(&crc);
+	for (define = globaldefines; define; define = define->next)
+	{
+		CRC_ContinueProcessString(&crc, define->name, strlen(define->name) + 1);
+		for (t = define->parms; t; t = t->next)
+		{
+			CRC_ContinueProcessString(&crc, t->string, strlen(t->string) + 1);
+		} //end for
+		CRC_ContinueProcessString(&crc, "#", 1);
+		for (t = define->tokens; t; t = t->next)
+		{
+			CRC_ContinueProcessString(&crc, t->string, strlen(t->string) + 1);
+		} //end for
+	} //end for
+	return CRC_Value(crc);
+#else
+	return 0;
+#endif //BOTLIB
+} //end of the function PC_GlobalDefinesCRC
+//============================================================================
 //
 // Parameter:				-
 // Returns:					-
@@ -133,6 +133,10 @@ int PC_AddGlobalDefine(char *string);
 int PC_RemoveGlobalDefine(char *name);
 //remove all globals defines
 void PC_RemoveAllGlobalDefines(void);
+//crc of all global defines
+int PC_GlobalDefinesCRC(void);
+//free the token memory when no tokens are in use
+void PC_ShutdownTokenHeap(void);
 //add builtin defines
 void PC_AddBuiltinDefines(source_t *source);
 //set the source include path
@@ -56,6 +56,7 @@ typedef enum {qfalse, qtrue}	qboolean;
 #include "l_memory.h"
 #include "l_log.h"
 #include "l_libvar.h"
+#include "l_cache.h"
 #endif //BOTLIB
 
 #ifdef MEQCC
@@ -1339,7 +1340,12 @@ script_t *LoadScriptFile(const char *filename)
 	else
 		Com_sprintf(pathname, sizeof(pathname), "%s", filename);
 	length = botimport.FS_FOpenFile( pathname, &fp, FS_READ );
-	if (!fp) return NULL;
+	if (!fp)
+	{
+		//a file showing up later changes the compiled bot files
+		Cache_AddDependency(pathname, NULL, -1);
+		return NULL;
+	} //end if
 #else
 	fp = fopen(filename, "rb");
 	if (!fp) return NULL;
@@ -1371,6 +1377,7 @@ script_t *LoadScriptFile(const char *filename)
 #ifdef BOTLIB
 	botimport.FS_Read(script->buffer, length, fp);
 	botimport.FS_FCloseFile(fp);
+	Cache_AddDependency(pathname, script->buffer, length);
 #else
 	if (fread(script->buffer, length, 1, fp) != 1)
 	{
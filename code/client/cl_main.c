@@ -3612,6 +3612,7 @@ void CL_InitRef( void ) {
 	ri.FS_ReadShader = FS_ReadShader;
 	ri.FS_GetFileExtension = FS_GetFileExtension;
 	ri.FS_CheckFilesFromSamePk3 = FS_CheckFilesFromSamePk3;
+	ri.FS_ImageLookupBatch = FS_ImageLookupBatch;
 #endif
 
 	ret = GetRefAPI( REF_API_VERSION, &ri );
@@ -615,6 +615,9 @@ void Cbuf_Execute (void) {
 			break; }
 
 		mode = cbuf_get_command(&main_cbuf, cmd, sizeof(cmd));
+#ifdef CMOD_HITCH_RECORDER
+		if(*cmd) cmod_hitch_command(cmd);
+#endif
 		if(*cmd) Cmd_ExecuteStringByMode(cmd, mode); } }
 
 #ifdef CMOD_SERVER_CMD_TRIGGERS
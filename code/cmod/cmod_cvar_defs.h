@@ -52,6 +52,14 @@ CVAR_DEF(s_noOverlap, "1", CVAR_ARCHIVE);
 CVAR_DEF(cmod_log_flush, "1", 0)
 #endif
 
+#ifdef CMOD_PROFILER
+CVAR_DEF(com_profile, "0", 0)
+#endif
+
+#ifdef CMOD_HITCH_RECORDER
+CVAR_DEF(sv_hitchThreshold, "100", 0)
+#endif
+
 #ifdef CMOD_MIN_SNAPS
 CVAR_DEF(sv_minSnaps, "50", CVAR_ARCHIVE);
 #endif
@@ -370,6 +370,11 @@
 // Used to enable features in the cMod VMs that are too specialized to enable by default for all engines
 #define CMOD_VM_CONFIG_VALUES
 
+// [FEATURE] Timing zones around the main engine phases, enabled by "com_profile" cvar.
+// Supports "profile_report" for per-zone histograms and "profile_export" to write a
+// Chrome trace file.
+#define CMOD_PROFILER
+
 // [BUGFIX] Use traditional EF float casting behavior in VM, which fixes the physics behavior
 // in various mods
 #define CMOD_VMFLOATCAST
@@ -411,6 +416,13 @@
 #define CMOD_LOGGING_MESSAGES
 #endif
 
+// [FEATURE] Keep timings and activity counts for recent frames, and write them to the
+// hitch log (enabled by "cmod_log_hitch" cvar) when a server frame takes longer than
+// "sv_hitchThreshold" milliseconds
+#if defined(CMOD_LOGGING_SYSTEM)	// required
+#define CMOD_HITCH_RECORDER
+#endif
+
 // [COMMON] Add console command to copy debug info to clipboard
 #define CMOD_COPYDEBUG_CMD
 
@@ -0,0 +1,152 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+Copyright (C) 2017 Noah Metzger (chomenor@gmail.com)
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+#ifdef CMOD_HITCH_RECORDER
+#include "../qcommon/q_shared.h"
+#include "../qcommon/qcommon.h"
+
+// Keeps a record of the last HITCH_FRAMES server frames: phase timings, activity counters,
+// and the commands that were executed. When a server frame takes longer than
+// sv_hitchThreshold milliseconds, the whole record is written to the hitch log.
+
+// Each record covers one SV_Frame call plus everything that happened since the previous
+// one, such as packets processed and commands executed while waiting for the frame.
+
+#define HITCH_FRAMES 32
+#define HITCH_COMMAND_TEXT 256
+
+typedef struct {
+	int frame_number;	// count of recorded server frames
+	int sv_time;
+	int msec;
+	int interval;		// usec since start of previous server frame
+	int frame_time;		// usec in SV_Frame
+	int phase_time[HITCH_PHASE_COUNT];	// usec
+	cmod_hitch_counters_t counters;
+	char commands[HITCH_COMMAND_TEXT];
+} hitch_frame_t;
+
+#define CMHitchPhaseEntry(id, name) name,
+static const char *phase_names[] = {
+	CMHitchPhaseList
+};
+#undef CMHitchPhaseEntry
+
+cmod_hitch_counters_t cmod_hitch_counters;
+
+static hitch_frame_t frames[HITCH_FRAMES];
+static hitch_frame_t current;
+static unsigned int frame_count;
+static int64_t last_frame_start;
+
+// Hitches within HITCH_FRAMES of the previous dump are already mostly covered by it,
+// so they are only counted and reported with the next dump
+static unsigned int last_dump_frame;
+static int skipped_dumps;
+
+/* ******************************************************************************** */
+// Recording
+/* ******************************************************************************** */
+
+int64_t cmod_hitch_phase(cmod_hitch_phase_t phase, int64_t start) {
+	// Adds time since start to given phase of current frame
+	// Returns the end time, so a following phase can start from it without reading the clock again
+	int64_t end = Sys_Microseconds();
+	current.phase_time[phase] += (int)(end - start);
+	return end; }
+
+void cmod_hitch_command(const char *cmd) {
+	// Adds command to the list of commands executed in current frame
+	// Once the list is full it ends with "..." and further commands are dropped
+	cmod_stream_t stream = {current.commands, 0, sizeof(current.commands), qfalse};
+	stream.position = strlen(current.commands);
+	if(stream.position >= sizeof(current.commands) - 4) return;
+
+	cmod_stream_append_string_separated(&stream, cmd, "; ");
+	if(stream.position >= sizeof(current.commands) - 4) {
+		Q_strncpyz(current.commands + sizeof(current.commands) - 4, "...", 4); } }
+
+/* ******************************************************************************** */
+// Dump
+/* ******************************************************************************** */
+
+static void hitch_write_frame(const hitch_frame_t *frame, qboolean hitch) {
+	char buffer[1024];
+	cmod_stream_t stream = {buffer, 0, sizeof(buffer), qfalse};
+	int i;
+
+	cmod_stream_append_string(&stream, va("%c%8i %9i %4i %8i %8i", hitch ? '*' : ' ', frame->frame_number,
+			frame->sv_time, frame->msec, frame->interval, frame->frame_time));
+	for(i=0; i<HITCH_PHASE_COUNT; ++i) {
+		cmod_stream_append_string(&stream, va(" %9i", frame->phase_time[i])); }
+	cmod_stream_append_string(&stream, va(" %6i %6i %7i %6i %9i  %s\n", frame->counters.packets_in,
+			frame->counters.packets_out, frame->counters.vm_calls, frame->counters.fs_reads,
+			frame->counters.fs_read_bytes, frame->commands));
+
+	cmLog(LOG_HITCH, LOGFLAG_RAW_STRING, "%s", buffer); }
+
+static void hitch_dump(int threshold) {
+	char buffer[1024];
+	cmod_stream_t stream = {buffer, 0, sizeof(buffer), qfalse};
+	unsigned int first = frame_count > HITCH_FRAMES ? frame_count - HITCH_FRAMES : 0;
+	unsigned int i;
+
+	cmLog(LOG_HITCH, LOGFLAG_COM_PRINTF, "Server frame took %i ms (sv_hitchThreshold %i)%s",
+			frames[(frame_count - 1) % HITCH_FRAMES].frame_time / 1000, threshold,
+			skipped_dumps ? va(", %i more hitches since last dump", skipped_dumps) : "");
+
+	cmod_stream_append_string(&stream, "    index    svtime msec interval sv_frame");
+	for(i=0; i<HITCH_PHASE_COUNT; ++i) {
+		cmod_stream_append_string(&stream, va(" %9s", phase_names[i])); }
+	cmod_stream_append_string(&stream, " pktin pktout vmcalls fsread fsbytes  commands\n");
+	cmLog(LOG_HITCH, LOGFLAG_RAW_STRING, "(times in usec)\n%s", buffer);
+
+	for(i=first; i<frame_count; ++i) {
+		hitch_write_frame(&frames[i % HITCH_FRAMES], i == frame_count - 1 ? qtrue : qfalse); }
+
+	cmLog(LOG_HITCH, LOGFLAG_RAW_STRING | LOGFLAG_FLUSH, "\n");
+	last_dump_frame = frame_count;
+	skipped_dumps = 0; }
+
+void cmod_hitch_server_frame(int64_t start, int msec, int sv_time) {
+	// Called at the end of SV_Frame with the time it started
+	int64_t end = Sys_Microseconds();
+	int threshold = sv_hitchThreshold->integer;
+
+	current.frame_number = (int)frame_count;
+	current.sv_time = sv_time;
+	current.msec = msec;
+	current.interval = last_frame_start ? (int)(start - last_frame_start) : 0;
+	current.frame_time = (int)(end - start);
+	current.counters = cmod_hitch_counters;
+	frames[frame_count++ % HITCH_FRAMES] = current;
+
+	last_frame_start = start;
+	Com_Memset(&current, 0, sizeof(current));
+	Com_Memset(&cmod_hitch_counters, 0, sizeof(cmod_hitch_counters));
+
+	if(threshold > 0 && end - start >= (int64_t)threshold * 1000) {
+		if(last_dump_frame && frame_count - last_dump_frame < HITCH_FRAMES) ++skipped_dumps;
+		else hitch_dump(threshold); } }
+
+#endif
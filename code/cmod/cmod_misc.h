@@ -58,6 +58,7 @@ unsigned int cmod_read_token_ws(const char **current, char *buffer, unsigned int
 #define CMLogList \
 	CMLogEntry(LOG_SERVER, "server", 1) \
 	CMLogEntry(LOG_RECORD, "record", 1) \
+	CMLogEntry(LOG_HITCH, "hitch", 1) \
 
 #define CMLogEntry(id, name, date_mode) id,
 typedef enum {
@@ -76,6 +77,67 @@ void cmod_logging_frame(void);
 void QDECL cmLog(cmod_log_id_t log_id, int flags, const char *fmt, ...) __attribute__ ((format (printf, 3, 4)));
 #endif
 
+#ifdef CMOD_PROFILER
+// id, name
+#define CMProfileList \
+	CMProfileEntry(PROFILE_EVENT_LOOP, "Com_EventLoop") \
+	CMProfileEntry(PROFILE_SV_FRAME, "SV_Frame") \
+	CMProfileEntry(PROFILE_GAME_SYSCALL, "SV_GameSystemCalls") \
+	CMProfileEntry(PROFILE_SEND_CLIENT_MESSAGES, "SV_SendClientMessages") \
+	CMProfileEntry(PROFILE_FS_READFILE, "FS_ReadFile") \
+	CMProfileEntry(PROFILE_CM_BOXTRACE, "CM_BoxTrace") \
+	CMProfileEntry(PROFILE_VM_CALL, "VM_Call") \
+
+#define CMProfileEntry(id, name) id,
+typedef enum {
+	CMProfileList
+	PROFILE_COUNT
+} cmod_profile_zone_t;
+#undef CMProfileEntry
+
+extern qboolean cmod_profile_active;
+
+// Usage: start = CMPROFILE_START(); ... CMPROFILE_END(zone, start);
+#define CMPROFILE_START() ( cmod_profile_active ? Sys_Microseconds() : -1 )
+#define CMPROFILE_END(zone, start) do { if((start) >= 0) cmod_profile_record(zone, start); } while(0)
+
+void cmod_profile_initialize(void);
+void cmod_profile_frame(void);
+void cmod_profile_record(cmod_profile_zone_t zone, int64_t start);
+#endif
+
+#ifdef CMOD_HITCH_RECORDER
+// id, name
+#define CMHitchPhaseList \
+	CMHitchPhaseEntry(HITCH_PHASE_PACKETS, "packets") \
+	CMHitchPhaseEntry(HITCH_PHASE_COMMANDS, "commands") \
+	CMHitchPhaseEntry(HITCH_PHASE_BOTS, "bots") \
+	CMHitchPhaseEntry(HITCH_PHASE_GAME, "game") \
+	CMHitchPhaseEntry(HITCH_PHASE_SNAPSHOTS, "snapshots") \
+
+#define CMHitchPhaseEntry(id, name) id,
+typedef enum {
+	CMHitchPhaseList
+	HITCH_PHASE_COUNT
+} cmod_hitch_phase_t;
+#undef CMHitchPhaseEntry
+
+// Activity counters for the current frame, incremented directly by the engine
+typedef struct {
+	int packets_in;		// packets processed by the server
+	int packets_out;	// network packets sent by the server
+	int vm_calls;
+	int fs_reads;		// calls to FS_ReadData, including cache hits
+	int fs_read_bytes;	// bytes read from disk
+} cmod_hitch_counters_t;
+
+extern cmod_hitch_counters_t cmod_hitch_counters;
+
+int64_t cmod_hitch_phase(cmod_hitch_phase_t phase, int64_t start);
+void cmod_hitch_command(const char *cmd);
+void cmod_hitch_server_frame(int64_t start, int msec, int sv_time);
+#endif
+
 #ifdef CMOD_MAP_AUTO_ADJUST
 void cmod_map_adjust_configure(const char *mapname);
 #endif
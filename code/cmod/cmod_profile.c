@@ -0,0 +1,251 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+Copyright (C) 2017 Noah Metzger (chomenor@gmail.com)
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+#ifdef CMOD_PROFILER
+#include "../qcommon/q_shared.h"
+#include "../qcommon/qcommon.h"
+
+// Timing zones placed around the main engine phases (see CMProfileList). While com_profile
+// is enabled, each completed zone is written to a ring buffer holding the most recent
+// events, which can be exported in Chrome trace event format (chrome://tracing or Perfetto),
+// and added to per-zone histograms of call durations and per-frame totals.
+
+// All zones are on the main thread, so the ring has a single writer and needs no locking.
+// While com_profile is disabled each zone costs a single flag test.
+
+#define PROFILE_EVENTS 65536	// must be power of 2
+
+// Histogram buckets are exact below 2 * PROFILE_SUB_BUCKETS microseconds, and above that
+// each power of 2 is split into PROFILE_SUB_BUCKETS buckets, for about 6% resolution.
+#define PROFILE_SUB_BUCKETS 16
+#define PROFILE_BUCKETS (28 * PROFILE_SUB_BUCKETS)
+
+typedef struct {
+	int64_t start;
+	int duration;
+	int zone;
+} profile_event_t;
+
+typedef struct {
+	unsigned int count;
+	unsigned int max;
+	uint64_t total;
+	unsigned int buckets[PROFILE_BUCKETS];
+} profile_histogram_t;
+
+typedef struct {
+	const char *name;
+	profile_histogram_t calls;
+	profile_histogram_t frames;
+
+	// Current frame
+	unsigned int frame_calls;
+	unsigned int frame_time;
+} profile_zone_t;
+
+#define CMProfileEntry(id, name) {name},
+static profile_zone_t zones[] = {
+	CMProfileList
+};
+#undef CMProfileEntry
+
+qboolean cmod_profile_active;
+
+static profile_event_t *events;
+static unsigned int event_count;
+static int64_t profile_start_time;
+static int profile_frames;
+
+/* ******************************************************************************** */
+// Histograms
+/* ******************************************************************************** */
+
+static int profile_bucket(unsigned int value) {
+	int shift = 0;
+	while(value >= 2 * PROFILE_SUB_BUCKETS) {
+		value >>= 1;
+		++shift; }
+	return shift * PROFILE_SUB_BUCKETS + (int)value; }
+
+static unsigned int profile_bucket_limit(int bucket) {
+	// Returns highest value that falls in bucket
+	int shift;
+	if(bucket < 2 * PROFILE_SUB_BUCKETS) return (unsigned int)bucket;
+	shift = bucket / PROFILE_SUB_BUCKETS - 1;
+	return (((unsigned int)(bucket - shift * PROFILE_SUB_BUCKETS) + 1) << shift) - 1; }
+
+static void profile_histogram_add(profile_histogram_t *hist, unsigned int value) {
+	++hist->count;
+	hist->total += value;
+	if(value > hist->max) hist->max = value;
+	++hist->buckets[profile_bucket(value)]; }
+
+static unsigned int profile_histogram_percentile(const profile_histogram_t *hist, float fraction) {
+	unsigned int target;
+	unsigned int sum = 0;
+	int i;
+	if(!hist->count) return 0;
+
+	target = (unsigned int)(hist->count * fraction);
+	if(target >= hist->count) target = hist->count - 1;
+	for(i=0; i<PROFILE_BUCKETS; ++i) {
+		sum += hist->buckets[i];
+		if(sum > target) {
+			unsigned int limit = profile_bucket_limit(i);
+			return limit < hist->max ? limit : hist->max; } }
+
+	return hist->max; }
+
+/* ******************************************************************************** */
+// Recording
+/* ******************************************************************************** */
+
+static void profile_reset(void) {
+	int i;
+	for(i=0; i<PROFILE_COUNT; ++i) {
+		Com_Memset(&zones[i].calls, 0, sizeof(zones[i].calls));
+		Com_Memset(&zones[i].frames, 0, sizeof(zones[i].frames));
+		zones[i].frame_calls = 0;
+		zones[i].frame_time = 0; }
+	event_count = 0;
+	profile_frames = 0;
+	profile_start_time = Sys_Microseconds(); }
+
+static void profile_set_active(qboolean active) {
+	if(active) {
+		events = (profile_event_t *)Z_Malloc(sizeof(*events) * PROFILE_EVENTS);
+		profile_reset();
+		cmod_profile_active = qtrue; }
+	else {
+		cmod_profile_active = qfalse;
+		Z_Free(events);
+		events = NULL; } }
+
+void cmod_profile_record(cmod_profile_zone_t zone, int64_t start) {
+	// Called through CMPROFILE_END
+	int64_t duration;
+	profile_event_t *event;
+	if(!cmod_profile_active) return;
+
+	duration = Sys_Microseconds() - start;
+	if(duration < 0) duration = 0;
+	if(duration > 0x7fffffff) duration = 0x7fffffff;
+
+	event = &events[event_count++ & (PROFILE_EVENTS - 1)];
+	event->start = start;
+	event->duration = (int)duration;
+	event->zone = zone;
+
+	profile_histogram_add(&zones[zone].calls, (unsigned int)duration);
+	++zones[zone].frame_calls;
+	zones[zone].frame_time += (unsigned int)duration; }
+
+void cmod_profile_frame(void) {
+	int i;
+	if(!com_profile) return;
+	if((com_profile->integer != 0) != cmod_profile_active) profile_set_active(com_profile->integer ? qtrue : qfalse);
+	if(!cmod_profile_active) return;
+
+	// Per-frame totals only count frames in which the zone was entered
+	for(i=0; i<PROFILE_COUNT; ++i) {
+		if(zones[i].frame_calls) {
+			profile_histogram_add(&zones[i].frames, zones[i].frame_time);
+			zones[i].frame_calls = 0;
+			zones[i].frame_time = 0; } }
+
+	++profile_frames; }
+
+/* ******************************************************************************** */
+// Commands
+/* ******************************************************************************** */
+
+static void profile_report_cmd(void) {
+	int i;
+	if(!cmod_profile_active) {
+		Com_Printf("Profiler not active; set com_profile to 1 to enable.\n");
+		return; }
+
+	Com_Printf("%i frames over %.1f seconds, %u zone events\n", profile_frames,
+			(float)(Sys_Microseconds() - profile_start_time) / 1000000.0f, event_count);
+	Com_Printf("times in usec         ----------------- per call ----------------  ------------- per frame -------------\n");
+	Com_Printf("zone                      calls    avg    p50    p90    p99    max  frames    p50    p90    p99    max\n");
+
+	for(i=0; i<PROFILE_COUNT; ++i) {
+		const profile_histogram_t *calls = &zones[i].calls;
+		const profile_histogram_t *frames = &zones[i].frames;
+		Com_Printf("%-22s %8u %6u %6u %6u %6u %6u  %6u %6u %6u %6u %6u\n", zones[i].name, calls->count,
+				calls->count ? (unsigned int)(calls->total / calls->count) : 0,
+				profile_histogram_percentile(calls, 0.5f), profile_histogram_percentile(calls, 0.9f),
+				profile_histogram_percentile(calls, 0.99f), calls->max, frames->count,
+				profile_histogram_percentile(frames, 0.5f), profile_histogram_percentile(frames, 0.9f),
+				profile_histogram_percentile(frames, 0.99f), frames->max); } }
+
+static void profile_reset_cmd(void) {
+	if(!cmod_profile_active) {
+		Com_Printf("Profiler not active; set com_profile to 1 to enable.\n");
+		return; }
+	profile_reset();
+	Com_Printf("Profile data reset.\n"); }
+
+static void profile_export_cmd(void) {
+	// Writes the events currently in the ring buffer as a Chrome trace
+	char path[MAX_QPATH];
+	fileHandle_t handle;
+	unsigned int i;
+	unsigned int first;
+	unsigned int written = 0;
+
+	if(!cmod_profile_active) {
+		Com_Printf("Profiler not active; set com_profile to 1 to enable.\n");
+		return; }
+	if(Cmd_Argc() > 2) {
+		Com_Printf("Usage: profile_export [name]\n");
+		return; }
+
+	Com_sprintf(path, sizeof(path), "profile/%s", Cmd_Argc() > 1 ? Cmd_Argv(1) : "trace");
+	COM_DefaultExtension(path, sizeof(path), ".json");
+	handle = FS_SV_FOpenFileWrite(path);
+	if(!handle) {
+		Com_Printf("Failed to open %s for writing.\n", path);
+		return; }
+
+	first = event_count > PROFILE_EVENTS ? event_count - PROFILE_EVENTS : 0;
+	FS_Printf(handle, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	for(i=first; i!=event_count; ++i) {
+		const profile_event_t *event = &events[i & (PROFILE_EVENTS - 1)];
+		if(event->start < profile_start_time) continue;
+		FS_Printf(handle, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%lld,\"dur\":%i}",
+				written ? "," : "", zones[event->zone].name, (long long)(event->start - profile_start_time),
+				event->duration);
+		++written; }
+	FS_Printf(handle, "\n]}\n");
+	FS_FCloseFile(handle);
+
+	Com_Printf("Wrote %u events to %s\n", written, path); }
+
+void cmod_profile_initialize(void) {
+	Cmd_AddCommand("profile_report", profile_report_cmd);
+	Cmd_AddCommand("profile_reset", profile_reset_cmd);
+	Cmd_AddCommand("profile_export", profile_export_cmd); }
+
+#endif
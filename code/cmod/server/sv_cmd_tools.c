@@ -621,6 +621,9 @@ static void trigger_exec(const char *cmd, const char *tag) {
 
 	if(cmod_trigger_debug->integer) {
 		Com_Printf("Running trigger '%s'\n", tag); }
+#ifdef CMOD_HITCH_RECORDER
+	cmod_hitch_command(va("[trigger %s]", tag));
+#endif
 
 	// Only exec now if there were no previous commands in command buffer
 	if(empty) {
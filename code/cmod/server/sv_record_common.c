@@ -24,6 +24,11 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #ifdef CMOD_RECORD
 #include "sv_record_local.h"
 
+#if idx64 || defined(__SSE2__)
+#include <emmintrin.h>
+#define RECORD_SIMD_COMPARE
+#endif
+
 /* ******************************************************************************** */
 // Data Stream
 /* ******************************************************************************** */
@@ -51,10 +56,18 @@ void record_stream_write(void *data, int size, record_data_stream_t *stream) {
 void record_stream_write_value(int value, int size, record_data_stream_t *stream) {
 	record_stream_write(&value, size, stream); }
 
+qboolean record_stream_read_available(int size, record_data_stream_t *stream) {
+	// Returns qtrue if size bytes can be read from stream, refilling from file if needed
+	if(size < 0) return qfalse;
+	if(stream->position + size <= stream->size && stream->position + size >= stream->position) return qtrue;
+	if(stream->reader) return record_file_reader_refill(stream, size);
+	return qfalse; }
+
 char *record_stream_read_static(int size, record_data_stream_t *stream) {
-	char *output = stream->data + stream->position;
-	if(stream->position + size > stream->size || stream->position + size < stream->position) {
+	char *output;
+	if(!record_stream_read_available(size, stream)) {
 		record_stream_error(stream, "record_stream_read_static: stream overflow"); }
+	output = stream->data + stream->position;
 	stream->position += size;
 	return output; }
 
@@ -62,9 +75,11 @@ void record_stream_read_buffer(void *output, int size, record_data_stream_t *str
 	void *data = record_stream_read_static(size, stream);
 	if(data) Com_Memcpy(output, data, size); }
 
-void dump_stream_to_file(record_data_stream_t *stream, fileHandle_t file) {
-	FS_Write(stream->data, stream->position, file);
+#ifndef CMOD_RECORD_TOOL
+void dump_stream_to_file(record_data_stream_t *stream, record_file_writer_t *rfw) {
+	record_file_writer_write(rfw, stream->data, stream->position);
 	stream->position = 0; }
+#endif
 
 /* ******************************************************************************** */
 // Memory allocation
@@ -176,6 +191,27 @@ char *record_decode_string(record_data_stream_t *stream, int *length_out) {
 
 // ***** Generic Structure *****
 
+#ifdef RECORD_SIMD_COMPARE
+static qboolean record_block_changed(const unsigned int *state, const unsigned int *source) {
+	// Returns qtrue if any of 4 words differ
+	__m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)state), _mm_loadu_si128((const __m128i *)source));
+	return _mm_movemask_epi8(equal) != 0xffff ? qtrue : qfalse; }
+#endif
+
+static qboolean record_structure_changed(const void *state, const void *source, int size) {
+	// Returns qtrue if structures differ
+#ifdef RECORD_SIMD_COMPARE
+	__m128i difference = _mm_setzero_si128();
+	while(size >= 16) {
+		difference = _mm_or_si128(difference, _mm_xor_si128(_mm_loadu_si128((const __m128i *)state),
+				_mm_loadu_si128((const __m128i *)source)));
+		state = (const byte *)state + 16;
+		source = (const byte *)source + 16;
+		size -= 16; }
+	if(_mm_movemask_epi8(_mm_cmpeq_epi8(difference, _mm_setzero_si128())) != 0xffff) return qtrue;
+#endif
+	return size && memcmp(state, source, size) ? qtrue : qfalse; }
+
 static void record_encode_structure(qboolean byte_pass, unsigned int *state, unsigned int *source, int size, record_data_stream_t *stream) {
 	// Basic structure encoding sends the index byte followed by data chunk
 	// Field encoding sends the index byte with high bit set, followed by byte field indicating
@@ -187,6 +223,12 @@ static void record_encode_structure(qboolean byte_pass, unsigned int *state, uns
 	int field_position = 0;
 
 	for(i=0; i<size; ++i) {
+#ifdef RECORD_SIMD_COMPARE
+		// Skip unchanged blocks of 4 words
+		if(!(i & 3) && i + 4 <= size && !record_block_changed(state + i, source + i)) {
+			i += 3;
+			continue; }
+#endif
 		if(state[i] != source[i] && (!byte_pass || (state[i] & ~255) == (source[i] & ~255))) {
 			if(field && i - field_position < 8) {
 				*field |= (1 << (i - field_position)); }
@@ -246,20 +288,46 @@ void record_decode_entitystate(entityState_t *state, record_data_stream_t *strea
 
 // ***** Entitysets *****
 
+static void record_entityset_changes(record_entityset_t *state, record_entityset_t *source, unsigned int *removed,
+		unsigned int *modified) {
+	// Builds bitmaps of entities to remove and entities to add or modify
+	// Only entities active in either set are compared, 32 at a time by active flag word
+	int i, j;
+	for(i=0; i<(MAX_GENTITIES+31)/32; ++i) {
+		unsigned int state_active = (unsigned int)state->active_flags[i];
+		unsigned int source_active = (unsigned int)source->active_flags[i];
+		unsigned int compare = state_active & source_active;
+
+		removed[i] = state_active & ~source_active;
+		modified[i] = source_active & ~state_active;
+		if(!compare) continue;
+
+		for(j=0; j<32; ++j) {
+			if(!(compare & (1u << j))) continue;
+			if(record_structure_changed(&state->entities[i*32+j], &source->entities[i*32+j], sizeof(entityState_t))) {
+				modified[i] |= 1u << j; } } } }
+
 void record_encode_entityset(record_entityset_t *state, record_entityset_t *source, record_data_stream_t *stream) {
 	// Sets state equal to source, and writes delta change to stream
-	int i;
-	for(i=0; i<MAX_GENTITIES; ++i) {
-		if(!record_bit_get(state->active_flags, i) && !record_bit_get(source->active_flags, i)) continue;
-		else if(record_bit_get(state->active_flags, i) && !record_bit_get(source->active_flags, i)) {
-			//Com_Printf("encode remove %i\n", i);
-			record_stream_write_value(i | (1 << 12), 2, stream);
-			record_bit_unset(state->active_flags, i); }
-		else if(!record_bit_get(state->active_flags, i) || memcmp(&state->entities[i], &source->entities[i], sizeof(state->entities[i]))) {
-			//Com_Printf("encode modify %i\n", i);
-			record_stream_write_value(i | (2 << 12), 2, stream);
-			record_encode_entitystate(&state->entities[i], &source->entities[i], stream);
-			record_bit_set(state->active_flags, i); } }
+	unsigned int removed[(MAX_GENTITIES+31)/32];
+	unsigned int modified[(MAX_GENTITIES+31)/32];
+	int i, j;
+
+	record_entityset_changes(state, source, removed, modified);
+
+	for(i=0; i<(MAX_GENTITIES+31)/32; ++i) {
+		if(!(removed[i] | modified[i])) continue;
+		for(j=0; j<32; ++j) {
+			int entity = i * 32 + j;
+			if(removed[i] & (1u << j)) {
+				//Com_Printf("encode remove %i\n", entity);
+				record_stream_write_value(entity | (1 << 12), 2, stream);
+				record_bit_unset(state->active_flags, entity); }
+			else if(modified[i] & (1u << j)) {
+				//Com_Printf("encode modify %i\n", entity);
+				record_stream_write_value(entity | (2 << 12), 2, stream);
+				record_encode_entitystate(&state->entities[entity], &source->entities[entity], stream);
+				record_bit_set(state->active_flags, entity); } } }
 
 	// Finished
 	record_stream_write_value(-1, 2, stream); }
@@ -335,6 +403,10 @@ void record_convert_record_usercmd_to_usercmd(record_usercmd_t *source, usercmd_
 	target->upmove = source->upmove;
 	target->weapon = source->weapon; }
 
+// Entity and visibility building access the live server, which isn't available in the
+// standalone record tool
+#ifndef CMOD_RECORD_TOOL
+
 /* ******************************************************************************** */
 // Entity Set Building
 /* ******************************************************************************** */
@@ -567,6 +639,8 @@ void record_tweak_inactive_visibility(record_entityset_t *entityset, record_visi
 		// Toggle visibility of inactive entities that are visible in the old visibility
 		target->ent_visibility[i] = source->ent_visibility[i] | (old_visibility->ent_visibility[i] & ~entityset->active_flags[i]); } }
 
+#endif
+
 /* ******************************************************************************** */
 // Message Building
 /* ******************************************************************************** */
@@ -623,14 +697,8 @@ void record_write_gamestate_message(record_entityset_t *baselines, char **config
 		// write the checksum feed
 		MSG_WriteLong(msg, 0); } }
 
-void record_write_snapshot_message(record_entityset_t *entities, record_visibility_state_t *visibility, playerState_t *ps,
-		record_entityset_t *delta_entities, record_visibility_state_t *delta_visibility, playerState_t *delta_ps,
-		record_entityset_t *baselines, int baseline_cutoff, int lastClientCommand, int deltaFrame, int snapFlags,
-		int sv_time, msg_t *msg) {
-	// Based on sv_snapshot.c->SV_SendClientSnapshot
-	// For non-delta snapshot, set delta_entities, delta_visibility, delta_ps, and deltaFrame to null
-	int i;
-
+void record_write_snapshot_header(int lastClientCommand, int deltaFrame, int snapFlags, int sv_time, msg_t *msg) {
+	// Writes the part of the snapshot preceding the area visibility
 	MSG_WriteByte(msg, svc_snapshot);
 
 #ifdef ELITEFORCE
@@ -643,7 +711,14 @@ void record_write_snapshot_message(record_entityset_t *entities, record_visibili
 	MSG_WriteByte(msg, deltaFrame);
 
 	// Write snapflags
-	MSG_WriteByte(msg, snapFlags);
+	MSG_WriteByte(msg, snapFlags); }
+
+void record_write_snapshot_body(record_entityset_t *entities, record_visibility_state_t *visibility, playerState_t *ps,
+		record_entityset_t *delta_entities, record_visibility_state_t *delta_visibility, playerState_t *delta_ps,
+		record_entityset_t *baselines, int baseline_cutoff, msg_t *msg) {
+	// Writes area visibility, playerstate, and entities
+	// For non-delta snapshot, set delta_entities, delta_visibility, and delta_ps to null
+	int i;
 
 	// Write area visibility
 	{	int inverted_area_visibility[8];
@@ -658,7 +733,7 @@ void record_write_snapshot_message(record_entityset_t *entities, record_visibili
 	for(i=0; i<MAX_GENTITIES; ++i) {
 		if(record_bit_get(entities->active_flags, i) && record_bit_get(visibility->ent_visibility, i)) {
 			// Active and visible entity
-			if(deltaFrame && record_bit_get(delta_entities->active_flags, i) && record_bit_get(delta_visibility->ent_visibility, i)) {
+			if(delta_entities && record_bit_get(delta_entities->active_flags, i) && record_bit_get(delta_visibility->ent_visibility, i)) {
 				// Keep entity (delta from previous entity)
 				MSG_WriteDeltaEntity(msg, &delta_entities->entities[i], &entities->entities[i], qfalse); }
 			else {
@@ -669,7 +744,7 @@ void record_write_snapshot_message(record_entityset_t *entities, record_visibili
 					entityState_t nullstate;
 					Com_Memset(&nullstate, 0, sizeof(nullstate));
 					MSG_WriteDeltaEntity(msg, &nullstate, &entities->entities[i], qtrue); } } }
-		else if(deltaFrame && record_bit_get(delta_entities->active_flags, i) && record_bit_get(delta_visibility->ent_visibility, i)) {
+		else if(delta_entities && record_bit_get(delta_entities->active_flags, i) && record_bit_get(delta_visibility->ent_visibility, i)) {
 			// Remove entity
 			MSG_WriteBits(msg, i, GENTITYNUM_BITS);
 			MSG_WriteBits(msg, 1, 1); } }
@@ -677,4 +752,36 @@ void record_write_snapshot_message(record_entityset_t *entities, record_visibili
 	// End of entities
 	MSG_WriteBits(msg, (MAX_GENTITIES-1), GENTITYNUM_BITS); }
 
+void record_write_snapshot_message(record_entityset_t *entities, record_visibility_state_t *visibility, playerState_t *ps,
+		record_entityset_t *delta_entities, record_visibility_state_t *delta_visibility, playerState_t *delta_ps,
+		record_entityset_t *baselines, int baseline_cutoff, int lastClientCommand, int deltaFrame, int snapFlags,
+		int sv_time, msg_t *msg) {
+	// Based on sv_snapshot.c->SV_SendClientSnapshot
+	// For non-delta snapshot, set delta_entities, delta_visibility, delta_ps, and deltaFrame to null
+	record_write_snapshot_header(lastClientCommand, deltaFrame, snapFlags, sv_time, msg);
+	record_write_snapshot_body(entities, visibility, ps, delta_entities, delta_visibility, delta_ps,
+			baselines, baseline_cutoff, msg); }
+
+void record_msg_append_bits(msg_t *msg, const byte *data, int bits) {
+	// Appends bits previously written to a separate message with the same encoding mode
+	// Huffman and compat bit packing are both least significant bit first with no alignment,
+	// so the copied section decodes the same at any position
+	if(msg->overflowed) return;
+	if(msg->bit + bits > msg->maxsize << 3) {
+		msg->overflowed = qtrue;
+		return; }
+
+	while(bits > 0) {
+		int count = bits < 8 ? bits : 8;
+		int value = *(data++) & ((1 << count) - 1);
+		int offset = msg->bit & 7;
+		byte *target = &msg->data[msg->bit >> 3];
+		*target = (*target & ((1 << offset) - 1)) | (value << offset);
+		if(offset + count > 8) target[1] = value >> (8 - offset);
+		msg->bit += count;
+		bits -= count; }
+
+	if(msg->oob) msg->cursize = (msg->bit >> 3) + ((msg->bit & 7) ? 1 : 0);
+	else msg->cursize = (msg->bit >> 3) + 1; }
+
 #endif
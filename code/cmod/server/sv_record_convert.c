@@ -148,64 +148,34 @@ static void write_demo_map_restart(record_demo_writer_t *rdw) {
 // Record Stream Reader
 /* ******************************************************************************** */
 
-typedef struct {
-	record_data_stream_t stream;
-	record_state_t *rs;
-
-	record_command_t command;
-	int time;
-	int clientNum;
-} record_stream_reader_t;
-
-static qboolean load_record_file_into_stream(fileHandle_t fp, record_data_stream_t *stream) {
-	// Returns qtrue on success, qfalse otherwise
-	// In the event of qtrue, call free on stream->data
-	FS_Seek(fp, 0, FS_SEEK_END);
-	stream->size = FS_FTell(fp);
-	if(!stream->size) return qfalse;
-	stream->data = record_calloc(stream->size);
-
-	FS_Seek(fp, 0, FS_SEEK_SET);
-	FS_Read(stream->data, stream->size, fp);
-	stream->position = 0;
-	return qtrue; }
-
 static qboolean initialize_record_stream_reader(record_stream_reader_t *rsr, const char *path) {
 	// Returns qtrue on success, qfalse otherwise
 	// In the event of qtrue, stream needs to be freed by close_record_stream_reader
-	fileHandle_t fp = 0;
 	int protocol;
 	int max_clients;
 
 	Com_Memset(rsr, 0, sizeof(*rsr));
 
-	FS_SV_FOpenFileRead(path, &fp);
-	if(!fp) {
-		record_printf(RP_ALL, "initialize_record_stream_reader: failed to open source file\n");
-		return qfalse; }
-
-	if(!load_record_file_into_stream(fp, &rsr->stream)) {
+	if(!record_file_reader_open(path, &rsr->stream)) {
 		record_printf(RP_ALL, "initialize_record_stream_reader: failed to read source file\n");
-		FS_FCloseFile(fp);
 		return qfalse; }
-	FS_FCloseFile(fp);
 
-	if(rsr->stream.size < 8) {
+	if(!record_stream_read_available(8, &rsr->stream)) {
 		record_printf(RP_ALL, "initialize_record_stream_reader: invalid source file length\n");
-		record_free(rsr->stream.data);
+		record_file_reader_close(&rsr->stream);
 		return qfalse; }
 
 	protocol = *(int *)record_stream_read_static(4, &rsr->stream);
 	if(protocol != RECORD_PROTOCOL) {
 		record_printf(RP_ALL, "initialize_record_stream_reader: record stream has wrong protocol (got %i, expected %i)\n",
 				protocol, RECORD_PROTOCOL);
-		record_free(rsr->stream.data);
+		record_file_reader_close(&rsr->stream);
 		return qfalse; }
 
 	max_clients = *(int *)record_stream_read_static(4, &rsr->stream);
 	if(max_clients < 1 || max_clients > 256) {
 		record_printf(RP_ALL, "initialize_record_stream_reader: bad max_clients\n");
-		record_free(rsr->stream.data);
+		record_file_reader_close(&rsr->stream);
 		return qfalse; }
 
 	rsr->rs = allocate_record_state(max_clients);
@@ -213,17 +183,25 @@ static qboolean initialize_record_stream_reader(record_stream_reader_t *rsr, con
 	return qtrue; }
 
 static void close_record_stream_reader(record_stream_reader_t *rsr) {
-	record_free(rsr->stream.data);
+	record_file_reader_close(&rsr->stream);
 	free_record_state(rsr->rs); }
 
+static qboolean seek_stream_reader(record_stream_reader_t *rsr, int time) {
+	// Moves reader to the last keyframe at or before time
+	// Returns qtrue on success, qfalse if no suitable keyframe is available
+	int keyframe_time = record_file_reader_seek(&rsr->stream, time);
+	if(keyframe_time < 0) return qfalse;
+	record_printf(RP_DEBUG, "stream reader seeking to keyframe at time %i\n", keyframe_time);
+	return qtrue; }
+
 static void stream_reader_set_clientnum(record_stream_reader_t *rsr, int clientNum) {
 	if(clientNum < 0 || clientNum >= rsr->rs->max_clients) {
 		record_stream_error(&rsr->stream, "stream_reader_set_clientnum: invalid clientnum"); }
 	rsr->clientNum = clientNum; }
 
-static qboolean advance_stream_reader(record_stream_reader_t *rsr) {
+qboolean advance_stream_reader(record_stream_reader_t *rsr) {
 	// Returns qtrue on success, qfalse on error or end of stream
-	if(rsr->stream.position >= rsr->stream.size) return qfalse;
+	if(!record_stream_read_available(1, &rsr->stream)) return qfalse;
 	rsr->command = *(unsigned char *)record_stream_read_static(1, &rsr->stream);
 
 	switch(rsr->command) {
@@ -245,6 +223,8 @@ static qboolean advance_stream_reader(record_stream_reader_t *rsr) {
 		case RC_STATE_CONFIGSTRING: {
 			int index = *(unsigned short *)record_stream_read_static(2, &rsr->stream);
 			char *string = record_decode_string(&rsr->stream, 0);
+			if(index >= MAX_CONFIGSTRINGS) record_stream_error(&rsr->stream, "advance_stream_reader: invalid configstring index");
+			rsr->configstring_index = index;
 			Z_Free(rsr->rs->configstrings[index]);
 			rsr->rs->configstrings[index] = CopyString(string);
 			break; }
@@ -265,6 +245,16 @@ static qboolean advance_stream_reader(record_stream_reader_t *rsr) {
 		case RC_EVENT_BASELINES:
 		case RC_EVENT_MAP_RESTART:
 			break;
+		case RC_EVENT_KEYFRAME: {
+			int max_clients = rsr->rs->max_clients;
+			int i;
+			rsr->time = *(int *)record_stream_read_static(4, &rsr->stream);
+			for(i=0; i<max_clients; ++i) {
+				rsr->keyframe_active[i] = *(char *)record_stream_read_static(1, &rsr->stream);
+				rsr->keyframe_instances[i] = *(int *)record_stream_read_static(4, &rsr->stream); }
+			free_record_state(rsr->rs);
+			rsr->rs = allocate_record_state(max_clients);
+			break; }
 
 		default:
 			record_printf(RP_ALL, "advance_stream_reader: unknown command %i\n", rsr->command);
@@ -278,6 +268,7 @@ static qboolean advance_stream_reader(record_stream_reader_t *rsr) {
 
 typedef enum {
 	CSTATE_NOT_STARTED,		// Gamestate not written yet
+	CSTATE_PENDING,			// Session in progress, waiting for start time
 	CSTATE_CONVERTING,		// Gamestate written, write snapshots
 	CSTATE_FINISHED			// Finished, don't write anything more
 } record_conversion_state_t;
@@ -285,117 +276,290 @@ typedef enum {
 typedef struct {
 	int clientNum;
 	int instance_wait;
+	int start_time;
+	int end_time;		// 0 for no limit
+	qboolean seeking;	// Started from a keyframe rather than the beginning of the stream
 	int firing_time;	// For weapon timing
 	record_conversion_state_t state;
-	record_entityset_t baselines;
-	record_stream_reader_t rsr;
 	record_demo_writer_t rdw;
 	int frame_count;
 } record_conversion_handler_t;
 
-static void process_stream_conversion(record_conversion_handler_t *rch) {
-	rch->rsr.stream.abort_set = qtrue;
-	if(setjmp(rch->rsr.stream.abort)) return;
+static void conversion_handle_event(record_conversion_handler_t *rch, record_stream_reader_t *rsr,
+			record_entityset_t *baselines) {
+	// Processes the current reader command for one output demo
+	switch(rsr->command) {
+		case RC_EVENT_SNAPSHOT:
+			if(rch->state == CSTATE_PENDING && rsr->time >= rch->start_time) {
+				write_demo_gamestate(baselines, rsr->rs->configstrings, rch->clientNum, &rch->rdw);
+				rch->state = CSTATE_CONVERTING; }
+			if(rch->state == CSTATE_CONVERTING && rch->end_time && rsr->time > rch->end_time) {
+				rch->state = CSTATE_FINISHED; }
+			if(rch->state == CSTATE_CONVERTING) {
+				playerState_t ps = rsr->rs->clients[rch->clientNum].playerstate;
+				if(record_convert_simulate_follow->integer) playerstate_set_follow_mode(&ps);
+				write_demo_snapshot(&rsr->rs->entities, &rsr->rs->clients[rch->clientNum].visibility,
+						&ps, rsr->time, &rch->rdw);
+				++rch->frame_count; }
+			break;
 
-	while(advance_stream_reader(&rch->rsr)) {
-		switch(rch->rsr.command) {
-			case RC_EVENT_BASELINES:
-				rch->baselines = rch->rsr.rs->entities;
-				break;
+		case RC_EVENT_SERVERCMD:
+			if(rch->state == CSTATE_CONVERTING && rsr->clientNum == rch->clientNum) {
+				write_demo_svcmd(rsr->rs->current_servercmd, &rch->rdw); }
+			break;
 
-			case RC_EVENT_SNAPSHOT:
-				if(rch->state == CSTATE_CONVERTING) {
-					playerState_t ps = rch->rsr.rs->clients[rch->clientNum].playerstate;
-					if(record_convert_simulate_follow->integer) playerstate_set_follow_mode(&ps);
-					write_demo_snapshot(&rch->rsr.rs->entities, &rch->rsr.rs->clients[rch->clientNum].visibility,
-							&ps, rch->rsr.time, &rch->rdw);
-					++rch->frame_count; }
-				break;
+		case RC_STATE_USERCMD:
+			if(rch->state == CSTATE_CONVERTING && rsr->clientNum == rch->clientNum &&
+					record_convert_weptiming->integer) {
+				usercmd_t usercmd;
+				record_convert_record_usercmd_to_usercmd(&rsr->rs->clients[rch->clientNum].usercmd, &usercmd);
+				if(usercmd_is_firing_weapon(&usercmd)) {
+					if(!rch->firing_time) {
+						write_demo_svcmd("print \"Firing\n\"", &rch->rdw);
+						rch->firing_time = usercmd.serverTime; } }
+				else {
+					if(rch->firing_time) {
+						char buffer[128];
+						Com_sprintf(buffer, sizeof(buffer), "print \"Ceased %i\n\"",
+								usercmd.serverTime - rch->firing_time);
+						write_demo_svcmd(buffer, &rch->rdw);
+						rch->firing_time = 0; } } }
+			break;
 
-			case RC_EVENT_SERVERCMD:
-				if(rch->state == CSTATE_CONVERTING && rch->rsr.clientNum == rch->clientNum) {
-					write_demo_svcmd(rch->rsr.rs->current_servercmd, &rch->rdw); }
-				break;
+		case RC_EVENT_MAP_RESTART:
+			if(rch->state == CSTATE_CONVERTING) write_demo_map_restart(&rch->rdw);
+			break;
 
-			case RC_STATE_USERCMD:
-				if(rch->state == CSTATE_CONVERTING && rch->rsr.clientNum == rch->clientNum &&
-						record_convert_weptiming->integer) {
-					usercmd_t usercmd;
-					record_convert_record_usercmd_to_usercmd(&rch->rsr.rs->clients[rch->clientNum].usercmd, &usercmd);
-					if(usercmd_is_firing_weapon(&usercmd)) {
-						if(!rch->firing_time) {
-							write_demo_svcmd("print \"Firing\n\"", &rch->rdw);
-							rch->firing_time = usercmd.serverTime; } }
-					else {
-						if(rch->firing_time) {
-							char buffer[128];
-							Com_sprintf(buffer, sizeof(buffer), "print \"Ceased %i\n\"",
-									usercmd.serverTime - rch->firing_time);
-							write_demo_svcmd(buffer, &rch->rdw);
-							rch->firing_time = 0; } } }
-				break;
+		case RC_EVENT_CLIENT_ENTER_WORLD:
+			if(rch->state == CSTATE_NOT_STARTED && rsr->clientNum == rch->clientNum) {
+				if(rch->instance_wait) --rch->instance_wait;
+				else if(rsr->time < rch->start_time) rch->state = CSTATE_PENDING;
+				else {
+					// Start encoding
+					write_demo_gamestate(baselines, rsr->rs->configstrings, rch->clientNum, &rch->rdw);
+					rch->state = CSTATE_CONVERTING; } }
+			break;
 
-			case RC_EVENT_MAP_RESTART:
-				if(rch->state == CSTATE_CONVERTING) write_demo_map_restart(&rch->rdw);
-				break;
+		case RC_EVENT_CLIENT_DISCONNECT:
+			if((rch->state == CSTATE_CONVERTING || rch->state == CSTATE_PENDING) && rsr->clientNum == rch->clientNum) {
+				// Stop encoding
+				rch->state = CSTATE_FINISHED; }
+			break;
 
-			case RC_EVENT_CLIENT_ENTER_WORLD:
-				if(rch->state == CSTATE_NOT_STARTED && rch->rsr.clientNum == rch->clientNum) {
-					if(rch->instance_wait) --rch->instance_wait;
-					else {
-						// Start encoding
-						write_demo_gamestate(&rch->baselines, rch->rsr.rs->configstrings, rch->clientNum, &rch->rdw);
-						rch->state = CSTATE_CONVERTING; } }
-				break;
+		case RC_EVENT_KEYFRAME:
+			if(rch->seeking) {
+				// Determine session status from the keyframe we started at
+				int instance = rch->instance_wait;
+				int count = rsr->keyframe_instances[rch->clientNum];
+				rch->seeking = qfalse;
+				if(rsr->keyframe_active[rch->clientNum] && instance == count - 1) rch->state = CSTATE_PENDING;
+				else if(instance >= count) rch->instance_wait = instance - count;
+				else rch->state = CSTATE_FINISHED; }
+			break;
+		default:
+			break; } }
 
-			case RC_EVENT_CLIENT_DISCONNECT:
-				if(rch->state == CSTATE_CONVERTING && rch->rsr.clientNum == rch->clientNum) {
-					// Stop encoding
-					rch->state = CSTATE_FINISHED; }
-				break;
-			default:
-				break; } }
+static void process_stream_conversion(record_conversion_handler_t *rch, record_stream_reader_t *rsr) {
+	record_entityset_t *baselines = record_calloc(sizeof(*baselines));
 
-	rch->rsr.stream.abort_set = qfalse; }
+	rsr->stream.abort_set = qtrue;
+	if(setjmp(rsr->stream.abort)) {
+		record_free(baselines);
+		return; }
+
+	while(advance_stream_reader(rsr)) {
+		if(rsr->command == RC_EVENT_BASELINES) *baselines = rsr->rs->entities;
+		conversion_handle_event(rch, rsr, baselines);
+
+		// No need to decode the rest of the stream
+		if(rch->state == CSTATE_FINISHED) break; }
 
-static void run_conversion(const char *path, int clientNum, int instance) {
-	const char *output_path = record_convert_legacy_protocol->integer ?
-			"demos/output.efdemo" : "demos/output.dm_26";
+	rsr->stream.abort_set = qfalse;
+	record_free(baselines); }
+
+static const char *conversion_output_extension(void) {
+	return record_convert_legacy_protocol->integer ? "efdemo" : "dm_26"; }
+
+qboolean record_convert_file(const char *path, const char *output_base, int clientNum, int instance,
+			int start_time, int end_time) {
+	// Writes demo for one client session to output_base plus demo extension
+	// Returns qtrue if any frames were written, qfalse otherwise
+	char output_path[MAX_OSPATH];
+	record_stream_reader_t *rsr;
 	record_conversion_handler_t *rch;
+	qboolean result;
 
+	Com_sprintf(output_path, sizeof(output_path), "%s.%s", output_base, conversion_output_extension());
+
+	rsr = record_calloc(sizeof(*rsr));
 	rch = record_calloc(sizeof(*rch));
 	rch->clientNum = clientNum;
 	rch->instance_wait = instance;
+	rch->start_time = start_time;
+	rch->end_time = end_time;
 
-	if(!initialize_record_stream_reader(&rch->rsr, path)) {
+	if(!initialize_record_stream_reader(rsr, path)) {
 		record_free(rch);
-		return; }
+		record_free(rsr);
+		return qfalse; }
+
+	if(start_time && seek_stream_reader(rsr, start_time)) rch->seeking = qtrue;
 
 	if(!initialize_demo_writer(&rch->rdw, output_path, record_convert_legacy_protocol->integer ? qtrue : qfalse)) {
-		close_record_stream_reader(&rch->rsr);
+		close_record_stream_reader(rsr);
 		record_free(rch);
-		return; }
+		record_free(rsr);
+		return qfalse; }
 
-	process_stream_conversion(rch);
+	process_stream_conversion(rch, rsr);
 
 	if(rch->state == CSTATE_NOT_STARTED) {
 		record_printf(RP_ALL, "failed to locate session; check client and instance parameters\n"
 				"use record_scan command to show available client and instance options\n"); }
 	else {
-		if(rch->state == CSTATE_CONVERTING) {
+		if(rch->state == CSTATE_PENDING || (rch->state == CSTATE_FINISHED && !rch->frame_count)) {
+			record_printf(RP_ALL, "session does not cover requested start time\n"); }
+		else if(rch->state == CSTATE_CONVERTING && !rch->end_time) {
 			record_printf(RP_ALL, "failed to reach disconnect marker; demo may be incomplete\n"); }
 		record_printf(RP_ALL, "%i frames written to %s\n", rch->frame_count, output_path); }
 
+	result = rch->frame_count ? qtrue : qfalse;
 	close_demo_writer(&rch->rdw);
-	close_record_stream_reader(&rch->rsr);
-	record_free(rch); }
+	close_record_stream_reader(rsr);
+	record_free(rch);
+	record_free(rsr);
+	return result; }
 
 void record_convert_cmd(void) {
 	char path[128];
 
 	if(Cmd_Argc() < 2) {
-		record_printf(RP_ALL, "Usage: record_convert <path within 'records' directory> <client> <instance>\n"
-			"Example: record_convert source.rec 0 0\n");
+		record_printf(RP_ALL, "Usage: record_convert <path within 'records' directory> <client> <instance> [start time] [end time]\n"
+			"Example: record_convert source.rec 0 0\n"
+			"Times are server times in milliseconds as shown by record_scan\n");
+		return; }
+
+	Com_sprintf(path, sizeof(path), "records/%s", Cmd_Argv(1));
+	COM_DefaultExtension(path, sizeof(path), ".rec");
+	if(strstr(path, "..")) {
+		record_printf(RP_ALL, "Invalid path\n");
+		return; }
+
+	record_convert_file(path, "demos/output", atoi(Cmd_Argv(2)), atoi(Cmd_Argv(3)), atoi(Cmd_Argv(4)), atoi(Cmd_Argv(5))); }
+
+/* ******************************************************************************** */
+// Batch Conversion
+/* ******************************************************************************** */
+
+// Converts every session in a record file with a single pass over the stream. Each decoded
+// command is passed to a conversion handler for every client currently in the world.
+
+// Filesystem handles are limited, so cap the number of demos being written at once
+#define RECORD_CONVERT_MAX_WRITERS 32
+
+typedef struct {
+	record_stream_reader_t rsr;
+	const char *output_base;
+	record_entityset_t baselines;
+	record_conversion_handler_t *handlers[256];
+	int instance_counts[256];
+	int active_writers;
+	int demo_count;
+	int skipped_count;
+} record_batch_conversion_t;
+
+static void batch_finish_handler(record_batch_conversion_t *rbc, int clientNum) {
+	record_conversion_handler_t *rch = rbc->handlers[clientNum];
+	if(!rch) return;
+	if(rch->state == CSTATE_CONVERTING) {
+		record_printf(RP_ALL, "client(%i): failed to reach disconnect marker; demo may be incomplete\n", clientNum); }
+	close_demo_writer(&rch->rdw);
+	record_free(rch);
+	rbc->handlers[clientNum] = 0;
+	--rbc->active_writers; }
+
+static void batch_start_handler(record_batch_conversion_t *rbc, int clientNum) {
+	// Called on client enter world event to start a new output demo
+	int instance = rbc->instance_counts[clientNum]++;
+	char output_path[MAX_OSPATH];
+	record_conversion_handler_t *rch;
+
+	// Shouldn't normally happen, but finish any existing demo for this client
+	batch_finish_handler(rbc, clientNum);
+
+	if(rbc->active_writers >= RECORD_CONVERT_MAX_WRITERS) {
+		record_printf(RP_ALL, "client(%i) instance(%i): too many simultaneous demos; skipping\n", clientNum, instance);
+		++rbc->skipped_count;
+		return; }
+
+	Com_sprintf(output_path, sizeof(output_path), "%s_%i_%i.%s", rbc->output_base, clientNum, instance,
+			conversion_output_extension());
+
+	rch = record_calloc(sizeof(*rch));
+	rch->clientNum = clientNum;
+	if(!initialize_demo_writer(&rch->rdw, output_path, record_convert_legacy_protocol->integer ? qtrue : qfalse)) {
+		record_free(rch);
+		++rbc->skipped_count;
+		return; }
+
+	record_printf(RP_ALL, "client(%i) instance(%i) time(%i): writing %s\n", clientNum, instance,
+			rbc->rsr.time, output_path);
+	rbc->handlers[clientNum] = rch;
+	++rbc->active_writers;
+	++rbc->demo_count; }
+
+static void process_stream_batch_conversion(record_batch_conversion_t *rbc) {
+	record_stream_reader_t *rsr = &rbc->rsr;
+	int max_clients = rsr->rs->max_clients;
+	int i;
+
+	rsr->stream.abort_set = qtrue;
+	if(setjmp(rsr->stream.abort)) return;
+
+	while(advance_stream_reader(rsr)) {
+		if(rsr->command == RC_EVENT_BASELINES) rbc->baselines = rsr->rs->entities;
+		if(rsr->command == RC_EVENT_CLIENT_ENTER_WORLD) batch_start_handler(rbc, rsr->clientNum);
+
+		// Pass the command to every demo currently being written
+		for(i=0; i<max_clients; ++i) {
+			record_conversion_handler_t *rch = rbc->handlers[i];
+			if(!rch) continue;
+			conversion_handle_event(rch, rsr, &rbc->baselines);
+			if(rch->state == CSTATE_FINISHED) batch_finish_handler(rbc, i); } }
+
+	rsr->stream.abort_set = qfalse; }
+
+int record_convert_file_all(const char *path, const char *output_base) {
+	// Writes demo for each client session to output_base plus "_<client>_<instance>" and demo extension
+	// Returns number of demos written
+	record_batch_conversion_t *rbc = record_calloc(sizeof(*rbc));
+	int demo_count;
+	int i;
+
+	if(!initialize_record_stream_reader(&rbc->rsr, path)) {
+		record_free(rbc);
+		return 0; }
+
+	rbc->output_base = output_base;
+	process_stream_batch_conversion(rbc);
+
+	for(i=0; i<ARRAY_LEN(rbc->handlers); ++i) batch_finish_handler(rbc, i);
+	record_printf(RP_ALL, "%i demos written", rbc->demo_count);
+	if(rbc->skipped_count) record_printf(RP_ALL, ", %i sessions skipped", rbc->skipped_count);
+	record_printf(RP_ALL, "\n");
+
+	demo_count = rbc->demo_count;
+	close_record_stream_reader(&rbc->rsr);
+	record_free(rbc);
+	return demo_count; }
+
+void record_convert_all_cmd(void) {
+	char path[128];
+
+	if(Cmd_Argc() < 2) {
+		record_printf(RP_ALL, "Usage: record_convert_all <path within 'records' directory>\n"
+			"Example: record_convert_all source.rec\n"
+			"Writes a demo for every client session in the record file\n");
 		return; }
 
 	Com_sprintf(path, sizeof(path), "records/%s", Cmd_Argv(1));
@@ -404,7 +568,7 @@ void record_convert_cmd(void) {
 		record_printf(RP_ALL, "Invalid path\n");
 		return; }
 
-	run_conversion(path, atoi(Cmd_Argv(2)), atoi(Cmd_Argv(3))); }
+	record_convert_file_all(path, "demos/output"); }
 
 /* ******************************************************************************** */
 // Record Scanning
@@ -421,8 +585,8 @@ static void process_stream_scan(record_stream_reader_t *rsr) {
 	while(advance_stream_reader(rsr)) {
 		switch(rsr->command) {
 			case RC_EVENT_CLIENT_ENTER_WORLD:
-				record_printf(RP_ALL, "client(%i) instance(%i)\n", rsr->clientNum,
-						instance_counts[rsr->clientNum]);
+				record_printf(RP_ALL, "client(%i) instance(%i) time(%i)\n", rsr->clientNum,
+						instance_counts[rsr->clientNum], rsr->time);
 				++instance_counts[rsr->clientNum];
 				break;
 			default:
@@ -430,7 +594,7 @@ static void process_stream_scan(record_stream_reader_t *rsr) {
 
 	rsr->stream.abort_set = qfalse; }
 
-static void run_scan(const char *path) {
+void record_scan_file(const char *path) {
 	record_stream_reader_t *rsr = record_calloc(sizeof(*rsr));
 
 	if(!initialize_record_stream_reader(rsr, path)) {
@@ -438,6 +602,10 @@ static void run_scan(const char *path) {
 		return; }
 
 	process_stream_scan(rsr);
+	{	record_file_index_t *index = record_file_reader_index(&rsr->stream);
+		if(index && index->keyframe_count) {
+			record_printf(RP_ALL, "%i keyframes indexed (time %i to %i)\n", index->keyframe_count,
+					index->keyframes[0].time, index->keyframes[index->keyframe_count - 1].time); } }
 
 	close_record_stream_reader(rsr);
 	record_free(rsr); }
@@ -456,6 +624,738 @@ void record_scan_cmd(void) {
 		record_printf(RP_ALL, "Invalid path\n");
 		return; }
 
-	run_scan(path); }
+	record_scan_file(path); }
+
+/* ******************************************************************************** */
+// Event Index
+/* ******************************************************************************** */
+
+// Indexes notable game events in a record file, so clips around them can be converted
+// without searching the recording by hand. The index is written next to the record file
+// with the extension replaced by .evi.
+
+#define RECORD_EVENT_INDEX_MAGIC 0x58495645	// "EVIX"
+#define RECORD_EVENT_INDEX_VERSION 1
+
+typedef enum {
+	REV_DEATH,			// Player health dropped to zero
+	REV_FRAG,			// Player score increased
+	REV_FLAG,			// Flag print message; client is the player named in the message, if any
+	REV_TEAM_SCORE,		// Team score configstring increased
+	REV_COUNT
+} record_event_type_t;
+
+static const char *record_event_names[REV_COUNT] = {"death", "frag", "flag", "teamscore"};
+
+typedef struct {
+	int time;
+	int value;					// New score for frag and team score events
+	unsigned char type;
+	unsigned char clientNum;	// 255 if not associated with a client
+	unsigned short instance;
+} record_event_t;
+
+typedef struct {
+	record_stream_reader_t rsr;
+	int instance_counts[256];
+	char active_clients[256];
+	int health[256];
+	int score[256];
+	qboolean tracking[256];		// Health and score have been initialized for client
+	int team_scores[2];
+	int last_flag_time;
+	unsigned int last_flag_hash;
+
+	record_event_t *events;
+	int event_count;
+	int event_capacity;
+} record_event_scan_t;
+
+static void event_scan_add(record_event_scan_t *res, record_event_type_t type, int clientNum, int value) {
+	record_event_t *event;
+	if(res->event_count >= res->event_capacity) {
+		record_event_t *old_events = res->events;
+		res->event_capacity = res->event_capacity ? res->event_capacity * 2 : 256;
+		res->events = record_calloc(sizeof(*res->events) * res->event_capacity);
+		if(old_events) {
+			Com_Memcpy(res->events, old_events, sizeof(*res->events) * res->event_count);
+			record_free(old_events); } }
+
+	event = &res->events[res->event_count++];
+	event->time = res->rsr.time;
+	event->value = value;
+	event->type = type;
+	event->clientNum = clientNum >= 0 ? clientNum : 255;
+	event->instance = clientNum >= 0 && res->instance_counts[clientNum] > 0 ? res->instance_counts[clientNum] - 1 : 0; }
+
+static void event_scan_snapshot(record_event_scan_t *res) {
+	// Checks playerstates of active clients for deaths and score changes
+	record_state_t *rs = res->rsr.rs;
+	int i;
+	for(i=0; i<rs->max_clients; ++i) {
+		playerState_t *ps = &rs->clients[i].playerstate;
+		int health = ps->stats[0];		// 0=STAT_HEALTH
+		int score = ps->persistant[0];	// 0=PERS_SCORE
+
+		// Spectators have the playerstate of the client they are following
+		if(!res->active_clients[i] || playerstate_is_spectator(ps)) {
+			res->tracking[i] = qfalse;
+			continue; }
+
+		if(res->tracking[i]) {
+			if(res->health[i] > 0 && health <= 0) event_scan_add(res, REV_DEATH, i, 0);
+			if(score > res->score[i]) event_scan_add(res, REV_FRAG, i, score); }
+
+		res->health[i] = health;
+		res->score[i] = score;
+		res->tracking[i] = qtrue; } }
+
+static int event_scan_named_client(record_event_scan_t *res, const char *text) {
+	// Returns the active client with the longest name contained in text, or -1 if none
+	int best_client = -1;
+	int best_length = 0;
+	int i;
+	for(i=0; i<res->rsr.rs->max_clients && i<MAX_CLIENTS; ++i) {
+		const char *name;
+		int length;
+		if(!res->active_clients[i]) continue;
+		name = Info_ValueForKey(res->rsr.rs->configstrings[CS_PLAYERS + i], "n");
+		length = strlen(name);
+		if(length > best_length && strstr(text, name)) {
+			best_client = i;
+			best_length = length; } }
+	return best_client; }
+
+static void event_scan_servercmd(record_event_scan_t *res) {
+	// Checks for flag messages
+	const char *cmd = res->rsr.rs->current_servercmd;
+	unsigned int hash = 0;
+	const char *current;
+
+	if(Q_stricmpn(cmd, "print ", 6) && Q_stricmpn(cmd, "cp ", 3)) return;
+	if(!Q_stristr(cmd, "flag")) return;
+
+	// Broadcast messages are recorded once for each client, so skip duplicates
+	for(current=cmd; *current; ++current) hash = hash * 31 + (unsigned char)*current;
+	if(res->event_count && res->last_flag_time == res->rsr.time && res->last_flag_hash == hash) return;
+	res->last_flag_time = res->rsr.time;
+	res->last_flag_hash = hash;
+
+	event_scan_add(res, REV_FLAG, event_scan_named_client(res, cmd), 0); }
+
+static void event_scan_configstring(record_event_scan_t *res) {
+	// Checks for team score increases
+	int index = res->rsr.configstring_index;
+	int score;
+	if(index != CS_SCORES1 && index != CS_SCORES2) return;
+
+	score = atoi(res->rsr.rs->configstrings[index]);
+	if(score > res->team_scores[index - CS_SCORES1]) {
+		event_scan_add(res, REV_TEAM_SCORE, -1, score); }
+	res->team_scores[index - CS_SCORES1] = score; }
+
+static qboolean process_stream_event_scan(record_event_scan_t *res) {
+	// Returns qtrue if stream was read to the end, qfalse on stream error
+	record_stream_reader_t *rsr = &res->rsr;
+
+	rsr->stream.abort_set = qtrue;
+	if(setjmp(rsr->stream.abort)) return qfalse;
+
+	while(advance_stream_reader(rsr)) {
+		switch(rsr->command) {
+			case RC_EVENT_SNAPSHOT:
+				event_scan_snapshot(res);
+				break;
+			case RC_EVENT_SERVERCMD:
+				event_scan_servercmd(res);
+				break;
+			case RC_STATE_CONFIGSTRING:
+				event_scan_configstring(res);
+				break;
+			case RC_EVENT_CLIENT_ENTER_WORLD:
+				res->active_clients[rsr->clientNum] = 1;
+				res->tracking[rsr->clientNum] = qfalse;
+				++res->instance_counts[rsr->clientNum];
+				break;
+			case RC_EVENT_CLIENT_DISCONNECT:
+				res->active_clients[rsr->clientNum] = 0;
+				break;
+			case RC_EVENT_KEYFRAME:
+				Com_Memcpy(res->active_clients, rsr->keyframe_active, sizeof(res->active_clients));
+				Com_Memcpy(res->instance_counts, rsr->keyframe_instances, sizeof(res->instance_counts));
+				break;
+			default:
+				break; } }
+
+	rsr->stream.abort_set = qfalse;
+	return record_stream_read_available(1, &rsr->stream) ? qfalse : qtrue; }
+
+static void get_event_index_path(const char *path, char *output, int output_size) {
+	COM_StripExtension(path, output, output_size);
+	Q_strcat(output, output_size, ".evi"); }
+
+static qboolean write_event_index(const char *path, record_event_t *events, int event_count) {
+	// Returns qtrue on success, qfalse on error
+	char index_path[MAX_OSPATH];
+	int header[3] = {RECORD_EVENT_INDEX_MAGIC, RECORD_EVENT_INDEX_VERSION, event_count};
+	fileHandle_t fp;
+
+	get_event_index_path(path, index_path, sizeof(index_path));
+	fp = FS_SV_FOpenFileWrite(index_path);
+	if(!fp) {
+		record_printf(RP_ALL, "write_event_index: failed to open %s\n", index_path);
+		return qfalse; }
+	FS_Write(header, sizeof(header), fp);
+	if(event_count) FS_Write(events, sizeof(*events) * event_count, fp);
+	FS_FCloseFile(fp);
+	return qtrue; }
+
+static record_event_t *load_event_index(const char *path, int *event_count_out) {
+	// Returns events on success, which need to be freed by record_free, or null on error
+	char index_path[MAX_OSPATH];
+	int header[3];
+	record_event_t *events;
+	fileHandle_t fp;
+	long length;
+
+	get_event_index_path(path, index_path, sizeof(index_path));
+	length = FS_SV_FOpenFileRead(index_path, &fp);
+	if(!fp) return 0;
+
+	if(length < (long)sizeof(header) || FS_Read(header, sizeof(header), fp) != sizeof(header) ||
+			header[0] != RECORD_EVENT_INDEX_MAGIC || header[1] != RECORD_EVENT_INDEX_VERSION || header[2] < 0 ||
+			length != (long)(sizeof(header) + sizeof(*events) * header[2])) {
+		record_printf(RP_ALL, "load_event_index: invalid index file %s\n", index_path);
+		FS_FCloseFile(fp);
+		return 0; }
+
+	events = record_calloc(sizeof(*events) * header[2] + 1);
+	FS_Read(events, sizeof(*events) * header[2], fp);
+	FS_FCloseFile(fp);
+	*event_count_out = header[2];
+	return events; }
+
+int record_index_file(const char *path) {
+	// Scans record file and writes event index
+	// Returns number of events indexed, or -1 on error
+	record_event_scan_t *res = record_calloc(sizeof(*res));
+	int counts[REV_COUNT];
+	int result;
+	int i;
+
+	if(!initialize_record_stream_reader(&res->rsr, path)) {
+		record_free(res);
+		return -1; }
+
+	if(!process_stream_event_scan(res)) record_printf(RP_ALL, "record stream is invalid or truncated; indexing valid part\n");
+
+	Com_Memset(counts, 0, sizeof(counts));
+	for(i=0; i<res->event_count; ++i) ++counts[res->events[i].type];
+	for(i=0; i<REV_COUNT; ++i) record_printf(RP_ALL, "%s events: %i\n", record_event_names[i], counts[i]);
+
+	result = write_event_index(path, res->events, res->event_count) ? res->event_count : -1;
+
+	close_record_stream_reader(&res->rsr);
+	if(res->events) record_free(res->events);
+	record_free(res);
+	return result; }
+
+int record_parse_event_types(const char *names) {
+	// Converts comma separated event type names to a bitmask, or returns -1 on invalid name
+	char buffer[256];
+	char *current = buffer;
+	int mask = 0;
+
+	Q_strncpyz(buffer, names, sizeof(buffer));
+	while(current) {
+		char *next = strchr(current, ',');
+		int i;
+		if(next) *(next++) = 0;
+
+		if(!Q_stricmp(current, "all")) {
+			mask = (1 << REV_COUNT) - 1; }
+		else {
+			for(i=0; i<REV_COUNT; ++i) {
+				if(!Q_stricmp(current, record_event_names[i])) break; }
+			if(i >= REV_COUNT) return -1;
+			mask |= 1 << i; }
+		current = next; }
+
+	return mask; }
+
+int record_clip_file(const char *path, const char *output_base, int event_types, int time_before, int time_after) {
+	// Converts a demo of the window around each selected event, from the view of the client involved
+	// Nearby events for the same client session are merged into one clip
+	// Returns number of clips written
+	record_event_t *events;
+	int event_count = 0;
+	int clip_count = 0;
+	int i, j;
+
+	events = load_event_index(path, &event_count);
+	if(!events) {
+		if(record_index_file(path) < 0) return 0;
+		events = load_event_index(path, &event_count);
+		if(!events) return 0; }
+
+	for(i=0; i<event_count; ++i) {
+		record_event_t *event = &events[i];
+		char clip_base[MAX_OSPATH];
+		int end_time;
+		if(!(event_types & (1 << event->type)) || event->clientNum == 255) continue;
+
+		// Extend clip over following events in the same session
+		end_time = event->time + time_after;
+		for(j=i+1; j<event_count && events[j].time - time_before <= end_time; ++j) {
+			if(!(event_types & (1 << events[j].type)) || events[j].clientNum != event->clientNum ||
+					events[j].instance != event->instance) continue;
+			end_time = events[j].time + time_after;
+			events[j].clientNum = 255; }
+
+		Com_sprintf(clip_base, sizeof(clip_base), "%s_%s_%i_%i", output_base, record_event_names[event->type],
+				event->clientNum, event->time);
+		record_printf(RP_ALL, "%s event for client %i at time %i\n", record_event_names[event->type],
+				event->clientNum, event->time);
+		if(record_convert_file(path, clip_base, event->clientNum, event->instance,
+				event->time - time_before > 0 ? event->time - time_before : 0, end_time)) ++clip_count; }
+
+	record_printf(RP_ALL, "%i clips written\n", clip_count);
+	record_free(events);
+	return clip_count; }
+
+void record_index_cmd(void) {
+	char path[128];
+
+	if(Cmd_Argc() < 2) {
+		record_printf(RP_ALL, "Usage: record_index <path within 'records' directory>\n"
+			"Example: record_index source.rec\n");
+		return; }
+
+	Com_sprintf(path, sizeof(path), "records/%s", Cmd_Argv(1));
+	COM_DefaultExtension(path, sizeof(path), ".rec");
+	if(strstr(path, "..")) {
+		record_printf(RP_ALL, "Invalid path\n");
+		return; }
+
+	record_index_file(path); }
+
+void record_clip_cmd(void) {
+	char path[128];
+	int event_types;
+
+	if(Cmd_Argc() < 3) {
+		record_printf(RP_ALL, "Usage: record_clip <path within 'records' directory> <event types> [seconds before] [seconds after]\n"
+			"Example: record_clip source.rec frag,flag 5 3\n"
+			"Event types: death, frag, flag, teamscore, all\n");
+		return; }
+
+	Com_sprintf(path, sizeof(path), "records/%s", Cmd_Argv(1));
+	COM_DefaultExtension(path, sizeof(path), ".rec");
+	if(strstr(path, "..")) {
+		record_printf(RP_ALL, "Invalid path\n");
+		return; }
+
+	event_types = record_parse_event_types(Cmd_Argv(2));
+	if(event_types < 0) {
+		record_printf(RP_ALL, "Invalid event type\n");
+		return; }
+
+	record_clip_file(path, "demos/clip", event_types, Cmd_Argc() >= 4 ? atoi(Cmd_Argv(3)) * 1000 : 5000,
+			Cmd_Argc() >= 5 ? atoi(Cmd_Argv(4)) * 1000 : 3000); }
+
+/* ******************************************************************************** */
+// Record Verification
+/* ******************************************************************************** */
+
+typedef struct {
+	int command_count;
+	int snapshot_count;
+	int keyframe_count;
+	int session_count;
+	int first_time;
+	int last_time;
+	qboolean time_error;
+	qboolean index_error;
+	qboolean stream_error;
+} record_verify_stats_t;
+
+static void process_stream_verify(record_stream_reader_t *rsr, record_verify_stats_t *stats) {
+	record_file_index_t *index = record_file_reader_index(&rsr->stream);
+
+	rsr->stream.abort_set = qtrue;
+	if(setjmp(rsr->stream.abort)) {
+		stats->stream_error = qtrue;
+		return; }
+
+	while(advance_stream_reader(rsr)) {
+		++stats->command_count;
+		switch(rsr->command) {
+			case RC_EVENT_SNAPSHOT:
+				if(stats->snapshot_count && rsr->time < stats->last_time) {
+					if(!stats->time_error) record_printf(RP_ALL, "snapshot time went backwards at time %i\n", rsr->time);
+					stats->time_error = qtrue; }
+				if(!stats->snapshot_count) stats->first_time = rsr->time;
+				stats->last_time = rsr->time;
+				++stats->snapshot_count;
+				break;
+			case RC_EVENT_CLIENT_ENTER_WORLD:
+				++stats->session_count;
+				break;
+			case RC_EVENT_KEYFRAME:
+				// Keyframes should match the file index, if present
+				if(index && index->keyframe_count && (stats->keyframe_count >= index->keyframe_count ||
+						index->keyframes[stats->keyframe_count].time != rsr->time)) {
+					if(!stats->index_error) record_printf(RP_ALL, "keyframe at time %i doesn't match index\n", rsr->time);
+					stats->index_error = qtrue; }
+				++stats->keyframe_count;
+				break;
+			default:
+				break; } }
+
+	// Reader should only stop at the end of the stream
+	if(record_stream_read_available(1, &rsr->stream)) stats->stream_error = qtrue;
+	if(index && index->keyframe_count && index->keyframe_count != stats->keyframe_count) stats->index_error = qtrue;
+
+	rsr->stream.abort_set = qfalse; }
+
+qboolean record_verify_file(const char *path) {
+	// Decodes the complete record stream and checks file and stream structure
+	// Returns qtrue if no errors were found, qfalse otherwise
+	record_stream_reader_t *rsr = record_calloc(sizeof(*rsr));
+	record_verify_stats_t stats;
+	qboolean result;
+
+	if(!initialize_record_stream_reader(rsr, path)) {
+		record_free(rsr);
+		return qfalse; }
+
+	Com_Memset(&stats, 0, sizeof(stats));
+	process_stream_verify(rsr, &stats);
+
+	record_printf(RP_ALL, "%i commands, %i snapshots (time %i to %i), %i sessions, %i keyframes\n",
+			stats.command_count, stats.snapshot_count, stats.first_time, stats.last_time, stats.session_count,
+			stats.keyframe_count);
+	if(record_file_reader_error(&rsr->stream)) record_printf(RP_ALL, "file contains invalid or truncated blocks\n");
+	if(stats.stream_error) record_printf(RP_ALL, "record stream is invalid or truncated\n");
+	if(stats.index_error) record_printf(RP_ALL, "keyframe index doesn't match stream\n");
+
+	result = !record_file_reader_error(&rsr->stream) && !stats.stream_error && !stats.index_error &&
+			!stats.time_error ? qtrue : qfalse;
+	record_printf(RP_ALL, "%s: %s\n", path, result ? "ok" : "errors found");
+
+	close_record_stream_reader(rsr);
+	record_free(rsr);
+	return result; }
+
+void record_verify_cmd(void) {
+	char path[128];
+
+	if(Cmd_Argc() < 2) {
+		record_printf(RP_ALL, "Usage: record_verify <path within 'records' directory>\n"
+			"Example: record_verify source.rec\n");
+		return; }
+
+	Com_sprintf(path, sizeof(path), "records/%s", Cmd_Argv(1));
+	COM_DefaultExtension(path, sizeof(path), ".rec");
+	if(strstr(path, "..")) {
+		record_printf(RP_ALL, "Invalid path\n");
+		return; }
+
+	record_verify_file(path); }
+
+/* ******************************************************************************** */
+// Record Benchmark
+/* ******************************************************************************** */
+
+// Replays a record file through the codec and the state encoders to check them against the
+// decoded data and measure throughput, without the live server checks of record_verify_data
+
+#define BENCHMARK_SCRATCH_SIZE (1 << 21)
+
+typedef struct {
+	record_stream_reader_t rsr;
+	record_state_t *encode_state;	// State for re-encoding decoded data
+	record_state_t *decode_state;	// State for decoding re-encoded data
+	record_data_stream_t scratch;
+	char active_clients[256];
+	qboolean keyframe_pending;		// Visibility can't be checked against previous state after a keyframe
+
+	int frame_count;
+	unsigned int raw_bytes;
+	unsigned int recompressed_bytes;
+	int64_t compress_time;
+	int64_t decompress_time;
+	int64_t decode_time;
+	int64_t round_trip_time;
+	int codec_errors;
+	int round_trip_errors;
+	int visibility_errors;
+	unsigned int checksum;
+} record_benchmark_t;
+
+static unsigned int benchmark_hash(unsigned int hash, const void *data, int size) {
+	// FNV-1a
+	const unsigned char *bytes = (const unsigned char *)data;
+	int i;
+	for(i=0; i<size; ++i) {
+		hash = (hash ^ bytes[i]) * 16777619u; }
+	return hash; }
+
+static qboolean benchmark_codec_pass(record_benchmark_t *rb, const char *path) {
+	// Recompresses the raw stream in file block sized chunks and checks it decompresses to the same data
+	// Returns qtrue on success, qfalse if file couldn't be opened
+	record_data_stream_t stream;
+	char *compressed = record_calloc(RECORD_BLOCK_BOUND(RECORD_FILE_BLOCK_SIZE));
+	char *decompressed = record_calloc(RECORD_FILE_BLOCK_SIZE);
+
+	if(!record_file_reader_open(path, &stream)) {
+		record_free(compressed);
+		record_free(decompressed);
+		return qfalse; }
+
+	while(1) {
+		int length, compressed_length;
+		int64_t start;
+
+		record_file_reader_refill(&stream, RECORD_FILE_BLOCK_SIZE);
+		length = stream.size - stream.position;
+		if(length > RECORD_FILE_BLOCK_SIZE) length = RECORD_FILE_BLOCK_SIZE;
+		if(length <= 0) break;
+
+		start = Sys_Microseconds();
+		compressed_length = record_compress_block(stream.data + stream.position, length, compressed,
+				RECORD_BLOCK_BOUND(RECORD_FILE_BLOCK_SIZE));
+		rb->compress_time += Sys_Microseconds() - start;
+
+		if(compressed_length > 0) {
+			start = Sys_Microseconds();
+			if(record_decompress_block(compressed, compressed_length, decompressed, length) != length ||
+					memcmp(decompressed, stream.data + stream.position, length)) {
+				++rb->codec_errors; }
+			rb->decompress_time += Sys_Microseconds() - start;
+			rb->recompressed_bytes += compressed_length; }
+		else {
+			// Incompressible block; stored raw in files
+			rb->recompressed_bytes += length; }
+
+		rb->raw_bytes += length;
+		stream.position += length; }
+
+	record_file_reader_close(&stream);
+	record_free(compressed);
+	record_free(decompressed);
+	return qtrue; }
+
+static void benchmark_reset_scratch(record_benchmark_t *rb) {
+	rb->scratch.position = 0;
+	rb->scratch.size = BENCHMARK_SCRATCH_SIZE; }
+
+static record_data_stream_t benchmark_scratch_reader(record_benchmark_t *rb) {
+	// Returns stream for decoding the data just encoded to scratch
+	record_data_stream_t stream = rb->scratch;
+	stream.size = stream.position;
+	stream.position = 0;
+	return stream; }
+
+static qboolean benchmark_entityset_differs(record_entityset_t *state1, record_entityset_t *state2) {
+	int i;
+	if(memcmp(state1->active_flags, state2->active_flags, sizeof(state1->active_flags))) return qtrue;
+	for(i=0; i<MAX_GENTITIES; ++i) {
+		if(!record_bit_get(state1->active_flags, i)) continue;
+		if(memcmp(&state1->entities[i], &state2->entities[i], sizeof(state1->entities[i]))) return qtrue; }
+	return qfalse; }
+
+static void benchmark_check_visibility(record_benchmark_t *rb, record_visibility_state_t *old_visibility,
+		record_visibility_state_t *visibility) {
+	// Writer visibility is adjusted by record_tweak_inactive_visibility, so inactive entities should
+	// keep their previous visibility bits
+	record_entityset_t *entities = &rb->rsr.rs->entities;
+	int i;
+	if(visibility->area_visibility_size < 0 || visibility->area_visibility_size > sizeof(visibility->area_visibility)) {
+		++rb->visibility_errors;
+		return; }
+	if(rb->keyframe_pending) return;
+	for(i=0; i<(MAX_GENTITIES+31)/32; ++i) {
+		if((visibility->ent_visibility[i] & ~entities->active_flags[i]) !=
+				(old_visibility->ent_visibility[i] & ~entities->active_flags[i])) {
+			++rb->visibility_errors;
+			return; } } }
+
+static void benchmark_round_trip(record_benchmark_t *rb) {
+	// Re-encodes the state changed by the current command and decodes it into a separate state,
+	// which should match the state decoded from the file
+	record_stream_reader_t *rsr = &rb->rsr;
+	record_data_stream_t stream;
+	int clientNum = rsr->clientNum;
+	qboolean error = qfalse;
+	int64_t start = Sys_Microseconds();
+
+	benchmark_reset_scratch(rb);
+	rb->scratch.abort_set = qtrue;
+	if(setjmp(rb->scratch.abort)) {
+		// Re-encoded data couldn't be decoded
+		++rb->round_trip_errors;
+		return; }
+
+	switch(rsr->command) {
+		case RC_STATE_ENTITY_SET:
+			record_encode_entityset(&rb->encode_state->entities, &rsr->rs->entities, &rb->scratch);
+			stream = benchmark_scratch_reader(rb);
+			record_decode_entityset(&rb->decode_state->entities, &stream);
+			error = benchmark_entityset_differs(&rb->decode_state->entities, &rsr->rs->entities);
+			break;
+		case RC_STATE_PLAYERSTATE:
+			record_encode_playerstate(&rb->encode_state->clients[clientNum].playerstate,
+					&rsr->rs->clients[clientNum].playerstate, &rb->scratch);
+			stream = benchmark_scratch_reader(rb);
+			record_decode_playerstate(&rb->decode_state->clients[clientNum].playerstate, &stream);
+			error = memcmp(&rb->decode_state->clients[clientNum].playerstate, &rsr->rs->clients[clientNum].playerstate,
+					sizeof(playerState_t)) ? qtrue : qfalse;
+			break;
+		case RC_STATE_VISIBILITY:
+			benchmark_check_visibility(rb, &rb->encode_state->clients[clientNum].visibility,
+					&rsr->rs->clients[clientNum].visibility);
+			record_encode_visibility_state(&rb->encode_state->clients[clientNum].visibility,
+					&rsr->rs->clients[clientNum].visibility, &rb->scratch);
+			stream = benchmark_scratch_reader(rb);
+			record_decode_visibility_state(&rb->decode_state->clients[clientNum].visibility, &stream);
+			error = memcmp(&rb->decode_state->clients[clientNum].visibility, &rsr->rs->clients[clientNum].visibility,
+					sizeof(record_visibility_state_t)) ? qtrue : qfalse;
+			break;
+		case RC_STATE_USERCMD:
+			record_encode_usercmd(&rb->encode_state->clients[clientNum].usercmd,
+					&rsr->rs->clients[clientNum].usercmd, &rb->scratch);
+			stream = benchmark_scratch_reader(rb);
+			record_decode_usercmd(&rb->decode_state->clients[clientNum].usercmd, &stream);
+			error = memcmp(&rb->decode_state->clients[clientNum].usercmd, &rsr->rs->clients[clientNum].usercmd,
+					sizeof(record_usercmd_t)) ? qtrue : qfalse;
+			break;
+		default:
+			rb->scratch.abort_set = qfalse;
+			return; }
+
+	rb->scratch.abort_set = qfalse;
+	if(error || stream.position != stream.size) ++rb->round_trip_errors;
+	rb->round_trip_time += Sys_Microseconds() - start; }
+
+static void benchmark_snapshot_checksum(record_benchmark_t *rb) {
+	// Adds decoded snapshot state to the file checksum
+	record_state_t *rs = rb->rsr.rs;
+	int i;
+	rb->checksum = benchmark_hash(rb->checksum, &rb->rsr.time, sizeof(rb->rsr.time));
+	rb->checksum = benchmark_hash(rb->checksum, rs->entities.active_flags, sizeof(rs->entities.active_flags));
+	for(i=0; i<MAX_GENTITIES; ++i) {
+		if(!record_bit_get(rs->entities.active_flags, i)) continue;
+		rb->checksum = benchmark_hash(rb->checksum, &rs->entities.entities[i], sizeof(rs->entities.entities[i])); }
+	for(i=0; i<rs->max_clients; ++i) {
+		if(!rb->active_clients[i]) continue;
+		rb->checksum = benchmark_hash(rb->checksum, &rs->clients[i].playerstate, sizeof(rs->clients[i].playerstate));
+		rb->checksum = benchmark_hash(rb->checksum, &rs->clients[i].visibility, sizeof(rs->clients[i].visibility)); } }
+
+static qboolean process_stream_benchmark(record_benchmark_t *rb) {
+	// Returns qtrue if the stream was decoded to the end, qfalse on stream error
+	record_stream_reader_t *rsr = &rb->rsr;
+
+	rsr->stream.abort_set = qtrue;
+	if(setjmp(rsr->stream.abort)) return qfalse;
+
+	while(1) {
+		int64_t start = Sys_Microseconds();
+		qboolean have_command = advance_stream_reader(rsr);
+		rb->decode_time += Sys_Microseconds() - start;
+		if(!have_command) break;
+
+		benchmark_round_trip(rb);
+
+		switch(rsr->command) {
+			case RC_EVENT_SNAPSHOT:
+				benchmark_snapshot_checksum(rb);
+				rb->keyframe_pending = qfalse;
+				++rb->frame_count;
+				break;
+			case RC_EVENT_CLIENT_ENTER_WORLD:
+				rb->active_clients[rsr->clientNum] = 1;
+				break;
+			case RC_EVENT_CLIENT_DISCONNECT:
+				rb->active_clients[rsr->clientNum] = 0;
+				break;
+			case RC_EVENT_KEYFRAME:
+				Com_Memcpy(rb->active_clients, rsr->keyframe_active, sizeof(rb->active_clients));
+				rb->keyframe_pending = qtrue;
+				break;
+			default:
+				break; } }
+
+	rsr->stream.abort_set = qfalse;
+	return record_stream_read_available(1, &rsr->stream) ? qfalse : qtrue; }
+
+static double benchmark_rate(double amount, int64_t usec) {
+	return usec > 0 ? amount * 1000000.0 / (double)usec : 0.0; }
+
+qboolean record_benchmark_file(const char *path, unsigned int *checksum_out) {
+	// Runs codec and state encoding round trips on a record file and prints throughput
+	// Returns qtrue if no errors were found, qfalse otherwise
+	record_benchmark_t *rb = record_calloc(sizeof(*rb));
+	double megabytes;
+	qboolean stream_ok;
+	qboolean result;
+
+	if(!benchmark_codec_pass(rb, path) || !initialize_record_stream_reader(&rb->rsr, path)) {
+		record_free(rb);
+		return qfalse; }
+
+	rb->encode_state = allocate_record_state(rb->rsr.rs->max_clients);
+	rb->decode_state = allocate_record_state(rb->rsr.rs->max_clients);
+	rb->scratch.data = record_calloc(BENCHMARK_SCRATCH_SIZE);
+	rb->checksum = 2166136261u;
+
+	stream_ok = process_stream_benchmark(rb);
+	megabytes = (double)rb->raw_bytes / (1024.0 * 1024.0);
+
+	record_printf(RP_ALL, "%i frames, %.2f MB record stream, %.2f MB recompressed\n", rb->frame_count, megabytes,
+			(double)rb->recompressed_bytes / (1024.0 * 1024.0));
+	record_printf(RP_ALL, "decode: %.0f frames/s, %.1f MB/s\n", benchmark_rate(rb->frame_count, rb->decode_time),
+			benchmark_rate(megabytes, rb->decode_time));
+	record_printf(RP_ALL, "round trip: %.0f frames/s, %.1f MB/s\n", benchmark_rate(rb->frame_count, rb->round_trip_time),
+			benchmark_rate(megabytes, rb->round_trip_time));
+	record_printf(RP_ALL, "codec: compress %.1f MB/s, decompress %.1f MB/s\n", benchmark_rate(megabytes, rb->compress_time),
+			benchmark_rate(megabytes, rb->decompress_time));
+	if(!stream_ok) record_printf(RP_ALL, "record stream is invalid or truncated\n");
+	if(rb->codec_errors) record_printf(RP_ALL, "%i codec round trip errors\n", rb->codec_errors);
+	if(rb->round_trip_errors) record_printf(RP_ALL, "%i state round trip errors\n", rb->round_trip_errors);
+	if(rb->visibility_errors) record_printf(RP_ALL, "%i visibility errors\n", rb->visibility_errors);
+	record_printf(RP_ALL, "checksum: %08x\n", rb->checksum);
+
+	result = stream_ok && !rb->codec_errors && !rb->round_trip_errors && !rb->visibility_errors ? qtrue : qfalse;
+	if(checksum_out) *checksum_out = rb->checksum;
+
+	close_record_stream_reader(&rb->rsr);
+	free_record_state(rb->encode_state);
+	free_record_state(rb->decode_state);
+	record_free(rb->scratch.data);
+	record_free(rb);
+	return result; }
+
+void record_benchmark_cmd(void) {
+	char path[128];
+	unsigned int checksum;
+	qboolean result;
+
+	if(Cmd_Argc() < 2) {
+		record_printf(RP_ALL, "Usage: record_benchmark <path within 'records' directory> [expected checksum]\n"
+			"Example: record_benchmark source.rec 1a2b3c4d\n");
+		return; }
+
+	Com_sprintf(path, sizeof(path), "records/%s", Cmd_Argv(1));
+	COM_DefaultExtension(path, sizeof(path), ".rec");
+	if(strstr(path, "..")) {
+		record_printf(RP_ALL, "Invalid path\n");
+		return; }
+
+	result = record_benchmark_file(path, &checksum);
+	if(Cmd_Argc() >= 3 && strtoul(Cmd_Argv(2), 0, 16) != checksum) {
+		record_printf(RP_ALL, "checksum mismatch (expected %s)\n", Cmd_Argv(2));
+		result = qfalse; }
+	record_printf(RP_ALL, "%s: %s\n", path, result ? "ok" : "errors found"); }
 
 #endif
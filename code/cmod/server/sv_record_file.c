@@ -0,0 +1,691 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+Copyright (C) 2017 Noah Metzger (chomenor@gmail.com)
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+#ifdef CMOD_RECORD
+#include "sv_record_local.h"
+
+// Record files consist of a header (RECORD_FILE_MAGIC, RECORD_FILE_VERSION) followed by
+// blocks of the raw record stream. Each block is prefixed by its raw size and stored size,
+// and is compressed if the stored size is smaller than the raw size.
+
+// Version 2 files start a new block at each keyframe and end with an index:
+// RECORD_FILE_INDEX_MARKER, keyframe count, record_keyframe_t entries, then
+// the file offset of the index marker and RECORD_FILE_INDEX_MAGIC.
+
+// Files from before the container format contain the raw record stream directly, which
+// starts with RECORD_PROTOCOL, so they can be distinguished by the first 4 bytes.
+
+/* ******************************************************************************** */
+// Block Compression
+/* ******************************************************************************** */
+
+// Simple LZ77 codec using LZ4-style sequences: a token byte containing literal length and
+// match length nibbles, optional extended lengths, literals, and a 2-byte match offset.
+// The final sequence contains only literals.
+
+#define LZ_HASH_BITS 14
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 65535
+
+static unsigned int lz_hash(const unsigned char *data) {
+	unsigned int value;
+	Com_Memcpy(&value, data, 4);
+	return (value * 2654435761u) >> (32 - LZ_HASH_BITS); }
+
+static unsigned char *lz_write_length(unsigned char *output, int length) {
+	while(length >= 255) {
+		*output++ = 255;
+		length -= 255; }
+	*output++ = (unsigned char)length;
+	return output; }
+
+static unsigned char *lz_write_sequence(unsigned char *output, const unsigned char *literals, int literal_length,
+			int offset, int match_length) {
+	// Set match_length to 0 for the final literal-only sequence
+	unsigned char *token = output++;
+	*token = (unsigned char)((literal_length < 15 ? literal_length : 15) << 4);
+	if(literal_length >= 15) output = lz_write_length(output, literal_length - 15);
+	Com_Memcpy(output, literals, literal_length);
+	output += literal_length;
+
+	if(match_length) {
+		match_length -= LZ_MIN_MATCH;
+		*token |= (unsigned char)(match_length < 15 ? match_length : 15);
+		*output++ = (unsigned char)(offset & 255);
+		*output++ = (unsigned char)(offset >> 8);
+		if(match_length >= 15) output = lz_write_length(output, match_length - 15); }
+
+	return output; }
+
+int record_compress_block(const char *input, int input_size, char *output, int output_size) {
+	// Returns compressed size, or 0 if the output buffer is too small
+	// Output buffer of RECORD_BLOCK_BOUND(input_size) is always sufficient
+	int table[1 << LZ_HASH_BITS];
+	const unsigned char *base = (const unsigned char *)input;
+	const unsigned char *ip = base;
+	const unsigned char *anchor = base;
+	const unsigned char *end = base + input_size;
+	unsigned char *op = (unsigned char *)output;
+	unsigned char *op_end = op + output_size;
+	int literal_length;
+
+	Com_Memset(table, -1, sizeof(table));
+
+	while(input_size >= LZ_MIN_MATCH && ip <= end - LZ_MIN_MATCH) {
+		unsigned int hash = lz_hash(ip);
+		int ref = table[hash];
+		const unsigned char *match;
+		const unsigned char *scan;
+		int match_length;
+		table[hash] = (int)(ip - base);
+
+		if(ref < 0 || (ip - base) - ref > LZ_MAX_OFFSET || memcmp(base + ref, ip, LZ_MIN_MATCH)) {
+			++ip;
+			continue; }
+
+		// Extend the match
+		match = base + ref + LZ_MIN_MATCH;
+		scan = ip + LZ_MIN_MATCH;
+		while(scan < end && *scan == *match) {
+			++scan;
+			++match; }
+		match_length = (int)(scan - ip);
+		literal_length = (int)(ip - anchor);
+
+		if(op_end - op < 1 + literal_length + literal_length / 255 + 1 + 2 + match_length / 255 + 1) return 0;
+		op = lz_write_sequence(op, anchor, literal_length, (int)(ip - (base + ref)), match_length);
+
+		ip = scan;
+		anchor = ip; }
+
+	// Write remaining literals
+	literal_length = (int)(end - anchor);
+	if(op_end - op < 1 + literal_length + literal_length / 255 + 1) return 0;
+	op = lz_write_sequence(op, anchor, literal_length, 0, 0);
+
+	return (int)(op - (unsigned char *)output); }
+
+static const unsigned char *lz_read_length(const unsigned char *input, const unsigned char *end, int *length) {
+	// Returns null on error
+	unsigned char value;
+	do {
+		if(input >= end) return 0;
+		value = *input++;
+		*length += value;
+	} while(value == 255);
+	return input; }
+
+int record_decompress_block(const char *input, int input_size, char *output, int output_size) {
+	// Returns decompressed size, or -1 on error
+	const unsigned char *ip = (const unsigned char *)input;
+	const unsigned char *ip_end = ip + input_size;
+	unsigned char *op = (unsigned char *)output;
+	unsigned char *op_end = op + output_size;
+
+	while(ip < ip_end) {
+		int token = *ip++;
+		int length = token >> 4;
+		int offset;
+		const unsigned char *match;
+
+		// Literals
+		if(length == 15 && !(ip = lz_read_length(ip, ip_end, &length))) return -1;
+		if(length > ip_end - ip || length > op_end - op) return -1;
+		Com_Memcpy(op, ip, length);
+		op += length;
+		ip += length;
+		if(ip >= ip_end) break;
+
+		// Match
+		if(ip_end - ip < 2) return -1;
+		offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if(!offset || offset > op - (unsigned char *)output) return -1;
+		length = token & 15;
+		if(length == 15 && !(ip = lz_read_length(ip, ip_end, &length))) return -1;
+		length += LZ_MIN_MATCH;
+		if(length > op_end - op) return -1;
+
+		// Byte copy since match can overlap output
+		match = op - offset;
+		while(length--) *op++ = *match++; }
+
+	return (int)(op - (unsigned char *)output); }
+
+// The standalone record tool only reads record files
+#ifndef CMOD_RECORD_TOOL
+
+/* ******************************************************************************** */
+// Asynchronous File Writer
+/* ******************************************************************************** */
+
+// The frame thread copies record stream data into a ring of chunks and submits full chunks
+// to a background thread, which compresses them and writes them to the output file. The
+// output is a raw OS file that only the writer thread touches, since engine file handles
+// are only safe to use from the main thread. The writer thread reports the file offset of
+// each block back through the chunk, so the keyframe index is built on the frame thread
+// and handed to the writer thread to write at close. The frame thread only blocks if the
+// writer falls a full ring behind.
+
+#define RECORD_WRITER_CHUNK_COUNT 8
+
+typedef struct {
+	char data[RECORD_FILE_BLOCK_SIZE];
+	int size;
+
+	// Set if chunk starts with a keyframe
+	qboolean keyframe;
+	int keyframe_time;
+	unsigned int keyframe_raw_offset;
+
+	// Set by the writer thread; size 0 if the block is stored uncompressed
+	char compressed[RECORD_BLOCK_BOUND(RECORD_FILE_BLOCK_SIZE)];
+	int compressed_size;
+	unsigned int file_offset;
+} record_file_chunk_t;
+
+struct record_file_writer_s {
+	qboolean compress;
+
+	record_file_chunk_t chunks[RECORD_WRITER_CHUNK_COUNT];
+
+	// Protected by mutex when threaded
+	unsigned int submitted_count;
+	unsigned int written_count;
+	qboolean shutdown;
+	qboolean thread_exited;
+
+	qboolean threaded;
+	sysMutex_t *mutex;
+	sysSignal_t *work_signal;
+	sysSignal_t *done_signal;
+
+	// Writer thread only, until it exits
+	FILE *file;
+	qboolean write_error;
+	unsigned int raw_bytes;
+	unsigned int stored_bytes;
+	unsigned int file_position;
+
+	// Frame thread only; keyframes are read by the writer thread once shutdown is set
+	unsigned int completed_count;
+	record_keyframe_t *keyframes;
+	int keyframe_count;
+	int keyframe_alloc;
+	int stall_count;
+	unsigned int raw_written;
+};
+
+static FILE *record_file_open_output(const char *path) {
+	// Opens path in the write directory, or returns null on error
+#ifdef NEW_FILESYSTEM
+	char ospath[FS_MAX_PATH];
+	if(!FS_GeneratePathWritedir(0, path, FS_CREATE_DIRECTORIES, FS_ALLOW_DIRECTORIES | FS_CREATE_DIRECTORIES_FOR_FILE,
+			ospath, sizeof(ospath))) return 0;
+#else
+	char ospath[MAX_OSPATH];
+	Com_sprintf(ospath, sizeof(ospath), "%s/%s", Cvar_VariableString("fs_homepath"), path);
+#endif
+	return Sys_FOpen(ospath, "wb"); }
+
+static void record_file_output(record_file_writer_t *rfw, const void *data, int size) {
+	// Runs on the writer thread
+	if(!size || rfw->write_error) return;
+	if(fwrite(data, size, 1, rfw->file) != 1) rfw->write_error = qtrue;
+	rfw->file_position += size; }
+
+static void record_file_add_keyframe(record_file_writer_t *rfw, record_file_chunk_t *chunk) {
+	record_keyframe_t *keyframe;
+	if(rfw->keyframe_count >= rfw->keyframe_alloc) {
+		record_keyframe_t *old = rfw->keyframes;
+		rfw->keyframe_alloc = rfw->keyframe_alloc ? rfw->keyframe_alloc * 2 : 64;
+		rfw->keyframes = record_calloc(sizeof(*rfw->keyframes) * rfw->keyframe_alloc);
+		if(old) {
+			Com_Memcpy(rfw->keyframes, old, sizeof(*rfw->keyframes) * rfw->keyframe_count);
+			record_free(old); } }
+
+	keyframe = &rfw->keyframes[rfw->keyframe_count++];
+	keyframe->time = chunk->keyframe_time;
+	keyframe->file_offset = chunk->file_offset;
+	keyframe->raw_offset = chunk->keyframe_raw_offset; }
+
+static void record_file_write_block(record_file_writer_t *rfw, record_file_chunk_t *chunk) {
+	// Runs on the writer thread; compresses chunk and writes it to file
+	// Must not use engine file handles or record allocations
+	int header[2];
+	const char *data;
+	int stored_size;
+
+	chunk->compressed_size = 0;
+	if(rfw->compress) {
+		int compressed_size = record_compress_block(chunk->data, chunk->size, chunk->compressed,
+				sizeof(chunk->compressed));
+		if(compressed_size > 0 && compressed_size < chunk->size) chunk->compressed_size = compressed_size; }
+
+	data = chunk->compressed_size ? chunk->compressed : chunk->data;
+	stored_size = chunk->compressed_size ? chunk->compressed_size : chunk->size;
+	chunk->file_offset = rfw->file_position;
+
+	header[0] = chunk->size;
+	header[1] = stored_size;
+	record_file_output(rfw, header, sizeof(header));
+	record_file_output(rfw, data, stored_size);
+
+	rfw->raw_bytes += chunk->size;
+	rfw->stored_bytes += sizeof(header) + stored_size; }
+
+static void record_file_write_index(record_file_writer_t *rfw) {
+	// Runs on the writer thread after all blocks are written; closes the file
+	int header[2];
+	int footer[2];
+
+	header[0] = RECORD_FILE_INDEX_MARKER;
+	header[1] = rfw->keyframe_count;
+	footer[0] = (int)rfw->file_position;
+	footer[1] = RECORD_FILE_INDEX_MAGIC;
+
+	record_file_output(rfw, header, sizeof(header));
+	record_file_output(rfw, rfw->keyframes, sizeof(*rfw->keyframes) * rfw->keyframe_count);
+	record_file_output(rfw, footer, sizeof(footer));
+
+	if(fclose(rfw->file)) rfw->write_error = qtrue;
+	rfw->file = 0; }
+
+static void record_file_writer_thread(void *arg) {
+	record_file_writer_t *rfw = (record_file_writer_t *)arg;
+
+	while(1) {
+		unsigned int index;
+		qboolean have_chunk;
+		qboolean shutdown;
+
+		Sys_LockMutex(rfw->mutex);
+		index = rfw->written_count;
+		have_chunk = index != rfw->submitted_count ? qtrue : qfalse;
+		shutdown = rfw->shutdown;
+		Sys_UnlockMutex(rfw->mutex);
+
+		if(have_chunk) {
+			record_file_write_block(rfw, &rfw->chunks[index % RECORD_WRITER_CHUNK_COUNT]);
+			Sys_LockMutex(rfw->mutex);
+			++rfw->written_count;
+			Sys_RaiseSignal(rfw->done_signal);
+			Sys_UnlockMutex(rfw->mutex);
+			continue; }
+
+		if(shutdown) break;
+		Sys_WaitSignal(rfw->work_signal); }
+
+	// Shutdown is only set once every chunk is written and the keyframe index is complete
+	record_file_write_index(rfw);
+
+	// The frame thread may free rfw as soon as it sees thread_exited, so nothing
+	// can be touched after the mutex is released
+	Sys_LockMutex(rfw->mutex);
+	Sys_RaiseSignal(rfw->done_signal);
+	rfw->thread_exited = qtrue;
+	Sys_UnlockMutex(rfw->mutex); }
+
+static void record_file_writer_reclaim(record_file_writer_t *rfw) {
+	// Records keyframes of chunks the writer thread has finished with, making them available for reuse
+	unsigned int written_count;
+	Sys_LockMutex(rfw->mutex);
+	written_count = rfw->written_count;
+	Sys_UnlockMutex(rfw->mutex);
+
+	while(rfw->completed_count != written_count) {
+		record_file_chunk_t *chunk = &rfw->chunks[rfw->completed_count % RECORD_WRITER_CHUNK_COUNT];
+		if(chunk->keyframe) record_file_add_keyframe(rfw, chunk);
+		++rfw->completed_count; } }
+
+static record_file_chunk_t *record_file_writer_current_chunk(record_file_writer_t *rfw) {
+	return &rfw->chunks[rfw->submitted_count % RECORD_WRITER_CHUNK_COUNT]; }
+
+static void record_file_writer_submit(record_file_writer_t *rfw) {
+	// Hands the current chunk to the writer thread, or writes it directly if not threaded
+	if(!rfw->threaded) {
+		record_file_chunk_t *chunk = record_file_writer_current_chunk(rfw);
+		record_file_write_block(rfw, chunk);
+		++rfw->submitted_count;
+		++rfw->written_count;
+		record_file_writer_reclaim(rfw);
+		return; }
+
+	Sys_LockMutex(rfw->mutex);
+	++rfw->submitted_count;
+	Sys_UnlockMutex(rfw->mutex);
+	Sys_RaiseSignal(rfw->work_signal); }
+
+static void record_file_writer_wait(record_file_writer_t *rfw, unsigned int max_pending) {
+	// Waits until no more than max_pending submitted chunks are still being written
+	record_file_writer_reclaim(rfw);
+	if(rfw->submitted_count - rfw->completed_count <= max_pending) return;
+	++rfw->stall_count;
+	while(1) {
+		Sys_WaitSignal(rfw->done_signal);
+		record_file_writer_reclaim(rfw);
+		if(rfw->submitted_count - rfw->completed_count <= max_pending) break; } }
+
+static void record_file_writer_acquire_chunk(record_file_writer_t *rfw) {
+	// Waits until the current chunk is free to fill
+	if(!rfw->threaded) return;
+	record_file_writer_wait(rfw, RECORD_WRITER_CHUNK_COUNT - 1); }
+
+static void record_file_writer_next_chunk(record_file_writer_t *rfw) {
+	// Submits current chunk and prepares the following one
+	record_file_chunk_t *chunk;
+	record_file_writer_submit(rfw);
+	record_file_writer_acquire_chunk(rfw);
+	chunk = record_file_writer_current_chunk(rfw);
+	chunk->size = 0;
+	chunk->keyframe = qfalse; }
+
+record_file_writer_t *record_file_writer_open(const char *path) {
+	// Returns null if the output file can't be opened
+	int header[2] = {RECORD_FILE_MAGIC, RECORD_FILE_VERSION};
+	record_file_writer_t *rfw;
+	FILE *file = record_file_open_output(path);
+	if(!file) return 0;
+
+	rfw = record_calloc(sizeof(*rfw));
+	rfw->file = file;
+	rfw->compress = record_compression->integer ? qtrue : qfalse;
+
+	// Written before the thread starts, so the file is still only used by one thread at a time
+	record_file_output(rfw, header, sizeof(header));
+
+	rfw->mutex = Sys_CreateMutex();
+	rfw->work_signal = Sys_CreateSignal();
+	rfw->done_signal = Sys_CreateSignal();
+	rfw->threaded = Sys_CreateThread(record_file_writer_thread, rfw);
+	if(!rfw->threaded) {
+		record_printf(RP_ALL, "record_file_writer_open: failed to start writer thread; writing synchronously\n"); }
+
+	return rfw; }
+
+void record_file_writer_write(record_file_writer_t *rfw, const char *data, int size) {
+	while(size > 0) {
+		record_file_chunk_t *chunk;
+		int copy_size;
+
+		record_file_writer_acquire_chunk(rfw);
+		chunk = record_file_writer_current_chunk(rfw);
+
+		copy_size = RECORD_FILE_BLOCK_SIZE - chunk->size;
+		if(copy_size > size) copy_size = size;
+		Com_Memcpy(chunk->data + chunk->size, data, copy_size);
+		chunk->size += copy_size;
+		rfw->raw_written += copy_size;
+		data += copy_size;
+		size -= copy_size;
+
+		if(chunk->size == RECORD_FILE_BLOCK_SIZE) record_file_writer_next_chunk(rfw); } }
+
+void record_file_writer_keyframe(record_file_writer_t *rfw, int time) {
+	// Starts a new block so the keyframe data written next can be decoded without the preceding blocks
+	record_file_chunk_t *chunk;
+	if(record_file_writer_current_chunk(rfw)->size) record_file_writer_next_chunk(rfw);
+	chunk = record_file_writer_current_chunk(rfw);
+	chunk->keyframe = qtrue;
+	chunk->keyframe_time = time;
+	chunk->keyframe_raw_offset = rfw->raw_written; }
+
+void record_file_writer_close(record_file_writer_t *rfw) {
+	// Writes any remaining data and the index, then closes the file and frees the writer
+	if(record_file_writer_current_chunk(rfw)->size) record_file_writer_submit(rfw);
+
+	if(rfw->threaded) {
+		qboolean exited = qfalse;
+
+		// Keyframe index needs the offsets of all blocks before the thread can write it
+		record_file_writer_wait(rfw, 0);
+
+		Sys_LockMutex(rfw->mutex);
+		rfw->shutdown = qtrue;
+		Sys_UnlockMutex(rfw->mutex);
+		Sys_RaiseSignal(rfw->work_signal);
+
+		while(1) {
+			Sys_LockMutex(rfw->mutex);
+			exited = rfw->thread_exited;
+			Sys_UnlockMutex(rfw->mutex);
+			if(exited) break;
+			Sys_WaitSignal(rfw->done_signal); } }
+	else {
+		record_file_write_index(rfw); }
+
+	if(rfw->write_error) record_printf(RP_ALL, "record_file_writer_close: error writing record file\n");
+	record_printf(RP_DEBUG, "record file writer: %u bytes, %u stored (%.1f%%), %i stalls\n", rfw->raw_bytes,
+			rfw->stored_bytes, rfw->raw_bytes ? (float)rfw->stored_bytes * 100.0f / rfw->raw_bytes : 0.0f,
+			rfw->stall_count);
+
+	Sys_DestroySignal(rfw->done_signal);
+	Sys_DestroySignal(rfw->work_signal);
+	Sys_DestroyMutex(rfw->mutex);
+	if(rfw->keyframes) record_free(rfw->keyframes);
+	record_free(rfw); }
+
+#endif
+
+/* ******************************************************************************** */
+// Streaming File Reader
+/* ******************************************************************************** */
+
+// The reader keeps a fixed-size window of decoded record stream data, which is refilled
+// from the file on demand by record_stream_read_static. Memory usage is independent of
+// the recording length. Pointers returned by stream reads are only valid until the next read.
+
+#define RECORD_READER_WINDOW_SIZE (RECORD_FILE_BLOCK_SIZE * 4)
+
+struct record_file_reader_s {
+	fileHandle_t file;
+	int version;				// 0 for legacy raw stream files
+	unsigned int file_position;	// Position of next block to read
+	unsigned int data_end;		// End of block data (start of index or end of file)
+	qboolean error_reported;
+
+	record_file_index_t index;
+	char block_buffer[RECORD_FILE_BLOCK_SIZE];
+	char window[RECORD_READER_WINDOW_SIZE];
+};
+
+static void record_file_reader_load_index(record_file_reader_t *reader, unsigned int file_size) {
+	// Loads index for version 2 files and sets data_end
+	int footer[2];
+	int header[2];
+	unsigned int index_position;
+
+	reader->data_end = file_size;
+	if(reader->version < 2 || file_size < 8 + sizeof(footer)) return;
+
+	FS_Seek(reader->file, file_size - sizeof(footer), FS_SEEK_SET);
+	if(FS_Read(footer, sizeof(footer), reader->file) != sizeof(footer) || footer[1] != RECORD_FILE_INDEX_MAGIC) {
+		// Probably a file left over from a crash; blocks are still readable
+		record_printf(RP_DEBUG, "record_file_reader_load_index: index not found\n");
+		return; }
+
+	index_position = (unsigned int)footer[0];
+	if(index_position < 8 || index_position > file_size - sizeof(footer) - sizeof(header)) {
+		record_printf(RP_ALL, "record_file_reader_load_index: invalid index position\n");
+		return; }
+	FS_Seek(reader->file, index_position, FS_SEEK_SET);
+	if(FS_Read(header, sizeof(header), reader->file) != sizeof(header) || header[0] != RECORD_FILE_INDEX_MARKER ||
+			header[1] < 0 || index_position + sizeof(header) + header[1] * sizeof(record_keyframe_t) + sizeof(footer) != file_size) {
+		record_printf(RP_ALL, "record_file_reader_load_index: invalid index\n");
+		return; }
+
+	if(header[1]) {
+		reader->index.keyframes = record_calloc(sizeof(*reader->index.keyframes) * header[1]);
+		FS_Read(reader->index.keyframes, sizeof(*reader->index.keyframes) * header[1], reader->file);
+		reader->index.keyframe_count = header[1]; }
+	reader->data_end = index_position; }
+
+qboolean record_file_reader_open(const char *path, record_data_stream_t *stream) {
+	// Returns qtrue on success, qfalse otherwise
+	// In the event of qtrue, stream needs to be freed by record_file_reader_close
+	record_file_reader_t *reader;
+	fileHandle_t fp = 0;
+	unsigned int file_size;
+	int header[2];
+
+	Com_Memset(stream, 0, sizeof(*stream));
+
+	FS_SV_FOpenFileRead(path, &fp);
+	if(!fp) {
+		record_printf(RP_ALL, "record_file_reader_open: failed to open source file\n");
+		return qfalse; }
+
+	FS_Seek(fp, 0, FS_SEEK_END);
+	file_size = FS_FTell(fp);
+	FS_Seek(fp, 0, FS_SEEK_SET);
+
+	reader = record_calloc(sizeof(*reader));
+	reader->file = fp;
+
+	if(file_size >= sizeof(header) && FS_Read(header, sizeof(header), fp) == sizeof(header) &&
+			header[0] == RECORD_FILE_MAGIC) {
+		if(header[1] < 1 || header[1] > RECORD_FILE_VERSION) {
+			record_printf(RP_ALL, "record_file_reader_open: unsupported record file version %i\n", header[1]);
+			FS_FCloseFile(fp);
+			record_free(reader);
+			return qfalse; }
+		reader->version = header[1];
+		reader->file_position = sizeof(header);
+		record_file_reader_load_index(reader, file_size);
+		FS_Seek(fp, reader->file_position, FS_SEEK_SET); }
+	else {
+		// Legacy file containing raw stream
+		reader->data_end = file_size;
+		FS_Seek(fp, 0, FS_SEEK_SET); }
+
+	stream->data = reader->window;
+	stream->reader = reader;
+	return qtrue; }
+
+void record_file_reader_close(record_data_stream_t *stream) {
+	record_file_reader_t *reader = stream->reader;
+	if(!reader) return;
+	FS_FCloseFile(reader->file);
+	if(reader->index.keyframes) record_free(reader->index.keyframes);
+	record_free(reader);
+	Com_Memset(stream, 0, sizeof(*stream)); }
+
+static qboolean record_file_reader_read_block(record_file_reader_t *reader, record_data_stream_t *stream) {
+	// Appends next block of data to the window
+	// Returns qtrue on success, qfalse on end of file or error
+	unsigned int space = RECORD_READER_WINDOW_SIZE - stream->size;
+	int header[2];
+
+	if(!reader->version) {
+		// Legacy file
+		unsigned int length = reader->data_end - reader->file_position;
+		if(length > space) length = space;
+		if(length > RECORD_FILE_BLOCK_SIZE) length = RECORD_FILE_BLOCK_SIZE;
+		if(!length || FS_Read(stream->data + stream->size, length, reader->file) != length) return qfalse;
+		reader->file_position += length;
+		stream->size += length;
+		return qtrue; }
+
+	if(reader->file_position >= reader->data_end) return qfalse;
+	if(reader->data_end - reader->file_position < sizeof(header) ||
+			FS_Read(header, sizeof(header), reader->file) != sizeof(header) ||
+			header[0] <= 0 || header[0] > RECORD_FILE_BLOCK_SIZE || header[1] <= 0 || header[1] > header[0] ||
+			(unsigned int)header[1] > reader->data_end - reader->file_position - sizeof(header)) {
+		// Could be a truncated file from a crash, so use the valid part
+		if(!reader->error_reported) {
+			record_printf(RP_ALL, "record_file_reader: invalid block at offset %u\n", reader->file_position);
+			reader->error_reported = qtrue; }
+		reader->file_position = reader->data_end;
+		return qfalse; }
+	if((unsigned int)header[0] > space) {
+		// Shouldn't happen since reads are much smaller than the window
+		FS_Seek(reader->file, reader->file_position, FS_SEEK_SET);
+		return qfalse; }
+
+	if(header[1] == header[0]) {
+		if(FS_Read(stream->data + stream->size, header[1], reader->file) != header[1]) return qfalse; }
+	else {
+		if(FS_Read(reader->block_buffer, header[1], reader->file) != header[1]) return qfalse;
+		if(record_decompress_block(reader->block_buffer, header[1], stream->data + stream->size, header[0]) != header[0]) {
+			record_printf(RP_ALL, "record_file_reader: block decompression failed at offset %u\n", reader->file_position);
+			reader->error_reported = qtrue;
+			reader->file_position = reader->data_end;
+			return qfalse; } }
+
+	reader->file_position += sizeof(header) + header[1];
+	stream->size += header[0];
+	return qtrue; }
+
+qboolean record_file_reader_refill(record_data_stream_t *stream, unsigned int needed) {
+	// Attempts to make at least 'needed' bytes available from the current stream position
+	// Returns qtrue on success, qfalse if not enough data is available
+	record_file_reader_t *reader = stream->reader;
+	if(!reader || needed > RECORD_READER_WINDOW_SIZE) return qfalse;
+
+	// Discard consumed data
+	if(stream->position) {
+		memmove(stream->data, stream->data + stream->position, stream->size - stream->position);
+		stream->size -= stream->position;
+		stream->position = 0; }
+
+	while(stream->size < needed) {
+		if(!record_file_reader_read_block(reader, stream)) return qfalse; }
+	return qtrue; }
+
+static int record_file_index_lookup(record_file_index_t *index, int time) {
+	// Returns index of the last keyframe at or before time, or -1 if none
+	int low = 0;
+	int high = index->keyframe_count - 1;
+	int result = -1;
+	while(low <= high) {
+		int mid = (low + high) / 2;
+		if(index->keyframes[mid].time <= time) {
+			result = mid;
+			low = mid + 1; }
+		else {
+			high = mid - 1; } }
+	return result; }
+
+int record_file_reader_seek(record_data_stream_t *stream, int time) {
+	// Moves stream to the last keyframe at or before time
+	// Returns keyframe time on success, -1 if no suitable keyframe is available
+	record_file_reader_t *reader = stream->reader;
+	int keyframe = reader ? record_file_index_lookup(&reader->index, time) : -1;
+	if(keyframe < 0) return -1;
+	if(reader->index.keyframes[keyframe].file_offset < 8 ||
+			reader->index.keyframes[keyframe].file_offset >= reader->data_end) return -1;
+
+	reader->file_position = reader->index.keyframes[keyframe].file_offset;
+	FS_Seek(reader->file, reader->file_position, FS_SEEK_SET);
+	stream->position = 0;
+	stream->size = 0;
+	return reader->index.keyframes[keyframe].time; }
+
+record_file_index_t *record_file_reader_index(record_data_stream_t *stream) {
+	return stream->reader ? &stream->reader->index : 0; }
+
+qboolean record_file_reader_error(record_data_stream_t *stream) {
+	// Returns qtrue if invalid or truncated block data was encountered
+	return stream->reader && stream->reader->error_reported ? qtrue : qfalse; }
+
+#endif
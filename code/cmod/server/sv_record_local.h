@@ -28,11 +28,16 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 // Definitions
 /* ******************************************************************************** */
 
+typedef struct record_file_reader_s record_file_reader_t;
+
 typedef struct {
 	char *data;
 	unsigned int position;
 	unsigned int size;
 
+	// Source for refilling data when reading from a file; null otherwise
+	record_file_reader_t *reader;
+
 	// Overflow abort
 	qboolean abort_set;
 	jmp_buf abort;
@@ -80,6 +85,27 @@ typedef struct {
 
 #define RECORD_PROTOCOL 6
 
+// Record file container; see sv_record_file.c
+#define RECORD_FILE_MAGIC 0x43455246	// "FREC"
+#define RECORD_FILE_VERSION 2
+#define RECORD_FILE_BLOCK_SIZE 65536
+#define RECORD_BLOCK_BOUND(size) ((size) + (size) / 255 + 16)
+#define RECORD_FILE_INDEX_MARKER -1
+#define RECORD_FILE_INDEX_MAGIC 0x58444e49	// "INDX"
+
+typedef struct record_file_writer_s record_file_writer_t;
+
+typedef struct {
+	int time;
+	unsigned int file_offset;	// Start of the block beginning with the keyframe
+	unsigned int raw_offset;	// Position of the keyframe in the uncompressed record stream
+} record_keyframe_t;
+
+typedef struct {
+	record_keyframe_t *keyframes;
+	int keyframe_count;
+} record_file_index_t;
+
 typedef enum {
 	// State
 	RC_STATE_ENTITY_SET = 32,
@@ -95,9 +121,33 @@ typedef enum {
 	RC_EVENT_SERVERCMD,
 	RC_EVENT_CLIENT_ENTER_WORLD,
 	RC_EVENT_CLIENT_DISCONNECT,
-	RC_EVENT_MAP_RESTART
+	RC_EVENT_MAP_RESTART,
+	RC_EVENT_KEYFRAME		// Resets record state; following state commands rebuild it from scratch
 } record_command_t;
 
+typedef struct {
+	record_data_stream_t stream;
+	record_state_t *rs;
+
+	record_command_t command;
+	int time;
+	int clientNum;
+	int configstring_index;
+
+	// Session info from the last keyframe
+	char keyframe_active[256];
+	int keyframe_instances[256];
+} record_stream_reader_t;
+
+typedef struct {
+	// Stream state used in place of the local game by the spectator system in relay mode
+	record_state_t *rs;
+	record_entityset_t baselines;
+	char active_clients[256];
+	int time;
+	int snapflags;
+} record_spectator_source_t;
+
 /* ******************************************************************************** */
 // Main
 /* ******************************************************************************** */
@@ -109,6 +159,11 @@ extern cvar_t *admin_spectator_slots;
 extern cvar_t *record_auto_recording;
 extern cvar_t *record_full_bot_data;
 extern cvar_t *record_full_usercmd_data;
+extern cvar_t *record_compression;
+extern cvar_t *record_keyframe_interval;
+extern cvar_t *record_export_port;
+extern cvar_t *record_spectator_timing;
+extern cvar_t *record_relay_address;
 
 extern cvar_t *record_convert_legacy_protocol;
 extern cvar_t *record_convert_weptiming;
@@ -129,12 +184,61 @@ void record_write_stop(void);
 void record_start_cmd(void);
 void record_stop_cmd(void);
 
+/* ******************************************************************************** */
+// File
+/* ******************************************************************************** */
+
+int record_compress_block(const char *input, int input_size, char *output, int output_size);
+int record_decompress_block(const char *input, int input_size, char *output, int output_size);
+record_file_writer_t *record_file_writer_open(const char *path);
+void record_file_writer_write(record_file_writer_t *rfw, const char *data, int size);
+void record_file_writer_keyframe(record_file_writer_t *rfw, int time);
+void record_file_writer_close(record_file_writer_t *rfw);
+qboolean record_file_reader_open(const char *path, record_data_stream_t *stream);
+void record_file_reader_close(record_data_stream_t *stream);
+qboolean record_file_reader_refill(record_data_stream_t *stream, unsigned int needed);
+int record_file_reader_seek(record_data_stream_t *stream, int time);
+record_file_index_t *record_file_reader_index(record_data_stream_t *stream);
+qboolean record_file_reader_error(record_data_stream_t *stream);
+
 /* ******************************************************************************** */
 // Convert
 /* ******************************************************************************** */
 
+qboolean advance_stream_reader(record_stream_reader_t *rsr);
+qboolean record_convert_file(const char *path, const char *output_base, int clientNum, int instance,
+			int start_time, int end_time);
+int record_convert_file_all(const char *path, const char *output_base);
+void record_scan_file(const char *path);
+qboolean record_verify_file(const char *path);
+qboolean record_benchmark_file(const char *path, unsigned int *checksum_out);
+int record_index_file(const char *path);
+int record_parse_event_types(const char *names);
+int record_clip_file(const char *path, const char *output_base, int event_types, int time_before, int time_after);
 void record_convert_cmd(void);
+void record_convert_all_cmd(void);
 void record_scan_cmd(void);
+void record_verify_cmd(void);
+void record_benchmark_cmd(void);
+void record_index_cmd(void);
+void record_clip_cmd(void);
+
+/* ******************************************************************************** */
+// Relay
+/* ******************************************************************************** */
+
+void record_export_frame(void);
+qboolean record_export_connected(void);
+qboolean record_export_pending(void);
+void record_export_keyframe(int max_clients);
+void record_export_write(const char *data, int size);
+void record_export_stop(void);
+void record_export_status(void);
+qboolean record_relay_enabled(void);
+record_spectator_source_t *record_relay_source(void);
+void record_relay_frame(void);
+void record_relay_shutdown(void);
+void record_relay_status(void);
 
 /* ******************************************************************************** */
 // Spectator
@@ -159,9 +263,10 @@ void record_stream_error(record_data_stream_t *stream, const char *message);
 char *record_stream_write_allocate(int size, record_data_stream_t *stream);
 void record_stream_write(void *data, int size, record_data_stream_t *stream);
 void record_stream_write_value(int value, int size, record_data_stream_t *stream);
+qboolean record_stream_read_available(int size, record_data_stream_t *stream);
 char *record_stream_read_static(int size, record_data_stream_t *stream);
 void record_stream_read_buffer(void *output, int size, record_data_stream_t *stream);
-void dump_stream_to_file(record_data_stream_t *stream, fileHandle_t file);
+void dump_stream_to_file(record_data_stream_t *stream, record_file_writer_t *rfw);
 
 // ***** Memory Allocation *****
 
@@ -229,3 +334,8 @@ void record_write_snapshot_message(record_entityset_t *entities, record_visibili
 		record_entityset_t *delta_entities, record_visibility_state_t *delta_visibility, playerState_t *delta_ps,
 		record_entityset_t *baselines, int baseline_cutoff, int lastClientCommand, int deltaFrame, int snapFlags,
 		int sv_time, msg_t *msg);
+void record_write_snapshot_header(int lastClientCommand, int deltaFrame, int snapFlags, int sv_time, msg_t *msg);
+void record_write_snapshot_body(record_entityset_t *entities, record_visibility_state_t *visibility, playerState_t *ps,
+		record_entityset_t *delta_entities, record_visibility_state_t *delta_visibility, playerState_t *delta_ps,
+		record_entityset_t *baselines, int baseline_cutoff, msg_t *msg);
+void record_msg_append_bits(msg_t *msg, const byte *data, int bits);
@@ -32,6 +32,11 @@ cvar_t *admin_spectator_slots;
 cvar_t *record_auto_recording;
 cvar_t *record_full_bot_data;
 cvar_t *record_full_usercmd_data;
+cvar_t *record_compression;
+cvar_t *record_keyframe_interval;
+cvar_t *record_export_port;
+cvar_t *record_spectator_timing;
+cvar_t *record_relay_address;
 
 cvar_t *record_convert_legacy_protocol;
 cvar_t *record_convert_weptiming;
@@ -46,27 +51,33 @@ cvar_t *record_verify_data;
 
 void record_process_usercmd(int clientNum, usercmd_t *usercmd) {
 	if(!record_initialized) return;
-	record_spectator_process_usercmd(clientNum, usercmd);
+	if(!record_relay_enabled()) record_spectator_process_usercmd(clientNum, usercmd);
 	record_write_usercmd(usercmd, clientNum); }
 
 void record_process_configstring_change(int index, const char *value) {
 	if(!record_initialized) return;
-	record_spectator_process_configstring_change(index, value);
+	if(!record_relay_enabled()) record_spectator_process_configstring_change(index, value);
 	record_write_configstring_change(index, value); }
 
 void record_process_servercmd(int clientNum, const char *value) {
 	if(!record_initialized) return;
-	record_spectator_process_servercmd(clientNum, value);
+	if(!record_relay_enabled()) record_spectator_process_servercmd(clientNum, value);
 	record_write_servercmd(clientNum, value); }
 
 void record_process_map_loaded(void) {
 	if(!record_initialized) return;
-	record_spectator_process_map_loaded(); }
+	if(!record_relay_enabled()) record_spectator_process_map_loaded(); }
 
 void record_process_snapshot(void) {
 	if(!record_initialized) return;
-	record_spectator_process_snapshot();
-	record_write_snapshot(); }
+	// In relay mode spectators are fed from the incoming record stream instead of the local game
+	if(record_relay_enabled()) {
+		record_relay_frame(); }
+	else {
+		record_relay_shutdown();
+		record_spectator_process_snapshot(); }
+	record_write_snapshot();
+	record_export_frame(); }
 
 void record_game_shutdown(void) {
 	if(!record_initialized) return;
@@ -94,6 +105,11 @@ void record_initialize(void) {
 	record_auto_recording = Cvar_Get("record_auto_recording", "0", 0);
 	record_full_bot_data = Cvar_Get("record_full_bot_data", "0", 0);
 	record_full_usercmd_data = Cvar_Get("record_full_usercmd_data", "0", 0);
+	record_compression = Cvar_Get("record_compression", "1", 0);
+	record_keyframe_interval = Cvar_Get("record_keyframe_interval", "30", 0);
+	record_export_port = Cvar_Get("record_export_port", "0", 0);
+	record_spectator_timing = Cvar_Get("record_spectator_timing", "0", 0);
+	record_relay_address = Cvar_Get("record_relay_address", "", 0);
 
 	record_convert_legacy_protocol = Cvar_Get("record_convert_legacy_protocol", "1", 0);
 	record_convert_weptiming = Cvar_Get("record_convert_weptiming", "0", 0);
@@ -105,8 +121,15 @@ void record_initialize(void) {
 	Cmd_AddCommand("record_start", record_start_cmd);
 	Cmd_AddCommand("record_stop", record_stop_cmd);
 	Cmd_AddCommand("record_convert", record_convert_cmd);
+	Cmd_AddCommand("record_convert_all", record_convert_all_cmd);
 	Cmd_AddCommand("record_scan", record_scan_cmd);
+	Cmd_AddCommand("record_verify", record_verify_cmd);
+	Cmd_AddCommand("record_benchmark", record_benchmark_cmd);
+	Cmd_AddCommand("record_index", record_index_cmd);
+	Cmd_AddCommand("record_clip", record_clip_cmd);
 	Cmd_AddCommand("spect_status", record_spectator_status);
+	Cmd_AddCommand("record_export_status", record_export_status);
+	Cmd_AddCommand("record_relay_status", record_relay_status);
 
 	record_initialized = qtrue; }
 
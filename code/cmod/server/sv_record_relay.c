@@ -0,0 +1,455 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+Copyright (C) 2017 Noah Metzger (chomenor@gmail.com)
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+#ifdef CMOD_RECORD
+#include "sv_record_local.h"
+
+// The game server can export the live record stream over a local socket (record_export_port),
+// and a second server process with record_relay_address set to its numeric "ip:port" runs
+// the spectator system from that stream instead of its own game. The game server's cost
+// stays fixed no matter how many spectators are connected to the relay. The stream runs
+// whenever relays are connected, whether or not the game server is recording to file.
+
+// Stream data is sent as frames consisting of a 4-byte length followed by that many bytes of
+// record stream. Each session starts with a frame containing RECORD_PROTOCOL and max_clients,
+// followed by a keyframe. A zero length frame marks the end of the session.
+
+#define RECORD_EXPORT_MAX_RELAYS 16
+#define RECORD_RELAY_BUFFER_LIMIT (16 << 20)
+#define RECORD_RELAY_RECONNECT_TIME 5000
+#define RECORD_RELAY_CONNECT_TIMEOUT 10000
+
+/* ******************************************************************************** */
+// Relay Buffers
+/* ******************************************************************************** */
+
+typedef struct {
+	char *data;
+	unsigned int size;
+	unsigned int used;
+	unsigned int position;
+} record_relay_buffer_t;
+
+static qboolean relay_buffer_append(record_relay_buffer_t *buffer, const void *data, unsigned int length) {
+	// Returns qtrue on success, qfalse if buffer limit exceeded
+	if(buffer->position && buffer->position == buffer->used) {
+		buffer->position = buffer->used = 0; }
+
+	if(buffer->used + length > buffer->size) {
+		unsigned int new_size = buffer->size ? buffer->size : 65536;
+		char *new_data;
+
+		// Discard consumed data before growing
+		if(buffer->position) {
+			memmove(buffer->data, buffer->data + buffer->position, buffer->used - buffer->position);
+			buffer->used -= buffer->position;
+			buffer->position = 0; }
+
+		while(new_size < buffer->used + length) new_size *= 2;
+		if(new_size > RECORD_RELAY_BUFFER_LIMIT) return qfalse;
+		if(new_size > buffer->size) {
+			new_data = record_calloc(new_size);
+			if(buffer->data) {
+				Com_Memcpy(new_data, buffer->data, buffer->used);
+				record_free(buffer->data); }
+			buffer->data = new_data;
+			buffer->size = new_size; } }
+
+	Com_Memcpy(buffer->data + buffer->used, data, length);
+	buffer->used += length;
+	return qtrue; }
+
+static void relay_buffer_free(record_relay_buffer_t *buffer) {
+	if(buffer->data) record_free(buffer->data);
+	Com_Memset(buffer, 0, sizeof(*buffer)); }
+
+/* ******************************************************************************** */
+// Stream Export
+/* ******************************************************************************** */
+
+typedef enum {
+	EXPORT_FREE,
+	EXPORT_PENDING,		// Waiting for next keyframe
+	EXPORT_ACTIVE		// Receiving stream
+} record_export_relay_state_t;
+
+typedef struct {
+	record_export_relay_state_t state;
+	int socket;
+	record_relay_buffer_t buffer;
+} record_export_relay_t;
+
+typedef struct {
+	int port;
+	int listen_socket;
+	record_export_relay_t relays[RECORD_EXPORT_MAX_RELAYS];
+} record_export_state_t;
+
+static record_export_state_t *exs;
+
+static void export_drop_relay(record_export_relay_t *relay, const char *reason) {
+	record_printf(RP_ALL, "Record export: relay %i disconnected (%s)\n", (int)(relay - exs->relays), reason);
+	NET_TCPClose(relay->socket);
+	relay_buffer_free(&relay->buffer);
+	relay->state = EXPORT_FREE; }
+
+static void export_send_frame(record_export_relay_t *relay, const char *data, int size) {
+	if(!relay_buffer_append(&relay->buffer, &size, 4) || !relay_buffer_append(&relay->buffer, data, size)) {
+		export_drop_relay(relay, "send buffer overflow"); } }
+
+static void export_shutdown(void) {
+	int i;
+	if(!exs) return;
+	for(i=0; i<RECORD_EXPORT_MAX_RELAYS; ++i) {
+		if(exs->relays[i].state != EXPORT_FREE) export_drop_relay(&exs->relays[i], "export stopped"); }
+	NET_TCPClose(exs->listen_socket);
+	record_free(exs);
+	exs = 0; }
+
+static void export_accept_relays(void) {
+	int i;
+	int sock;
+	while((sock = NET_TCPAccept(exs->listen_socket)) >= 0) {
+		for(i=0; i<RECORD_EXPORT_MAX_RELAYS; ++i) {
+			if(exs->relays[i].state == EXPORT_FREE) break; }
+		if(i >= RECORD_EXPORT_MAX_RELAYS) {
+			record_printf(RP_ALL, "Record export: relay slots full\n");
+			NET_TCPClose(sock);
+			continue; }
+
+		Com_Memset(&exs->relays[i], 0, sizeof(exs->relays[i]));
+		exs->relays[i].socket = sock;
+		exs->relays[i].state = EXPORT_PENDING;
+		record_printf(RP_ALL, "Record export: relay %i connected\n", i); } }
+
+static void export_send_relays(void) {
+	int i;
+	for(i=0; i<RECORD_EXPORT_MAX_RELAYS; ++i) {
+		record_export_relay_t *relay = &exs->relays[i];
+		record_relay_buffer_t *buffer = &relay->buffer;
+		if(relay->state == EXPORT_FREE) continue;
+
+		while(buffer->position < buffer->used) {
+			int sent = NET_TCPSend(relay->socket, buffer->data + buffer->position, buffer->used - buffer->position);
+			if(sent < 0) {
+				export_drop_relay(relay, "connection failed");
+				break; }
+			if(!sent) break;
+			buffer->position += sent; }
+
+		if(relay->state == EXPORT_PENDING && buffer->position == buffer->used) {
+			// Detect closed connections while waiting for a stream to start
+			char dummy[64];
+			if(NET_TCPReceive(relay->socket, dummy, sizeof(dummy)) < 0) export_drop_relay(relay, "connection closed"); } } }
+
+void record_export_frame(void) {
+	// Called every server frame to open or close the export socket, accept relays, and send data
+	if(exs && exs->port != record_export_port->integer) export_shutdown();
+
+	if(!exs && record_export_port->integer > 0) {
+		int sock = NET_TCPListen(record_export_port->integer);
+		if(sock < 0) {
+			record_printf(RP_ALL, "Record export: failed to open port %i\n", record_export_port->integer);
+			Cvar_Set("record_export_port", "0");
+			return; }
+		exs = record_calloc(sizeof(*exs));
+		exs->port = record_export_port->integer;
+		exs->listen_socket = sock;
+		record_printf(RP_ALL, "Record export: listening on port %i\n", exs->port); }
+
+	if(!exs) return;
+	export_accept_relays();
+	export_send_relays(); }
+
+qboolean record_export_connected(void) {
+	// Returns qtrue if any relays are connected, in which case the stream session is kept running
+	int i;
+	if(!exs) return qfalse;
+	for(i=0; i<RECORD_EXPORT_MAX_RELAYS; ++i) {
+		if(exs->relays[i].state != EXPORT_FREE) return qtrue; }
+	return qfalse; }
+
+qboolean record_export_pending(void) {
+	// Returns qtrue if any relays are waiting for a keyframe to start the stream
+	int i;
+	if(!exs) return qfalse;
+	for(i=0; i<RECORD_EXPORT_MAX_RELAYS; ++i) {
+		if(exs->relays[i].state == EXPORT_PENDING) return qtrue; }
+	return qfalse; }
+
+void record_export_keyframe(int max_clients) {
+	// Called before a keyframe is written; pending relays start receiving the stream here
+	int i;
+	int header[2];
+	if(!exs) return;
+
+	header[0] = RECORD_PROTOCOL;
+	header[1] = max_clients;
+	for(i=0; i<RECORD_EXPORT_MAX_RELAYS; ++i) {
+		record_export_relay_t *relay = &exs->relays[i];
+		if(relay->state != EXPORT_PENDING) continue;
+		export_send_frame(relay, (char *)header, sizeof(header));
+		if(relay->state == EXPORT_PENDING) relay->state = EXPORT_ACTIVE; } }
+
+void record_export_write(const char *data, int size) {
+	int i;
+	if(!exs || size <= 0) return;
+	for(i=0; i<RECORD_EXPORT_MAX_RELAYS; ++i) {
+		if(exs->relays[i].state == EXPORT_ACTIVE) export_send_frame(&exs->relays[i], data, size); } }
+
+void record_export_stop(void) {
+	// Called when the stream session ends; relays wait for the next session
+	int i;
+	if(!exs) return;
+	for(i=0; i<RECORD_EXPORT_MAX_RELAYS; ++i) {
+		record_export_relay_t *relay = &exs->relays[i];
+		if(relay->state != EXPORT_ACTIVE) continue;
+		export_send_frame(relay, 0, 0);
+		if(relay->state == EXPORT_ACTIVE) relay->state = EXPORT_PENDING; } }
+
+void record_export_status(void) {
+	int i;
+	if(!exs) {
+		record_printf(RP_ALL, "Record export not running\n");
+		return; }
+
+	record_printf(RP_ALL, "Record export listening on port %i\n", exs->port);
+	for(i=0; i<RECORD_EXPORT_MAX_RELAYS; ++i) {
+		record_export_relay_t *relay = &exs->relays[i];
+		if(relay->state == EXPORT_FREE) continue;
+		record_printf(RP_ALL, "relay(%i) state(%s) buffered(%u)\n", i, relay->state == EXPORT_ACTIVE ? "active" : "pending",
+				relay->buffer.used - relay->buffer.position); } }
+
+/* ******************************************************************************** */
+// Stream Relay
+/* ******************************************************************************** */
+
+typedef struct {
+	int socket;
+	qboolean connecting;		// Non-blocking connect in progress
+	int connect_timeout;
+	int next_connect_time;
+	record_relay_buffer_t buffer;
+
+	qboolean have_stream;
+	qboolean session_started;	// First snapshot of the stream has been received
+	record_stream_reader_t rsr;
+	record_spectator_source_t source;
+} record_relay_state_t;
+
+static record_relay_state_t *rls;
+
+qboolean record_relay_enabled(void) {
+	return *record_relay_address->string ? qtrue : qfalse; }
+
+record_spectator_source_t *record_relay_source(void) {
+	// Returns current stream state for spectators, or null if no stream is available
+	if(!rls || !rls->session_started) return 0;
+	return &rls->source; }
+
+static void relay_end_stream(void) {
+	if(!rls->have_stream) return;
+	free_record_state(rls->rsr.rs);
+	Com_Memset(&rls->rsr, 0, sizeof(rls->rsr));
+	Com_Memset(&rls->source, 0, sizeof(rls->source));
+	rls->have_stream = qfalse;
+	rls->session_started = qfalse; }
+
+static void relay_disconnect(const char *reason) {
+	record_printf(RP_ALL, "Record relay: disconnected (%s)\n", reason);
+	relay_end_stream();
+	NET_TCPClose(rls->socket);
+	rls->socket = -1;
+	relay_buffer_free(&rls->buffer);
+	rls->next_connect_time = svs.time + RECORD_RELAY_RECONNECT_TIME; }
+
+static void relay_connect_failed(void) {
+	NET_TCPClose(rls->socket);
+	rls->socket = -1;
+	rls->connecting = qfalse;
+	rls->next_connect_time = svs.time + RECORD_RELAY_RECONNECT_TIME;
+	record_printf(RP_DEBUG, "Record relay: failed to connect to %s\n", record_relay_address->string); }
+
+static qboolean relay_start_stream(const char *data, int size) {
+	// Returns qtrue on success, qfalse on invalid header
+	int protocol, max_clients;
+	if(size != 8) return qfalse;
+	protocol = ((int *)data)[0];
+	max_clients = ((int *)data)[1];
+	if(protocol != RECORD_PROTOCOL || max_clients < 1 || max_clients > 256) return qfalse;
+
+	rls->rsr.rs = allocate_record_state(max_clients);
+	rls->source.rs = rls->rsr.rs;
+	rls->have_stream = qtrue;
+	return qtrue; }
+
+static void relay_process_command(record_stream_reader_t *rsr, record_spectator_source_t *source) {
+	// Passes stream events to the spectator system
+	switch(rsr->command) {
+		case RC_STATE_CONFIGSTRING:
+			record_spectator_process_configstring_change(rsr->configstring_index,
+					rsr->rs->configstrings[rsr->configstring_index]);
+			break;
+		case RC_STATE_USERCMD: {
+			usercmd_t usercmd;
+			record_convert_record_usercmd_to_usercmd(&rsr->rs->clients[rsr->clientNum].usercmd, &usercmd);
+			record_spectator_process_usercmd(rsr->clientNum, &usercmd);
+			break; }
+		case RC_EVENT_BASELINES:
+			source->baselines = rsr->rs->entities;
+			break;
+		case RC_EVENT_SNAPSHOT:
+			source->time = rsr->time;
+			record_spectator_process_snapshot();
+			break;
+		case RC_EVENT_SERVERCMD:
+			record_spectator_process_servercmd(rsr->clientNum, rsr->rs->current_servercmd);
+			break;
+		case RC_EVENT_CLIENT_ENTER_WORLD:
+			source->active_clients[rsr->clientNum] = 1;
+			break;
+		case RC_EVENT_CLIENT_DISCONNECT:
+			source->active_clients[rsr->clientNum] = 0;
+			break;
+		case RC_EVENT_MAP_RESTART:
+			source->snapflags ^= SNAPFLAG_SERVERCOUNT;
+			break;
+		case RC_EVENT_KEYFRAME:
+			// Reader has reset the record state
+			Com_Memcpy(source->active_clients, rsr->keyframe_active, sizeof(source->active_clients));
+			source->rs = rsr->rs;
+			source->time = rsr->time;
+			break;
+		default:
+			break; } }
+
+static qboolean relay_process_frame(char *data, int size) {
+	// Returns qtrue on success, qfalse on stream error
+	record_stream_reader_t *rsr = &rls->rsr;
+
+	if(!size) {
+		record_printf(RP_ALL, "Record relay: stream ended\n");
+		relay_end_stream();
+		return qtrue; }
+
+	if(!rls->have_stream) {
+		if(!relay_start_stream(data, size)) return qfalse;
+		record_printf(RP_ALL, "Record relay: stream started\n");
+		return qtrue; }
+
+	rsr->stream.data = data;
+	rsr->stream.size = size;
+	rsr->stream.position = 0;
+
+	rsr->stream.abort_set = qtrue;
+	if(setjmp(rsr->stream.abort)) return qfalse;
+
+	while(rsr->stream.position < rsr->stream.size) {
+		if(!advance_stream_reader(rsr)) {
+			rsr->stream.abort_set = qfalse;
+			return qfalse; }
+
+		if(rsr->command == RC_EVENT_SNAPSHOT && !rls->session_started) {
+			// State from the initial keyframe is complete, so spectators can load the new gamestate
+			rls->source.time = rsr->time;
+			record_spectator_process_map_loaded();
+			rls->session_started = qtrue; }
+
+		relay_process_command(rsr, &rls->source); }
+
+	rsr->stream.abort_set = qfalse;
+	return qtrue; }
+
+static void relay_receive(void) {
+	char data[65536];
+	int received;
+
+	while((received = NET_TCPReceive(rls->socket, data, sizeof(data))) != 0) {
+		if(received < 0) {
+			relay_disconnect("connection closed");
+			return; }
+		if(!relay_buffer_append(&rls->buffer, data, received)) {
+			relay_disconnect("receive buffer overflow");
+			return; } }
+
+	// Process all complete frames
+	while(rls->buffer.used - rls->buffer.position >= 4) {
+		record_relay_buffer_t *buffer = &rls->buffer;
+		int size = *(int *)(buffer->data + buffer->position);
+		if(size < 0 || size > RECORD_RELAY_BUFFER_LIMIT) {
+			relay_disconnect("invalid frame");
+			return; }
+		if(buffer->used - buffer->position - 4 < (unsigned int)size) break;
+
+		if(!relay_process_frame(buffer->data + buffer->position + 4, size)) {
+			relay_disconnect("invalid stream data");
+			return; }
+		buffer->position += 4 + size; } }
+
+void record_relay_frame(void) {
+	// Called every server frame when relay mode is enabled
+	if(!rls) {
+		rls = record_calloc(sizeof(*rls));
+		rls->socket = -1; }
+
+	if(rls->socket < 0) {
+		if(svs.time - rls->next_connect_time < 0) return;
+		rls->socket = NET_TCPConnect(record_relay_address->string);
+		if(rls->socket < 0) {
+			relay_connect_failed();
+			return; }
+		rls->connecting = qtrue;
+		rls->connect_timeout = svs.time + RECORD_RELAY_CONNECT_TIMEOUT; }
+
+	if(rls->connecting) {
+		// Poll the connect so an unreachable address doesn't stall server frames
+		int status = NET_TCPConnectStatus(rls->socket);
+		if(status < 0 || (!status && svs.time - rls->connect_timeout >= 0)) {
+			relay_connect_failed();
+			return; }
+		if(!status) return;
+		rls->connecting = qfalse;
+		record_printf(RP_ALL, "Record relay: connected to %s\n", record_relay_address->string); }
+
+	relay_receive(); }
+
+void record_relay_shutdown(void) {
+	if(!rls) return;
+	if(rls->socket >= 0) relay_disconnect("relay stopped");
+	record_free(rls);
+	rls = 0; }
+
+void record_relay_status(void) {
+	if(!record_relay_enabled()) {
+		record_printf(RP_ALL, "Record relay not enabled\n");
+		return; }
+	if(!rls || rls->socket < 0) {
+		record_printf(RP_ALL, "Record relay: not connected to %s\n", record_relay_address->string);
+		return; }
+	if(rls->connecting) {
+		record_printf(RP_ALL, "Record relay: connecting to %s\n", record_relay_address->string);
+		return; }
+	record_printf(RP_ALL, "Record relay: connected to %s, %s\n", record_relay_address->string,
+			rls->have_stream ? va("stream time %i", rls->source.time) : "waiting for stream"); }
+
+#endif
@@ -31,6 +31,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 typedef struct {
 	playerState_t ps;
 	int frame_entities_position;
+	int target_client;
 	record_visibility_state_t visibility;
 } spectator_frame_t;
 
@@ -49,16 +50,123 @@ typedef struct {
 
 #define FRAME_ENTITY_COUNT (PACKET_BACKUP * 2)
 
+// Maximum number of distinct snapshot bodies that can be shared in one frame
+#define SNAPSHOT_ENCODING_COUNT 16
+
+typedef struct {
+	// Snapshot body (everything after snapflags) which only depends on these fields,
+	// so it can be reused by all spectators with the same values in the current frame
+	int target_client;
+	int delta_target_client;	// -1 for non-delta
+	int delta_frame_entities_position;
+	int baseline_cutoff;
+	qboolean compat;
+
+	int bits;
+	byte data[MAX_MSGLEN];
+} snapshot_encoding_t;
+
 typedef struct {
 	record_entityset_t current_baselines;
 	spectator_t *spectators;
 	int max_spectators;
 	int frame_entities_position;
 	record_entityset_t frame_entities[FRAME_ENTITY_COUNT];
+
+	// Shared snapshot encodings; only valid during record_spectator_process_snapshot
+	snapshot_encoding_t *encodings;
+	int encoding_count;
+	qboolean encodings_active;
+	int frame_encodes;
 } spectator_system_t;
 
 spectator_system_t *sps;
 
+/* ******************************************************************************** */
+// Game State Source
+/* ******************************************************************************** */
+
+// Spectators normally follow the local game, but in relay mode they follow the state
+// of the record stream received from another server
+
+static record_spectator_source_t *relay_source(void) {
+	// Returns relay stream state if relay mode is enabled, null otherwise
+	if(!record_relay_enabled()) return 0;
+	return record_relay_source(); }
+
+static qboolean source_available(void) {
+	if(record_relay_enabled()) return record_relay_source() ? qtrue : qfalse;
+	return qtrue; }
+
+static int source_max_clients(void) {
+	record_spectator_source_t *source = relay_source();
+	if(record_relay_enabled()) return source ? source->rs->max_clients : 0;
+	return sv_maxclients->integer; }
+
+static qboolean source_client_active(int clientnum) {
+	record_spectator_source_t *source = relay_source();
+	if(clientnum < 0 || clientnum >= source_max_clients()) return qfalse;
+	if(source) return source->active_clients[clientnum] ? qtrue : qfalse;
+	if(sv.state != SS_GAME) return qfalse;
+	if(svs.clients[clientnum].state != CS_ACTIVE) return qfalse;
+	return qtrue; }
+
+static const char *source_client_info(int clientnum) {
+	// Returns player configstring from relay stream
+	const char *info = relay_source()->rs->configstrings[CS_PLAYERS + clientnum];
+	return info ? info : ""; }
+
+static qboolean source_client_is_bot(int clientnum) {
+	if(relay_source()) return *Info_ValueForKey(source_client_info(clientnum), "skill") ? qtrue : qfalse;
+	return svs.clients[clientnum].netchan.remoteAddress.type == NA_BOT ? qtrue : qfalse; }
+
+static const char *source_client_name(int clientnum) {
+	if(relay_source()) return Info_ValueForKey(source_client_info(clientnum), "n");
+	return svs.clients[clientnum].name; }
+
+static playerState_t *source_playerstate(int clientnum) {
+	record_spectator_source_t *source = relay_source();
+	if(source) return &source->rs->clients[clientnum].playerstate;
+	return SV_GameClientNum(clientnum); }
+
+static void source_get_visibility(int clientnum, record_visibility_state_t *target) {
+	record_spectator_source_t *source = relay_source();
+	if(source) *target = source->rs->clients[clientnum].visibility;
+	else record_get_current_visibility(clientnum, target); }
+
+static char **source_configstrings(void) {
+	record_spectator_source_t *source = relay_source();
+	if(source) return source->rs->configstrings;
+	return sv.configstrings; }
+
+static int source_time(void) {
+	record_spectator_source_t *source = relay_source();
+	if(source) return source->time;
+	return sv.time; }
+
+static int source_snapflags(void) {
+	record_spectator_source_t *source = relay_source();
+	if(source) return source->snapflags;
+	return svs.snapFlagServerBit; }
+
+static void source_get_entities(record_entityset_t *target) {
+	record_spectator_source_t *source = relay_source();
+	if(source) *target = source->rs->entities;
+	else get_current_entities(target); }
+
+static void source_get_baselines(record_entityset_t *target) {
+	record_spectator_source_t *source = relay_source();
+	if(source) *target = source->baselines;
+	else get_current_baselines(target); }
+
+static qboolean source_server_id_current(int serverId) {
+	// Returns qtrue if server id received from client matches current gamestate
+	record_spectator_source_t *source = relay_source();
+	if(source) {
+		const char *systeminfo = source->rs->configstrings[CS_SYSTEMINFO];
+		return systeminfo && serverId == atoi(Info_ValueForKey(systeminfo, "sv_serverid")) ? qtrue : qfalse; }
+	return serverId >= sv.restartedServerId && serverId <= sv.serverId ? qtrue : qfalse; }
+
 /* ******************************************************************************** */
 // Command / configstring update handling
 /* ******************************************************************************** */
@@ -126,22 +234,21 @@ static void spectator_send_configstring(client_t *cl, int index, const char *val
 /* ******************************************************************************** */
 
 static qboolean target_client_valid(int clientnum) {
-	if(sv.state != SS_GAME) return qfalse;
-	if(clientnum < 0 || clientnum > sv_maxclients->integer) return qfalse;
-	if(svs.clients[clientnum].state != CS_ACTIVE) return qfalse;
-	return qtrue; }
+	return source_client_active(clientnum); }
 
 static int select_target_client(int start_index, qboolean cycleall) {
 	// Returns clientnum if valid client selected, -1 otherwise
 	int i;
-	if(start_index < 0 || start_index >= sv_maxclients->integer) start_index = 0;
+	int max_clients = source_max_clients();
+	if(max_clients <= 0) return -1;
+	if(start_index < 0 || start_index >= max_clients) start_index = 0;
 
-	for(i=start_index; i<start_index+sv_maxclients->integer; ++i) {
-		int clientnum = i % sv_maxclients->integer;
+	for(i=start_index; i<start_index+max_clients; ++i) {
+		int clientnum = i % max_clients;
 		if(!target_client_valid(clientnum)) continue;
 		if(!cycleall) {
-			if(svs.clients[clientnum].netchan.remoteAddress.type == NA_BOT) continue;
-			if(playerstate_is_spectator(SV_GameClientNum(clientnum))) continue; }
+			if(source_client_is_bot(clientnum)) continue;
+			if(playerstate_is_spectator(source_playerstate(clientnum))) continue; }
 		return clientnum; }
 
 	if(!cycleall) return select_target_client(start_index, qtrue);
@@ -154,11 +261,11 @@ static void advance_target_client(spectator_t *spectator) {
 	spectator->target_client = select_target_client(spectator->target_client + 1, spectator->cycleall);
 	if(spectator->target_client >= 0 && spectator->target_client != original_target) {
 		const char *suffix = "";
-		if(playerstate_is_spectator(SV_GameClientNum(spectator->target_client))) suffix = " [SPECT]";
-		if(svs.clients[spectator->target_client].netchan.remoteAddress.type == NA_BOT) suffix = " [BOT]";
+		if(playerstate_is_spectator(source_playerstate(spectator->target_client))) suffix = " [SPECT]";
+		if(source_client_is_bot(spectator->target_client)) suffix = " [BOT]";
 
 		spectator_add_server_command_fmt(&spectator->cl, "print \"Client(%i) Name(%s^7)%s\n\"",
-				spectator->target_client, svs.clients[spectator->target_client].name, suffix); } }
+				spectator->target_client, source_client_name(spectator->target_client), suffix); } }
 
 static void validate_target_client(spectator_t *spectator) {
 	// Advances target client if current one is invalid
@@ -205,12 +312,66 @@ static void send_spectator_gamestate(spectator_t *spectator) {
 	initialize_spectator_message(cl, &msg, msg_buf, sizeof(msg_buf));
 
 	// Write gamestate message
-	record_write_gamestate_message(&sps->current_baselines, sv.configstrings, 0, cl->reliableSequence, &msg,
+	record_write_gamestate_message(&sps->current_baselines, source_configstrings(), 0, cl->reliableSequence, &msg,
 			&spectator->baseline_cutoff);
 
 	// Send to client
 	SV_SendMessageToClient(&msg, cl); }
 
+static snapshot_encoding_t *get_snapshot_encoding(spectator_t *spectator, spectator_frame_t *current_frame,
+		spectator_frame_t *delta_frame, msg_t *target_msg) {
+	// Returns shared snapshot body for the current frame, encoding it if necessary
+	// Returns null if encodings are not available
+	client_t *cl = &spectator->cl;
+	int delta_target_client = delta_frame ? delta_frame->target_client : -1;
+	int delta_position = delta_frame ? delta_frame->frame_entities_position : 0;
+	snapshot_encoding_t *encoding;
+	msg_t msg;
+	int i;
+
+	if(!sps->encodings_active) return 0;
+
+	// Compat messages pad to a byte boundary when writing area visibility, so the encoding
+	// is only position independent when the body starts on a byte boundary
+	if(target_msg->compat && (target_msg->bit & 7)) return 0;
+
+	for(i=0; i<sps->encoding_count; ++i) {
+		encoding = &sps->encodings[i];
+		if(encoding->target_client == current_frame->target_client &&
+				encoding->delta_target_client == delta_target_client &&
+				encoding->delta_frame_entities_position == delta_position &&
+				encoding->baseline_cutoff == spectator->baseline_cutoff && encoding->compat == cl->compat) {
+			return encoding; } }
+
+	if(sps->encoding_count >= SNAPSHOT_ENCODING_COUNT) return 0;
+	encoding = &sps->encodings[sps->encoding_count];
+	encoding->target_client = current_frame->target_client;
+	encoding->delta_target_client = delta_target_client;
+	encoding->delta_frame_entities_position = delta_position;
+	encoding->baseline_cutoff = spectator->baseline_cutoff;
+	encoding->compat = cl->compat;
+
+	// Encode using the same message mode as the destination
+#ifdef ELITEFORCE
+	if(cl->compat) {
+		MSG_InitOOB(&msg, encoding->data, sizeof(encoding->data));
+		msg.compat = qtrue; }
+	else
+#endif
+	MSG_Init(&msg, encoding->data, sizeof(encoding->data));
+
+	record_write_snapshot_body(&sps->frame_entities[current_frame->frame_entities_position % FRAME_ENTITY_COUNT],
+			&current_frame->visibility, &current_frame->ps,
+			delta_frame ? &sps->frame_entities[delta_frame->frame_entities_position % FRAME_ENTITY_COUNT] : 0,
+			delta_frame ? &delta_frame->visibility : 0, delta_frame ? &delta_frame->ps : 0,
+			&sps->current_baselines, spectator->baseline_cutoff, &msg);
+	++sps->frame_encodes;
+	if(msg.overflowed) return 0;
+
+	encoding->bits = msg.bit;
+	++sps->encoding_count;
+	return encoding; }
+
 static void send_spectator_snapshot(spectator_t *spectator) {
 	// Based on sv_snapshot.c->SV_SendClientSnapshot
 	client_t *cl = &spectator->cl;
@@ -219,22 +380,23 @@ static void send_spectator_snapshot(spectator_t *spectator) {
 	spectator_frame_t *current_frame = &spectator->frames[cl->netchan.outgoingSequence % PACKET_BACKUP];
 	spectator_frame_t *delta_frame = 0;
 	int delta_frame_offset = 0;
-	int snapFlags = svs.snapFlagServerBit;
+	int snapFlags = source_snapflags();
 
 	// Advance target client if current one is invalid
 	validate_target_client(spectator);
 	if(spectator->target_client < 0) return;
 
 	// Store snapshot time in case it is needed to set oldServerTime on a map change
-	spectator->last_snapshot_sv_time = sv.time + cl->oldServerTime;
+	spectator->last_snapshot_sv_time = source_time() + cl->oldServerTime;
 
 	// Determine snapFlags
 	if(cl->state != CS_ACTIVE) snapFlags |= SNAPFLAG_NOT_ACTIVE;
 
 	// Set up current frame
 	current_frame->frame_entities_position = sps->frame_entities_position;
-	current_frame->ps = *SV_GameClientNum(spectator->target_client);
-	record_get_current_visibility(spectator->target_client, &current_frame->visibility);
+	current_frame->target_client = spectator->target_client;
+	current_frame->ps = *source_playerstate(spectator->target_client);
+	source_get_visibility(spectator->target_client, &current_frame->visibility);
 
 	// Tweak playerstate to indicate spectator mode
 	playerstate_set_follow_mode(&current_frame->ps);
@@ -253,12 +415,18 @@ static void send_spectator_snapshot(spectator_t *spectator) {
 	initialize_spectator_message(cl, &msg, msg_buf, sizeof(msg_buf));
 
 	// Write snapshot message
-	record_write_snapshot_message(&sps->frame_entities[current_frame->frame_entities_position % FRAME_ENTITY_COUNT],
-			&current_frame->visibility, &current_frame->ps,
-			delta_frame ? &sps->frame_entities[delta_frame->frame_entities_position % FRAME_ENTITY_COUNT] : 0,
-			delta_frame ? &delta_frame->visibility : 0, delta_frame ? &delta_frame->ps : 0,
-			&sps->current_baselines, spectator->baseline_cutoff, cl->lastClientCommand,
-			delta_frame ? delta_frame_offset : 0, snapFlags, spectator->last_snapshot_sv_time, &msg);
+	record_write_snapshot_header(cl->lastClientCommand, delta_frame ? delta_frame_offset : 0, snapFlags,
+			spectator->last_snapshot_sv_time, &msg);
+	{	snapshot_encoding_t *encoding = get_snapshot_encoding(spectator, current_frame, delta_frame, &msg);
+		if(encoding) {
+			record_msg_append_bits(&msg, encoding->data, encoding->bits); }
+		else {
+			record_write_snapshot_body(&sps->frame_entities[current_frame->frame_entities_position % FRAME_ENTITY_COUNT],
+					&current_frame->visibility, &current_frame->ps,
+					delta_frame ? &sps->frame_entities[delta_frame->frame_entities_position % FRAME_ENTITY_COUNT] : 0,
+					delta_frame ? &delta_frame->visibility : 0, delta_frame ? &delta_frame->ps : 0,
+					&sps->current_baselines, spectator->baseline_cutoff, &msg);
+			++sps->frame_encodes; } }
 
 	// Send to client
 	SV_SendMessageToClient(&msg, cl); }
@@ -302,6 +470,7 @@ static void spectator_enter_world(spectator_t *spectator) {
 	// Spectators don't really enter the world, but they do need some configuration
 	// to go to CS_ACTIVE after loading the map
 	client_t *cl = &spectator->cl;
+	char **configstrings = source_configstrings();
 	int i;
 
 	cl->state = CS_ACTIVE;
@@ -309,7 +478,7 @@ static void spectator_enter_world(spectator_t *spectator) {
 	// Based on sv_init.c->SV_UpdateConfigstrings
 	for(i=0; i<MAX_CONFIGSTRINGS; ++i) {
 		if(cl->csUpdated[i]) {
-			spectator_send_configstring(cl, i, sv.configstrings[i]);
+			spectator_send_configstring(cl, i, configstrings[i] ? configstrings[i] : "");
 			cl->csUpdated[i] = qfalse; } }
 
 	cl->deltaMessage = -1;
@@ -350,7 +519,7 @@ static void process_spectator_move(spectator_t *spectator, msg_t *msg, qboolean
 	if(cl->state == CS_PRIMED) spectator_enter_world(spectator);
 
 	// Handle sv.time reset on map restart etc.
-	if(cl->lastUsercmd.serverTime > sv.time) cl->lastUsercmd.serverTime = 0;
+	if(cl->lastUsercmd.serverTime > source_time()) cl->lastUsercmd.serverTime = 0;
 
 	for(i=0; i<cmdCount; ++i) {
 		if(cmds[i].serverTime > cmds[cmdCount-1].serverTime) continue;
@@ -424,7 +593,10 @@ static void process_spectator_message(spectator_t *spectator, msg_t *msg) {
 		cl->reliableAcknowledge = cl->reliableSequence;
 		return; }
 
-	if(serverId < sv.restartedServerId || serverId > sv.serverId) {
+	// In relay mode, wait until the stream is available
+	if(!source_available()) return;
+
+	if(!source_server_id_current(serverId)) {
 		// Pre map change serverID, or invalid high serverID
 		if(cl->messageAcknowledge > cl->gamestateMessageNum) {
 			// No previous gamestate waiting to be acknowledged - send new one
@@ -461,9 +633,11 @@ static void initialize_spectator_system(int max_spectators) {
 	sps = record_calloc(sizeof(*sps));
 	sps->spectators = record_calloc(sizeof(*sps->spectators) * max_spectators);
 	sps->max_spectators = max_spectators;
-	get_current_baselines(&sps->current_baselines); }
+	sps->encodings = record_calloc(sizeof(*sps->encodings) * SNAPSHOT_ENCODING_COUNT);
+	if(source_available()) source_get_baselines(&sps->current_baselines); }
 
 static void free_spectator_system(void) {
+	record_free(sps->encodings);
 	record_free(sps->spectators);
 	record_free(sps);
 	sps = 0; }
@@ -509,10 +683,18 @@ void record_spectator_status(void) {
 void record_spectator_process_snapshot(void) {
 	int i;
 	qboolean active = qfalse;
+	int snapshots = 0;
+	int64_t start_time;
 	if(!sps) return;
+	start_time = Sys_Microseconds();
+
+	// Spectators with the same target and delta frame share one snapshot body encoding
+	sps->encoding_count = 0;
+	sps->encodings_active = qtrue;
+	sps->frame_encodes = 0;
 
 	// Add current entities to entity buffer
-	get_current_entities(&sps->frame_entities[++sps->frame_entities_position % FRAME_ENTITY_COUNT]);
+	source_get_entities(&sps->frame_entities[++sps->frame_entities_position % FRAME_ENTITY_COUNT]);
 
 	// Based on sv_snapshot.c->SV_SendClientMessages
 	for(i=0; i<sps->max_spectators; ++i) {
@@ -538,7 +720,14 @@ void record_spectator_process_snapshot(void) {
 
 		send_spectator_snapshot(&sps->spectators[i]);
 		cl->lastSnapshotTime = svs.time;
-		cl->rateDelayed = qfalse; }
+		cl->rateDelayed = qfalse;
+		++snapshots; }
+
+	sps->encodings_active = qfalse;
+
+	if(record_spectator_timing->integer && snapshots) {
+		record_printf(RP_ALL, "Spectator frame: snapshots(%i) encodes(%i) time(%i usec)\n", snapshots,
+				sps->frame_encodes, (int)(Sys_Microseconds() - start_time)); }
 
 	if(!active) {
 		// No active spectators; free spectator system to save memory
@@ -610,7 +799,7 @@ void record_spectator_process_map_loaded(void) {
 	if(!sps) return;
 
 	// Update current baselines
-	get_current_baselines(&sps->current_baselines);
+	source_get_baselines(&sps->current_baselines);
 
 	for(i=0; i<sps->max_spectators; ++i) {
 		client_t *cl = &sps->spectators[i].cl;
@@ -623,7 +812,7 @@ void record_spectator_process_configstring_change(int index, const char *value)
 	if(!sps) return;
 
 	// Based on sv_init.c->SV_SetConfigstring
-	if(sv.state == SS_GAME || sv.restarting) {
+	if(relay_source() || sv.state == SS_GAME || sv.restarting) {
 		for(i=0; i<sps->max_spectators; ++i) {
 			client_t *cl = &sps->spectators[i].cl;
 			if(cl->state == CS_ACTIVE) spectator_send_configstring(cl, index, value);
@@ -0,0 +1,431 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+Copyright (C) 2017 Noah Metzger (chomenor@gmail.com)
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+// Standalone record tool
+// Links the record reader, demo writer, and msg code without the rest of the engine, so
+// record files can be converted, scanned, and verified from the command line
+
+#if defined(CMOD_RECORD) && defined(CMOD_RECORD_TOOL)
+#include "sv_record_local.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+static cvar_t legacy_protocol_cvar;
+static cvar_t weptiming_cvar;
+static cvar_t simulate_follow_cvar;
+static cvar_t debug_prints_cvar;
+
+cvar_t *record_convert_legacy_protocol = &legacy_protocol_cvar;
+cvar_t *record_convert_weptiming = &weptiming_cvar;
+cvar_t *record_convert_simulate_follow = &simulate_follow_cvar;
+cvar_t *record_debug_prints = &debug_prints_cvar;
+
+// Referenced by msg.c
+cvar_t *cl_shownet;
+
+/* ******************************************************************************** */
+// Engine Functions
+/* ******************************************************************************** */
+
+// Prefix for output lines, to identify the source file when running parallel jobs
+static char print_prefix[MAX_OSPATH];
+static qboolean print_line_start = qtrue;
+
+void QDECL Com_Printf(const char *fmt, ...) {
+	va_list argptr;
+	char message[MAXPRINTMSG];
+	const char *current = message;
+
+	va_start(argptr, fmt);
+	Q_vsnprintf(message, sizeof(message), fmt, argptr);
+	va_end(argptr);
+
+	while(*current) {
+		const char *line_end = strchr(current, '\n');
+		int length = line_end ? (int)(line_end - current) + 1 : (int)strlen(current);
+		if(print_line_start && *print_prefix) fputs(print_prefix, stdout);
+		fwrite(current, 1, length, stdout);
+		print_line_start = line_end ? qtrue : qfalse;
+		current += length; }
+	fflush(stdout); }
+
+void QDECL Com_Error(int code, const char *fmt, ...) {
+	va_list argptr;
+	char message[MAXPRINTMSG];
+
+	va_start(argptr, fmt);
+	Q_vsnprintf(message, sizeof(message), fmt, argptr);
+	va_end(argptr);
+
+	fprintf(stderr, "%serror: %s\n", print_prefix, message);
+	exit(1); }
+
+char *CopyString(const char *in) {
+	char *out = malloc(strlen(in) + 1);
+	if(!out) Com_Error(ERR_FATAL, "CopyString: out of memory");
+	strcpy(out, in);
+	return out; }
+
+void Z_Free(void *ptr) {
+	free(ptr); }
+
+int64_t Sys_Microseconds(void) {
+#ifdef _WIN32
+	LARGE_INTEGER frequency, current;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&current);
+	return current.QuadPart * 1000000 / frequency.QuadPart;
+#else
+	struct timespec tp;
+	clock_gettime(CLOCK_MONOTONIC, &tp);
+	return (int64_t)tp.tv_sec * 1000000 + tp.tv_nsec / 1000;
+#endif
+	}
+
+// Commands aren't used by the tool, but are linked as part of the convert module
+int Cmd_Argc(void) {
+	return 0; }
+
+char *Cmd_Argv(int arg) {
+	return ""; }
+
+/* ******************************************************************************** */
+// Filesystem Functions
+/* ******************************************************************************** */
+
+// Paths are used directly as operating system paths
+
+#define MAX_TOOL_FILES 64
+static FILE *tool_files[MAX_TOOL_FILES];
+
+static fileHandle_t tool_file_open(const char *path, const char *mode) {
+	int i;
+	for(i=1; i<MAX_TOOL_FILES; ++i) {
+		if(!tool_files[i]) break; }
+	if(i >= MAX_TOOL_FILES) Com_Error(ERR_FATAL, "tool_file_open: no free handles");
+
+	tool_files[i] = fopen(path, mode);
+	if(!tool_files[i]) return 0;
+	return i; }
+
+static FILE *tool_file_get(fileHandle_t f) {
+	if(f <= 0 || f >= MAX_TOOL_FILES || !tool_files[f]) Com_Error(ERR_FATAL, "tool_file_get: invalid handle");
+	return tool_files[f]; }
+
+fileHandle_t FS_FOpenFileWrite(const char *qpath) {
+	return tool_file_open(qpath, "wb"); }
+
+fileHandle_t FS_SV_FOpenFileWrite(const char *filename) {
+	return tool_file_open(filename, "wb"); }
+
+long FS_SV_FOpenFileRead(const char *filename, fileHandle_t *fp) {
+	long length;
+	*fp = tool_file_open(filename, "rb");
+	if(!*fp) return -1;
+	fseek(tool_files[*fp], 0, SEEK_END);
+	length = ftell(tool_files[*fp]);
+	fseek(tool_files[*fp], 0, SEEK_SET);
+	return length; }
+
+int FS_Read(void *buffer, int len, fileHandle_t f) {
+	return (int)fread(buffer, 1, len, tool_file_get(f)); }
+
+int FS_Write(const void *buffer, int len, fileHandle_t f) {
+	return (int)fwrite(buffer, 1, len, tool_file_get(f)); }
+
+int FS_Seek(fileHandle_t f, long offset, int origin) {
+	int whence = origin == FS_SEEK_CUR ? SEEK_CUR : origin == FS_SEEK_END ? SEEK_END : SEEK_SET;
+	return fseek(tool_file_get(f), offset, whence); }
+
+int FS_FTell(fileHandle_t f) {
+	return (int)ftell(tool_file_get(f)); }
+
+void FS_FCloseFile(fileHandle_t f) {
+	fclose(tool_file_get(f));
+	tool_files[f] = 0; }
+
+/* ******************************************************************************** */
+// Options
+/* ******************************************************************************** */
+
+typedef enum {
+	TOOL_CONVERT,
+	TOOL_CONVERT_ALL,
+	TOOL_SCAN,
+	TOOL_VERIFY,
+	TOOL_BENCH,
+	TOOL_INDEX,
+	TOOL_CLIP
+} tool_mode_t;
+
+typedef struct {
+	tool_mode_t mode;
+	int clientNum;
+	int instance;
+	int start_time;
+	int end_time;
+	int event_types;
+	int time_before;
+	int time_after;
+	const char *output_dir;
+	const char *golden_path;
+} tool_options_t;
+
+/* ******************************************************************************** */
+// Golden Checksums
+/* ******************************************************************************** */
+
+// Golden file lines are in the format "<checksum> <record path>"
+
+static qboolean golden_lookup(const char *golden_path, const char *path, unsigned int *checksum) {
+	// Returns qtrue if checksum found, qfalse otherwise
+	char line[MAX_OSPATH + 16];
+	qboolean found = qfalse;
+	FILE *fp = fopen(golden_path, "r");
+	if(!fp) return qfalse;
+
+	while(!found && fgets(line, sizeof(line), fp)) {
+		char *name = strchr(line, ' ');
+		if(!name) continue;
+		*(name++) = 0;
+		name[strcspn(name, "\r\n")] = 0;
+		if(strcmp(name, path)) continue;
+		*checksum = (unsigned int)strtoul(line, 0, 16);
+		found = qtrue; }
+
+	fclose(fp);
+	return found; }
+
+static void golden_add(const char *golden_path, const char *path, unsigned int checksum) {
+	FILE *fp = fopen(golden_path, "a");
+	if(!fp) {
+		Com_Printf("failed to open golden checksum file %s\n", golden_path);
+		return; }
+	fprintf(fp, "%08x %s\n", checksum, path);
+	fclose(fp); }
+
+static qboolean run_benchmark(const char *path, const tool_options_t *options) {
+	// Returns qtrue on success, qfalse on error or checksum mismatch
+	unsigned int checksum;
+	unsigned int expected;
+	qboolean result = record_benchmark_file(path, &checksum);
+	if(!options->golden_path) return result;
+
+	if(golden_lookup(options->golden_path, path, &expected)) {
+		if(checksum != expected) {
+			Com_Printf("checksum mismatch: expected %08x\n", expected);
+			result = qfalse; }
+		else {
+			Com_Printf("checksum matches golden file\n"); } }
+	else if(result) {
+		// First run for this file; record current output as the reference
+		golden_add(options->golden_path, path, checksum);
+		Com_Printf("checksum added to golden file\n"); }
+
+	return result; }
+
+/* ******************************************************************************** */
+// Jobs
+/* ******************************************************************************** */
+
+static void get_output_base(const char *path, const tool_options_t *options, char *output, int output_size) {
+	// Strips extension from source path, and replaces directory if output directory is set
+	if(options->output_dir) {
+		const char *name = strrchr(path, '/');
+#ifdef _WIN32
+		const char *name2 = strrchr(path, '\\');
+		if(name2 > name) name = name2;
+#endif
+		Com_sprintf(output, output_size, "%s/%s", options->output_dir, name ? name + 1 : path); }
+	else {
+		Q_strncpyz(output, path, output_size); }
+	COM_StripExtension(output, output, output_size); }
+
+static qboolean run_job(const char *path, const tool_options_t *options) {
+	// Returns qtrue on success, qfalse on error
+	char output_base[MAX_OSPATH];
+	get_output_base(path, options, output_base, sizeof(output_base));
+
+	switch(options->mode) {
+		case TOOL_CONVERT:
+			return record_convert_file(path, output_base, options->clientNum, options->instance,
+					options->start_time, options->end_time);
+		case TOOL_CONVERT_ALL:
+			return record_convert_file_all(path, output_base) ? qtrue : qfalse;
+		case TOOL_SCAN:
+			record_scan_file(path);
+			return qtrue;
+		case TOOL_VERIFY:
+			return record_verify_file(path);
+		case TOOL_BENCH:
+			return run_benchmark(path, options);
+		case TOOL_INDEX:
+			return record_index_file(path) >= 0 ? qtrue : qfalse;
+		case TOOL_CLIP:
+			return record_clip_file(path, output_base, options->event_types,
+					options->time_before, options->time_after) ? qtrue : qfalse; }
+	return qfalse; }
+
+static int run_jobs(char **paths, int path_count, const tool_options_t *options, int max_jobs) {
+	// Returns number of failed jobs
+	int failures = 0;
+	int i;
+
+#ifndef _WIN32
+	if(max_jobs > 1 && path_count > 1) {
+		// Run each file in a separate process, since the msg code is not thread safe
+		int running = 0;
+		int status;
+
+		for(i=0; i<path_count; ++i) {
+			pid_t pid;
+			if(running >= max_jobs) {
+				if(wait(&status) > 0) {
+					--running;
+					if(!WIFEXITED(status) || WEXITSTATUS(status)) ++failures; } }
+
+			pid = fork();
+			if(pid < 0) {
+				Com_Printf("fork failed for %s\n", paths[i]);
+				++failures;
+				continue; }
+			if(!pid) {
+				Com_sprintf(print_prefix, sizeof(print_prefix), "[%s] ", paths[i]);
+				exit(run_job(paths[i], options) ? 0 : 1); }
+			++running; }
+
+		while(running > 0 && wait(&status) > 0) {
+			--running;
+			if(!WIFEXITED(status) || WEXITSTATUS(status)) ++failures; }
+		return failures; }
+#endif
+
+	for(i=0; i<path_count; ++i) {
+		if(path_count > 1) Com_Printf("%s\n", paths[i]);
+		if(!run_job(paths[i], options)) ++failures; }
+	return failures; }
+
+/* ******************************************************************************** */
+// Main
+/* ******************************************************************************** */
+
+static void print_usage(void) {
+	printf("Usage: cmod_recordtool [options] <command> ...\n"
+		"Commands:\n"
+		"  convert <file> <client> <instance> [start time] [end time]\n"
+		"  convert_all <files...>    Write a demo for every client session\n"
+		"  scan <files...>           List client sessions\n"
+		"  verify <files...>         Check file and record stream structure\n"
+		"  bench <files...>          Check codec and state encoding round trips and measure throughput\n"
+		"  index <files...>          Write event index (.evi) next to each file\n"
+		"  clip <file> <types> [seconds before] [seconds after]\n"
+		"                            Write a demo around each event of the given types\n"
+		"                            (death, frag, flag, teamscore, all; comma separated)\n"
+		"Options:\n"
+		"  -j <count>         Number of files to process at once\n"
+		"  -o <directory>     Output directory for demos (default: next to source file)\n"
+		"  -protocol <0|1>    1 for legacy protocol demos (default), 0 for dm_26\n"
+		"  -weptiming         Add weapon timing messages\n"
+		"  -nofollow          Don't simulate spectator follow mode\n"
+		"  -golden <file>     Compare bench checksums against file, adding any missing ones\n"
+		"  -debug             Print debug messages\n"); }
+
+int main(int argc, char **argv) {
+	tool_options_t options;
+	int max_jobs = 1;
+	int arg = 1;
+	const char *command;
+
+	Com_Memset(&options, 0, sizeof(options));
+	legacy_protocol_cvar.integer = 1;
+	simulate_follow_cvar.integer = 1;
+
+	while(arg < argc && argv[arg][0] == '-') {
+		if(!strcmp(argv[arg], "-j") && arg + 1 < argc) {
+			max_jobs = atoi(argv[++arg]);
+			if(max_jobs < 1) max_jobs = 1; }
+		else if(!strcmp(argv[arg], "-o") && arg + 1 < argc) {
+			options.output_dir = argv[++arg]; }
+		else if(!strcmp(argv[arg], "-protocol") && arg + 1 < argc) {
+			legacy_protocol_cvar.integer = atoi(argv[++arg]); }
+		else if(!strcmp(argv[arg], "-weptiming")) {
+			weptiming_cvar.integer = 1; }
+		else if(!strcmp(argv[arg], "-nofollow")) {
+			simulate_follow_cvar.integer = 0; }
+		else if(!strcmp(argv[arg], "-golden") && arg + 1 < argc) {
+			options.golden_path = argv[++arg]; }
+		else if(!strcmp(argv[arg], "-debug")) {
+			debug_prints_cvar.integer = 1; }
+		else {
+			print_usage();
+			return 1; }
+		++arg; }
+
+	if(arg + 1 >= argc) {
+		print_usage();
+		return 1; }
+	command = argv[arg++];
+
+	if(!strcmp(command, "convert")) {
+		if(arg + 3 > argc) {
+			print_usage();
+			return 1; }
+		options.mode = TOOL_CONVERT;
+		options.clientNum = atoi(argv[arg + 1]);
+		options.instance = atoi(argv[arg + 2]);
+		if(arg + 3 < argc) options.start_time = atoi(argv[arg + 3]);
+		if(arg + 4 < argc) options.end_time = atoi(argv[arg + 4]);
+		return run_job(argv[arg], &options) ? 0 : 1; }
+
+	if(!strcmp(command, "clip")) {
+		if(arg + 2 > argc) {
+			print_usage();
+			return 1; }
+		options.mode = TOOL_CLIP;
+		options.event_types = record_parse_event_types(argv[arg + 1]);
+		if(options.event_types < 0) {
+			print_usage();
+			return 1; }
+		options.time_before = arg + 2 < argc ? atoi(argv[arg + 2]) * 1000 : 5000;
+		options.time_after = arg + 3 < argc ? atoi(argv[arg + 3]) * 1000 : 3000;
+		return run_job(argv[arg], &options) ? 0 : 1; }
+
+	if(!strcmp(command, "convert_all")) options.mode = TOOL_CONVERT_ALL;
+	else if(!strcmp(command, "scan")) options.mode = TOOL_SCAN;
+	else if(!strcmp(command, "verify")) options.mode = TOOL_VERIFY;
+	else if(!strcmp(command, "bench")) options.mode = TOOL_BENCH;
+	else if(!strcmp(command, "index")) options.mode = TOOL_INDEX;
+	else {
+		print_usage();
+		return 1; }
+
+	return run_jobs(argv + arg, argc - arg, &options, max_jobs) ? 1 : 0; }
+
+#endif
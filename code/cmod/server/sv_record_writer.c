@@ -28,22 +28,42 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 // Definitions
 /* ******************************************************************************** */
 
-typedef struct {
-	qboolean auto_started;
+// The stream session runs while a recording is active or relays are connected to the export
+// port, so relays can be served without recording to file. A recording always begins a new
+// session, since record files need to start with the complete initial state.
 
+typedef struct {
 	record_state_t *rs;
 	char active_players[256];
+	int instance_counts[256];
 	int last_snapflags;
+	int last_keyframe_time;
 
-	char *target_directory;
-	char *target_filename;
-
-	fileHandle_t recordfile;
 	record_data_stream_t stream;
 	char stream_buffer[131072];
 } record_writer_state_t;
 
+typedef struct {
+	qboolean auto_started;
+
+	char *target_directory;
+	char *target_filename;
+
+	record_file_writer_t *file_writer;
+} record_writer_file_t;
+
 record_writer_state_t *rws;
+static record_writer_file_t *rwf;
+
+/* ******************************************************************************** */
+// Stream Output
+/* ******************************************************************************** */
+
+static void flush_record_stream(void) {
+	// Sends buffered stream data to the record file and any connected relays
+	record_export_write(rws->stream.data, rws->stream.position);
+	if(rwf && rwf->file_writer) dump_stream_to_file(&rws->stream, rwf->file_writer);
+	else rws->stream.position = 0; }
 
 /* ******************************************************************************** */
 // State-Updating Operations
@@ -187,40 +207,80 @@ static void record_update_current_servercmd(char *value) {
 	rws->rs->current_servercmd = CopyString(value); }
 
 /* ******************************************************************************** */
-// Recording Start/Stop Functions
+// Keyframes
 /* ******************************************************************************** */
 
-static void deallocate_record_writer(void) {
-	if(!rws) return;
-	if(rws->rs) free_record_state(rws->rs);
-	if(rws->target_directory) Z_Free(rws->target_directory);
-	if(rws->target_filename) Z_Free(rws->target_filename);
-	record_free(rws);
-	rws = 0; }
+static void record_write_keyframe(void) {
+	// Writes the complete current state from scratch at the start of a new file block, so readers
+	// can begin decoding here using the file index instead of replaying the stream from the start
+	int i;
+	record_state_t *old_rs = rws->rs;
 
-static void close_record_writer(void) {
-	if(!rws) {
-		// Not supposed to happen
-		record_printf(RP_ALL, "close_record_writer called with record writer not initialized\n");
-		return; }
+	record_export_keyframe(old_rs->max_clients);
+	if(rwf) record_file_writer_keyframe(rwf->file_writer, sv.time);
+	rws->rs = allocate_record_state(old_rs->max_clients);
+
+	record_stream_write_value(RC_EVENT_KEYFRAME, 1, &rws->stream);
+	record_stream_write_value(sv.time, 4, &rws->stream);
+
+	// Session info so readers can tell which client instances are in progress
+	for(i=0; i<old_rs->max_clients; ++i) {
+		record_stream_write_value(rws->active_players[i], 1, &rws->stream);
+		record_stream_write_value(rws->instance_counts[i], 4, &rws->stream); }
+
+	for(i=0; i<MAX_CONFIGSTRINGS; ++i) {
+		record_update_configstring(i, old_rs->configstrings[i]); }
+	record_update_current_servercmd(old_rs->current_servercmd);
+	flush_record_stream();
+
+	// Flush between entity sets to keep the same stream buffer usage as record_write_start
+	{	record_entityset_t baselines;
+		get_current_baselines(&baselines);
+		record_update_entityset(&baselines); }
+	record_stream_write_value(RC_EVENT_BASELINES, 1, &rws->stream);
+	flush_record_stream();
+	record_update_entityset(&old_rs->entities);
+
+	for(i=0; i<old_rs->max_clients; ++i) {
+		if(!rws->active_players[i]) continue;
+		record_update_playerstate(&old_rs->clients[i].playerstate, i);
+		record_update_visibility_state(&old_rs->clients[i].visibility, i);
+
+		record_stream_write_value(RC_STATE_USERCMD, 1, &rws->stream);
+		record_stream_write_value(i, 1, &rws->stream);
+		record_encode_usercmd(&rws->rs->clients[i].usercmd, &old_rs->clients[i].usercmd, &rws->stream); }
+
+	free_record_state(old_rs);
+	flush_record_stream();
+	rws->last_keyframe_time = sv.time; }
 
-	// Flush stream to file and close temp file
-	dump_stream_to_file(&rws->stream, rws->recordfile);
-	FS_FCloseFile(rws->recordfile);
+/* ******************************************************************************** */
+// Recording Start/Stop Functions
+/* ******************************************************************************** */
 
-	// Attempt to move the temp file to final destination
-	FS_SV_Rename("records/current.rec", va("records/%s/%s.rec", rws->target_directory, rws->target_filename), qfalse);
+static void close_record_file(void) {
+	// Flushes stream to file, closes temp file, and moves it to final destination
+	if(!rwf) return;
 
-	deallocate_record_writer(); }
+	if(rws) flush_record_stream();
+	if(rwf->file_writer) {
+		record_file_writer_close(rwf->file_writer);
+		FS_SV_Rename("records/current.rec", va("records/%s/%s.rec", rwf->target_directory, rwf->target_filename), qfalse); }
 
-static void initialize_record_writer(int max_clients, qboolean auto_started) {
-	if(rws) {
+	if(rwf->target_directory) Z_Free(rwf->target_directory);
+	if(rwf->target_filename) Z_Free(rwf->target_filename);
+	record_free(rwf);
+	rwf = 0; }
+
+static void open_record_file(qboolean auto_started) {
+	if(rwf) {
 		// Not supposed to happen
-		record_printf(RP_ALL, "initialize_record_writer called with record writer already initialized\n");
+		record_printf(RP_ALL, "open_record_file called with record file already open\n");
 		return; }
 
 	// Allocate the structure
-	rws = record_calloc(sizeof(*rws));
+	rwf = record_calloc(sizeof(*rwf));
+	rwf->auto_started = auto_started;
 
 	// Make sure records folder exists
 	Sys_Mkdir(va("%s/records", Cvar_VariableString("fs_homepath")));
@@ -235,32 +295,33 @@ static void initialize_record_writer(int max_clients, qboolean auto_started) {
 		time(&rawtime);
 		timeinfo = localtime(&rawtime);
 		if(!timeinfo) {
-			record_printf(RP_ALL, "initialize_record_writer: failed to get timeinfo\n");
-			deallocate_record_writer();
+			record_printf(RP_ALL, "open_record_file: failed to get timeinfo\n");
+			close_record_file();
 			return; }
 
-		rws->target_directory = CopyString(va("%i-%02i-%02i", timeinfo->tm_year + 1900, timeinfo->tm_mon + 1, timeinfo->tm_mday));
-		rws->target_filename = CopyString(va("%02i-%02i-%02i", timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec)); }
+		rwf->target_directory = CopyString(va("%i-%02i-%02i", timeinfo->tm_year + 1900, timeinfo->tm_mon + 1, timeinfo->tm_mday));
+		rwf->target_filename = CopyString(va("%02i-%02i-%02i", timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec)); }
 
 	// Open the temp output file
-	rws->recordfile = FS_SV_FOpenFileWrite("records/current.rec");
-	if(!rws->recordfile) {
-		record_printf(RP_ALL, "initialize_record_writer: failed to open output file\n");
-		deallocate_record_writer();
-		return; }
-
-	// Set up the stream
-	rws->stream.data = rws->stream_buffer;
-	rws->stream.size = sizeof(rws->stream_buffer);
-
-	// Set up the record state
-	rws->rs = allocate_record_state(max_clients);
-	rws->auto_started = auto_started;
-	rws->last_snapflags = svs.snapFlagServerBit; }
+	rwf->file_writer = record_file_writer_open("records/current.rec");
+	if(!rwf->file_writer) {
+		record_printf(RP_ALL, "open_record_file: failed to open output file\n");
+		close_record_file();
+		return; } }
+
+static void end_record_stream(void) {
+	// Ends the stream session; relays wait for the next session
+	if(!rws) return;
+	flush_record_stream();
+	record_export_stop();
+	if(rws->rs) free_record_state(rws->rs);
+	record_free(rws);
+	rws = 0; }
 
 static void record_write_client_enter_world(int clientNum) {
 	if(!rws) return;
 	rws->active_players[clientNum] = 1;
+	++rws->instance_counts[clientNum];
 	record_stream_write_value(RC_EVENT_CLIENT_ENTER_WORLD, 1, &rws->stream);
 	record_stream_write_value(clientNum, 1, &rws->stream); }
 
@@ -280,16 +341,24 @@ static void check_record_connections(void) {
 		else {
 			if(rws->active_players[i]) record_write_client_disconnect(i); } } }
 
-static void record_write_start(int max_clients, qboolean auto_started) {
+static void start_record_stream(int max_clients) {
 	int i;
 	if(rws) return;
 
 	if(max_clients < 1 || max_clients > 256) {
-		record_printf(RP_ALL, "record_write_start: invalid max_clients");
+		record_printf(RP_ALL, "start_record_stream: invalid max_clients");
 		max_clients = 256; }
 
-	initialize_record_writer(max_clients, auto_started);
-	if(!rws) return;
+	// Allocate the structure
+	rws = record_calloc(sizeof(*rws));
+
+	// Set up the stream
+	rws->stream.data = rws->stream_buffer;
+	rws->stream.size = sizeof(rws->stream_buffer);
+
+	// Set up the record state
+	rws->rs = allocate_record_state(max_clients);
+	rws->last_snapflags = svs.snapFlagServerBit;
 
 	// Write the protocol
 	record_stream_write_value(RECORD_PROTOCOL, 4, &rws->stream);
@@ -300,7 +369,7 @@ static void record_write_start(int max_clients, qboolean auto_started) {
 	// Write the configstrings
 	for(i=0; i<MAX_CONFIGSTRINGS; ++i) {
 		if(!sv.configstrings[i]) {
-			record_printf(RP_ALL, "record_write_start: null configstring\n");
+			record_printf(RP_ALL, "start_record_stream: null configstring\n");
 			continue; }
 		if(!*sv.configstrings[i]) continue;
 		record_update_configstring(i, sv.configstrings[i]); }
@@ -311,15 +380,32 @@ static void record_write_start(int max_clients, qboolean auto_started) {
 		record_update_entityset(&baselines); }
 	record_stream_write_value(RC_EVENT_BASELINES, 1, &rws->stream);
 
-	dump_stream_to_file(&rws->stream, rws->recordfile);
+	flush_record_stream();
+	rws->last_keyframe_time = sv.time; }
 
-	record_printf(RP_ALL, "Recording to %s/%s.rec\n", rws->target_directory, rws->target_filename); }
+static void record_write_start(int max_clients, qboolean auto_started) {
+	if(rwf) return;
 
-void record_write_stop(void) {
-	if(!rws) return;
-	close_record_writer();
+	// Restart any session running for relays so the file gets the full initial state
+	end_record_stream();
+
+	open_record_file(auto_started);
+	if(!rwf) return;
+	start_record_stream(max_clients);
+
+	record_printf(RP_ALL, "Recording to %s/%s.rec\n", rwf->target_directory, rwf->target_filename); }
+
+static void record_file_stop(void) {
+	// Stops recording to file; the stream session continues if relays are connected
+	if(!rwf) return;
+	close_record_file();
 	record_printf(RP_ALL, "Recording stopped.\n"); }
 
+void record_write_stop(void) {
+	// Stops recording and ends the stream session
+	record_file_stop();
+	end_record_stream(); }
+
 static qboolean have_recordable_players(qboolean include_bots) {
 	int i;
 	if(sv.state != SS_GAME) return qfalse;
@@ -329,7 +415,7 @@ static qboolean have_recordable_players(qboolean include_bots) {
 	return qfalse; }
 
 void record_start_cmd(void) {
-	if(rws) {
+	if(rwf) {
 		record_printf(RP_ALL, "Already recording.\n");
 		return; }
 	if(!have_recordable_players(record_full_bot_data->integer)) {
@@ -338,12 +424,12 @@ void record_start_cmd(void) {
 	record_write_start(sv_maxclients->integer, qfalse); }
 
 void record_stop_cmd(void) {
-	if(!rws) {
+	if(!rwf) {
 		record_printf(RP_ALL, "Not currently recording.\n");
 		return; }
 	if(record_auto_recording->integer) {
 		record_printf(RP_ALL, "NOTE: To permanently stop recording, set record_auto_recording to 0.\n"); }
-	record_write_stop(); }
+	record_file_stop(); }
 
 /* ******************************************************************************** */
 // Event Handling Functions
@@ -374,11 +460,13 @@ void record_write_servercmd(int clientNum, const char *value) {
 
 void record_write_snapshot(void) {
 	// Check record connections; auto start and stop recording if needed
-	if(!rws && record_auto_recording->integer && have_recordable_players(qfalse)) {
+	if(!rwf && record_auto_recording->integer && have_recordable_players(qfalse)) {
 		record_write_start(sv_maxclients->integer, qtrue); }
+	if(!rws && record_export_connected()) start_record_stream(sv_maxclients->integer);
 	if(rws) check_record_connections();
-	if(rws && !have_recordable_players(record_full_bot_data->integer && !rws->auto_started)) {
-		record_write_stop(); }
+	if(rwf && !have_recordable_players(record_full_bot_data->integer && !rwf->auto_started)) {
+		record_file_stop(); }
+	if(!rwf && !record_export_connected()) end_record_stream();
 	if(!rws) return;
 
 	// Check for map restart
@@ -401,6 +489,11 @@ void record_write_snapshot(void) {
 	record_stream_write_value(RC_EVENT_SNAPSHOT, 1, &rws->stream);
 	record_stream_write_value(sv.time, 4, &rws->stream);
 
-	dump_stream_to_file(&rws->stream, rws->recordfile); }
+	flush_record_stream();
+
+	// Relays waiting to join the stream also need a keyframe to start from
+	if(record_export_pending() || (record_keyframe_interval->integer > 0 &&
+			sv.time - rws->last_keyframe_time >= record_keyframe_interval->integer * 1000)) {
+		record_write_keyframe(); } }
 
 #endif
@@ -155,6 +155,29 @@ static void FS_ReadCacheDebug_f( void ) {
 	FS_ReadCache_Debug();
 }
 
+/*
+=================
+FS_ReadCacheStats_f
+=================
+*/
+static void FS_ReadCacheStats_f( void ) {
+	FS_ReadCache_Stats();
+}
+
+/*
+=================
+FS_ReadCacheTest_f
+=================
+*/
+static void FS_ReadCacheTest_f( void ) {
+	if ( Cmd_Argc() > 4 ) {
+		Com_Printf( "Usage: readcache_test [threads] [passes] [filter]\n" );
+		return;
+	}
+	FS_ReadCache_Test( Cmd_Argc() > 3 ? Cmd_Argv( 3 ) : "*", Cmd_Argc() > 1 ? atoi( Cmd_Argv( 1 ) ) : 4,
+			Cmd_Argc() > 2 ? atoi( Cmd_Argv( 2 ) ) : 4 );
+}
+
 /*
 =================
 FS_IndexCacheWrite_f
@@ -336,6 +359,8 @@ void FS_RegisterCommands( void ) {
 
 	Cmd_AddCommand( "fs_refresh", FS_Refresh_f );
 	Cmd_AddCommand( "readcache_debug", FS_ReadCacheDebug_f );
+	Cmd_AddCommand( "readcache_stats", FS_ReadCacheStats_f );
+	Cmd_AddCommand( "readcache_test", FS_ReadCacheTest_f );
 	Cmd_AddCommand( "indexcache_write", FS_IndexCacheWrite_f );
 
 	Cmd_AddCommand( "dir", FS_Dir_f );
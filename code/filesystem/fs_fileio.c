@@ -348,38 +348,69 @@ qboolean FS_FileExists( const char *file ) {
 
 File read cache
 
+The cache is divided into shards, selected by file hash, which each have their own lock,
+lookup table, and clock ring. Entries are reference counted and can't be evicted while
+data is held by a caller. When memory is needed, entries are evicted from the shards in
+rotation using the clock algorithm, so entries that have been accessed since the last
+sweep get a second chance.
+
+The cache can be used from any thread. FS_ReadData and FS_ReadFile can be called from
+worker threads started by Sys_CreateThread, such as asynchronous loaders. On those threads
+lookups bypass the lookup cache, and reference tracking, prefetch recording, and debug output
+are skipped, since that state belongs to the main thread. Worker reads must be finished
+before the filesystem is refreshed, because they use the file index without locking.
+
 ###############################################################################################
 */
 
 typedef struct cache_entry_s {
 	unsigned int size;
-	int lock_count;
-	int stage;
+	int refcount;
+	int shard;	// CACHE_SHARD_NONE for uncached buffers
+	qboolean referenced;	// clock bit
+	qboolean published;	// entry is registered in shard
 
 	const fsc_file_t *file;
 	unsigned int file_size;
 	unsigned int file_timestamp;
 
-	struct cache_entry_s *next_position;
 	unsigned int lookup_hash;
 	struct cache_entry_s *next_lookup;
 	struct cache_entry_s *prev_lookup;
+	struct cache_entry_s *next_clock;
+	struct cache_entry_s *prev_clock;
 } cache_entry_t;
 
-// ***** Cache lookup table *****
+#define CACHE_HEADER_SIZE ( ( sizeof( cache_entry_t ) + 15 ) & ~15 )
+#define CACHE_ENTRY_DATA( cache_entry ) ( (char *)( cache_entry ) + CACHE_HEADER_SIZE )
+#define CACHE_DATA_ENTRY( data ) ( (cache_entry_t *)( (char *)( data ) - CACHE_HEADER_SIZE ) )
+
+// ***** Cache shards *****
 
-#define CACHE_LOOKUP_TABLE_SIZE 4096
-static cache_entry_t *cache_lookup_table[CACHE_LOOKUP_TABLE_SIZE];
+#define CACHE_SHARD_COUNT 16
+#define CACHE_SHARD_NONE -1
+#define CACHE_LOOKUP_TABLE_SIZE 256
+
+typedef struct {
+	sysMutex_t *mutex;
+	cache_entry_t *lookup_table[CACHE_LOOKUP_TABLE_SIZE];
+	cache_entry_t *clock_hand;	// null if shard is empty
+	int entry_count;
 
-// ***** Cache data store *****
+	unsigned int hits;
+	unsigned int misses;
+	unsigned int evictions;
+} cache_shard_t;
 
-#define CACHE_ENTRY_DATA( cache_entry ) ( (char *)( cache_entry ) + sizeof( cache_entry_t ) )
-#define CACHE_ALIGN( ptr ) ( ( ( uintptr_t )( ptr ) + 15 ) & ~15 )
+static cache_shard_t cache_shards[CACHE_SHARD_COUNT];
 
-int cache_stage = 0;
-int cache_size = 0;
-cache_entry_t *base_entry;
-cache_entry_t *head_entry; // Last entry created. Null if just initialized.
+// ***** Cache memory budget *****
+
+static sysMutex_t *cache_budget_mutex;
+static unsigned int cache_size;
+static unsigned int cache_used;
+static unsigned int cache_evict_cursor;
+static unsigned int cache_insert_failures;
 
 /*
 =================
@@ -395,46 +426,74 @@ static unsigned int FS_ReadCache_HashFile( const fsc_file_t *file ) {
 
 /*
 =================
-FS_ReadCache_LookupTableRegister
+FS_ReadCache_LookupBucket
 =================
 */
-static void FS_ReadCache_LookupTableRegister( cache_entry_t *entry ) {
-	int position = entry->lookup_hash % CACHE_LOOKUP_TABLE_SIZE;
-	entry->next_lookup = cache_lookup_table[position];
+static cache_entry_t **FS_ReadCache_LookupBucket( cache_shard_t *shard, unsigned int lookup_hash ) {
+	return &shard->lookup_table[( lookup_hash / CACHE_SHARD_COUNT ) % CACHE_LOOKUP_TABLE_SIZE];
+}
+
+/*
+=================
+FS_ReadCache_Register
+
+Adds entry to shard lookup table and clock ring. Shard must be locked.
+=================
+*/
+static void FS_ReadCache_Register( cache_shard_t *shard, cache_entry_t *entry ) {
+	cache_entry_t **bucket = FS_ReadCache_LookupBucket( shard, entry->lookup_hash );
+
+	entry->next_lookup = *bucket;
 	entry->prev_lookup = NULL;
-	if ( cache_lookup_table[position] ) {
-		cache_lookup_table[position]->prev_lookup = entry;
+	if ( *bucket ) {
+		( *bucket )->prev_lookup = entry;
 	}
-	cache_lookup_table[position] = entry;
+	*bucket = entry;
+
+	// Insert behind the clock hand, so the new entry is the last to be checked
+	if ( shard->clock_hand ) {
+		entry->next_clock = shard->clock_hand;
+		entry->prev_clock = shard->clock_hand->prev_clock;
+		entry->prev_clock->next_clock = entry;
+		shard->clock_hand->prev_clock = entry;
+	} else {
+		entry->next_clock = entry->prev_clock = entry;
+		shard->clock_hand = entry;
+	}
+
+	entry->published = qtrue;
+	++shard->entry_count;
 }
 
 /*
 =================
-FS_ReadCache_LookupTableDeregister
+FS_ReadCache_Deregister
+
+Removes entry from shard lookup table and clock ring. Shard must be locked.
 =================
 */
-static void FS_ReadCache_LookupTableDeregister( cache_entry_t *entry ) {
-	int position = entry->lookup_hash % CACHE_LOOKUP_TABLE_SIZE;
+static void FS_ReadCache_Deregister( cache_shard_t *shard, cache_entry_t *entry ) {
 	if ( entry->next_lookup ) {
 		entry->next_lookup->prev_lookup = entry->prev_lookup;
 	}
 	if ( entry->prev_lookup ) {
 		entry->prev_lookup->next_lookup = entry->next_lookup;
 	} else {
-		cache_lookup_table[position] = entry->next_lookup;
+		*FS_ReadCache_LookupBucket( shard, entry->lookup_hash ) = entry->next_lookup;
 	}
-}
 
-/*
-=================
-FS_ReadCache_LookupTableDeregisterRange
-=================
-*/
-static void FS_ReadCache_LookupTableDeregisterRange( cache_entry_t *start, cache_entry_t *end ) {
-	while ( start && start != end ) {
-		FS_ReadCache_LookupTableDeregister( start );
-		start = start->next_position;
+	if ( entry->next_clock == entry ) {
+		shard->clock_hand = NULL;
+	} else {
+		entry->prev_clock->next_clock = entry->next_clock;
+		entry->next_clock->prev_clock = entry->prev_clock;
+		if ( shard->clock_hand == entry ) {
+			shard->clock_hand = entry->next_clock;
+		}
 	}
+
+	entry->published = qfalse;
+	--shard->entry_count;
 }
 
 /*
@@ -461,95 +520,196 @@ static qboolean FS_ReadCache_EntryMatchesFile( const fsc_file_t *file, const cac
 
 /*
 =================
-FS_ReadCache_LookupSearch
+FS_ReadCache_Lookup
+
+Attempts to locate file in cache. Returns corresponding cache entry with reference count
+incremented if found, null otherwise.
 =================
 */
-static cache_entry_t *FS_ReadCache_LookupSearch( const fsc_file_t *file ) {
-	cache_entry_t *entry = cache_lookup_table[FS_ReadCache_HashFile( file ) % CACHE_LOOKUP_TABLE_SIZE];
-	cache_entry_t *best_entry = NULL;
+static cache_entry_t *FS_ReadCache_Lookup( const fsc_file_t *file ) {
+	unsigned int hash = FS_ReadCache_HashFile( file );
+	cache_shard_t *shard = &cache_shards[hash % CACHE_SHARD_COUNT];
+	cache_entry_t *entry;
 
-	while ( entry ) {
-		if ( ( !best_entry || entry->stage > best_entry->stage ) && FS_ReadCache_EntryMatchesFile( file, entry ) ) {
-			best_entry = entry;
-		}
+	if ( !shard->mutex ) {
+		return NULL;
+	}
+
+	Sys_LockMutex( shard->mutex );
+	entry = *FS_ReadCache_LookupBucket( shard, hash );
+	while ( entry && !FS_ReadCache_EntryMatchesFile( file, entry ) ) {
 		entry = entry->next_lookup;
 	}
+	if ( entry ) {
+		++entry->refcount;
+		entry->referenced = qtrue;
+		++shard->hits;
+	} else {
+		++shard->misses;
+	}
+	Sys_UnlockMutex( shard->mutex );
 
-	return best_entry;
+	return entry;
 }
 
 /*
 =================
-FS_ReadCache_Allocate
+FS_ReadCache_EvictFromShard
+
+Advances the clock hand of the shard until an entry is evicted or the ring has been swept
+twice. Returns number of bytes released, or 0 if nothing could be evicted.
 =================
 */
-static cache_entry_t *FS_ReadCache_Allocate( const fsc_file_t *file, unsigned int size ) {
-	unsigned int required_space = size + sizeof( cache_entry_t );
-	int wrapped_around = 0;
-	cache_entry_t *lead_entry = head_entry; // Entry preceding new entry (can be null)
-	cache_entry_t *limit_entry = lead_entry ? lead_entry->next_position : NULL; // Entry following new entry (can be null)
-	char *start_point, *end_point; // Range of memory available for new entry: [start, end)
-	cache_entry_t *new_entry;
-
-	while ( 1 ) {
-		// Check if we have enough space yet
-		start_point = (char *)CACHE_ALIGN( lead_entry ? (char *)lead_entry + lead_entry->size + sizeof( cache_entry_t ) : (char *)base_entry );
-		end_point = limit_entry ? (char *)limit_entry : (char *)base_entry + cache_size;
-		FSC_ASSERT( end_point >= start_point );
+static unsigned int FS_ReadCache_EvictFromShard( cache_shard_t *shard ) {
+	unsigned int released = 0;
+	int steps;
 
-		if ( end_point - start_point >= required_space ) {
+	Sys_LockMutex( shard->mutex );
+	for ( steps = shard->entry_count * 2; steps > 0 && shard->clock_hand; --steps ) {
+		cache_entry_t *entry = shard->clock_hand;
+		if ( entry->refcount ) {
+			shard->clock_hand = entry->next_clock;
+		} else if ( entry->referenced ) {
+			entry->referenced = qfalse;
+			shard->clock_hand = entry->next_clock;
+		} else {
+			FS_ReadCache_Deregister( shard, entry );
+			++shard->evictions;
+			released = entry->size;
+			FSC_Free( entry );
 			break;
 		}
+	}
+	Sys_UnlockMutex( shard->mutex );
 
-		// Wraparound check
-		if ( !limit_entry ) {
-			if ( !head_entry || wrapped_around++ ) {
-				return NULL;
-			}
-			lead_entry = NULL;
-			limit_entry = base_entry;
-			continue;
-		}
+	if ( released ) {
+		Sys_LockMutex( cache_budget_mutex );
+		cache_used -= released;
+		Sys_UnlockMutex( cache_budget_mutex );
+	}
+	return released;
+}
 
-		// Don't advance limit over a locked entry
-		while ( limit_entry && limit_entry->lock_count ) {
-			lead_entry = limit_entry;
-			limit_entry = lead_entry->next_position;
-		}
+/*
+=================
+FS_ReadCache_Reserve
 
-		// Advance limit
-		if ( limit_entry ) {
-			limit_entry = limit_entry->next_position;
-		}
+Reserves space in the cache memory budget, evicting entries as needed.
+Returns qtrue on success, qfalse if not enough entries could be evicted.
+=================
+*/
+static qboolean FS_ReadCache_Reserve( unsigned int size ) {
+	int failed_shards = 0;
+
+	if ( !cache_budget_mutex ) {
+		return qfalse;
 	}
 
-	// We have space for a new entry
-	new_entry = (cache_entry_t *)start_point;
+	while ( 1 ) {
+		unsigned int shard_num;
 
-	// Deregister entries we are overwriting
-	if ( lead_entry ) {
-		FS_ReadCache_LookupTableDeregisterRange( lead_entry->next_position, limit_entry );
-		lead_entry->next_position = new_entry;
-	} else if ( head_entry ) {
-		FS_ReadCache_LookupTableDeregisterRange( base_entry, limit_entry );
+		Sys_LockMutex( cache_budget_mutex );
+		if ( size <= cache_size - cache_used ) {
+			cache_used += size;
+			Sys_UnlockMutex( cache_budget_mutex );
+			return qtrue;
+		}
+		shard_num = cache_evict_cursor++ % CACHE_SHARD_COUNT;
+		Sys_UnlockMutex( cache_budget_mutex );
+
+		if ( FS_ReadCache_EvictFromShard( &cache_shards[shard_num] ) ) {
+			failed_shards = 0;
+		} else if ( ++failed_shards >= CACHE_SHARD_COUNT ) {
+			Sys_LockMutex( cache_budget_mutex );
+			++cache_insert_failures;
+			Sys_UnlockMutex( cache_budget_mutex );
+			return qfalse;
+		}
 	}
+}
+
+/*
+=================
+FS_ReadCache_Allocate
 
-	new_entry->next_position = limit_entry;
-	head_entry = new_entry;
+Allocates a buffer with cache header and reference count of 1. If use_cache is set and space
+is available in the cache budget, the entry can later be added to the cache using
+FS_ReadCache_Publish, otherwise it is a plain buffer that is freed on release.
+=================
+*/
+static cache_entry_t *FS_ReadCache_Allocate( const fsc_file_t *file, unsigned int size, qboolean use_cache ) {
+	qboolean cached = use_cache && FS_ReadCache_Reserve( size );
+	cache_entry_t *new_entry = (cache_entry_t *)FSC_Malloc( CACHE_HEADER_SIZE + size );
 
+	FSC_Memset( new_entry, 0, sizeof( *new_entry ) );
 	new_entry->size = size;
-	new_entry->lock_count = 0;
-	new_entry->stage = cache_stage;
+	new_entry->refcount = 1;
 	new_entry->file = file;
 	new_entry->file_size = file ? file->filesize : 0;
 	new_entry->file_timestamp = file && file->sourcetype == FSC_SOURCETYPE_DIRECT ? ( (fsc_file_direct_t *)file )->os_timestamp : 0;
 	new_entry->lookup_hash = FS_ReadCache_HashFile( file );
-
-	FS_ReadCache_LookupTableRegister( new_entry );
+	new_entry->shard = cached ? (int)( new_entry->lookup_hash % CACHE_SHARD_COUNT ) : CACHE_SHARD_NONE;
 
 	return new_entry;
 }
 
+/*
+=================
+FS_ReadCache_Publish
+
+Makes an entry from FS_ReadCache_Allocate available to lookups, after the data has been loaded.
+=================
+*/
+static void FS_ReadCache_Publish( cache_entry_t *entry ) {
+	cache_shard_t *shard;
+	if ( entry->shard == CACHE_SHARD_NONE || !entry->file ) {
+		return;
+	}
+
+	shard = &cache_shards[entry->shard];
+	Sys_LockMutex( shard->mutex );
+	entry->referenced = qtrue;
+	FS_ReadCache_Register( shard, entry );
+	Sys_UnlockMutex( shard->mutex );
+}
+
+/*
+=================
+FS_ReadCache_Release
+
+Decrements reference count of entry. Entries that are not published in the cache are freed.
+=================
+*/
+static void FS_ReadCache_Release( cache_entry_t *entry ) {
+	cache_shard_t *shard;
+	qboolean free_entry;
+
+	if ( entry->shard == CACHE_SHARD_NONE ) {
+		if ( entry->refcount != 1 ) {
+			Com_Error( ERR_DROP, "FS_FreeData on invalid or already freed entry." );
+		}
+		FSC_Free( entry );
+		return;
+	}
+
+	shard = &cache_shards[entry->shard];
+	Sys_LockMutex( shard->mutex );
+	if ( entry->refcount <= 0 ) {
+		Sys_UnlockMutex( shard->mutex );
+		Com_Error( ERR_DROP, "FS_FreeData on invalid or already freed entry." );
+	}
+	--entry->refcount;
+	free_entry = !entry->refcount && !entry->published;
+	Sys_UnlockMutex( shard->mutex );
+
+	if ( free_entry ) {
+		Sys_LockMutex( cache_budget_mutex );
+		cache_used -= entry->size;
+		Sys_UnlockMutex( cache_budget_mutex );
+		FSC_Free( entry );
+	}
+}
+
 /*
 =================
 FS_ReadCache_Initialize
@@ -565,6 +725,7 @@ void FS_ReadCache_Initialize( void ) {
 	cvar_t *cache_megs_cvar = Cvar_Get( "fs_read_cache_megs", "64", CVAR_LATCH | CVAR_ARCHIVE );
 #endif
 	int cache_megs = cache_megs_cvar->integer;
+	int i;
 	if ( cache_megs < 0 ) {
 		cache_megs = 0;
 	}
@@ -572,137 +733,745 @@ void FS_ReadCache_Initialize( void ) {
 		cache_megs = 1024;
 	}
 
-	cache_size = cache_megs << 20;
-	base_entry = (cache_entry_t *)FSC_Malloc( cache_size );
-	head_entry = NULL;
+	cache_size = (unsigned int)cache_megs << 20;
+	cache_used = 0;
+	cache_budget_mutex = Sys_CreateMutex();
+	for ( i = 0; i < CACHE_SHARD_COUNT; ++i ) {
+		cache_shards[i].mutex = Sys_CreateMutex();
+	}
 }
 
 /*
 =================
 FS_ReadCache_AdvanceStage
 
-Causes existing files in cache to be recopied to the front of the cache on reference.
-This may be called between level loads to help with performance. This is only for
-optimization purposes and should not have any functional effects.
+Clears the clock bit on all cache entries, so files that aren't referenced again after this
+call are the first to be evicted. This may be called between level loads to help with
+performance. This is only for optimization purposes and should not have any functional effects.
 =================
 */
 void FS_ReadCache_AdvanceStage( void ) {
-	++cache_stage;
+	int i;
+	for ( i = 0; i < CACHE_SHARD_COUNT; ++i ) {
+		cache_shard_t *shard = &cache_shards[i];
+		cache_entry_t *entry;
+		if ( !shard->mutex ) {
+			continue;
+		}
+
+		Sys_LockMutex( shard->mutex );
+		entry = shard->clock_hand;
+		if ( entry ) {
+			do {
+				entry->referenced = qfalse;
+			} while ( ( entry = entry->next_clock ) != shard->clock_hand );
+		}
+		Sys_UnlockMutex( shard->mutex );
+	}
+}
+
+// ***** Cache debugging *****
+
+/*
+=================
+FS_ReadCache_EntryCountTable
+
+Shard must be locked.
+=================
+*/
+static int FS_ReadCache_EntryCountTable( const cache_shard_t *shard ) {
+	int i;
+	cache_entry_t *entry;
+	int count = 0;
+
+	for ( i = 0; i < CACHE_LOOKUP_TABLE_SIZE; ++i ) {
+		entry = shard->lookup_table[i];
+		while ( entry ) {
+			++count;
+			entry = entry->next_lookup;
+		}
+	}
+
+	return count;
 }
 
 /*
 =================
-FS_ReadCache_CacheLookupStaged
+FS_ReadCache_Debug
+
+Prints information about cache contents to console.
+=================
+*/
+void FS_ReadCache_Debug( void ) {
+	char data[1000];
+	fsc_stream_t stream = FSC_InitStream( data, sizeof( data ) );
+	int i;
+
+#define ADD_STRING( string ) FSC_StreamAppendString( &stream, string )
+
+	for ( i = 0; i < CACHE_SHARD_COUNT; ++i ) {
+		cache_shard_t *shard = &cache_shards[i];
+		cache_entry_t *entry;
+		int index_counter = 0;
+		if ( !shard->mutex ) {
+			continue;
+		}
+
+		Sys_LockMutex( shard->mutex );
+		entry = shard->clock_hand;
+		if ( entry ) {
+			do {
+				stream.position = 0;
+				ADD_STRING( "File(" );
+				FS_FileToStream( entry->file, &stream, qtrue, qtrue, qtrue, qfalse );
+				ADD_STRING( va( ") Shard(%i) Index(%i) Size(%u) Refcount(%i) Referenced(%i)",
+								i, index_counter, entry->size, entry->refcount, entry->referenced ) );
+				if ( entry == shard->clock_hand ) {
+					ADD_STRING( " <clock hand>" );
+				}
+				ADD_STRING( "\n\n" );
+				Com_Printf( "%s", stream.data );
+				++index_counter;
+			} while ( ( entry = entry->next_clock ) != shard->clock_hand );
+		}
+
+		// These should always be the same
+		if ( index_counter != shard->entry_count || index_counter != FS_ReadCache_EntryCountTable( shard ) ) {
+			Com_Printf( "WARNING: shard %i entry count mismatch - ring(%i) count(%i) table(%i)\n", i,
+					index_counter, shard->entry_count, FS_ReadCache_EntryCountTable( shard ) );
+		}
+		Sys_UnlockMutex( shard->mutex );
+	}
+}
 
-Attempts to locate file in cache. Returns corresponding cache entry if found, null otherwise.
+typedef struct {
+	const char *ext;
+	int count;
+	unsigned int bytes;
+} cache_type_stats_t;
 
-If file is found in an earlier cache stage, it will be duplicated to the front of the cache
-and the new entry returned instead.
+/*
+=================
+FS_ReadCache_Stats
+
+Prints cache counters and memory footprint by file type to console.
 =================
 */
-static cache_entry_t *FS_ReadCache_CacheLookupStaged( const fsc_file_t *file ) {
-	cache_entry_t *entry = FS_ReadCache_LookupSearch( file );
-	if ( !entry ) {
-		return NULL;
+void FS_ReadCache_Stats( void ) {
+	cache_type_stats_t *types = NULL;
+	int type_count = 0;
+	int type_capacity = 0;
+	unsigned int hits = 0, misses = 0, evictions = 0;
+	int entries = 0, locked = 0;
+	int i, j;
+
+	if ( !cache_budget_mutex ) {
+		Com_Printf( "Read cache not initialized.\n" );
+		return;
 	}
 
-	if ( entry->stage != cache_stage ) {
-		cache_entry_t *new_entry;
-		++entry->lock_count;
-		new_entry = FS_ReadCache_Allocate( file, entry->size );
-		--entry->lock_count;
-		if ( new_entry ) {
-			FSC_Memcpy( CACHE_ENTRY_DATA( new_entry ), CACHE_ENTRY_DATA( entry ), entry->size );
-			return new_entry;
+	for ( i = 0; i < CACHE_SHARD_COUNT; ++i ) {
+		cache_shard_t *shard = &cache_shards[i];
+		cache_entry_t *entry;
+
+		Sys_LockMutex( shard->mutex );
+		hits += shard->hits;
+		misses += shard->misses;
+		evictions += shard->evictions;
+		entries += shard->entry_count;
+
+		entry = shard->clock_hand;
+		if ( entry ) {
+			do {
+				const char *ext = entry->file ? (const char *)STACKPTR( entry->file->qp_ext_ptr ) : "";
+				if ( !*ext ) {
+					ext = "<none>";
+				}
+				if ( entry->refcount ) {
+					++locked;
+				}
+
+				for ( j = 0; j < type_count; ++j ) {
+					if ( !Q_stricmp( types[j].ext, ext ) ) {
+						break;
+					}
+				}
+				if ( j == type_count ) {
+					if ( type_count == type_capacity ) {
+						cache_type_stats_t *new_types;
+						type_capacity = type_capacity ? type_capacity * 2 : 32;
+						new_types = (cache_type_stats_t *)Z_Malloc( type_capacity * sizeof( *types ) );
+						if ( types ) {
+							Com_Memcpy( new_types, types, type_count * sizeof( *types ) );
+							Z_Free( types );
+						}
+						types = new_types;
+					}
+					types[j].ext = ext;
+					types[j].count = 0;
+					types[j].bytes = 0;
+					++type_count;
+				}
+				++types[j].count;
+				types[j].bytes += entry->size;
+			} while ( ( entry = entry->next_clock ) != shard->clock_hand );
 		}
+		Sys_UnlockMutex( shard->mutex );
 	}
 
-	return entry;
+	Com_Printf( "size: %u KB used of %u KB\n", cache_used >> 10, cache_size >> 10 );
+	Com_Printf( "entries: %i (%i in use)\n", entries, locked );
+	Com_Printf( "hits: %u  misses: %u  hit rate: %.1f%%\n", hits, misses,
+			hits + misses ? (float)hits * 100.0f / (float)( hits + misses ) : 0.0f );
+	Com_Printf( "evictions: %u  uncached inserts: %u\n", evictions, cache_insert_failures );
+
+	if ( type_count ) {
+		Com_Printf( "\n%-16s %8s %12s\n", "type", "files", "KB" );
+		for ( i = 0; i < type_count; ++i ) {
+			Com_Printf( "%-16s %8i %12u\n", types[i].ext, types[i].count, types[i].bytes >> 10 );
+		}
+		Z_Free( types );
+	}
 }
 
-// ***** Cache debugging *****
+// ***** Cache thread test *****
+
+#define CACHE_TEST_MAX_FILES 1024
+#define CACHE_TEST_MAX_THREADS 8
+#define CACHE_TEST_HELD_BUFFERS 4
+
+typedef struct {
+	char **names;
+	const long *sizes;
+	const unsigned int *checksums;
+	int file_count;
+	int passes;
+	unsigned int seed;
+	int reads;
+	int failures;
+} cache_test_thread_t;
+
+static sysMutex_t *cache_test_mutex;
+static sysSignal_t *cache_test_done;
+static int cache_test_running;
 
 /*
 =================
-FS_ReadCache_EntryCountDirect
+FS_ReadCache_TestRun
+
+Reads random files from the list through FS_ReadFile and compares them against the
+size and checksum read on the main thread. A few buffers are held at a time, so entries
+are referenced from several threads while others are being evicted.
 =================
 */
-static int FS_ReadCache_EntryCountDirect( void ) {
-	cache_entry_t *entry = base_entry;
-	int count = 0;
+static void FS_ReadCache_TestRun( cache_test_thread_t *test ) {
+	void *held[CACHE_TEST_HELD_BUFFERS];
+	int i, index;
 
-	if ( !head_entry ) {
-		return 0;
+	Com_Memset( held, 0, sizeof( held ) );
+	for ( i = 0; i < test->passes * test->file_count; ++i ) {
+		void *data;
+		long size;
+
+		test->seed = test->seed * 1103515245 + 12345;
+		index = ( test->seed >> 8 ) % test->file_count;
+		size = FS_ReadFile( test->names[index], &data );
+		++test->reads;
+		if ( size != test->sizes[index] || ( data && Com_BlockChecksum( data, size ) != test->checksums[index] ) ) {
+			++test->failures;
+		}
+
+		if ( held[i % CACHE_TEST_HELD_BUFFERS] ) {
+			FS_FreeFile( held[i % CACHE_TEST_HELD_BUFFERS] );
+		}
+		held[i % CACHE_TEST_HELD_BUFFERS] = data;
 	}
-	do {
-		++count;
-	} while ( ( entry = entry->next_position ) );
 
-	return count;
+	for ( i = 0; i < CACHE_TEST_HELD_BUFFERS; ++i ) {
+		if ( held[i] ) {
+			FS_FreeFile( held[i] );
+		}
+	}
 }
 
 /*
 =================
-FS_ReadCache_EntryCountTable
+FS_ReadCache_TestThread
+=================
+*/
+static void FS_ReadCache_TestThread( void *arg ) {
+	FS_ReadCache_TestRun( (cache_test_thread_t *)arg );
+
+	Sys_LockMutex( cache_test_mutex );
+	if ( !--cache_test_running ) {
+		Sys_RaiseSignal( cache_test_done );
+	}
+	Sys_UnlockMutex( cache_test_mutex );
+}
+
+/*
+=================
+FS_ReadCache_Test
+
+Reads the files matching filter from several threads at once and reports any read that
+doesn't match the data read beforehand on the main thread. Set fs_read_cache_megs lower
+than the size of the files to test eviction as well.
 =================
 */
-static int FS_ReadCache_EntryCountTable( void ) {
+void FS_ReadCache_Test( const char *filter, int threads, int passes ) {
+	cache_test_thread_t tests[CACHE_TEST_MAX_THREADS];
+	long *sizes;
+	unsigned int *checksums;
+	char **names;
+	int file_count;
+	int reads = 0, failures = 0;
+	int64_t start, usec;
 	int i;
-	cache_entry_t *entry;
-	int count = 0;
 
-	for ( i = 0; i < CACHE_LOOKUP_TABLE_SIZE; ++i ) {
-		entry = cache_lookup_table[i];
-		while ( entry ) {
-			++count;
-			entry = entry->next_lookup;
+	if ( threads < 1 ) {
+		threads = 1;
+	} else if ( threads > CACHE_TEST_MAX_THREADS ) {
+		threads = CACHE_TEST_MAX_THREADS;
+	}
+	if ( passes < 1 ) {
+		passes = 1;
+	}
+
+	names = FS_ListFilteredFiles_Flags( "", "", filter, &file_count, 0 );
+	if ( !file_count ) {
+		Com_Printf( "No files match \"%s\".\n", filter );
+		FS_FreeFileList( names );
+		return;
+	}
+	if ( file_count > CACHE_TEST_MAX_FILES ) {
+		file_count = CACHE_TEST_MAX_FILES;
+	}
+
+	// Reference data from the main thread
+	sizes = (long *)Z_Malloc( file_count * sizeof( *sizes ) );
+	checksums = (unsigned int *)Z_Malloc( file_count * sizeof( *checksums ) );
+	for ( i = 0; i < file_count; ++i ) {
+		void *data;
+		sizes[i] = FS_ReadFile( names[i], &data );
+		checksums[i] = data ? Com_BlockChecksum( data, sizes[i] ) : 0;
+		if ( data ) {
+			FS_FreeFile( data );
 		}
 	}
 
-	return count;
+	if ( !cache_test_mutex ) {
+		cache_test_mutex = Sys_CreateMutex();
+		cache_test_done = Sys_CreateSignal();
+	}
+
+	Com_Memset( tests, 0, sizeof( tests ) );
+	for ( i = 0; i < threads; ++i ) {
+		tests[i].names = names;
+		tests[i].sizes = sizes;
+		tests[i].checksums = checksums;
+		tests[i].file_count = file_count;
+		tests[i].passes = passes;
+		tests[i].seed = 0x2545f491 + i * 7919;
+	}
+
+	start = Sys_Microseconds();
+	cache_test_running = threads;
+	for ( i = 0; i < threads; ++i ) {
+		if ( !Sys_CreateThread( FS_ReadCache_TestThread, &tests[i] ) ) {
+			Com_Printf( "WARNING: failed to create read cache test thread\n" );
+			FS_ReadCache_TestThread( &tests[i] );
+		}
+	}
+	Sys_WaitSignal( cache_test_done );
+	usec = Sys_Microseconds() - start;
+
+	for ( i = 0; i < threads; ++i ) {
+		reads += tests[i].reads;
+		failures += tests[i].failures;
+	}
+
+	Com_Printf( "%i reads of %i files on %i threads in %.2f ms, %i failed\n",
+			reads, file_count, threads, usec / 1000.0, failures );
+
+	Z_Free( checksums );
+	Z_Free( sizes );
+	FS_FreeFileList( names );
+}
+
+/*
+###############################################################################################
+
+Level prefetch
+
+Records the files read while each map is loaded, in read order, and saves the list to the
+"fsprefetch" directory alongside fscache.dat. The next time the same map is loaded, a worker
+thread reads the recorded byte ranges from disk ahead of the main thread, so the data is
+already in the OS page cache when the loading code requests it.
+
+The worker only uses plain file handles and does not access any filesystem state, so the
+list is converted to OS paths and offsets on the main thread before the worker is started.
+The worker is cancelled and waited for when the map changes again and on shutdown.
+
+###############################################################################################
+*/
+
+#define PREFETCH_MAX_FILES 4096
+#define PREFETCH_READ_CHUNK 65536
+
+typedef struct {
+	fs_hashtable_entry_t hte;
+	const fsc_file_t *file;
+} prefetch_record_entry_t;
+
+typedef struct {
+	char map_name[MAX_QPATH];
+	qboolean active;
+	fs_hashtable_t files;	// prefetch_record_entry_t
+	const fsc_file_t *order[PREFETCH_MAX_FILES];
+	int count;
+} prefetch_recorder_t;
+
+typedef struct {
+	unsigned int offset;
+	unsigned int length;
+	char *path;
+} prefetch_job_entry_t;
+
+typedef struct {
+	int count;
+	prefetch_job_entry_t entries[1];	// allocated to count
+} prefetch_job_t;
+
+static prefetch_recorder_t prefetch_recorder;
+
+// Main thread only
+static qboolean prefetch_worker_active;
+static char prefetch_worker_map[MAX_QPATH];
+
+// Shared with worker thread
+static sysMutex_t *prefetch_worker_mutex;
+static sysSignal_t *prefetch_worker_done;
+static qboolean prefetch_worker_cancel;	// protected by prefetch_worker_mutex
+static unsigned int prefetch_worker_bytes;	// written by worker, read after prefetch_worker_done
+
+/*
+=================
+FS_Prefetch_GeneratePath
+
+Writes path of prefetch list for given map to buffer. Returns qtrue on success, qfalse on error.
+=================
+*/
+static qboolean FS_Prefetch_GeneratePath( const char *map_name, qboolean write, char *buffer, unsigned int size ) {
+	char name[MAX_QPATH];
+	COM_StripExtension( COM_SkipPath( (char *)map_name ), name, sizeof( name ) );
+	if ( !*name ) {
+		return qfalse;
+	}
+
+	if ( write ) {
+		return FS_GeneratePathWritedir( "fsprefetch", va( "%s-%s.txt", FS_GetCurrentGameDir(), name ),
+				FS_CREATE_DIRECTORIES, 0, buffer, size ) ? qtrue : qfalse;
+	}
+	return FS_GeneratePathSourcedir( 0, "fsprefetch", va( "%s-%s.txt", FS_GetCurrentGameDir(), name ),
+			0, 0, buffer, size ) ? qtrue : qfalse;
 }
 
 /*
 =================
-FS_ReadCache_Debug
+FS_Prefetch_FileRange
 
-Prints information about cache contents to console.
+Determines the OS path and byte range containing the data of a file.
+Result path must be freed by FSC_Free. Returns null on error.
 =================
 */
-void FS_ReadCache_Debug( void ) {
-	cache_entry_t *entry = base_entry;
-	char data[1000];
-	fsc_stream_t stream = FSC_InitStream( data, sizeof( data ) );
-	int index_counter = 0;
+static char *FS_Prefetch_FileRange( const fsc_file_t *file, unsigned int *offset_out, unsigned int *length_out ) {
+	if ( file->sourcetype == FSC_SOURCETYPE_DIRECT ) {
+		*offset_out = 0;
+		*length_out = file->filesize;
+		return FSC_OSPathToString( (fsc_ospath_t *)STACKPTR( ( (fsc_file_direct_t *)file )->os_path_ptr ) );
+	}
+
+	if ( file->sourcetype == FSC_SOURCETYPE_PK3 ) {
+		const fsc_file_frompk3_t *pk3_file = (const fsc_file_frompk3_t *)file;
+		const fsc_file_direct_t *source_pk3 = (const fsc_file_direct_t *)STACKPTR( pk3_file->source_pk3 );
+		// Include local header, which precedes the compressed data
+		*offset_out = pk3_file->header_position;
+		*length_out = pk3_file->compressed_size + 30 + FSC_MAX_QPATH;
+		return FSC_OSPathToString( (fsc_ospath_t *)STACKPTR( source_pk3->os_path_ptr ) );
+	}
+
+	return NULL;
+}
+
+/*
+=================
+FS_Prefetch_RecordFile
+
+Adds file to the read history of the current map.
+=================
+*/
+static void FS_Prefetch_RecordFile( const fsc_file_t *file ) {
+	unsigned int hash;
+	fs_hashtable_iterator_t it;
+	prefetch_record_entry_t *entry;
 
-	if ( !head_entry ) {
+	if ( !prefetch_recorder.active || prefetch_recorder.count >= PREFETCH_MAX_FILES ) {
+		return;
+	}
+	if ( file->sourcetype != FSC_SOURCETYPE_DIRECT && file->sourcetype != FSC_SOURCETYPE_PK3 ) {
 		return;
 	}
 
-#define ADD_STRING( string ) FSC_StreamAppendString( &stream, string )
+	hash = FS_ReadCache_HashFile( file );
+	it = FS_Hashtable_Iterate( &prefetch_recorder.files, hash, qfalse );
+	while ( ( entry = (prefetch_record_entry_t *)FS_Hashtable_Next( &it ) ) ) {
+		if ( entry->file == file ) {
+			return;
+		}
+	}
+
+	entry = (prefetch_record_entry_t *)Z_Malloc( sizeof( *entry ) );
+	entry->file = file;
+	FS_Hashtable_Insert( &prefetch_recorder.files, (fs_hashtable_entry_t *)entry, hash );
+	prefetch_recorder.order[prefetch_recorder.count++] = file;
+}
+
+/*
+=================
+FS_Prefetch_WriteHistory
+
+Writes read history of the current map to disk and ends recording.
+=================
+*/
+static void FS_Prefetch_WriteHistory( void ) {
+	int i;
+	char path[FS_MAX_PATH];
+	fsc_filehandle_t *fp;
+
+	if ( !prefetch_recorder.active ) {
+		return;
+	}
+
+	if ( prefetch_recorder.count && FS_Prefetch_GeneratePath( prefetch_recorder.map_name, qtrue, path, sizeof( path ) ) ) {
+		fp = FSC_FOpen( path, "wb" );
+		if ( fp ) {
+			for ( i = 0; i < prefetch_recorder.count; ++i ) {
+				unsigned int offset, length;
+				char *os_path = FS_Prefetch_FileRange( prefetch_recorder.order[i], &offset, &length );
+				if ( os_path ) {
+					const char *line = va( "%u %u %s\n", offset, length, os_path );
+					FSC_FWrite( line, strlen( line ), fp );
+					FSC_Free( os_path );
+				}
+			}
+			FSC_FClose( fp );
+		}
+
+		if ( fs.cvar.fs_debug_fileio->integer ) {
+			FS_DPrintf( "prefetch: wrote %i entries for %s to %s\n", prefetch_recorder.count,
+					prefetch_recorder.map_name, fp ? path : "<failed to open file>" );
+		}
+	}
+
+	FS_Hashtable_Free( &prefetch_recorder.files, NULL );
+	prefetch_recorder.active = qfalse;
+	prefetch_recorder.count = 0;
+}
+
+/*
+=================
+FS_Prefetch_WorkerCancelled
+=================
+*/
+static qboolean FS_Prefetch_WorkerCancelled( void ) {
+	qboolean cancel;
+	Sys_LockMutex( prefetch_worker_mutex );
+	cancel = prefetch_worker_cancel;
+	Sys_UnlockMutex( prefetch_worker_mutex );
+	return cancel;
+}
+
+/*
+=================
+FS_Prefetch_Worker
+
+Runs in worker thread. Reads each range in the job and discards the data.
+=================
+*/
+static void FS_Prefetch_Worker( void *context ) {
+	prefetch_job_t *job = (prefetch_job_t *)context;
+	char *buffer = (char *)FSC_Malloc( PREFETCH_READ_CHUNK );
+	const char *open_path = NULL;
+	fsc_filehandle_t *fp = NULL;
+	int i;
+
+	for ( i = 0; i < job->count && !FS_Prefetch_WorkerCancelled(); ++i ) {
+		prefetch_job_entry_t *entry = &job->entries[i];
+		unsigned int remaining = entry->length;
+
+		// Consecutive entries are often in the same pk3, so keep the handle open
+		if ( !open_path || FSC_Strcmp( open_path, entry->path ) ) {
+			if ( fp ) {
+				FSC_FClose( fp );
+			}
+			fp = FSC_FOpen( entry->path, "rb" );
+			open_path = entry->path;
+		}
+		if ( !fp || FSC_FSeek( fp, (int)entry->offset, FSC_SEEK_SET ) ) {
+			continue;
+		}
+
+		while ( remaining && !FS_Prefetch_WorkerCancelled() ) {
+			unsigned int chunk = remaining < PREFETCH_READ_CHUNK ? remaining : PREFETCH_READ_CHUNK;
+			unsigned int read = FSC_FRead( buffer, chunk, fp );
+			prefetch_worker_bytes += read;
+			if ( read != chunk ) {
+				break;
+			}
+			remaining -= chunk;
+		}
+	}
+
+	if ( fp ) {
+		FSC_FClose( fp );
+	}
+	for ( i = 0; i < job->count; ++i ) {
+		FSC_Free( job->entries[i].path );
+	}
+	FSC_Free( buffer );
+	FSC_Free( job );
+	Sys_RaiseSignal( prefetch_worker_done );
+}
+
+/*
+=================
+FS_Prefetch_StopWorker
+
+Cancels the worker thread, if running, and waits for it to exit.
+=================
+*/
+static void FS_Prefetch_StopWorker( void ) {
+	if ( !prefetch_worker_active ) {
+		return;
+	}
+
+	Sys_LockMutex( prefetch_worker_mutex );
+	prefetch_worker_cancel = qtrue;
+	Sys_UnlockMutex( prefetch_worker_mutex );
+	Sys_WaitSignal( prefetch_worker_done );
+	prefetch_worker_active = qfalse;
+
+	if ( fs.cvar.fs_debug_fileio->integer ) {
+		FS_DPrintf( "prefetch: read %u bytes for %s\n", prefetch_worker_bytes, prefetch_worker_map );
+	}
+}
+
+/*
+=================
+FS_Prefetch_StartWorker
+
+Loads read history of given map, if any, and starts worker thread to prefetch it.
+=================
+*/
+static void FS_Prefetch_StartWorker( const char *map_name ) {
+	char path[FS_MAX_PATH];
+	char *data;
+	char *ptr;
+	unsigned int size;
+	prefetch_job_t *job;
 
-	do {
-		stream.position = 0;
-		if ( !entry->file ) {
-			ADD_STRING( va( "Null File Index(%i) Position(%i) Size(%i) Stage(%i) Lockcount(%i)",
-							index_counter, (int)( (char *)entry - (char *)base_entry ), entry->size, entry->stage, entry->lock_count ) );
+	if ( !FS_Prefetch_GeneratePath( map_name, qfalse, path, sizeof( path ) ) ) {
+		return;
+	}
+	data = FS_ReadData( NULL, path, &size, "FS_Prefetch_StartWorker" );
+	if ( !data ) {
+		return;
+	}
+
+	job = (prefetch_job_t *)FSC_Calloc( sizeof( *job ) + sizeof( *job->entries ) * PREFETCH_MAX_FILES );
+	ptr = data;
+	while ( *ptr && job->count < PREFETCH_MAX_FILES ) {
+		char *line = ptr;
+		char *end = strchr( ptr, '\n' );
+		prefetch_job_entry_t *entry = &job->entries[job->count];
+		if ( end ) {
+			*end = '\0';
+			ptr = end + 1;
 		} else {
-			ADD_STRING( "File(" );
-			FS_FileToStream( entry->file, &stream, qtrue, qtrue, qtrue, qfalse );
-			ADD_STRING( va( ") Index(%i) Position(%i) Size(%i) Stage(%i) Lockcount(%i)",
-							index_counter, (int)( (char *)entry - (char *)base_entry ), entry->size, entry->stage, entry->lock_count ) );
+			ptr += strlen( ptr );
+		}
+
+		entry->offset = strtoul( line, &line, 10 );
+		entry->length = strtoul( line, &line, 10 );
+		if ( *line != ' ' || !line[1] ) {
+			continue;
 		}
-		if ( entry == head_entry ) {
-			ADD_STRING( " <head entry>" );
+		entry->path = (char *)FSC_Malloc( strlen( line + 1 ) + 1 );
+		FSC_Strncpy( entry->path, line + 1, strlen( line + 1 ) + 1 );
+		++job->count;
+	}
+	FS_FreeData( data );
+
+	if ( fs.cvar.fs_debug_fileio->integer ) {
+		FS_DPrintf( "prefetch: starting prefetch of %i entries for %s\n", job->count, map_name );
+	}
+
+	if ( !prefetch_worker_mutex ) {
+		prefetch_worker_mutex = Sys_CreateMutex();
+		prefetch_worker_done = Sys_CreateSignal();
+	}
+	prefetch_worker_cancel = qfalse;
+	prefetch_worker_bytes = 0;
+	if ( !Sys_CreateThread( FS_Prefetch_Worker, job ) ) {
+		int i;
+		for ( i = 0; i < job->count; ++i ) {
+			FSC_Free( job->entries[i].path );
 		}
-		ADD_STRING( "\n\n" );
-		Com_Printf( "%s", stream.data );
-		++index_counter;
-	} while ( ( entry = entry->next_position ) );
+		FSC_Free( job );
+		return;
+	}
+	prefetch_worker_active = qtrue;
+	Q_strncpyz( prefetch_worker_map, map_name, sizeof( prefetch_worker_map ) );
+}
+
+/*
+=================
+FS_Prefetch_MapChange
+
+Called when the current map changes. Saves the read history of the previous map, starts
+prefetching the new map, and begins recording read history for it. Null map_name just ends
+recording for the previous map. Any prefetch still running for the previous map is cancelled.
+=================
+*/
+void FS_Prefetch_MapChange( const char *map_name ) {
+	if ( map_name && prefetch_recorder.active && !Q_stricmp( map_name, prefetch_recorder.map_name ) ) {
+		return;
+	}
+
+	FS_Prefetch_StopWorker();
+	FS_Prefetch_WriteHistory();
+
+	if ( !map_name || !*map_name || !fs.cvar.fs_prefetch->integer ) {
+		return;
+	}
+
+	FS_Prefetch_StartWorker( map_name );
+
+	Q_strncpyz( prefetch_recorder.map_name, map_name, sizeof( prefetch_recorder.map_name ) );
+	FS_Hashtable_Initialize( &prefetch_recorder.files, 1024 );
+	prefetch_recorder.count = 0;
+	prefetch_recorder.active = qtrue;
+}
+
+/*
+=================
+FS_Prefetch_Shutdown
 
-	// These should always be the same
-	Com_Printf( "entry count from direct iteration: %i\n", FS_ReadCache_EntryCountDirect() );
-	Com_Printf( "entry count from lookup table: %i\n", FS_ReadCache_EntryCountTable() );
+Called on shutdown to stop the worker thread before the process exits.
+=================
+*/
+void FS_Prefetch_Shutdown( void ) {
+	FS_Prefetch_StopWorker();
 }
 
 /*
@@ -719,6 +1488,7 @@ FS_ReadData
 
 Input can be either file or path, not both.
 Returns null on error, otherwise result needs to be freed by FS_FreeData.
+Can be called from worker threads, which skip reference tracking and debug output.
 Currently file-type read always reads file->filesize, otherwise it is an error and null is returned.
 =================
 */
@@ -728,19 +1498,28 @@ char *FS_ReadData( const fsc_file_t *file, const char *path, unsigned int *size_
 	void *os_path = NULL;
 	void *fsc_file_handle = NULL;
 	unsigned int size;
+	qboolean worker_thread = Sys_InWorkerThread();
+	qboolean debug = fs.cvar.fs_debug_fileio->integer && !worker_thread ? qtrue : qfalse;
 
 	// Ensure we have file or path set but not both
 	if ( ( file && path ) || ( !file && !path ) ) {
 		Com_Error( ERR_DROP, "Invalid parameters to FS_ReadData." );
 	}
 
+#ifdef CMOD_HITCH_RECORDER
+	if ( !worker_thread ) {
+		++cmod_hitch_counters.fs_reads;
+	}
+#endif
+
 	// Mark the file in reference tracking
-	if ( file ) {
+	if ( file && !worker_thread ) {
 		FS_RegisterReference( file );
+		FS_Prefetch_RecordFile( file );
 	}
 
 	// Print leading debug info
-	if ( fs.cvar.fs_debug_fileio->integer ) {
+	if ( debug ) {
 		FS_DPrintf( "********** load file data **********\n" );
 		FS_DPrintf( "  origin: %s\n", calling_function );
 		if ( file ) {
@@ -756,13 +1535,12 @@ char *FS_ReadData( const fsc_file_t *file, const char *path, unsigned int *size_
 
 	// Check if file is already available from cache
 	if ( file ) {
-		cache_entry = FS_ReadCache_CacheLookupStaged( file );
+		cache_entry = FS_ReadCache_Lookup( file );
 		if ( cache_entry ) {
-			++cache_entry->lock_count;
 			if ( size_out ) {
 				*size_out = cache_entry->size - 1;
 			}
-			if ( fs.cvar.fs_debug_fileio->integer ) {
+			if ( debug ) {
 				FS_DPrintf( "  result: loaded %u bytes from cache\n", cache_entry->size - 1 );
 			}
 			return CACHE_ENTRY_DATA( cache_entry );
@@ -805,16 +1583,9 @@ char *FS_ReadData( const fsc_file_t *file, const char *path, unsigned int *size_
 	}
 
 	// Obtain buffer from cache or malloc
-	if ( size < cache_size / 3 ) {
-		// Don't use more than 1/3 of the cache for a single file to avoid flushing smaller files
-		cache_entry = FS_ReadCache_Allocate( file, size + 1 );
-	}
-	if ( cache_entry ) {
-		++cache_entry->lock_count;
-		data = CACHE_ENTRY_DATA( cache_entry );
-	} else {
-		data = (char *)FSC_Malloc( size + 1 );
-	}
+	// Don't use more than 1/3 of the cache for a single file to avoid flushing smaller files
+	cache_entry = FS_ReadCache_Allocate( file, size + 1, file && size < cache_size / 3 ? qtrue : qfalse );
+	data = CACHE_ENTRY_DATA( cache_entry );
 
 	// Extract data into buffer
 	if ( fsc_file_handle ) {
@@ -829,25 +1600,29 @@ char *FS_ReadData( const fsc_file_t *file, const char *path, unsigned int *size_
 		}
 	}
 	data[size] = '\0';
+	FS_ReadCache_Publish( cache_entry );
+#ifdef CMOD_HITCH_RECORDER
+	if ( !worker_thread ) {
+		cmod_hitch_counters.fs_read_bytes += size;
+	}
+#endif
 
 	if ( size_out ) {
 		*size_out = size;
 	}
-	if ( fs.cvar.fs_debug_fileio->integer ) {
+	if ( debug ) {
 		FS_DPrintf( "  result: loaded %u bytes from file\n", size );
 	}
 	return data;
 
 	// Free buffer if there was an error extracting data
 error:
-	if ( fs.cvar.fs_debug_fileio->integer ) {
+	if ( debug ) {
 		FS_DPrintf( "  result: failed to load file\n" );
 	}
 	if ( cache_entry ) {
-		cache_entry->file = NULL;
-		cache_entry->lock_count = 0;
-	} else if ( data )
-		FSC_Free( data );
+		FS_ReadCache_Release( cache_entry );
+	}
 	if ( size_out ) {
 		*size_out = 0;
 	}
@@ -861,15 +1636,7 @@ FS_FreeData
 */
 void FS_FreeData( char *data ) {
 	FSC_ASSERT( data );
-	if ( data >= (char *)base_entry && data < (char *)base_entry + cache_size ) {
-		cache_entry_t *cache_entry = (cache_entry_t *)( data - sizeof( cache_entry_t ) );
-		if ( cache_entry->lock_count <= 0 ) {
-			Com_Error( ERR_DROP, "FS_FreeData on invalid or already freed entry." );
-		}
-		--cache_entry->lock_count;
-	} else {
-		FSC_Free( data );
-	}
+	FS_ReadCache_Release( CACHE_DATA_ENTRY( data ) );
 }
 
 /*
@@ -1983,16 +2750,8 @@ char *FS_Journal_ReadData( void ) {
 		return NULL;
 	}
 
-	// Obtain buffer from cache or malloc
-	{
-		cache_entry_t *cache_entry = FS_ReadCache_Allocate( NULL, length + 1 );
-		if ( cache_entry ) {
-			++cache_entry->lock_count;
-			data = CACHE_ENTRY_DATA( cache_entry );
-		} else {
-			data = (char *)FSC_Malloc( length + 1 );
-		}
-	}
+	// Obtain buffer with cache header so it can be freed by FS_FreeData
+	data = CACHE_ENTRY_DATA( FS_ReadCache_Allocate( NULL, length + 1, qfalse ) );
 
 	// Attempt to read data
 	r = FS_Read( data, length, com_journalDataFile );
@@ -2160,6 +2919,7 @@ static int FS_FOpenFile_ReadHandleOpen( const char *filename, fileHandle_t *hand
 	}
 
 	// Get the handle and size
+	FS_Prefetch_RecordFile( fscfile );
 	if ( allow_direct_handle && fscfile->sourcetype == FSC_SOURCETYPE_DIRECT ) {
 		handle = FS_DirectReadHandle_Open( fscfile, NULL, (unsigned int *)&size );
 		if ( !handle ) {
@@ -2611,9 +3371,14 @@ FS_ReadFile
 Returns -1 and nulls buffer on error. Returns size and sets buffer on success.
 On success result buffer must be freed with FS_FreeFile.
 Can be called with null buffer for size check.
+Can be called from worker threads; see FS_ReadData.
 =================
 */
+#ifdef CMOD_PROFILER
+static long FS_ReadFileInternal( const char *qpath, void **buffer ) {
+#else
 long FS_ReadFile( const char *qpath, void **buffer ) {
+#endif
 	const fsc_file_t *file;
 	unsigned int len;
 	FSC_ASSERT( qpath );
@@ -2637,6 +3402,23 @@ long FS_ReadFile( const char *qpath, void **buffer ) {
 	return (long)len;
 }
 
+#ifdef CMOD_PROFILER
+/*
+=================
+FS_ReadFile
+
+Times the file read for the profiler
+=================
+*/
+long FS_ReadFile( const char *qpath, void **buffer ) {
+	// The profiler is only recorded on the main thread
+	int64_t profileStart = Sys_InWorkerThread() ? -1 : CMPROFILE_START();
+	long result = FS_ReadFileInternal( qpath, buffer );
+	CMPROFILE_END( PROFILE_FS_READFILE, profileStart );
+	return result;
+}
+#endif
+
 /*
 =================
 FS_FreeFile
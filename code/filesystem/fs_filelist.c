@@ -45,6 +45,10 @@ typedef struct {
 	int general_directory_depth;
 	int direct_file_depth;
 	int direct_directory_depth;
+
+	// Set when listing is restricted to files with a single exact extension, so the
+	// extension index can be used instead of checking every file
+	const char *index_extension;
 } filelist_work_t;
 
 // Treat pk3dirs the same as pk3s here
@@ -221,6 +225,179 @@ static qboolean FS_FileList_StripTrailingSlash( const char *source, char *target
 /*
 ###############################################################################################
 
+Extension index
+
+Maps (directory, extension) combinations to the files with that extension directly within
+the directory. Each directory is indexed the first time it is used by a listing query, and
+the index is discarded when the filesystem generation changes.
+
+###############################################################################################
+*/
+
+typedef struct {
+	fs_hashtable_entry_t hte;
+	const fsc_directory_t *directory;
+	const char *extension;	// null for entry marking directory as indexed
+	const fsc_file_t **files;
+	int file_count;
+	int file_capacity;
+} extension_index_entry_t;
+
+static fs_hashtable_t extension_index;
+static unsigned int extension_index_generation;
+
+/*
+=================
+FS_FileList_ExtensionIndexHash
+=================
+*/
+static unsigned int FS_FileList_ExtensionIndexHash( const fsc_directory_t *directory, const char *extension ) {
+	return (unsigned int)( (uintptr_t)directory >> 4 ) * 31 + ( extension ? FSC_StringHash( extension, NULL ) : 0 );
+}
+
+/*
+=================
+FS_FileList_ExtensionIndexFind
+
+Returns index entry for given directory and extension, or null if not found.
+=================
+*/
+static extension_index_entry_t *FS_FileList_ExtensionIndexFind( const fsc_directory_t *directory, const char *extension ) {
+	fs_hashtable_iterator_t it = FS_Hashtable_Iterate( &extension_index,
+			FS_FileList_ExtensionIndexHash( directory, extension ), qfalse );
+	extension_index_entry_t *entry;
+
+	while ( ( entry = (extension_index_entry_t *)FS_Hashtable_Next( &it ) ) ) {
+		if ( entry->directory != directory ) {
+			continue;
+		}
+		if ( extension ? ( entry->extension && !Q_stricmp( entry->extension, extension ) ) : !entry->extension ) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+=================
+FS_FileList_ExtensionIndexInsert
+=================
+*/
+static extension_index_entry_t *FS_FileList_ExtensionIndexInsert( const fsc_directory_t *directory, const char *extension ) {
+	extension_index_entry_t *entry = (extension_index_entry_t *)Z_Malloc( sizeof( *entry ) );
+	entry->directory = directory;
+	entry->extension = extension;
+	FS_Hashtable_Insert( &extension_index, &entry->hte, FS_FileList_ExtensionIndexHash( directory, extension ) );
+	return entry;
+}
+
+/*
+=================
+FS_FileList_ExtensionIndexFreeEntry
+=================
+*/
+static void FS_FileList_ExtensionIndexFreeEntry( fs_hashtable_entry_t *hte ) {
+	extension_index_entry_t *entry = (extension_index_entry_t *)hte;
+	if ( entry->files ) {
+		Z_Free( (void *)entry->files );
+	}
+	Z_Free( entry );
+}
+
+/*
+=================
+FS_FileList_ExtensionIndexValidate
+
+Clears the extension index if the filesystem has changed since it was built.
+=================
+*/
+static void FS_FileList_ExtensionIndexValidate( void ) {
+	unsigned int generation = FS_GetGeneration();
+	if ( !extension_index.bucket_count ) {
+		FS_Hashtable_Initialize( &extension_index, 4096 );
+	} else if ( extension_index_generation != generation ) {
+		FS_Hashtable_Reset( &extension_index, FS_FileList_ExtensionIndexFreeEntry );
+	}
+	extension_index_generation = generation;
+}
+
+/*
+=================
+FS_FileList_ExtensionIndexDirectory
+
+Indexes the files directly within the directory by extension, if not already done.
+=================
+*/
+static void FS_FileList_ExtensionIndexDirectory( const fsc_directory_t *directory ) {
+	const fsc_file_t *file;
+	if ( FS_FileList_ExtensionIndexFind( directory, NULL ) ) {
+		return;
+	}
+
+	file = (const fsc_file_t *)STACKPTRN( directory->sub_file );
+	while ( file ) {
+		const char *extension = (const char *)STACKPTR( file->qp_ext_ptr );
+		if ( *extension ) {
+			extension_index_entry_t *entry = FS_FileList_ExtensionIndexFind( directory, extension );
+			if ( !entry ) {
+				entry = FS_FileList_ExtensionIndexInsert( directory, extension );
+			}
+			if ( entry->file_count >= entry->file_capacity ) {
+				const fsc_file_t **old_files = entry->files;
+				entry->file_capacity = entry->file_capacity ? entry->file_capacity * 2 : 16;
+				entry->files = (const fsc_file_t **)Z_Malloc( sizeof( *entry->files ) * entry->file_capacity );
+				if ( old_files ) {
+					Com_Memcpy( (void *)entry->files, old_files, sizeof( *entry->files ) * entry->file_count );
+					Z_Free( (void *)old_files );
+				}
+			}
+			entry->files[entry->file_count++] = file;
+		}
+
+		file = (const fsc_file_t *)STACKPTRN( file->next_in_directory );
+	}
+
+	FS_FileList_ExtensionIndexInsert( directory, NULL );
+}
+
+/*
+=================
+FS_FileList_ExtensionIndexLookup
+
+Returns files with given extension directly within directory. Extension index must be validated.
+=================
+*/
+static const fsc_file_t **FS_FileList_ExtensionIndexLookup( const fsc_directory_t *directory,
+		const char *extension, int *count_out ) {
+	extension_index_entry_t *entry;
+	FS_FileList_ExtensionIndexDirectory( directory );
+	entry = FS_FileList_ExtensionIndexFind( directory, extension );
+	*count_out = entry ? entry->file_count : 0;
+	return entry ? entry->files : NULL;
+}
+
+/*
+=================
+FS_FileList_IndexableExtension
+
+Returns qtrue if the extension query matches exactly the files with a certain qp_ext value.
+This is the case if the extension begins with a period and has no other special characters.
+=================
+*/
+static qboolean FS_FileList_IndexableExtension( const char *extension ) {
+	if ( !extension || extension[0] != '.' || !extension[1] ) {
+		return qfalse;
+	}
+	if ( strpbrk( extension + 1, "./\\*?" ) ) {
+		return qfalse;
+	}
+	return qtrue;
+}
+
+/*
+###############################################################################################
+
 File list generation
 
 ###############################################################################################
@@ -234,6 +411,15 @@ typedef struct {
 	file_list_sort_key_t *file_sort_key;
 } temp_file_set_entry_t;
 
+// Lists returned by the file list functions are reference counted, so the file list cache
+// can return the same list again instead of a copy.
+typedef struct {
+	int refcount;
+	char *list[1];	// null terminated, allocated to count + 1
+} file_list_t;
+
+#define FILE_LIST_FROM_LIST( strings ) ( (file_list_t *)( (char *)( strings ) - offsetof( file_list_t, list ) ) )
+
 /*
 =================
 FS_FileList_AllocateString
@@ -395,84 +581,112 @@ static void FS_FileList_CutStream( const fsc_stream_t *source, fsc_stream_t *tar
 
 /*
 =================
-FS_FileList_TempFileSetPopulate
+FS_FileList_TempFileSetAddFile
 
-Recursively searches for files matching listing criteria and adds them to file set.
+Adds file and directory strings generated by file to file set, if they match listing criteria.
 =================
 */
-static void FS_FileList_TempFileSetPopulate( const fsc_directory_t *base, fs_hashtable_t *output, filelist_work_t *flw ) {
+static void FS_FileList_TempFileSetAddFile( const fsc_file_t *file, fs_hashtable_t *output, filelist_work_t *flw ) {
 	char path_buffer[FS_FILE_BUFFER_SIZE];
 	fsc_stream_t path_stream = FSC_InitStream( path_buffer, sizeof( path_buffer ) );
 	char string_buffer[FS_FILE_BUFFER_SIZE];
 	fsc_stream_t string_stream = FSC_InitStream( string_buffer, sizeof( string_buffer ) );
-	fsc_file_t *file;
-	fsc_directory_t *directory;
+	int directory_depth = DIRECT_NON_PK3DIR( file ) ? flw->direct_directory_depth : flw->general_directory_depth;
+	int file_depth = DIRECT_NON_PK3DIR( file ) ? flw->direct_file_depth : flw->general_file_depth;
+	int i, j;
+	file_list_sort_key_t *sort_key = NULL;
+	int depth = 0;
 
-	file = (fsc_file_t *)STACKPTRN( base->sub_file );
-	while ( file ) {
-		if ( FSC_IsFileActive( file, &fs.index ) && FS_FileList_CheckFileListable( file, flw ) ) {
-			int directory_depth = DIRECT_NON_PK3DIR( file ) ? flw->direct_directory_depth : flw->general_directory_depth;
-			int file_depth = DIRECT_NON_PK3DIR( file ) ? flw->direct_file_depth : flw->general_file_depth;
-			int i, j;
-			file_list_sort_key_t *sort_key = NULL;
-			int depth = 0;
-
-			// Generate file and directory strings for each file, and call FS_FileList_TempFileSetInsert
-			// For example, a file with post-crop_length string "abc/def/temp.txt" will generate:
-			// - file string "abc/def/temp.txt" if file depth >= 3
-			// - if the file is in a pk3, "abc/" if dir depth >= 1, and "abc/def/" if dir depth >= 2
-			// - if file is on disk, ["abc", ".", ".."] if dir depth >= 1, ["abc/def", "abc/.", "abc/.."]
-			//       if dir depth >= 2, and ["abc/def/.", "abc/def/.."] if dir depth >= 3
-
-			path_stream.position = 0;
-			FS_FileToStream( file, &path_stream, qfalse, qfalse, qfalse, qfalse );
-			for ( i = flw->crop_length; i < path_stream.position; ++i ) {
-				if ( path_stream.data[i] == '/' ) {
-					depth++;
-					if ( depth <= directory_depth ) {
-						// Process directory
-						FS_FileList_CutStream( &path_stream, &string_stream, flw->crop_length, i );
-						// Include trailing slash unless directory is from disk, as per original filesystem behavior
-						if ( !DIRECT_NON_PK3DIR( file ) ) {
-							FSC_StreamAppendString( &string_stream, "/" );
-						}
-						if ( FS_FileList_CheckPathListable( &string_stream, flw ) ) {
-							FS_FileList_TempFileSetInsert( output, file, string_stream.data, qtrue, &sort_key, flw );
-						}
-					}
-				}
+	if ( !FSC_IsFileActive( file, &fs.index ) || !FS_FileList_CheckFileListable( file, flw ) ) {
+		return;
+	}
 
-				// Generate "." and ".." entries for directories from disk
-				if ( DIRECT_NON_PK3DIR( file ) && ( i == flw->crop_length || path_stream.data[i] == '/' ) && depth < directory_depth ) {
-					FS_FileList_CutStream( &path_stream, &string_stream, flw->crop_length, i );
-					if ( i != flw->crop_length ) {
-						FSC_StreamAppendString( &string_stream, "/" );
-					}
-					for ( j = 0; j < 2; ++j ) {
-						FSC_StreamAppendString( &string_stream, "." );
-						if ( FS_FileList_CheckPathListable( &string_stream, flw ) ) {
-							FS_FileList_TempFileSetInsert( output, file, string_stream.data, qtrue, &sort_key, flw );
-						}
-					}
+	// Generate file and directory strings for each file, and call FS_FileList_TempFileSetInsert
+	// For example, a file with post-crop_length string "abc/def/temp.txt" will generate:
+	// - file string "abc/def/temp.txt" if file depth >= 3
+	// - if the file is in a pk3, "abc/" if dir depth >= 1, and "abc/def/" if dir depth >= 2
+	// - if file is on disk, ["abc", ".", ".."] if dir depth >= 1, ["abc/def", "abc/.", "abc/.."]
+	//       if dir depth >= 2, and ["abc/def/.", "abc/def/.."] if dir depth >= 3
+
+	path_stream.position = 0;
+	FS_FileToStream( file, &path_stream, qfalse, qfalse, qfalse, qfalse );
+	for ( i = flw->crop_length; i < path_stream.position; ++i ) {
+		if ( path_stream.data[i] == '/' ) {
+			depth++;
+			if ( depth <= directory_depth ) {
+				// Process directory
+				FS_FileList_CutStream( &path_stream, &string_stream, flw->crop_length, i );
+				// Include trailing slash unless directory is from disk, as per original filesystem behavior
+				if ( !DIRECT_NON_PK3DIR( file ) ) {
+					FSC_StreamAppendString( &string_stream, "/" );
+				}
+				if ( FS_FileList_CheckPathListable( &string_stream, flw ) ) {
+					FS_FileList_TempFileSetInsert( output, file, string_stream.data, qtrue, &sort_key, flw );
 				}
 			}
+		}
 
-			if ( depth < file_depth ) {
-				// Process file
-				FS_FileList_CutStream( &path_stream, &string_stream, flw->crop_length, path_stream.position );
+		// Generate "." and ".." entries for directories from disk
+		if ( DIRECT_NON_PK3DIR( file ) && ( i == flw->crop_length || path_stream.data[i] == '/' ) && depth < directory_depth ) {
+			FS_FileList_CutStream( &path_stream, &string_stream, flw->crop_length, i );
+			if ( i != flw->crop_length ) {
+				FSC_StreamAppendString( &string_stream, "/" );
+			}
+			for ( j = 0; j < 2; ++j ) {
+				FSC_StreamAppendString( &string_stream, "." );
 				if ( FS_FileList_CheckPathListable( &string_stream, flw ) ) {
-					FS_FileList_TempFileSetInsert( output, file, string_stream.data, qfalse, &sort_key, flw );
+					FS_FileList_TempFileSetInsert( output, file, string_stream.data, qtrue, &sort_key, flw );
 				}
 			}
 		}
+	}
 
-		file = (fsc_file_t *)STACKPTRN( file->next_in_directory );
+	if ( depth < file_depth ) {
+		// Process file
+		FS_FileList_CutStream( &path_stream, &string_stream, flw->crop_length, path_stream.position );
+		if ( FS_FileList_CheckPathListable( &string_stream, flw ) ) {
+			FS_FileList_TempFileSetInsert( output, file, string_stream.data, qfalse, &sort_key, flw );
+		}
+	}
+}
+
+/*
+=================
+FS_FileList_TempFileSetPopulate
+
+Recursively searches for files matching listing criteria and adds them to file set.
+Level is the number of directories below the start directory.
+=================
+*/
+static void FS_FileList_TempFileSetPopulate( const fsc_directory_t *base, int level, fs_hashtable_t *output, filelist_work_t *flw ) {
+	fsc_file_t *file;
+	fsc_directory_t *directory;
+
+	if ( flw->index_extension ) {
+		int i, count;
+		const fsc_file_t **files = FS_FileList_ExtensionIndexLookup( base, flw->index_extension, &count );
+		for ( i = 0; i < count; ++i ) {
+			FS_FileList_TempFileSetAddFile( files[i], output, flw );
+		}
+	} else {
+		file = (fsc_file_t *)STACKPTRN( base->sub_file );
+		while ( file ) {
+			FS_FileList_TempFileSetAddFile( file, output, flw );
+			file = (fsc_file_t *)STACKPTRN( file->next_in_directory );
+		}
+	}
+
+	// If no directories are being listed, files in subdirectories beyond the file depth can't
+	// produce any output, so skip them
+	if ( !flw->general_directory_depth && !flw->direct_directory_depth &&
+			level + 1 >= flw->general_file_depth && level + 1 >= flw->direct_file_depth ) {
+		return;
 	}
 
 	// Process subdirectories
 	directory = (fsc_directory_t *)STACKPTRN( base->sub_directory );
 	while ( directory ) {
-		FS_FileList_TempFileSetPopulate( directory, output, flw );
+		FS_FileList_TempFileSetPopulate( directory, level + 1, output, flw );
 		directory = (fsc_directory_t *)STACKPTRN( directory->peer_directory );
 	}
 }
@@ -538,7 +752,7 @@ static char **FS_FileList_TempSetToList( fs_hashtable_t *file_set, int *numfiles
 	fs_hashtable_iterator_t it;
 	temp_file_set_entry_t *entry;
 	int position = 0;
-	char **output = (char **)Z_Malloc( sizeof( *output ) * ( file_set->element_count + 1 ) );
+	file_list_t *output = (file_list_t *)Z_Malloc( sizeof( *output ) + sizeof( *output->list ) * file_set->element_count );
 	temp_file_set_entry_t **temp_list = (temp_file_set_entry_t **)Z_Malloc( sizeof( *temp_list ) * file_set->element_count );
 
 	// Transfer entries from file set hashtable to temporary list
@@ -560,15 +774,147 @@ static char **FS_FileList_TempSetToList( fs_hashtable_t *file_set, int *numfiles
 
 	// Transfer strings from list to output array
 	for ( i = 0; i < file_set->element_count; ++i ) {
-		output[i] = temp_list[i]->string;
+		output->list[i] = temp_list[i]->string;
 	}
-	output[i] = NULL;
+	output->list[i] = NULL;
+	output->refcount = 1;
 
 	if ( numfiles_out ) {
 		*numfiles_out = file_set->element_count;
 	}
 	Z_Free( temp_list );
-	return output;
+	return output->list;
+}
+
+/*
+###############################################################################################
+
+File list cache
+
+Stores sorted results of recent file list queries, so menus that repeatedly list the same
+directory don't need to regenerate them. The cache is cleared when the filesystem generation
+changes. Cached lists are shared with callers through the list reference count.
+
+###############################################################################################
+*/
+
+#define FILELIST_CACHE_MAX_ENTRIES 64
+
+typedef struct {
+	fs_hashtable_entry_t hte;
+	char *key;
+	char **list;
+	int count;
+} filelist_cache_entry_t;
+
+static fs_hashtable_t filelist_cache;
+static unsigned int filelist_cache_generation;
+
+/*
+=================
+FS_FileList_CacheKey
+
+Writes string identifying query parameters to stream.
+=================
+*/
+static void FS_FileList_CacheKey( const char *path, const filelist_query_t *query, fsc_stream_t *stream ) {
+	FSC_StreamAppendString( stream, va( "%i", query->flags ) );
+	FSC_StreamAppendString( stream, path ? "\n+" : "\n-" );
+	FSC_StreamAppendString( stream, path ? path : "" );
+	FSC_StreamAppendString( stream, query->extension ? "\n+" : "\n-" );
+	FSC_StreamAppendString( stream, query->extension ? query->extension : "" );
+	FSC_StreamAppendString( stream, query->filter ? "\n+" : "\n-" );
+	FSC_StreamAppendString( stream, query->filter ? query->filter : "" );
+}
+
+/*
+=================
+FS_FileList_CacheFreeEntry
+=================
+*/
+static void FS_FileList_CacheFreeEntry( fs_hashtable_entry_t *hte ) {
+	filelist_cache_entry_t *entry = (filelist_cache_entry_t *)hte;
+	FS_FreeFileList( entry->list );
+	Z_Free( entry->key );
+	Z_Free( entry );
+}
+
+/*
+=================
+FS_FileList_CacheValidate
+
+Clears the cache if the filesystem has changed since results were stored.
+=================
+*/
+static void FS_FileList_CacheValidate( void ) {
+	unsigned int generation = FS_GetGeneration();
+	if ( !filelist_cache.bucket_count ) {
+		FS_Hashtable_Initialize( &filelist_cache, FILELIST_CACHE_MAX_ENTRIES );
+	} else if ( filelist_cache_generation != generation ) {
+		FS_Hashtable_Reset( &filelist_cache, FS_FileList_CacheFreeEntry );
+	}
+	filelist_cache_generation = generation;
+}
+
+/*
+=================
+FS_FileList_CacheLookup
+
+Returns cached list for query with reference count incremented, or null if not cached.
+=================
+*/
+static char **FS_FileList_CacheLookup( const char *path, const filelist_query_t *query, int *numfiles_out ) {
+	char key[FSC_MAX_QPATH * 4];
+	fsc_stream_t stream = FSC_InitStream( key, sizeof( key ) );
+	fs_hashtable_iterator_t it;
+	filelist_cache_entry_t *entry;
+
+	FS_FileList_CacheValidate();
+	FS_FileList_CacheKey( path, query, &stream );
+	if ( stream.overflowed ) {
+		return NULL;
+	}
+
+	it = FS_Hashtable_Iterate( &filelist_cache, FSC_StringHash( key, NULL ), qfalse );
+	while ( ( entry = (filelist_cache_entry_t *)FS_Hashtable_Next( &it ) ) ) {
+		if ( !strcmp( entry->key, key ) ) {
+			if ( numfiles_out ) {
+				*numfiles_out = entry->count;
+			}
+			++FILE_LIST_FROM_LIST( entry->list )->refcount;
+			return entry->list;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+=================
+FS_FileList_CacheStore
+
+Adds reference to list to cache for query.
+=================
+*/
+static void FS_FileList_CacheStore( const char *path, const filelist_query_t *query, char **list, int count ) {
+	char key[FSC_MAX_QPATH * 4];
+	fsc_stream_t stream = FSC_InitStream( key, sizeof( key ) );
+	filelist_cache_entry_t *entry;
+
+	FS_FileList_CacheKey( path, query, &stream );
+	if ( stream.overflowed ) {
+		return;
+	}
+	if ( filelist_cache.element_count >= FILELIST_CACHE_MAX_ENTRIES ) {
+		FS_Hashtable_Reset( &filelist_cache, FS_FileList_CacheFreeEntry );
+	}
+
+	entry = (filelist_cache_entry_t *)Z_Malloc( sizeof( *entry ) );
+	entry->key = FS_FileList_AllocateString( key );
+	entry->list = list;
+	++FILE_LIST_FROM_LIST( list )->refcount;
+	entry->count = count;
+	FS_Hashtable_Insert( &filelist_cache, &entry->hte, FSC_StringHash( key, NULL ) );
 }
 
 /*
@@ -656,6 +1002,17 @@ static char **FS_FileList_GenerateList( const char *path, int *numfiles_out, fil
 		FS_FileList_PrintDebugFlags( query->flags );
 	}
 
+	// Check for cached result
+	result = FS_FileList_CacheLookup( path, query, numfiles_out );
+	if ( result ) {
+		if ( fs.cvar.fs_debug_filelist->integer ) {
+			FS_DPrintf( "result: %i elements (cached)\n", numfiles_out ? *numfiles_out : -1 );
+			FS_DPrintf( "time: %i\n", Sys_Milliseconds() - start_time );
+			FS_DebugIndentStop();
+		}
+		return result;
+	}
+
 	// Initialize temp structures
 	Com_Memset( &flw, 0, sizeof( flw ) );
 	flw.extension = query->extension;
@@ -740,14 +1097,21 @@ static char **FS_FileList_GenerateList( const char *path, int *numfiles_out, fil
 			flw.crop_length = strlen( (const char *)STACKPTR( start_directory->qp_dir_ptr ) );
 		}
 
+		// Use extension index if only files with one specific extension can be listed
+		FS_FileList_ExtensionIndexValidate();
+		if ( !flw.general_directory_depth && !flw.direct_directory_depth && FS_FileList_IndexableExtension( flw.extension ) ) {
+			flw.index_extension = flw.extension;
+		}
+
 		// Populate file set
-		FS_FileList_TempFileSetPopulate( start_directory, &temp_file_set, &flw );
+		FS_FileList_TempFileSetPopulate( start_directory, 0, &temp_file_set, &flw );
 	} else if ( fs.cvar.fs_debug_filelist->integer ) {
 		FS_DPrintf( "NOTE: Failed to match start directory.\n" );
 	}
 
 	// Generate file list
 	result = FS_FileList_TempSetToList( &temp_file_set, numfiles_out, &flw );
+	FS_FileList_CacheStore( path, query, result, temp_file_set.element_count );
 
 	if ( fs.cvar.fs_debug_filelist->integer ) {
 		FS_DPrintf( "result: %i elements\n", temp_file_set.element_count );
@@ -767,16 +1131,23 @@ FS_FreeFileList
 =================
 */
 void FS_FreeFileList( char **list ) {
+	file_list_t *file_list;
 	int i;
 	if ( !list ) {
 		return;
 	}
 
+	// List may still be referenced by the file list cache
+	file_list = FILE_LIST_FROM_LIST( list );
+	if ( --file_list->refcount > 0 ) {
+		return;
+	}
+
 	for ( i = 0; list[i]; i++ ) {
 		Z_Free( list[i] );
 	}
 
-	Z_Free( list );
+	Z_Free( file_list );
 }
 
 /*
@@ -873,6 +1244,29 @@ static void FS_FreeModDirList( mod_dir_list_t *list ) {
 	for ( i = 0; i < list->count; ++i ) {
 		Z_Free( list->mod_dirs[i] );
 	}
+	list->count = 0;
+}
+
+/*
+=================
+FS_GetModDirList
+
+Returns mod directory list, regenerating it if the filesystem has changed since the last call.
+=================
+*/
+static const mod_dir_list_t *FS_GetModDirList( void ) {
+	static mod_dir_list_t list;
+	static qboolean valid = qfalse;
+	static unsigned int generation;
+
+	if ( !valid || generation != FS_GetGeneration() ) {
+		FS_FreeModDirList( &list );
+		FS_GenerateModDirList( &list );
+		generation = FS_GetGeneration();
+		valid = qtrue;
+	}
+
+	return &list;
 }
 
 /*
@@ -884,15 +1278,13 @@ static int FS_GetModList( char *listbuf, int bufsize ) {
 	int i;
 	int nTotal = 0; // Amount of buffer used so far
 	int nMods = 0; // Number of mods
-	mod_dir_list_t list;
+	const mod_dir_list_t *list = FS_GetModDirList();
 	char description[49];
 	int mod_name_length;
 	int description_length;
 
-	FS_GenerateModDirList( &list );
-
-	for ( i = 0; i < list.count; ++i ) {
-		char *mod_name = list.mod_dirs[i];
+	for ( i = 0; i < list->count; ++i ) {
+		char *mod_name = list->mod_dirs[i];
 
 		// skip standard directories
 		if ( !Q_stricmp( mod_name, com_basegame->string ) ) {
@@ -916,7 +1308,6 @@ static int FS_GetModList( char *listbuf, int bufsize ) {
 		}
 	}
 
-	FS_FreeModDirList( &list );
 	return nMods;
 }
 
@@ -932,7 +1323,7 @@ Exported functions
 =================
 FS_ListFilteredFiles_Flags
 
-Result must be freed by FS_FreeFileList.
+Result must be freed by FS_FreeFileList, and not modified since it may be shared with the cache.
 path, extension, filter, and numfiles_out may be null.
 =================
 */
@@ -946,7 +1337,7 @@ char **FS_ListFilteredFiles_Flags( const char *path, const char *extension,
 =================
 FS_ListFiles
 
-Result must be freed by FS_FreeFileList.
+Result must be freed by FS_FreeFileList, and not modified since it may be shared with the cache.
 path, extension, and numfiles may be null.
 =================
 */
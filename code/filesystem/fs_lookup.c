@@ -1007,6 +1007,157 @@ static void FS_PerformLookup( const lookup_query_t *queries, int query_count, qb
 	FS_FreeSelectionOutput( &selection_output );
 }
 
+/* *** Cached Lookup *** */
+
+// Results of standard lookups are cached until the filesystem generation changes, which
+// covers index refreshes as well as changes to the mod dir, current map, and connected server
+// pure state. Protected VM lookups are never cached since they can print warnings.
+
+#define LOOKUP_CACHE_MAX_ENTRIES 16384
+
+typedef struct {
+	fs_hashtable_entry_t hte;
+	char *key;
+	query_result_t result;
+	unsigned int hits;
+} lookup_cache_entry_t;
+
+typedef struct {
+	fs_hashtable_t ht;
+	unsigned int generation;
+	unsigned int hits;
+	unsigned int misses;
+	unsigned int resets;
+} lookup_cache_t;
+
+static lookup_cache_t lookup_cache;
+
+/*
+=================
+FS_LookupCache_GenerateKey
+
+Writes string identifying query to stream. Returns qtrue on success, qfalse on overflow.
+=================
+*/
+static qboolean FS_LookupCache_GenerateKey( const lookup_query_t *query, fsc_stream_t *stream ) {
+	int i;
+	ADD_STRING( va( "%i\n", query->lookup_flags ) );
+	if ( query->qp_name ) {
+		ADD_STRING( query->qp_dir );
+		ADD_STRING( query->qp_name );
+		for ( i = 0; i < query->extension_count; ++i ) {
+			ADD_STRING( "\n" );
+			ADD_STRING( query->qp_exts[i] );
+		}
+	}
+	ADD_STRING( "\n" );
+	if ( query->shader_name ) {
+		ADD_STRING( query->shader_name );
+	}
+	return stream->overflowed ? qfalse : qtrue;
+}
+
+/*
+=================
+FS_LookupCache_Validate
+
+Clears the cache if the filesystem generation has changed.
+=================
+*/
+static void FS_LookupCache_Validate( void ) {
+	unsigned int generation = FS_GetGeneration();
+	if ( !lookup_cache.ht.bucket_count ) {
+		FS_Hashtable_Initialize( &lookup_cache.ht, LOOKUP_CACHE_MAX_ENTRIES );
+	} else if ( lookup_cache.generation != generation || lookup_cache.ht.element_count >= LOOKUP_CACHE_MAX_ENTRIES ) {
+		FS_Hashtable_Reset( &lookup_cache.ht, NULL );
+		++lookup_cache.resets;
+	}
+	lookup_cache.generation = generation;
+}
+
+/*
+=================
+FS_LookupCache_Find
+
+Returns cache entry matching key, or null if not found.
+=================
+*/
+static lookup_cache_entry_t *FS_LookupCache_Find( const char *key ) {
+	fs_hashtable_iterator_t it = FS_Hashtable_Iterate( &lookup_cache.ht, FSC_StringHash( key, NULL ), qfalse );
+	lookup_cache_entry_t *entry;
+	while ( ( entry = (lookup_cache_entry_t *)FS_Hashtable_Next( &it ) ) ) {
+		if ( !strcmp( entry->key, key ) ) {
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+/*
+=================
+FS_PerformLookupCached
+
+Equivalent to FS_PerformLookup for a single non-protected query, but using the lookup cache.
+The lookup cache is only used from the main thread; worker threads perform the lookup directly.
+=================
+*/
+static void FS_PerformLookupCached( const lookup_query_t *query, query_result_t *output ) {
+	char key[FSC_MAX_QPATH * 4];
+	fsc_stream_t stream = FSC_InitStream( key, sizeof( key ) );
+	lookup_cache_entry_t *entry;
+
+	if ( Sys_InWorkerThread() || !FS_LookupCache_GenerateKey( query, &stream ) ) {
+		FS_PerformLookup( query, 1, qfalse, output );
+		return;
+	}
+
+	FS_LookupCache_Validate();
+	entry = FS_LookupCache_Find( key );
+	if ( entry ) {
+		++entry->hits;
+		++lookup_cache.hits;
+		*output = entry->result;
+		return;
+	}
+
+	++lookup_cache.misses;
+	FS_PerformLookup( query, 1, qfalse, output );
+
+	// Use Z_Malloc rather than CopyString, since large numbers of entries could overflow the small zone
+	entry = (lookup_cache_entry_t *)Z_Malloc( sizeof( *entry ) + stream.position + 1 );
+	entry->key = (char *)entry + sizeof( *entry );
+	Com_Memcpy( entry->key, key, stream.position + 1 );
+	entry->result = *output;
+	FS_Hashtable_Insert( &lookup_cache.ht, &entry->hte, FSC_StringHash( key, NULL ) );
+}
+
+/*
+=================
+FS_LookupCache_DebugPrint
+
+Prints cache statistics, and cache status of query if not null.
+=================
+*/
+static void FS_LookupCache_DebugPrint( const lookup_query_t *query ) {
+	FS_LookupCache_Validate();
+	if ( query ) {
+		char key[FSC_MAX_QPATH * 4];
+		fsc_stream_t stream = FSC_InitStream( key, sizeof( key ) );
+		lookup_cache_entry_t *entry = NULL;
+		if ( FS_LookupCache_GenerateKey( query, &stream ) ) {
+			entry = FS_LookupCache_Find( key );
+		}
+		if ( entry ) {
+			Com_Printf( "Lookup cache: query cached (%u hits)\n", entry->hits );
+		} else {
+			Com_Printf( "Lookup cache: query not cached\n" );
+		}
+	}
+	Com_Printf( "Lookup cache: %i entries, %u hits, %u misses, %u resets, generation %u\n",
+			lookup_cache.ht.element_count, lookup_cache.hits, lookup_cache.misses,
+			lookup_cache.resets, lookup_cache.generation );
+}
+
 /* *** Debug Query Storage *** */
 
 static qboolean have_debug_selection = qfalse;
@@ -1127,6 +1278,11 @@ static void FS_DebugLookup( const lookup_query_t *queries, int query_count, qboo
 	if ( debug_selection.resource_count > 1 ) {
 		Com_Printf( "Use the 'fs_compare' command to get precedence details.\n" );
 	}
+
+	// Protected lookups bypass the lookup cache, so only report its status for standard ones
+	if ( !protected_vm_lookup ) {
+		FS_LookupCache_DebugPrint( query_count == 1 ? &queries[0] : NULL );
+	}
 #ifdef CMOD_QVM_SELECTION
 	if ( output ) {
 		Com_Memset( output, 0, sizeof( *output ) );
@@ -1310,8 +1466,8 @@ const fsc_file_t *FS_GeneralLookup( const char *name, int lookup_flags, qboolean
 		return NULL;
 	}
 
-	FS_PerformLookup( &query, 1, qfalse, &lookup_result );
-	if ( fs.cvar.fs_debug_lookup->integer ) {
+	FS_PerformLookupCached( &query, &lookup_result );
+	if ( fs.cvar.fs_debug_lookup->integer && !Sys_InWorkerThread() ) {
 		FS_DPrintf( "********** general lookup **********\n" );
 		FS_DebugIndentStart();
 		FS_DPrintf( "name: %s\n", name );
@@ -1357,7 +1513,7 @@ static void FS_ShaderOrImageLookup( const char *name, qboolean image_only, int l
 	if ( debug ) {
 		FS_DebugLookup( &query, 1, qfalse );
 	} else {
-		FS_PerformLookup( &query, 1, qfalse, output );
+		FS_PerformLookupCached( &query, output );
 	}
 }
 
@@ -1433,6 +1589,25 @@ const fsc_file_t *FS_ImageLookup( const char *name, int lookup_flags, qboolean d
 	return lookup_result.file;
 }
 
+/*
+=================
+FS_ImageLookupBatch
+
+Performs image lookup for each name in the list, writing results to output, which must have
+space for count elements. Input names should be extension-free. Intended for resolving all the
+image stages of a shader in one call.
+=================
+*/
+void FS_ImageLookupBatch( const char **names, int count, int lookup_flags, const fsc_file_t **output ) {
+	int i;
+	FSC_ASSERT( names );
+	FSC_ASSERT( output );
+
+	for ( i = 0; i < count; ++i ) {
+		output[i] = names[i] && *names[i] ? FS_ImageLookup( names[i], lookup_flags, qfalse ) : NULL;
+	}
+}
+
 /*
 =================
 FS_SoundLookup
@@ -1476,7 +1651,7 @@ const fsc_file_t *FS_SoundLookup( const char *name, int lookup_flags, qboolean d
 		return NULL;
 	}
 
-	FS_PerformLookup( &query, 1, qfalse, &lookup_result );
+	FS_PerformLookupCached( &query, &lookup_result );
 	if ( fs.cvar.fs_debug_lookup->integer ) {
 		FS_DPrintf( "********** sound lookup **********\n" );
 		FS_DebugIndentStart();
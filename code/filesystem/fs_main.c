@@ -94,6 +94,27 @@ int FS_ConnectedServerPureState( void ) {
 	return 1;
 }
 
+/*
+=================
+FS_GetGeneration
+
+Returns a counter which changes whenever the file index or any filesystem state that can
+affect file lookup or listing results is modified. Used to invalidate cached results.
+=================
+*/
+unsigned int FS_GetGeneration( void ) {
+	int cvar_count = fs.cvar.fs_read_inactive_mods->modificationCount + fs.cvar.fs_list_inactive_mods->modificationCount +
+			fs.cvar.fs_mod_settings->modificationCount;
+#ifdef FS_SERVERCFG_ENABLED
+	cvar_count += fs.cvar.fs_servercfg->modificationCount;
+#endif
+	if ( cvar_count != fs.generation_cvar_count ) {
+		fs.generation_cvar_count = cvar_count;
+		++fs.generation;
+	}
+	return fs.generation;
+}
+
 /*
 ###############################################################################################
 
@@ -116,6 +137,9 @@ void FS_RegisterCurrentMap( const char *name ) {
 	} else {
 		fs.current_map_pk3 = FSC_GetBaseFile( bsp_file, &fs.index );
 	}
+	++fs.generation;
+
+	FS_Prefetch_MapChange( name );
 
 	if ( fs.cvar.fs_debug_state->integer ) {
 		char buffer[FS_FILE_BUFFER_SIZE];
@@ -137,6 +161,7 @@ Registers the sv_pure value of the server we are connecting to with the filesyst
 */
 void FS_SetConnectedServerPureValue( int sv_pure ) {
 	fs.connected_server_sv_pure = sv_pure;
+	++fs.generation;
 	if ( fs.cvar.fs_debug_state->integer ) {
 		Com_Printf( "fs_state: connected_server_sv_pure set to %i\n", sv_pure );
 	}
@@ -167,6 +192,7 @@ void FS_PureServerSetLoadedPaks( const char *hash_list, const char *name_list )
 	for ( i = 0; i < count; ++i ) {
 		FS_Pk3List_Insert( &fs.connected_server_pure_list, atoi( Cmd_Argv( i ) ) );
 	}
+	++fs.generation;
 
 	if ( fs.cvar.fs_debug_state->integer ) {
 		Com_Printf( "fs_state: connected_server_pure_list set to '%s'\n", hash_list );
@@ -184,6 +210,8 @@ void FS_DisconnectCleanup( void ) {
 	fs.current_map_pk3 = NULL;
 	fs.connected_server_sv_pure = 0;
 	FS_Pk3List_Free( &fs.connected_server_pure_list );
+	FS_Prefetch_MapChange( NULL );
+	++fs.generation;
 
 	if ( fs.cvar.fs_debug_state->integer ) {
 		Com_Printf( "fs_state: disconnect cleanup\n   > current_map_pk3 cleared"
@@ -219,6 +247,7 @@ static void FS_UpdateModDirExt( qboolean move_pid ) {
 	if ( !Q_stricmp( fs.current_mod_dir, com_basegame->string ) ) {
 		fs.current_mod_dir[0] = '\0';
 	}
+	++fs.generation;
 
 #ifndef CMOD_NO_SAFE_SETTINGS_PROMPT
 	// Move pid file to new mod dir if necessary
@@ -565,6 +594,7 @@ Updates file index to reflect files recently added/changed on disk.
 =================
 */
 void FS_Refresh( qboolean quiet ) {
+	fsc_stats_t old_active_stats = fs.index.active_stats;
 	int i;
 	if ( fs.cvar.fs_debug_refresh->integer ) {
 		quiet = qfalse;
@@ -589,6 +619,12 @@ void FS_Refresh( qboolean quiet ) {
 		Com_Printf( "Index memory usage at %iMB.\n", FSC_MemoryUseEstimate( &fs.index ) / 1048576 + 1 );
 	}
 
+	// Only advance generation if something changed, so cached results survive auto refreshes
+	if ( fs.index.new_stats.total_file_count ||
+			FSC_Memcmp( &old_active_stats, &fs.index.active_stats, sizeof( old_active_stats ) ) ) {
+		++fs.generation;
+	}
+
 	fs_refresh_frame = com_frameNumber;
 	FS_ReadbackTracker_Reset();
 }
@@ -794,6 +830,7 @@ void FS_Startup( void ) {
 	fs.cvar.fs_full_pure_validation = Cvar_Get( "fs_full_pure_validation", "0", CVAR_ARCHIVE );
 	fs.cvar.fs_download_mode = Cvar_Get( "fs_download_mode", "0", CVAR_ARCHIVE );
 	fs.cvar.fs_auto_refresh_enabled = Cvar_Get( "fs_auto_refresh_enabled", "1", 0 );
+	fs.cvar.fs_prefetch = Cvar_Get( "fs_prefetch", "1", CVAR_ARCHIVE );
 #ifdef FS_SERVERCFG_ENABLED
 	fs.cvar.fs_servercfg = Cvar_Get( "fs_servercfg", "servercfg", 0 );
 	fs.cvar.fs_servercfg_writedir = Cvar_Get( "fs_servercfg_writedir", "", 0 );
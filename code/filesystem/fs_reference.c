@@ -284,7 +284,12 @@ FS_GetPureChecksumEntry
 */
 static pure_checksum_entry_t *FS_GetPureChecksumEntry( const fsc_file_direct_t *pk3 ) {
 	pure_checksum_entry_t *entry = NULL;
-	FSC_LoadPk3( STACKPTR( pk3->os_path_ptr ), &fs.index, FSC_SPNULL, FS_GetPureChecksumEntryCallback, &entry );
+	if ( pk3->pk3_crcs_ptr ) {
+		// Use crc list stored in the index (and fscache.dat) to avoid rereading the central directory
+		FS_GetPureChecksumEntryCallback( &entry, (char *)STACKPTR( pk3->pk3_crcs_ptr ), pk3->pk3_crc_count * 4 );
+	} else {
+		FSC_LoadPk3( STACKPTR( pk3->os_path_ptr ), &fs.index, FSC_SPNULL, FS_GetPureChecksumEntryCallback, &entry );
+	}
 	if ( entry ) {
 		entry->pk3 = pk3;
 	}
@@ -179,6 +179,11 @@ static fsc_stackptr_t FSC_CacheConvertFile( fsc_stackptr_t source_file_ptr, expo
 		fsc_file_direct_t *export_file_typed = (fsc_file_direct_t *)export_file;
 		export_file_typed->qp_mod_ptr = FSC_CacheConvertString( export_file_typed->qp_mod_ptr, xw );
 		export_file_typed->pk3dir_ptr = FSC_CacheConvertString( export_file_typed->pk3dir_ptr, xw );
+		if ( export_file_typed->pk3_crcs_ptr ) {
+			export_file_typed->pk3_crcs_ptr = FSC_StackAllocate( &xw->export_stack, export_file_typed->pk3_crc_count * 4 );
+			FSC_Memcpy( FSC_STACK_RETRIEVE( &xw->export_stack, export_file_typed->pk3_crcs_ptr, fsc_false ),
+					STACKPTR_SRC( ( (fsc_file_direct_t *)source_file )->pk3_crcs_ptr ), export_file_typed->pk3_crc_count * 4 );
+		}
 		export_file_typed->refresh_count = 0;
 		export_file_typed->source_dir_id = 0;
 		// We can leave this null and let FSC_LoadFile patch it back in
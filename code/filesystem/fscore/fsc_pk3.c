@@ -464,6 +464,13 @@ void FSC_LoadPk3( fsc_ospath_t *os_path, fsc_filesystem_t *fs, fsc_stackptr_t so
 
 	sourcefile->pk3_hash = FSC_BlockChecksum( crcs_for_hash, crcs_for_hash_count * 4 );
 
+	// Save the crc list so pure checksums can be generated later without rereading the central directory
+	if ( crcs_for_hash_count && crcs_for_hash_count <= FSC_MAX_STORED_PK3_CRCS ) {
+		sourcefile->pk3_crcs_ptr = FSC_StackAllocate( &fs->general_stack, crcs_for_hash_count * 4 );
+		FSC_Memcpy( STACKPTR( sourcefile->pk3_crcs_ptr ), crcs_for_hash, crcs_for_hash_count * 4 );
+		sourcefile->pk3_crc_count = crcs_for_hash_count;
+	}
+
 	// Add the pk3 to the hash lookup table
 	FSC_RegisterPk3HashLookup( sourcefile_ptr, &fs->pk3_hash_lookup, &fs->general_stack );
 
@@ -26,7 +26,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 // If the version in the cache file does not match this string, the cache will be rebuilt.
 // This version should always be incremented when anything affecting the cache file format changes.
-#define FSC_CACHE_VERSION "ioq3-fs-v14"
+#define FSC_CACHE_VERSION "ioq3-fs-v15"
 
 #define FSC_MAX_QPATH 256	// Buffer size including null terminator
 #define FSC_MAX_MODDIR 32	// Buffer size including null terminator
@@ -34,6 +34,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define	FSC_MAX_TOKEN_CHARS 1024	// based on q_shared.h
 #define FSC_MAX_SHADER_NAME FSC_MAX_TOKEN_CHARS
 
+#define FSC_MAX_STORED_PK3_CRCS 65536	// larger pk3s fall back to rereading the central directory
+
 #define FSC_NULL 0		// normal pointer
 #define FSC_SPNULL 0	// fsc_stackptr_t
 
@@ -176,6 +178,9 @@ typedef struct {
 
 	fsc_stackptr_t pk3dir_ptr;		// null if file is not part of a pk3dir
 	unsigned int pk3_hash;			// null if file is not a valid pk3
+	fsc_stackptr_t pk3_crcs_ptr;	// central directory crcs used to derive pk3_hash and pure checksums,
+									// null if crcs not stored
+	unsigned int pk3_crc_count;		// 0 if crcs not stored
 
 	// For resource tallies
 	unsigned int pk3_subfile_count;
@@ -133,6 +133,7 @@ typedef struct {
 	cvar_t *fs_full_pure_validation;
 	cvar_t *fs_download_mode;
 	cvar_t *fs_auto_refresh_enabled;
+	cvar_t *fs_prefetch;
 	#ifdef FS_SERVERCFG_ENABLED
 	cvar_t *fs_servercfg;
 	cvar_t *fs_servercfg_listlimit;
@@ -161,6 +162,10 @@ typedef struct {
 
 	int connected_server_sv_pure;
 	pk3_list_t connected_server_pure_list;
+
+	// Incremented when the index or any state affecting file selection changes
+	unsigned int generation;
+	int generation_cvar_count;
 } fs_local_t;
 
 extern fs_local_t fs;
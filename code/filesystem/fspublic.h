@@ -114,6 +114,7 @@ DEF_PUBLIC( const char *FS_GetCurrentGameDir( void ) )
 DEF_PUBLIC( const char *FS_PidFileDirectory( void ) )
 DEF_PUBLIC( qboolean FS_Initialized( void ) )
 DEF_LOCAL( int FS_ConnectedServerPureState( void ) )
+DEF_LOCAL( unsigned int FS_GetGeneration( void ) )
 
 // State Modifiers
 DEF_PUBLIC( void FS_RegisterCurrentMap( const char *name ) )
@@ -140,6 +141,7 @@ DEF_LOCAL( void FS_DebugCompareResources( int resource1_position, int resource2_
 DEF_PUBLIC( const fsc_file_t *FS_GeneralLookup( const char *name, int lookup_flags, qboolean debug ) )
 DEF_PUBLIC( const fsc_shader_t *FS_ShaderLookup( const char *name, int lookup_flags, qboolean debug ) )
 DEF_PUBLIC( const fsc_file_t *FS_ImageLookup( const char *name, int lookup_flags, qboolean debug ) )
+DEF_PUBLIC( void FS_ImageLookupBatch( const char **names, int count, int lookup_flags, const fsc_file_t **output ) )
 DEF_PUBLIC( const fsc_file_t *FS_SoundLookup( const char *name, int lookup_flags, qboolean debug ) )
 DEF_PUBLIC( const fsc_file_t *FS_VMLookup( const char *name, qboolean qvm_only, qboolean debug, qboolean *is_dll_out ) )
 
@@ -174,6 +176,12 @@ DEF_PUBLIC( qboolean FS_FileExists( const char *file ) )
 DEF_PUBLIC( void FS_ReadCache_Initialize( void ) )
 DEF_PUBLIC( void FS_ReadCache_AdvanceStage( void ) )
 DEF_LOCAL( void FS_ReadCache_Debug( void ) )
+DEF_LOCAL( void FS_ReadCache_Stats( void ) )
+DEF_LOCAL( void FS_ReadCache_Test( const char *filter, int threads, int passes ) )
+
+// Level prefetch
+DEF_LOCAL( void FS_Prefetch_MapChange( const char *map_name ) )
+DEF_PUBLIC( void FS_Prefetch_Shutdown( void ) )
 
 // Data reading
 DEF_PUBLIC( char *FS_ReadData( const fsc_file_t *file, const char *path, unsigned int *size_out, const char *calling_function ) )
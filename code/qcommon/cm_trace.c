@@ -1374,7 +1374,13 @@ CM_BoxTrace
 void CM_BoxTrace( trace_t *results, const vec3_t start, const vec3_t end,
 						  vec3_t mins, vec3_t maxs,
 						  clipHandle_t model, int brushmask, int capsule ) {
+#ifdef CMOD_PROFILER
+	int64_t profileStart = CMPROFILE_START();
 	CM_Trace( results, start, end, mins, maxs, model, vec3_origin, brushmask, capsule, NULL );
+	CMPROFILE_END( PROFILE_CM_BOXTRACE, profileStart );
+#else
+	CM_Trace( results, start, end, mins, maxs, model, vec3_origin, brushmask, capsule, NULL );
+#endif
 }
 
 /*
@@ -437,6 +437,7 @@ void Com_Quit_f( void ) {
 #endif
 		Com_Shutdown ();
 #ifdef NEW_FILESYSTEM
+		FS_Prefetch_Shutdown();
 		FS_Handle_CloseAll();
 #else
 		FS_Shutdown(qtrue);
@@ -843,12 +844,31 @@ The rover can be left pointing at a non-empty block
 
 The zone calls are pretty much only used for small strings and structures,
 all big things are allocated on the hunk.
+
+Blocks up to ZONE_MAX_SLAB_BLOCK bytes don't come from the main zone directly.
+They are carved out of slabs, which are ZONE_SLAB_SIZE byte main zone blocks
+split into objects of a single size class. Each thread keeps a cache of free
+objects per size class, so most allocations and frees don't have to walk a
+zone or take the zone mutex. Slab objects keep the normal block header and
+tag, so Z_FreeTags and the heap logs work the same for them. TAG_SMALL blocks
+always come from the small zone.
 ==============================================================================
 */
 
 #define	ZONEID	0x1d4a11
+#define	SLABID	0x1d4a12
 #define MINFRAGMENT	64
 
+#define ZONE_SLAB_SIZE		32768	// bytes taken from the main zone for each slab
+#define ZONE_MAX_SLAB_BLOCK	1024	// including header and trash tester
+#define ZONE_CACHE_SIZE		32		// free objects cached per thread and size class
+
+#ifdef _MSC_VER
+#define ZONE_THREAD_LOCAL	__declspec( thread )
+#else
+#define ZONE_THREAD_LOCAL	__thread
+#endif
+
 typedef struct zonedebug_s {
 	char *label;
 	char *file;
@@ -859,8 +879,8 @@ typedef struct zonedebug_s {
 typedef struct memblock_s {
 	int		size;           // including the header and possibly tiny fragments
 	int     tag;            // a tag of 0 is a free block
-	struct memblock_s       *next, *prev;
-	int     id;        		// should be ZONEID
+	struct memblock_s       *next, *prev;	// for slab objects, next free object and owning slab
+	int     id;        		// should be ZONEID, or SLABID for slab objects
 #ifdef ZONE_DEBUG
 	zonedebug_t d;
 #endif
@@ -873,12 +893,50 @@ typedef struct {
 	memblock_t	*rover;
 } memzone_t;
 
+typedef struct zoneslab_s {
+	struct zoneslab_s	*next, *prev;
+	memblock_t	*freelist;
+	int		sizeClass;
+	int		used;			// objects allocated or held in thread caches
+	int		capacity;
+} zoneslab_t;
+
+#define ZONE_SLAB_HEADER	PAD( sizeof( zoneslab_t ), 16 )
+
+// block sizes of the slab size classes, including header and trash tester
+static const int zoneClassSizes[] = {
+	48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512, 640, 768, 896, ZONE_MAX_SLAB_BLOCK
+};
+
+#define ZONE_NUM_CLASSES	ARRAY_LEN( zoneClassSizes )
+
+typedef struct {
+	int		blockSize;
+	int		numSlabs;
+	zoneslab_t	*partial;		// slabs with free objects
+	zoneslab_t	*full;
+} zoneclass_t;
+
+typedef struct {
+	memblock_t	*objects[ZONE_NUM_CLASSES][ZONE_CACHE_SIZE];
+	int		count[ZONE_NUM_CLASSES];
+	qboolean	registered;		// counted in zoneThreads
+} zonecache_t;
+
 // main zone for all "dynamic" memory allocation
 static memzone_t	*mainzone;
 // we also have a small zone for small allocations that would only
 // fragment the main zone (think of cvar and cmd strings)
 static memzone_t	*smallzone;
 
+static zoneclass_t	zoneClasses[ZONE_NUM_CLASSES];
+static byte			zoneSizeClass[ZONE_MAX_SLAB_BLOCK / 16 + 1];	// by ( block size + 15 ) / 16
+static ZONE_THREAD_LOCAL zonecache_t	zoneCache;
+
+// protects the zones and slab lists; thread caches are only touched by their own thread
+static sysMutex_t	*zoneMutex;
+static int			zoneThreads;	// threads using their cache, protected by zoneMutex
+
 static void Z_CheckHeap( void );
 
 /*
@@ -924,21 +982,396 @@ int Z_AvailableMemory( void ) {
 	return Z_AvailableZoneMemory( mainzone );
 }
 
+/*
+========================
+Z_ZoneFree
+
+Returns a block to its zone. Caller must hold zoneMutex.
+========================
+*/
+static void Z_ZoneFree( memzone_t *zone, memblock_t *block ) {
+	memblock_t	*other;
+
+	zone->used -= block->size;
+	// set the block to something that should cause problems
+	// if it is referenced...
+	Com_Memset( block + 1, 0xaa, block->size - sizeof( *block ) );
+
+	block->tag = 0;		// mark as free
+
+	other = block->prev;
+	if (!other->tag) {
+		// merge with previous free block
+		other->size += block->size;
+		other->next = block->next;
+		other->next->prev = other;
+		if (block == zone->rover) {
+			zone->rover = other;
+		}
+		block = other;
+	}
+
+	zone->rover = block;
+
+	other = block->next;
+	if ( !other->tag ) {
+		// merge the next free block onto the end
+		block->size += other->size;
+		block->next = other->next;
+		block->next->prev = block;
+	}
+}
+
+/*
+========================
+Z_ZoneAlloc
+
+First fit allocation of a block of size bytes, including the header and
+trash tester. Returns NULL if no free block is large enough, so the caller
+can release zoneMutex before raising the error. Caller must hold zoneMutex.
+========================
+*/
+static memblock_t *Z_ZoneAlloc( memzone_t *zone, int size, int tag ) {
+	int		extra;
+	memblock_t	*start, *rover, *new, *base;
+
+	//
+	// scan through the block list looking for the first free block
+	// of sufficient size
+	//
+	base = rover = zone->rover;
+	start = base->prev;
+
+	do {
+		if (rover == start)	{
+			// scaned all the way around the list
+			return NULL;
+		}
+		if (rover->tag) {
+			base = rover = rover->next;
+		} else {
+			rover = rover->next;
+		}
+	} while (base->tag || base->size < size);
+
+	//
+	// found a block big enough
+	//
+	extra = base->size - size;
+	if (extra > MINFRAGMENT) {
+		// there will be a free fragment after the allocated block
+		new = (memblock_t *) ((byte *)base + size );
+		new->size = extra;
+		new->tag = 0;			// free block
+		new->prev = base;
+		new->id = ZONEID;
+		new->next = base->next;
+		new->next->prev = new;
+		base->next = new;
+		base->size = size;
+	}
+
+	base->tag = tag;			// no longer a free block
+
+	zone->rover = base->next;	// next allocation will start looking here
+	zone->used += base->size;	//
+
+	base->id = ZONEID;
+
+	return base;
+}
+
+/*
+========================
+Z_SlabObject
+========================
+*/
+static memblock_t *Z_SlabObject( zoneslab_t *slab, int index ) {
+	return (memblock_t *)( (byte *)slab + ZONE_SLAB_HEADER + index * zoneClasses[slab->sizeClass].blockSize );
+}
+
+/*
+========================
+Z_SlabLink
+========================
+*/
+static void Z_SlabLink( zoneslab_t **list, zoneslab_t *slab ) {
+	slab->prev = NULL;
+	slab->next = *list;
+	if ( *list ) {
+		(*list)->prev = slab;
+	}
+	*list = slab;
+}
+
+/*
+========================
+Z_SlabUnlink
+========================
+*/
+static void Z_SlabUnlink( zoneslab_t **list, zoneslab_t *slab ) {
+	if ( slab->prev ) {
+		slab->prev->next = slab->next;
+	} else {
+		*list = slab->next;
+	}
+	if ( slab->next ) {
+		slab->next->prev = slab->prev;
+	}
+}
+
+/*
+========================
+Z_NewSlab
+
+Takes a slab for the size class from the main zone. Returns NULL if the
+main zone is full. Caller must hold zoneMutex.
+========================
+*/
+static zoneslab_t *Z_NewSlab( int sizeClass ) {
+	zoneclass_t	*cls = &zoneClasses[sizeClass];
+	memblock_t	*block, *object;
+	zoneslab_t	*slab;
+	int			i;
+
+	block = Z_ZoneAlloc( mainzone, PAD( sizeof( memblock_t ) + ZONE_SLAB_SIZE + 4, sizeof( intptr_t ) ), TAG_SLAB );
+	if ( !block ) {
+		return NULL;
+	}
+#ifdef ZONE_DEBUG
+	block->d.label = "slab";
+	block->d.file = __FILE__;
+	block->d.line = __LINE__;
+	block->d.allocSize = ZONE_SLAB_SIZE;
+#endif
+	*(int *)((byte *)block + block->size - 4) = ZONEID;
+
+	slab = (zoneslab_t *)( block + 1 );
+	slab->sizeClass = sizeClass;
+	slab->used = 0;
+	slab->capacity = ( ZONE_SLAB_SIZE - ZONE_SLAB_HEADER ) / cls->blockSize;
+	slab->freelist = NULL;
+	for ( i = slab->capacity - 1; i >= 0; i-- ) {
+		object = Z_SlabObject( slab, i );
+		object->size = cls->blockSize;
+		object->tag = 0;
+		object->id = SLABID;
+		object->prev = (memblock_t *)slab;
+		object->next = slab->freelist;
+		slab->freelist = object;
+	}
+
+	Z_SlabLink( &cls->partial, slab );
+	cls->numSlabs++;
+	return slab;
+}
+
+/*
+========================
+Z_SlabReturn
+
+Puts a free object back on its slab. Caller must hold zoneMutex.
+========================
+*/
+static void Z_SlabReturn( memblock_t *block ) {
+	zoneslab_t	*slab = (zoneslab_t *)block->prev;
+	zoneclass_t	*cls = &zoneClasses[slab->sizeClass];
+
+	if ( !slab->freelist ) {
+		Z_SlabUnlink( &cls->full, slab );
+		Z_SlabLink( &cls->partial, slab );
+	}
+	block->next = slab->freelist;
+	slab->freelist = block;
+	slab->used--;
+}
+
+/*
+========================
+Z_SlabReleaseIfEmpty
+
+Gives an empty slab back to the main zone. The last slab of a class is kept,
+so a class that keeps crossing the slab boundary doesn't repeatedly allocate
+and free main zone blocks. Caller must hold zoneMutex.
+========================
+*/
+static void Z_SlabReleaseIfEmpty( zoneslab_t *slab ) {
+	zoneclass_t	*cls = &zoneClasses[slab->sizeClass];
+
+	if ( slab->used || cls->numSlabs <= 1 ) {
+		return;
+	}
+	Z_SlabUnlink( &cls->partial, slab );
+	cls->numSlabs--;
+	Z_ZoneFree( mainzone, (memblock_t *)slab - 1 );
+}
+
+/*
+========================
+Z_FillCache
+
+Moves up to half a cache worth of objects from the slabs to the thread
+cache. Returns the number of objects moved, which is only 0 if the main
+zone is out of memory.
+========================
+*/
+static int Z_FillCache( zonecache_t *cache, int sizeClass ) {
+	zoneclass_t	*cls = &zoneClasses[sizeClass];
+	zoneslab_t	*slab;
+	memblock_t	*block;
+	int			count;
+
+	Sys_LockMutex( zoneMutex );
+	for ( count = 0; count < ZONE_CACHE_SIZE / 2; count++ ) {
+		slab = cls->partial;
+		if ( !slab ) {
+			slab = Z_NewSlab( sizeClass );
+			if ( !slab ) {
+				break;
+			}
+		}
+
+		block = slab->freelist;
+		slab->freelist = block->next;
+		slab->used++;
+		if ( !slab->freelist ) {
+			Z_SlabUnlink( &cls->partial, slab );
+			Z_SlabLink( &cls->full, slab );
+		}
+		cache->objects[sizeClass][cache->count[sizeClass]++] = block;
+	}
+	Sys_UnlockMutex( zoneMutex );
+
+	return count;
+}
+
+/*
+========================
+Z_FlushCache
+
+Returns the count oldest objects in the thread cache to their slabs.
+The most recently freed ones are kept since they are likely still in
+the CPU cache.
+========================
+*/
+static void Z_FlushCache( zonecache_t *cache, int sizeClass, int count ) {
+	memblock_t	**objects = cache->objects[sizeClass];
+	zoneslab_t	*slab;
+	int			i;
+
+	Sys_LockMutex( zoneMutex );
+	for ( i = 0; i < count; i++ ) {
+		slab = (zoneslab_t *)objects[i]->prev;
+		Z_SlabReturn( objects[i] );
+		Z_SlabReleaseIfEmpty( slab );
+	}
+	Sys_UnlockMutex( zoneMutex );
+
+	cache->count[sizeClass] -= count;
+	memmove( objects, objects + count, cache->count[sizeClass] * sizeof( *objects ) );
+}
+
+/*
+========================
+Z_FlushThreadCache
+
+Returns all objects cached by the calling thread to their slabs.
+Threads started with Sys_CreateThread do this when they exit, and
+worker threads can do it when they go idle, so Z_FreeTags can run.
+========================
+*/
+void Z_FlushThreadCache( void ) {
+	zonecache_t	*cache = &zoneCache;
+	int			i;
+
+	for ( i = 0; i < ZONE_NUM_CLASSES; i++ ) {
+		if ( cache->count[i] ) {
+			Z_FlushCache( cache, i, cache->count[i] );
+		}
+	}
+
+	if ( cache->registered ) {
+		Sys_LockMutex( zoneMutex );
+		zoneThreads--;
+		Sys_UnlockMutex( zoneMutex );
+		cache->registered = qfalse;
+	}
+}
+
+/*
+========================
+Z_ThreadCache
+
+Returns the cache of the calling thread, counting the thread in zoneThreads
+when it starts using it.
+========================
+*/
+static zonecache_t *Z_ThreadCache( void ) {
+	zonecache_t	*cache = &zoneCache;
+
+	if ( !cache->registered ) {
+		Sys_LockMutex( zoneMutex );
+		zoneThreads++;
+		Sys_UnlockMutex( zoneMutex );
+		cache->registered = qtrue;
+	}
+	return cache;
+}
+
+/*
+========================
+Z_SlabAlloc
+
+Returns NULL if the main zone is out of memory.
+========================
+*/
+static memblock_t *Z_SlabAlloc( int sizeClass ) {
+	zonecache_t	*cache = Z_ThreadCache();
+
+	if ( !cache->count[sizeClass] && !Z_FillCache( cache, sizeClass ) ) {
+		return NULL;
+	}
+	return cache->objects[sizeClass][--cache->count[sizeClass]];
+}
+
+/*
+========================
+Z_InitSlabs
+========================
+*/
+static void Z_InitSlabs( void ) {
+	int		i, sizeClass;
+
+	sizeClass = 0;
+	for ( i = 0; i < ARRAY_LEN( zoneSizeClass ); i++ ) {
+		while ( zoneClassSizes[sizeClass] < i * 16 ) {
+			sizeClass++;
+		}
+		zoneSizeClass[i] = sizeClass;
+	}
+
+	for ( i = 0; i < ZONE_NUM_CLASSES; i++ ) {
+		zoneClasses[i].blockSize = zoneClassSizes[i];
+	}
+}
+
 /*
 ========================
 Z_Free
 ========================
 */
 void Z_Free( void *ptr ) {
-	memblock_t	*block, *other;
+	memblock_t	*block;
 	memzone_t *zone;
-	
+	zonecache_t	*cache;
+	int			sizeClass;
+
 	if (!ptr) {
 		Com_Error( ERR_DROP, "Z_Free: NULL pointer" );
 	}
 
 	block = (memblock_t *) ( (byte *)ptr - sizeof(memblock_t));
-	if (block->id != ZONEID) {
+	if (block->id != ZONEID && block->id != SLABID) {
 		Com_Error( ERR_FATAL, "Z_Free: freed a pointer without ZONEID" );
 	}
 	if (block->tag == 0) {
@@ -954,6 +1387,21 @@ void Z_Free( void *ptr ) {
 		Com_Error( ERR_FATAL, "Z_Free: memory block wrote past end" );
 	}
 
+	if (block->id == SLABID) {
+		// set the block to something that should cause problems
+		// if it is referenced...
+		Com_Memset( ptr, 0xaa, block->size - sizeof( *block ) );
+		block->tag = 0;		// mark as free
+
+		cache = Z_ThreadCache();
+		sizeClass = ((zoneslab_t *)block->prev)->sizeClass;
+		if ( cache->count[sizeClass] == ZONE_CACHE_SIZE ) {
+			Z_FlushCache( cache, sizeClass, ZONE_CACHE_SIZE / 2 );
+		}
+		cache->objects[sizeClass][cache->count[sizeClass]++] = block;
+		return;
+	}
+
 	if (block->tag == TAG_SMALL) {
 		zone = smallzone;
 	}
@@ -961,44 +1409,51 @@ void Z_Free( void *ptr ) {
 		zone = mainzone;
 	}
 
-	zone->used -= block->size;
-	// set the block to something that should cause problems
-	// if it is referenced...
-	Com_Memset( ptr, 0xaa, block->size - sizeof( *block ) );
-
-	block->tag = 0;		// mark as free
-	
-	other = block->prev;
-	if (!other->tag) {
-		// merge with previous free block
-		other->size += block->size;
-		other->next = block->next;
-		other->next->prev = other;
-		if (block == zone->rover) {
-			zone->rover = other;
-		}
-		block = other;
-	}
-
-	zone->rover = block;
-
-	other = block->next;
-	if ( !other->tag ) {
-		// merge the next free block onto the end
-		block->size += other->size;
-		block->next = other->next;
-		block->next->prev = block;
-	}
+	Sys_LockMutex( zoneMutex );
+	Z_ZoneFree( zone, block );
+	Sys_UnlockMutex( zoneMutex );
 }
 
 
 /*
 ================
 Z_FreeTags
+
+Slab object tags are written without zoneMutex by the thread that owns the
+object, so this can only run while no other thread is using its cache.
 ================
 */
 void Z_FreeTags( int tag ) {
 	memzone_t	*zone;
+	zoneslab_t	*slab, *next;
+	memblock_t	*block;
+	int			i, j, list;
+
+	// holding zoneMutex also keeps other threads from starting to use their caches
+	Sys_LockMutex( zoneMutex );
+	if ( zoneThreads > ( zoneCache.registered ? 1 : 0 ) ) {
+		Sys_UnlockMutex( zoneMutex );
+		Com_Error( ERR_FATAL, "Z_FreeTags: other threads are using the zone" );
+	}
+
+	// objects in thread caches are already free, so only the slabs need to be searched;
+	// full slabs move to the partial list when an object is returned, so walk that one first
+	for ( i = 0; i < ZONE_NUM_CLASSES; i++ ) {
+		for ( list = 0; list < 2; list++ ) {
+			for ( slab = list ? zoneClasses[i].full : zoneClasses[i].partial; slab; slab = next ) {
+				next = slab->next;
+				for ( j = 0; j < slab->capacity; j++ ) {
+					block = Z_SlabObject( slab, j );
+					if ( block->tag == tag ) {
+						Com_Memset( block + 1, 0xaa, block->size - sizeof( *block ) );
+						block->tag = 0;
+						Z_SlabReturn( block );
+					}
+				}
+				Z_SlabReleaseIfEmpty( slab );
+			}
+		}
+	}
 
 	if ( tag == TAG_SMALL ) {
 		zone = smallzone;
@@ -1007,15 +1462,17 @@ void Z_FreeTags( int tag ) {
 		zone = mainzone;
 	}
 	// use the rover as our pointer, because
-	// Z_Free automatically adjusts it
+	// Z_ZoneFree automatically adjusts it
 	zone->rover = zone->blocklist.next;
 	do {
 		if ( zone->rover->tag == tag ) {
-			Z_Free( (void *)(zone->rover + 1) );
+			Z_ZoneFree( zone, zone->rover );
 			continue;
 		}
 		zone->rover = zone->rover->next;
 	} while ( zone->rover != &zone->blocklist );
+
+	Sys_UnlockMutex( zoneMutex );
 }
 
 
@@ -1030,8 +1487,7 @@ void *Z_TagMallocDebug( int size, int tag, char *label, char *file, int line ) {
 #else
 void *Z_TagMalloc( int size, int tag ) {
 #endif
-	int		extra;
-	memblock_t	*start, *rover, *new, *base;
+	memblock_t	*base;
 	memzone_t *zone;
 
 	if (!tag) {
@@ -1048,61 +1504,35 @@ void *Z_TagMalloc( int size, int tag ) {
 #ifdef ZONE_DEBUG
 	allocSize = size;
 #endif
-	//
-	// scan through the block list looking for the first free block
-	// of sufficient size
-	//
 	size += sizeof(memblock_t);	// account for size of block header
 	size += 4;					// space for memory trash tester
 	size = PAD(size, sizeof(intptr_t));		// align to 32/64 bit boundary
-	
-	base = rover = zone->rover;
-	start = base->prev;
-	
-	do {
-		if (rover == start)	{
-			// scaned all the way around the list
+
+	if ( size <= ZONE_MAX_SLAB_BLOCK && tag != TAG_SMALL && mainzone ) {
+		// small blocks come from the slabs, except during startup
+		// before the main zone is allocated
+		base = Z_SlabAlloc( zoneSizeClass[( size + 15 ) >> 4] );
+		if ( base ) {
+			base->tag = tag;	// no longer a free object
+		}
+	} else {
+		Sys_LockMutex( zoneMutex );
+		base = Z_ZoneAlloc( zone, size, tag );
+		Sys_UnlockMutex( zoneMutex );
+	}
+
+	if ( !base ) {
 #ifdef ZONE_DEBUG
-			Z_LogHeap();
+		Z_LogHeap();
 
-			Com_Error(ERR_FATAL, "Z_Malloc: failed on allocation of %i bytes from the %s zone: %s, line: %d (%s)",
-								size, zone == smallzone ? "small" : "main", file, line, label);
+		Com_Error(ERR_FATAL, "Z_Malloc: failed on allocation of %i bytes from the %s zone: %s, line: %d (%s)",
+							size, zone == smallzone ? "small" : "main", file, line, label);
 #else
-			Com_Error(ERR_FATAL, "Z_Malloc: failed on allocation of %i bytes from the %s zone",
-								size, zone == smallzone ? "small" : "main");
+		Com_Error(ERR_FATAL, "Z_Malloc: failed on allocation of %i bytes from the %s zone",
+							size, zone == smallzone ? "small" : "main");
 #endif
-			return NULL;
-		}
-		if (rover->tag) {
-			base = rover = rover->next;
-		} else {
-			rover = rover->next;
-		}
-	} while (base->tag || base->size < size);
-	
-	//
-	// found a block big enough
-	//
-	extra = base->size - size;
-	if (extra > MINFRAGMENT) {
-		// there will be a free fragment after the allocated block
-		new = (memblock_t *) ((byte *)base + size );
-		new->size = extra;
-		new->tag = 0;			// free block
-		new->prev = base;
-		new->id = ZONEID;
-		new->next = base->next;
-		new->next->prev = new;
-		base->next = new;
-		base->size = size;
+		return NULL;
 	}
-	
-	base->tag = tag;			// no longer a free block
-	
-	zone->rover = base->next;	// next allocation will start looking here
-	zone->used += base->size;	//
-	
-	base->id = ZONEID;
 
 #ifdef ZONE_DEBUG
 	base->d.label = label;
@@ -1176,58 +1606,116 @@ static void Z_CheckHeap( void ) {
 
 /*
 ========================
-Z_LogZoneHeap
+Z_LogBlock
 ========================
 */
-void Z_LogZoneHeap( memzone_t *zone, char *name ) {
+static void Z_LogBlock( memblock_t *block ) {
 #ifdef ZONE_DEBUG
 	char dump[32], *ptr;
+	char buf[4096];
 	int  i, j;
+
+	ptr = ((char *) block) + sizeof(memblock_t);
+	j = 0;
+	for (i = 0; i < 20 && i < block->d.allocSize; i++) {
+		if (ptr[i] >= 32 && ptr[i] < 127) {
+			dump[j++] = ptr[i];
+		}
+		else {
+			dump[j++] = '_';
+		}
+	}
+	dump[j] = '\0';
+	Com_sprintf(buf, sizeof(buf), "size = %8d: %s, line: %d (%s) [%s]\r\n", block->d.allocSize, block->d.file, block->d.line, block->d.label, dump);
+	FS_Write(buf, strlen(buf), logfile);
+#endif
+}
+
+/*
+========================
+Z_LogTotals
+========================
+*/
+static void Z_LogTotals( char *name, int size, int allocSize, int numBlocks ) {
+	char		buf[4096];
+
+#ifdef ZONE_DEBUG
+	// subtract debug memory
+	size -= numBlocks * sizeof(zonedebug_t);
+#else
+	allocSize = numBlocks * sizeof(memblock_t); // + 32 bit alignment
 #endif
+	Com_sprintf(buf, sizeof(buf), "%d %s memory in %d blocks\r\n", size, name, numBlocks);
+	FS_Write(buf, strlen(buf), logfile);
+	Com_sprintf(buf, sizeof(buf), "%d %s memory overhead\r\n", size - allocSize, name);
+	FS_Write(buf, strlen(buf), logfile);
+}
+
+/*
+========================
+Z_LogZoneHeap
+========================
+*/
+void Z_LogZoneHeap( memzone_t *zone, char *name ) {
 	memblock_t	*block;
 	char		buf[4096];
 	int size, allocSize, numBlocks;
 
 	if (!logfile || !FS_Initialized())
 		return;
-	size = numBlocks = 0;
-#ifdef ZONE_DEBUG
-	allocSize = 0;
-#endif
+	size = allocSize = numBlocks = 0;
 	Com_sprintf(buf, sizeof(buf), "\r\n================\r\n%s log\r\n================\r\n", name);
 	FS_Write(buf, strlen(buf), logfile);
 	for (block = zone->blocklist.next ; block->next != &zone->blocklist; block = block->next) {
 		if (block->tag) {
+			Z_LogBlock( block );
 #ifdef ZONE_DEBUG
-			ptr = ((char *) block) + sizeof(memblock_t);
-			j = 0;
-			for (i = 0; i < 20 && i < block->d.allocSize; i++) {
-				if (ptr[i] >= 32 && ptr[i] < 127) {
-					dump[j++] = ptr[i];
-				}
-				else {
-					dump[j++] = '_';
-				}
-			}
-			dump[j] = '\0';
-			Com_sprintf(buf, sizeof(buf), "size = %8d: %s, line: %d (%s) [%s]\r\n", block->d.allocSize, block->d.file, block->d.line, block->d.label, dump);
-			FS_Write(buf, strlen(buf), logfile);
 			allocSize += block->d.allocSize;
 #endif
 			size += block->size;
 			numBlocks++;
 		}
 	}
+	Z_LogTotals( name, size, allocSize, numBlocks );
+}
+
+/*
+========================
+Z_LogSlabHeap
+
+Objects in thread caches are free and not listed.
+========================
+*/
+static void Z_LogSlabHeap( void ) {
+	zoneslab_t	*slab;
+	memblock_t	*block;
+	char		buf[4096];
+	int size, allocSize, numBlocks;
+	int i, j, list;
+
+	if (!logfile || !FS_Initialized())
+		return;
+	size = allocSize = numBlocks = 0;
+	Com_sprintf(buf, sizeof(buf), "\r\n================\r\nSLAB log\r\n================\r\n");
+	FS_Write(buf, strlen(buf), logfile);
+	for ( i = 0; i < ZONE_NUM_CLASSES; i++ ) {
+		for ( list = 0; list < 2; list++ ) {
+			for ( slab = list ? zoneClasses[i].full : zoneClasses[i].partial; slab; slab = slab->next ) {
+				for ( j = 0; j < slab->capacity; j++ ) {
+					block = Z_SlabObject( slab, j );
+					if ( block->tag ) {
+						Z_LogBlock( block );
 #ifdef ZONE_DEBUG
-	// subtract debug memory
-	size -= numBlocks * sizeof(zonedebug_t);
-#else
-	allocSize = numBlocks * sizeof(memblock_t); // + 32 bit alignment
+						allocSize += block->d.allocSize;
 #endif
-	Com_sprintf(buf, sizeof(buf), "%d %s memory in %d blocks\r\n", size, name, numBlocks);
-	FS_Write(buf, strlen(buf), logfile);
-	Com_sprintf(buf, sizeof(buf), "%d %s memory overhead\r\n", size - allocSize, name);
-	FS_Write(buf, strlen(buf), logfile);
+						size += block->size;
+						numBlocks++;
+					}
+				}
+			}
+		}
+	}
+	Z_LogTotals( "SLAB", size, allocSize, numBlocks );
 }
 
 /*
@@ -1236,8 +1724,11 @@ Z_LogHeap
 ========================
 */
 void Z_LogHeap( void ) {
+	Sys_LockMutex( zoneMutex );
 	Z_LogZoneHeap( mainzone, "MAIN" );
+	Z_LogSlabHeap();
 	Z_LogZoneHeap( smallzone, "SMALL" );
+	Sys_UnlockMutex( zoneMutex );
 }
 
 // static mem blocks to reduce a lot of small zone overhead
@@ -1366,18 +1857,29 @@ void Com_Meminfo_f( void ) {
 	int			zoneBytes, zoneBlocks;
 	int			smallZoneBytes;
 	int			botlibBytes, rendererBytes;
+	int			slabBytes, numSlabs;
 	int			unused;
+	zoneslab_t	*slab;
+	int			i, j, list;
+
+	Sys_LockMutex( zoneMutex );
 
 	zoneBytes = 0;
 	botlibBytes = 0;
 	rendererBytes = 0;
 	zoneBlocks = 0;
+	slabBytes = 0;
+	numSlabs = 0;
 	for (block = mainzone->blocklist.next ; ; block = block->next) {
 		if ( Cmd_Argc() != 1 ) {
 			Com_Printf ("block:%p    size:%7i    tag:%3i\n",
 				(void *)block, block->size, block->tag);
 		}
-		if ( block->tag ) {
+		if ( block->tag == TAG_SLAB ) {
+			// objects in the slab are counted below
+			slabBytes += block->size;
+			numSlabs++;
+		} else if ( block->tag ) {
 			zoneBytes += block->size;
 			zoneBlocks++;
 			if ( block->tag == TAG_BOTLIB ) {
@@ -1412,6 +1914,27 @@ void Com_Meminfo_f( void ) {
 		}
 	}
 
+	for ( i = 0; i < ZONE_NUM_CLASSES; i++ ) {
+		for ( list = 0; list < 2; list++ ) {
+			for ( slab = list ? zoneClasses[i].full : zoneClasses[i].partial; slab; slab = slab->next ) {
+				for ( j = 0; j < slab->capacity; j++ ) {
+					block = Z_SlabObject( slab, j );
+					if ( block->tag ) {
+						zoneBytes += block->size;
+						zoneBlocks++;
+						if ( block->tag == TAG_BOTLIB ) {
+							botlibBytes += block->size;
+						} else if ( block->tag == TAG_RENDERER ) {
+							rendererBytes += block->size;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	Sys_UnlockMutex( zoneMutex );
+
 	Com_Printf( "%8i bytes total hunk\n", s_hunkTotal );
 	Com_Printf( "%8i bytes total zone\n", s_zoneTotal );
 	Com_Printf( "\n" );
@@ -1444,6 +1967,7 @@ void Com_Meminfo_f( void ) {
 	Com_Printf( "        %8i bytes in dynamic renderer\n", rendererBytes );
 	Com_Printf( "        %8i bytes in dynamic other\n", zoneBytes - ( botlibBytes + rendererBytes ) );
 	Com_Printf( "        %8i bytes in small Zone memory\n", smallZoneBytes );
+	Com_Printf( "%8i bytes in %i zone slabs\n", slabBytes, numSlabs );
 }
 
 /*
@@ -1476,6 +2000,8 @@ void Com_TouchMemory( void ) {
 		sum += ((int *)s_hunkData)[i];
 	}
 
+	// slabs are main zone blocks, so this covers slab objects too
+	Sys_LockMutex( zoneMutex );
 	for (block = mainzone->blocklist.next ; ; block = block->next) {
 		if ( block->tag ) {
 			j = block->size >> 2;
@@ -1487,6 +2013,7 @@ void Com_TouchMemory( void ) {
 			break;			// all blocks have been hit	
 		}
 	}
+	Sys_UnlockMutex( zoneMutex );
 
 	end = Sys_Milliseconds();
 
@@ -1495,12 +2022,306 @@ void Com_TouchMemory( void ) {
 
 
 
+/*
+=================
+Com_ZoneFreeSpace
+
+Caller must hold zoneMutex.
+=================
+*/
+static void Com_ZoneFreeSpace( memzone_t *zone, int *freeBytes, int *freeBlocks, int *largest ) {
+	memblock_t	*block;
+
+	*freeBytes = *freeBlocks = *largest = 0;
+	for ( block = zone->blocklist.next; block != &zone->blocklist; block = block->next ) {
+		if ( !block->tag ) {
+			*freeBytes += block->size;
+			(*freeBlocks)++;
+			if ( block->size > *largest ) {
+				*largest = block->size;
+			}
+		}
+	}
+}
+
+/*
+=================
+Com_ZoneInfo_f
+
+Reports slab utilization and how fragmented the free space of the zones is,
+which is mostly of interest on servers that have been running for a long time.
+=================
+*/
+static void Com_ZoneInfo_f( void ) {
+	int			slabs[ZONE_NUM_CLASSES], objects[ZONE_NUM_CLASSES];
+	int			held[ZONE_NUM_CLASSES], inUse[ZONE_NUM_CLASSES];
+	int			freeBytes[2], freeBlocks[2], largest[2];
+	int			totalSlabs, usedBytes;
+	memzone_t	*zones[2] = { mainzone, smallzone };
+	const char	*zoneNames[2] = { "main", "small" };
+	zoneslab_t	*slab;
+	int			i, j, list;
+
+	Sys_LockMutex( zoneMutex );
+	for ( i = 0; i < ZONE_NUM_CLASSES; i++ ) {
+		slabs[i] = objects[i] = held[i] = inUse[i] = 0;
+		for ( list = 0; list < 2; list++ ) {
+			for ( slab = list ? zoneClasses[i].full : zoneClasses[i].partial; slab; slab = slab->next ) {
+				slabs[i]++;
+				objects[i] += slab->capacity;
+				held[i] += slab->used;
+				for ( j = 0; j < slab->capacity; j++ ) {
+					if ( Z_SlabObject( slab, j )->tag ) {
+						inUse[i]++;
+					}
+				}
+			}
+		}
+	}
+	for ( i = 0; i < 2; i++ ) {
+		Com_ZoneFreeSpace( zones[i], &freeBytes[i], &freeBlocks[i], &largest[i] );
+	}
+	Sys_UnlockMutex( zoneMutex );
+
+	Com_Printf( " class  slabs  objects   in use   cached    util\n" );
+	totalSlabs = usedBytes = 0;
+	for ( i = 0; i < ZONE_NUM_CLASSES; i++ ) {
+		if ( !slabs[i] ) {
+			continue;
+		}
+		Com_Printf( "%6i %6i %8i %8i %8i  %5.1f%%\n", zoneClasses[i].blockSize, slabs[i], objects[i],
+				inUse[i], held[i] - inUse[i], 100.0f * inUse[i] / objects[i] );
+		totalSlabs += slabs[i];
+		usedBytes += inUse[i] * zoneClasses[i].blockSize;
+	}
+	Com_Printf( "%i slabs of %i bytes, %i bytes in use (%.1f%%)\n", totalSlabs, ZONE_SLAB_SIZE, usedBytes,
+			totalSlabs ? 100.0f * usedBytes / ( totalSlabs * ZONE_SLAB_SIZE ) : 0.0f );
+
+	// fragmentation is the share of free space outside the largest free block
+	for ( i = 0; i < 2; i++ ) {
+		Com_Printf( "%s zone: %i of %i bytes free in %i blocks, largest %i, fragmentation %.1f%%\n",
+				zoneNames[i], freeBytes[i], zones[i]->size, freeBlocks[i], largest[i],
+				freeBytes[i] ? 100.0f * ( freeBytes[i] - largest[i] ) / freeBytes[i] : 0.0f );
+	}
+}
+
+/*
+==============================================================================
+
+Zone allocation benchmark
+
+Each run allocates and frees random sizes in a working set of ZONE_BENCH_SLOTS
+blocks, either through Z_TagMalloc / Z_Free or directly from the main zone
+like Z_TagMalloc did before slabs were added.
+
+==============================================================================
+*/
+
+#define ZONE_BENCH_SLOTS		4096
+#define ZONE_BENCH_MAX_THREADS	8
+
+typedef struct {
+	int			ops;
+	unsigned int	seed;
+	qboolean	zoneOnly;		// bypass the slabs and thread caches
+	qboolean	failed;			// main zone ran out of memory
+} zonebench_t;
+
+static sysMutex_t	*zoneBenchMutex;
+static sysSignal_t	*zoneBenchDone;
+static int			zoneBenchRunning;
+
+/*
+=================
+Com_ZoneBenchSize
+
+Mostly small strings and structures, with a few blocks too big for the slabs.
+=================
+*/
+static int Com_ZoneBenchSize( unsigned int *seed ) {
+	unsigned int	r;
+
+	*seed = *seed * 1103515245 + 12345;
+	r = *seed >> 8;
+	if ( r % 100 < 60 ) {
+		return 8 + ( r / 100 ) % 57;
+	}
+	if ( r % 100 < 90 ) {
+		return 65 + ( r / 100 ) % 448;
+	}
+	if ( r % 100 < 97 ) {
+		return 513 + ( r / 100 ) % 448;
+	}
+	return 1024 + ( r / 100 ) % 7169;
+}
+
+/*
+=================
+Com_ZoneBenchFree
+=================
+*/
+static void Com_ZoneBenchFree( zonebench_t *bench, void *ptr ) {
+	if ( bench->zoneOnly ) {
+		Sys_LockMutex( zoneMutex );
+		Z_ZoneFree( mainzone, (memblock_t *)ptr - 1 );
+		Sys_UnlockMutex( zoneMutex );
+	} else {
+		Z_Free( ptr );
+	}
+}
+
+/*
+=================
+Com_ZoneBenchRun
+=================
+*/
+static void Com_ZoneBenchRun( zonebench_t *bench ) {
+	void		*slots[ZONE_BENCH_SLOTS];
+	memblock_t	*block;
+	unsigned int	seed = bench->seed;
+	int			i, slot, size;
+
+	Com_Memset( slots, 0, sizeof( slots ) );
+	for ( i = 0; i < bench->ops; i++ ) {
+		seed = seed * 1103515245 + 12345;
+		slot = ( seed >> 8 ) % ZONE_BENCH_SLOTS;
+		if ( slots[slot] ) {
+			Com_ZoneBenchFree( bench, slots[slot] );
+			slots[slot] = NULL;
+			continue;
+		}
+
+		size = Com_ZoneBenchSize( &seed );
+		if ( bench->zoneOnly ) {
+			Sys_LockMutex( zoneMutex );
+			block = Z_ZoneAlloc( mainzone, PAD( sizeof( memblock_t ) + size + 4, sizeof( intptr_t ) ), TAG_GENERAL );
+			Sys_UnlockMutex( zoneMutex );
+			if ( !block ) {
+				bench->failed = qtrue;
+				break;
+			}
+#ifdef ZONE_DEBUG
+			block->d.label = "zonebench";
+			block->d.file = __FILE__;
+			block->d.line = __LINE__;
+			block->d.allocSize = size;
+#endif
+			slots[slot] = block + 1;
+		} else {
+			slots[slot] = Z_TagMalloc( size, TAG_GENERAL );
+		}
+		*(byte *)slots[slot] = 0;
+	}
+
+	for ( slot = 0; slot < ZONE_BENCH_SLOTS; slot++ ) {
+		if ( slots[slot] ) {
+			Com_ZoneBenchFree( bench, slots[slot] );
+		}
+	}
+}
+
+/*
+=================
+Com_ZoneBenchThread
+=================
+*/
+static void Com_ZoneBenchThread( void *arg ) {
+	Com_ZoneBenchRun( (zonebench_t *)arg );
+
+	Sys_LockMutex( zoneBenchMutex );
+	if ( !--zoneBenchRunning ) {
+		Sys_RaiseSignal( zoneBenchDone );
+	}
+	Sys_UnlockMutex( zoneBenchMutex );
+}
+
+/*
+=================
+Com_ZoneBenchReport
+
+Splits ops between threads and prints the time it took all of them to finish.
+=================
+*/
+static void Com_ZoneBenchReport( int ops, int threads, qboolean zoneOnly ) {
+	zonebench_t	benches[ZONE_BENCH_MAX_THREADS];
+	qboolean	failed = qfalse;
+	int64_t		start, usec;
+	int			i;
+
+	Com_Memset( benches, 0, sizeof( benches ) );
+	for ( i = 0; i < threads; i++ ) {
+		benches[i].ops = ops / threads;
+		benches[i].seed = 0x2545f491 + i * 7919;
+		benches[i].zoneOnly = zoneOnly;
+	}
+
+	start = Sys_Microseconds();
+	if ( threads == 1 ) {
+		Com_ZoneBenchRun( &benches[0] );
+	} else {
+		zoneBenchRunning = threads;
+		for ( i = 0; i < threads; i++ ) {
+			if ( !Sys_CreateThread( Com_ZoneBenchThread, &benches[i] ) ) {
+				Com_ZoneBenchThread( &benches[i] );
+			}
+		}
+		Sys_WaitSignal( zoneBenchDone );
+	}
+	usec = Sys_Microseconds() - start;
+
+	for ( i = 0; i < threads; i++ ) {
+		if ( benches[i].failed ) {
+			failed = qtrue;
+		}
+	}
+
+	Com_Printf( "%-10s %2i thread%s %9.2f ms %8.1f ns/op%s\n", zoneOnly ? "zone" : "slab", threads,
+			threads == 1 ? " " : "s", usec / 1000.0, usec * 1000.0 / ops, failed ? " (main zone full)" : "" );
+}
+
+/*
+=================
+Com_ZoneBench_f
+
+zonebench [operations] [threads]
+=================
+*/
+static void Com_ZoneBench_f( void ) {
+	int		ops = Cmd_Argc() > 1 ? atoi( Cmd_Argv( 1 ) ) : 1000000;
+	int		threads = Cmd_Argc() > 2 ? atoi( Cmd_Argv( 2 ) ) : 4;
+
+	if ( ops < 1000 ) {
+		ops = 1000;
+	}
+	if ( threads < 1 ) {
+		threads = 1;
+	} else if ( threads > ZONE_BENCH_MAX_THREADS ) {
+		threads = ZONE_BENCH_MAX_THREADS;
+	}
+
+	if ( !zoneBenchMutex ) {
+		zoneBenchMutex = Sys_CreateMutex();
+		zoneBenchDone = Sys_CreateSignal();
+	}
+
+	Com_Printf( "%i allocations and frees on %i slots, times are for all threads to finish\n",
+			ops, ZONE_BENCH_SLOTS );
+	Com_ZoneBenchReport( ops, 1, qfalse );
+	Com_ZoneBenchReport( ops, 1, qtrue );
+	if ( threads > 1 ) {
+		Com_ZoneBenchReport( ops, threads, qfalse );
+		Com_ZoneBenchReport( ops, threads, qtrue );
+	}
+}
+
 /*
 =================
 Com_InitZoneMemory
 =================
 */
 void Com_InitSmallZoneMemory( void ) {
+	zoneMutex = Sys_CreateMutex();
+
 	s_smallZoneTotal = 512 * 1024;
 	smallzone = calloc( s_smallZoneTotal, 1 );
 	if ( !smallzone ) {
@@ -1532,7 +2353,7 @@ void Com_InitZoneMemory( void ) {
 		Com_Error( ERR_FATAL, "Zone data failed to allocate %i megs", s_zoneTotal / (1024*1024) );
 	}
 	Z_ClearZone( mainzone, s_zoneTotal );
-
+	Z_InitSlabs();
 }
 
 /*
@@ -1663,6 +2484,8 @@ void Com_InitHunkMemory( void ) {
 	Hunk_Clear();
 
 	Cmd_AddCommand( "meminfo", Com_Meminfo_f );
+	Cmd_AddCommand( "zoneinfo", Com_ZoneInfo_f );
+	Cmd_AddCommand( "zonebench", Com_ZoneBench_f );
 #ifdef ZONE_DEBUG
 	Cmd_AddCommand( "zonelog", Z_LogHeap );
 #endif
@@ -2244,6 +3067,9 @@ Com_RunAndTimeServerPacket
 */
 void Com_RunAndTimeServerPacket( netadr_t *evFrom, msg_t *buf ) {
 	int		t1, t2, msec;
+#ifdef CMOD_HITCH_RECORDER
+	int64_t	hitchStart;
+#endif
 
 	t1 = 0;
 
@@ -2251,7 +3077,14 @@ void Com_RunAndTimeServerPacket( netadr_t *evFrom, msg_t *buf ) {
 		t1 = Sys_Milliseconds ();
 	}
 
+#ifdef CMOD_HITCH_RECORDER
+	hitchStart = Sys_Microseconds();
+#endif
 	SV_PacketEvent( *evFrom, buf );
+#ifdef CMOD_HITCH_RECORDER
+	++cmod_hitch_counters.packets_in;
+	cmod_hitch_phase( HITCH_PHASE_PACKETS, hitchStart );
+#endif
 
 	if ( com_speeds->integer ) {
 		t2 = Sys_Milliseconds ();
@@ -2954,6 +3787,10 @@ void Com_Init( char *commandLine ) {
 	Cmd_AddCommand("copydebug", cmod_copydebug_cmd);
 #endif
 
+#ifdef CMOD_PROFILER
+	cmod_profile_initialize();
+#endif
+
 #ifdef CMOD_URI_REGISTER_COMMAND
 	Cmd_AddCommand("uri", Stef_UriCmd);
 #endif
@@ -3363,6 +4200,12 @@ void Com_Frame( void ) {
 	int		timeBeforeEvents;
 	int		timeBeforeClient;
 	int		timeAfter;
+#ifdef CMOD_PROFILER
+	int64_t	profileStart;
+#endif
+#ifdef CMOD_HITCH_RECORDER
+	int64_t	hitchStart;
+#endif
   
 
 #ifdef CMOD_LONGJMP_FIX
@@ -3444,11 +4287,23 @@ void Com_Frame( void ) {
 	IN_Frame();
 
 	lastTime = com_frameTime;
+#ifdef CMOD_PROFILER
+	profileStart = CMPROFILE_START();
 	com_frameTime = Com_EventLoop();
+	CMPROFILE_END( PROFILE_EVENT_LOOP, profileStart );
+#else
+	com_frameTime = Com_EventLoop();
+#endif
 	
 	msec = com_frameTime - lastTime;
 
+#ifdef CMOD_HITCH_RECORDER
+	hitchStart = Sys_Microseconds();
+#endif
 	Cbuf_Execute ();
+#ifdef CMOD_HITCH_RECORDER
+	cmod_hitch_phase( HITCH_PHASE_COMMANDS, hitchStart );
+#endif
 
 	if (com_altivec->modified)
 	{
@@ -3466,7 +4321,13 @@ void Com_Frame( void ) {
 		timeBeforeServer = Sys_Milliseconds ();
 	}
 
+#ifdef CMOD_PROFILER
+	profileStart = CMPROFILE_START();
+	SV_Frame( msec );
+	CMPROFILE_END( PROFILE_SV_FRAME, profileStart );
+#else
 	SV_Frame( msec );
+#endif
 
 	// if "dedicated" has been modified, start up
 	// or shut down the client system.
@@ -3493,7 +4354,13 @@ void Com_Frame( void ) {
 	if ( com_speeds->integer ) {
 		timeBeforeEvents = Sys_Milliseconds ();
 	}
+#ifdef CMOD_PROFILER
+	profileStart = CMPROFILE_START();
 	Com_EventLoop();
+	CMPROFILE_END( PROFILE_EVENT_LOOP, profileStart );
+#else
+	Com_EventLoop();
+#endif
 	Cbuf_Execute ();
 
 
@@ -3559,6 +4426,9 @@ void Com_Frame( void ) {
 #ifdef CMOD_LOGGING_SYSTEM
 	cmod_logging_frame();
 #endif
+#ifdef CMOD_PROFILER
+	cmod_profile_frame();
+#endif
 #ifdef CMOD_MULTI_MASTER_QUERY
 	Stef_MultiMasterQuery_RunFrame();
 #endif
@@ -671,6 +671,12 @@ void NET_SendPacket( netsrc_t sock, int length, const void *data, netadr_t to )
 		return;
 	}
 
+#ifdef CMOD_HITCH_RECORDER
+	if ( sock == NS_SERVER ) {
+		++cmod_hitch_counters.packets_out;
+	}
+#endif
+
 	if ( sock == NS_CLIENT && cl_packetdelay->integer > 0 ) {
 		NET_QueuePacket( length, data, to, cl_packetdelay->integer );
 	}
@@ -1716,6 +1716,216 @@ void NET_Restart_f(void)
 	NET_Config(qtrue);
 }
 
+/*
+==============================================================================
+
+LOCAL STREAM SOCKETS
+
+Minimal non-blocking TCP support for streaming data between processes on the
+same machine. Sockets are referenced by integer handles, with -1 for invalid.
+
+==============================================================================
+*/
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+static qboolean NET_TCPSetNonBlocking( SOCKET sock ) {
+	ioctlarg_t _true = 1;
+	if( ioctlsocket( sock, FIONBIO, &_true ) == SOCKET_ERROR ) {
+		Com_Printf( "WARNING: NET_TCPSetNonBlocking: ioctl FIONBIO: %s\n", NET_ErrorString() );
+		return qfalse;
+	}
+	return qtrue;
+}
+
+/*
+====================
+NET_TCPListen
+
+Opens a listening socket on the loopback interface.
+====================
+*/
+int NET_TCPListen( int port ) {
+	SOCKET sock;
+	struct sockaddr_in address;
+	int i = 1;
+
+	if( ( sock = socket( PF_INET, SOCK_STREAM, IPPROTO_TCP ) ) == INVALID_SOCKET ) {
+		Com_Printf( "WARNING: NET_TCPListen: socket: %s\n", NET_ErrorString() );
+		return -1;
+	}
+
+	setsockopt( sock, SOL_SOCKET, SO_REUSEADDR, (char *)&i, sizeof( i ) );
+
+	Com_Memset( &address, 0, sizeof( address ) );
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+	address.sin_port = htons( (unsigned short)port );
+
+	if( bind( sock, (void *)&address, sizeof( address ) ) == SOCKET_ERROR ||
+			listen( sock, 8 ) == SOCKET_ERROR || !NET_TCPSetNonBlocking( sock ) ) {
+		Com_Printf( "WARNING: NET_TCPListen: failed to listen on port %i: %s\n", port, NET_ErrorString() );
+		closesocket( sock );
+		return -1;
+	}
+
+	return (int)sock;
+}
+
+/*
+====================
+NET_TCPAccept
+
+Returns new connection, or -1 if none are pending.
+====================
+*/
+int NET_TCPAccept( int listen_socket ) {
+	SOCKET sock = accept( (SOCKET)listen_socket, NULL, NULL );
+	if( sock == INVALID_SOCKET ) {
+		return -1;
+	}
+	if( !NET_TCPSetNonBlocking( sock ) ) {
+		closesocket( sock );
+		return -1;
+	}
+	return (int)sock;
+}
+
+/*
+====================
+NET_TCPConnect
+
+Starts a non-blocking connect to a numeric "a.b.c.d:port" address, so neither
+a DNS lookup nor an unreachable host can stall the caller. Completion has to be
+polled with NET_TCPConnectStatus. Returns -1 on an invalid address or failure.
+====================
+*/
+int NET_TCPConnect( const char *address ) {
+	SOCKET sock;
+	struct sockaddr_in sadr;
+	unsigned int ip[4], port;
+	char end;
+	int i;
+
+	if( sscanf( address, "%u.%u.%u.%u:%u%c", &ip[0], &ip[1], &ip[2], &ip[3], &port, &end ) != 5 ||
+			ip[0] > 255 || ip[1] > 255 || ip[2] > 255 || ip[3] > 255 || !port || port > 65535 ) {
+		Com_Printf( "WARNING: NET_TCPConnect: invalid address '%s'; expected numeric ip:port\n", address );
+		return -1;
+	}
+
+	Com_Memset( &sadr, 0, sizeof( sadr ) );
+	sadr.sin_family = AF_INET;
+	for( i = 0; i < 4; i++ ) {
+		((byte *)&sadr.sin_addr)[i] = (byte)ip[i];
+	}
+	sadr.sin_port = htons( (unsigned short)port );
+
+	if( ( sock = socket( PF_INET, SOCK_STREAM, IPPROTO_TCP ) ) == INVALID_SOCKET ) {
+		Com_Printf( "WARNING: NET_TCPConnect: socket: %s\n", NET_ErrorString() );
+		return -1;
+	}
+
+	if( !NET_TCPSetNonBlocking( sock ) ) {
+		closesocket( sock );
+		return -1;
+	}
+
+#ifdef _WIN32
+	if( connect( sock, (void *)&sadr, sizeof( sadr ) ) == SOCKET_ERROR && socketError != WSAEWOULDBLOCK ) {
+#else
+	if( connect( sock, (void *)&sadr, sizeof( sadr ) ) == SOCKET_ERROR && socketError != EINPROGRESS ) {
+#endif
+		closesocket( sock );
+		return -1;
+	}
+
+	return (int)sock;
+}
+
+/*
+====================
+NET_TCPConnectStatus
+
+Returns 1 once a connect started by NET_TCPConnect has completed, 0 while
+it is still in progress, or -1 if it failed.
+====================
+*/
+int NET_TCPConnectStatus( int sock ) {
+	fd_set writeSet, errorSet;
+	struct timeval timeout = { 0, 0 };
+	int error = 0;
+	socklen_t length = sizeof( error );
+
+	FD_ZERO( &writeSet );
+	FD_ZERO( &errorSet );
+	FD_SET( (SOCKET)sock, &writeSet );
+	FD_SET( (SOCKET)sock, &errorSet );
+
+	if( select( sock + 1, NULL, &writeSet, &errorSet, &timeout ) == SOCKET_ERROR ) {
+		return -1;
+	}
+	if( FD_ISSET( (SOCKET)sock, &errorSet ) ) {
+		// Windows reports failed connects here
+		return -1;
+	}
+	if( !FD_ISSET( (SOCKET)sock, &writeSet ) ) {
+		return 0;
+	}
+	if( getsockopt( (SOCKET)sock, SOL_SOCKET, SO_ERROR, (char *)&error, &length ) == SOCKET_ERROR || error ) {
+		return -1;
+	}
+	return 1;
+}
+
+/*
+====================
+NET_TCPSend
+
+Returns number of bytes sent, which may be 0 if the socket buffer is full,
+or -1 if the connection failed.
+====================
+*/
+int NET_TCPSend( int sock, const void *data, int length ) {
+	int result = send( (SOCKET)sock, data, length, MSG_NOSIGNAL );
+	if( result == SOCKET_ERROR ) {
+		return socketError == EAGAIN ? 0 : -1;
+	}
+	return result;
+}
+
+/*
+====================
+NET_TCPReceive
+
+Returns number of bytes received, which may be 0 if no data is available,
+or -1 if the connection was closed or failed.
+====================
+*/
+int NET_TCPReceive( int sock, void *data, int length ) {
+	int result = recv( (SOCKET)sock, data, length, 0 );
+	if( result == SOCKET_ERROR ) {
+		return socketError == EAGAIN ? 0 : -1;
+	}
+	if( result == 0 ) {
+		// Orderly shutdown
+		return -1;
+	}
+	return result;
+}
+
+/*
+====================
+NET_TCPClose
+====================
+*/
+void NET_TCPClose( int sock ) {
+	if( sock >= 0 ) {
+		closesocket( (SOCKET)sock );
+	}
+}
+
 #ifdef CMOD_MULTI_MASTER_QUERY
 /*
 ==============================================================================
@@ -214,6 +214,14 @@ void		NET_JoinMulticast6(void);
 void		NET_LeaveMulticast6(void);
 void		NET_Sleep(int msec);
 
+int		NET_TCPListen( int port );
+int		NET_TCPAccept( int listen_socket );
+int		NET_TCPConnect( const char *address );
+int		NET_TCPConnectStatus( int sock );
+int		NET_TCPSend( int sock, const void *data, int length );
+int		NET_TCPReceive( int sock, void *data, int length );
+void		NET_TCPClose( int sock );
+
 
 #define	MAX_MSGLEN				16384		// max length of a message, which may
 											// be fragmented into multiple packets
@@ -1011,7 +1019,8 @@ typedef enum {
 	TAG_BOTLIB,
 	TAG_RENDERER,
 	TAG_SMALL,
-	TAG_STATIC
+	TAG_STATIC,
+	TAG_SLAB			// main zone blocks holding slab objects
 } memtag_t;
 
 /*
@@ -1053,6 +1062,7 @@ void Z_Free( void *ptr );
 void Z_FreeTags( int tag );
 int Z_AvailableMemory( void );
 void Z_LogHeap( void );
+void Z_FlushThreadCache( void );	// called when Sys_CreateThread threads exit or go idle
 
 void Hunk_Clear( void );
 void Hunk_ClearToMark( void );
@@ -1207,6 +1217,8 @@ void	Sys_Print( const char *msg );
 // Sys_Milliseconds should only be used for profiling purposes,
 // any game related timing information should come from event timestamps
 int		Sys_Milliseconds (void);
+// Sys_Microseconds returns a high resolution monotonic time for profiling, relative to startup
+int64_t	Sys_Microseconds (void);
 
 qboolean Sys_RandomBytes( byte *string, int len );
 
@@ -1249,6 +1261,22 @@ char **Sys_ListFiles( const char *directory, const char *extension, char *filter
 void	Sys_FreeFileList( char **list );
 void	Sys_Sleep(int msec);
 
+// Threads and synchronization for optional background work.
+// Objects are allocated outside the zone so they can be used from any thread.
+typedef struct sysMutex_s sysMutex_t;
+typedef struct sysSignal_s sysSignal_t;		// auto-reset; one waiter is released per raise
+
+qboolean Sys_CreateThread( void (*function)( void *arg ), void *arg );
+qboolean Sys_InWorkerThread( void );		// true on threads started by Sys_CreateThread
+sysMutex_t *Sys_CreateMutex( void );
+void	Sys_DestroyMutex( sysMutex_t *mutex );
+void	Sys_LockMutex( sysMutex_t *mutex );
+void	Sys_UnlockMutex( sysMutex_t *mutex );
+sysSignal_t *Sys_CreateSignal( void );
+void	Sys_DestroySignal( sysSignal_t *signal );
+void	Sys_RaiseSignal( sysSignal_t *signal );
+void	Sys_WaitSignal( sysSignal_t *signal );
+
 qboolean Sys_LowPhysicalMemory( void );
 
 void Sys_SetEnv(const char *name, const char *value);
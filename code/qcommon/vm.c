@@ -866,6 +866,9 @@ intptr_t QDECL VM_Call( vm_t *vm, int callnum, ... )
 	vm_t	*oldVM;
 	intptr_t r;
 	int i;
+#ifdef CMOD_PROFILER
+	int64_t profileStart = CMPROFILE_START();
+#endif
 
 	if(!vm || !vm->name[0])
 		Com_Error(ERR_FATAL, "VM_Call with NULL vm");
@@ -879,6 +882,9 @@ intptr_t QDECL VM_Call( vm_t *vm, int callnum, ... )
 	}
 
 	++vm->callLevel;
+#ifdef CMOD_HITCH_RECORDER
+	++cmod_hitch_counters.vm_calls;
+#endif
 	// if we have a dll loaded, call it directly
 	if ( vm->entryPoint ) {
 		//rcg010207 -  see dissertation at top of VM_DllSyscall() in this file.
@@ -926,6 +932,9 @@ intptr_t QDECL VM_Call( vm_t *vm, int callnum, ... )
 
 	if ( oldVM != NULL )
 	  currentVM = oldVM;
+#ifdef CMOD_PROFILER
+	CMPROFILE_END( PROFILE_VM_CALL, profileStart );
+#endif
 	return r;
 }
 
@@ -130,6 +130,7 @@ int R_RandomOn( float t );
 void  R_NoiseInit( void );
 
 image_t     *R_FindImageFile( const char *name, imgType_t type, imgFlags_t flags );
+void        R_FindImageFiles( const char **names, int count, imgType_t type, imgFlags_t flags, image_t **images );
 image_t *R_CreateImage( const char *name, byte *pic, int width, int height, imgType_t type, imgFlags_t flags, int internalFormat );
 
 void R_IssuePendingRenderCommands( void );
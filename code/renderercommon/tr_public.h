@@ -198,6 +198,7 @@ typedef struct {
 	char *(*FS_ReadShader)( const fsc_shader_t *shader );
 	const char *(*FS_GetFileExtension)( const fsc_file_t *file );
 	qboolean (*FS_CheckFilesFromSamePk3)( const fsc_file_t *file1, const fsc_file_t *file2 );
+	void (*FS_ImageLookupBatch)( const char **names, int count, int lookup_flags, const fsc_file_t **output );
 #endif
 } refimport_t;
 
@@ -1008,6 +1008,36 @@ static imageExtToLoaderMap_t imageLoaders[ ] =
 
 static int numImageLoaders = ARRAY_LEN( imageLoaders );
 
+#ifdef NEW_FILESYSTEM
+#define MAX_IMAGE_BATCH 16
+
+// Files already resolved by R_FindImageFiles, keyed by extension-free name
+static struct {
+	char name[MAX_QPATH];
+	const fsc_file_t *file;
+} imageBatch[MAX_IMAGE_BATCH];
+static int imageBatchCount;
+
+/*
+=================
+R_ImageLookupNewFS
+
+Returns the file for an extension-free image name, using the current batch result if there is one.
+=================
+*/
+static const fsc_file_t *R_ImageLookupNewFS( const char *localName ) {
+	int i;
+
+	for ( i = 0; i < imageBatchCount; ++i ) {
+		if ( !strcmp( imageBatch[i].name, localName ) ) {
+			return imageBatch[i].file;
+		}
+	}
+
+	return ri.FS_ImageLookup( localName, 0, qfalse );
+}
+#endif
+
 /*
 =================
 R_LoadImage
@@ -1030,7 +1060,7 @@ void R_LoadImageNewFS( const char *name, byte **pic, int *width, int *height ) {
 
 	// Look up the file
 	COM_StripExtension( name, localName, MAX_QPATH );
-	file = ri.FS_ImageLookup( localName, 0, qfalse );
+	file = R_ImageLookupNewFS( localName );
 	if ( !file ) {
 		return;
 	}
@@ -1138,23 +1168,16 @@ void R_LoadImage( const char *name, byte **pic, int *width, int *height )
 
 /*
 ===============
-R_FindImageFile
+R_FindLoadedImage
 
-Finds or loads the given image.
-Returns NULL if it fails, not a default image.
-==============
+Returns the already loaded image for name, or NULL.
+===============
 */
-image_t	*R_FindImageFile( const char *name, imgType_t type, imgFlags_t flags )
+static image_t *R_FindLoadedImage( const char *name, imgFlags_t flags )
 {
 	image_t	*image;
-	int		width, height;
-	byte	*pic;
 	long	hash;
 
-	if (!name) {
-		return NULL;
-	}
-
 	hash = generateHashValue(name);
 
 	//
@@ -1177,6 +1200,32 @@ image_t	*R_FindImageFile( const char *name, imgType_t type, imgFlags_t flags )
 		}
 	}
 
+	return NULL;
+}
+
+/*
+===============
+R_FindImageFile
+
+Finds or loads the given image.
+Returns NULL if it fails, not a default image.
+==============
+*/
+image_t	*R_FindImageFile( const char *name, imgType_t type, imgFlags_t flags )
+{
+	image_t	*image;
+	int		width, height;
+	byte	*pic;
+
+	if (!name) {
+		return NULL;
+	}
+
+	image = R_FindLoadedImage( name, flags );
+	if ( image ) {
+		return image;
+	}
+
 	//
 	// load the pic from disk
 	//
@@ -1191,6 +1240,55 @@ image_t	*R_FindImageFile( const char *name, imgType_t type, imgFlags_t flags )
 }
 
 
+/*
+===============
+R_FindImageFiles
+
+Finds or loads each of the given images, like R_FindImageFile. With the new filesystem
+the images that aren't loaded yet are looked up with a single FS_ImageLookupBatch call.
+===============
+*/
+void R_FindImageFiles( const char **names, int count, imgType_t type, imgFlags_t flags, image_t **images )
+{
+	int		i;
+#ifdef NEW_FILESYSTEM
+	const char *lookupNames[MAX_IMAGE_BATCH];
+	const fsc_file_t *files[MAX_IMAGE_BATCH];
+	int		start, end;
+
+	if ( tr.new_filesystem ) {
+		for ( start = 0; start < count; start = end ) {
+			end = MIN( count, start + MAX_IMAGE_BATCH );
+
+			imageBatchCount = 0;
+			for ( i = start; i < end; ++i ) {
+				if ( names[i] && !R_FindLoadedImage( names[i], flags ) ) {
+					COM_StripExtension( names[i], imageBatch[imageBatchCount].name, MAX_QPATH );
+					lookupNames[imageBatchCount] = imageBatch[imageBatchCount].name;
+					++imageBatchCount;
+				}
+			}
+
+			ri.FS_ImageLookupBatch( lookupNames, imageBatchCount, 0, files );
+			for ( i = 0; i < imageBatchCount; ++i ) {
+				imageBatch[i].file = files[i];
+			}
+
+			for ( i = start; i < end; ++i ) {
+				images[i] = R_FindImageFile( names[i], type, flags );
+			}
+			imageBatchCount = 0;
+		}
+		return;
+	}
+#endif
+
+	for ( i = 0; i < count; ++i ) {
+		images[i] = R_FindImageFile( names[i], type, flags );
+	}
+}
+
+
 /*
 ================
 R_CreateDlightImage
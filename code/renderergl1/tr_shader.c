@@ -709,6 +709,10 @@ static qboolean ParseStage( shaderStage_t *stage, char **text )
 		else if ( !Q_stricmp( token, "animMap" ) )
 		{
 			int	totalImages = 0;
+			char	animNames[MAX_IMAGE_ANIMATIONS][MAX_QPATH];
+			const char	*animNamePtrs[MAX_IMAGE_ANIMATIONS];
+			imgFlags_t flags = IMGFLAG_NONE;
+			int		num;
 
 			token = COM_ParseExt( text, qfalse );
 			if ( !token[0] )
@@ -720,31 +724,34 @@ static qboolean ParseStage( shaderStage_t *stage, char **text )
 
 			// parse up to MAX_IMAGE_ANIMATIONS animations
 			while ( 1 ) {
-				int		num;
-
 				token = COM_ParseExt( text, qfalse );
 				if ( !token[0] ) {
 					break;
 				}
-				num = stage->bundle[0].numImageAnimations;
-				if ( num < MAX_IMAGE_ANIMATIONS ) {
-					imgFlags_t flags = IMGFLAG_NONE;
+				if ( totalImages < MAX_IMAGE_ANIMATIONS ) {
+					Q_strncpyz( animNames[totalImages], token, sizeof( animNames[totalImages] ) );
+					animNamePtrs[totalImages] = animNames[totalImages];
+				}
+				totalImages++;
+			}
 
-					if (!shader.noMipMaps)
-						flags |= IMGFLAG_MIPMAP;
+			if (!shader.noMipMaps)
+				flags |= IMGFLAG_MIPMAP;
 
-					if (!shader.noPicMip)
-						flags |= IMGFLAG_PICMIP;
+			if (!shader.noPicMip)
+				flags |= IMGFLAG_PICMIP;
 
-					stage->bundle[0].image[num] = R_FindImageFile( token, IMGTYPE_COLORALPHA, flags );
-					if ( !stage->bundle[0].image[num] )
-					{
-						ri.Printf( PRINT_WARNING, "WARNING: R_FindImageFile could not find '%s' in shader '%s'\n", token, shader.name );
-						return qfalse;
-					}
-					stage->bundle[0].numImageAnimations++;
+			// load all the frames together so the files are looked up in one batch
+			num = MIN( totalImages, MAX_IMAGE_ANIMATIONS );
+			R_FindImageFiles( animNamePtrs, num, IMGTYPE_COLORALPHA, flags, stage->bundle[0].image );
+			for ( stage->bundle[0].numImageAnimations = 0; stage->bundle[0].numImageAnimations < num;
+					stage->bundle[0].numImageAnimations++ ) {
+				if ( !stage->bundle[0].image[stage->bundle[0].numImageAnimations] )
+				{
+					ri.Printf( PRINT_WARNING, "WARNING: R_FindImageFile could not find '%s' in shader '%s'\n",
+							animNames[stage->bundle[0].numImageAnimations], shader.name );
+					return qfalse;
 				}
-				totalImages++;
 			}
 
 			if ( totalImages > MAX_IMAGE_ANIMATIONS ) {
@@ -1297,7 +1304,8 @@ skyParms <outerbox> <cloudheight> <innerbox>
 static void ParseSkyParms( char **text ) {
 	char		*token;
 	static char	*suf[6] = {"rt", "bk", "lf", "ft", "up", "dn"};
-	char		pathname[MAX_QPATH];
+	char		pathnames[6][MAX_QPATH];
+	const char	*pathnamePtrs[6];
 	int			i;
 	imgFlags_t imgFlags = IMGFLAG_MIPMAP | IMGFLAG_PICMIP;
 
@@ -1309,10 +1317,12 @@ static void ParseSkyParms( char **text ) {
 	}
 	if ( strcmp( token, "-" ) ) {
 		for (i=0 ; i<6 ; i++) {
-			Com_sprintf( pathname, sizeof(pathname), "%s_%s.tga"
+			Com_sprintf( pathnames[i], sizeof(pathnames[i]), "%s_%s.tga"
 				, token, suf[i] );
-			shader.sky.outerbox[i] = R_FindImageFile( ( char * ) pathname, IMGTYPE_COLORALPHA, imgFlags | IMGFLAG_CLAMPTOEDGE );
-
+			pathnamePtrs[i] = pathnames[i];
+		}
+		R_FindImageFiles( pathnamePtrs, 6, IMGTYPE_COLORALPHA, imgFlags | IMGFLAG_CLAMPTOEDGE, shader.sky.outerbox );
+		for (i=0 ; i<6 ; i++) {
 			if ( !shader.sky.outerbox[i] ) {
 				shader.sky.outerbox[i] = tr.defaultImage;
 			}
@@ -1340,9 +1350,12 @@ static void ParseSkyParms( char **text ) {
 	}
 	if ( strcmp( token, "-" ) ) {
 		for (i=0 ; i<6 ; i++) {
-			Com_sprintf( pathname, sizeof(pathname), "%s_%s.tga"
+			Com_sprintf( pathnames[i], sizeof(pathnames[i]), "%s_%s.tga"
 				, token, suf[i] );
-			shader.sky.innerbox[i] = R_FindImageFile( ( char * ) pathname, IMGTYPE_COLORALPHA, imgFlags );
+			pathnamePtrs[i] = pathnames[i];
+		}
+		R_FindImageFiles( pathnamePtrs, 6, IMGTYPE_COLORALPHA, imgFlags, shader.sky.innerbox );
+		for (i=0 ; i<6 ; i++) {
 			if ( !shader.sky.innerbox[i] ) {
 				shader.sky.innerbox[i] = tr.defaultImage;
 			}
@@ -441,6 +441,9 @@ void		SV_BotFreeClient( int clientNum );
 void		SV_BotInitCvars(void);
 int			SV_BotLibSetup( void );
 int			SV_BotLibShutdown( void );
+void		SV_BotPrecomputeRoutes_f( void );
+void		SV_BotAASBenchmark_f( void );
+void		SV_BotAASEntityProfile_f( void );
 int			SV_BotGetSnapshotEntity( int client, int ent );
 int			SV_BotGetConsoleMessage( int client, char *buf, int size );
 
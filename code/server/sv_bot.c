@@ -37,6 +37,7 @@ int bot_maxdebugpolys;
 
 extern botlib_export_t	*botlib_export;
 int	bot_enable;
+static cvar_t *bot_threads;
 
 
 /*
@@ -426,6 +427,174 @@ static void BotClientCommand( int client, char *command ) {
 	SV_ExecuteClientCommand( &svs.clients[client], command, qtrue );
 }
 
+/*
+==============================================================
+
+BOT WORKER THREADS
+
+Botlib calls run on the main thread, except for jobs it hands to BotImport_RunJobs,
+which are spread over a pool of worker threads while the main thread takes part and
+waits for them to finish. The workers are started on first use and kept for the rest
+of the session; bot_threads sets how many threads are used including the main thread.
+
+==============================================================
+*/
+
+typedef struct {
+	sysSignal_t *start;
+	int thread;
+} botWorker_t;
+
+static struct {
+	sysMutex_t *mutex;
+	sysSignal_t *done;
+	botWorker_t workers[BOTLIB_MAX_THREADS];
+	int numWorkers;
+
+	// current batch, protected by mutex
+	void (*function)( int index, int thread, void *arg );
+	void *arg;
+	int count;
+	int next;
+	int running;
+} botJobs;
+
+/*
+==================
+SV_BotRunJobs
+
+Runs jobs of the current batch until none are left.
+==================
+*/
+static void SV_BotRunJobs( int thread ) {
+	int index;
+
+	while ( 1 ) {
+		Sys_LockMutex( botJobs.mutex );
+		index = botJobs.next < botJobs.count ? botJobs.next++ : -1;
+		Sys_UnlockMutex( botJobs.mutex );
+		if ( index < 0 ) {
+			return;
+		}
+		botJobs.function( index, thread, botJobs.arg );
+	}
+}
+
+/*
+==================
+SV_BotWorkerThread
+==================
+*/
+static void SV_BotWorkerThread( void *arg ) {
+	botWorker_t *worker = (botWorker_t *)arg;
+
+	while ( 1 ) {
+		Sys_WaitSignal( worker->start );
+		SV_BotRunJobs( worker->thread );
+		// give cached zone objects back while idle, this also allows Z_FreeTags
+		Z_FlushThreadCache();
+
+		Sys_LockMutex( botJobs.mutex );
+		if ( !--botJobs.running ) {
+			Sys_RaiseSignal( botJobs.done );
+		}
+		Sys_UnlockMutex( botJobs.mutex );
+	}
+}
+
+/*
+==================
+BotImport_RunJobs
+==================
+*/
+static int BotImport_RunJobs( void (*function)( int index, int thread, void *arg ), void *arg, int count ) {
+	int threads = bot_threads ? bot_threads->integer : 1;
+	int i;
+
+	if ( threads > BOTLIB_MAX_THREADS ) {
+		threads = BOTLIB_MAX_THREADS;
+	}
+	if ( threads <= 1 ) {
+		return qfalse;
+	}
+	if ( threads > count ) {
+		threads = count;
+	}
+
+	if ( !botJobs.mutex ) {
+		botJobs.mutex = Sys_CreateMutex();
+		botJobs.done = Sys_CreateSignal();
+	}
+
+	// start more workers if needed; worker threads are numbered from 1, the main thread is 0
+	while ( botJobs.numWorkers < threads - 1 ) {
+		botWorker_t *worker = &botJobs.workers[botJobs.numWorkers];
+		if ( !worker->start ) {
+			worker->start = Sys_CreateSignal();
+		}
+		worker->thread = botJobs.numWorkers + 1;
+		if ( !Sys_CreateThread( SV_BotWorkerThread, worker ) ) {
+			Com_Printf( S_COLOR_YELLOW "WARNING: failed to start bot worker thread\n" );
+			break;
+		}
+		++botJobs.numWorkers;
+	}
+	if ( threads > botJobs.numWorkers + 1 ) {
+		threads = botJobs.numWorkers + 1;
+	}
+
+	botJobs.function = function;
+	botJobs.arg = arg;
+	botJobs.count = count;
+	botJobs.next = 0;
+	botJobs.running = threads - 1;
+	for ( i = 0; i < threads - 1; ++i ) {
+		Sys_RaiseSignal( botJobs.workers[i].start );
+	}
+
+	SV_BotRunJobs( 0 );
+	if ( threads > 1 ) {
+		Sys_WaitSignal( botJobs.done );
+	}
+	return qtrue;
+}
+
+/*
+==================
+BotImport_MutexCreate
+==================
+*/
+static void *BotImport_MutexCreate( void ) {
+	return Sys_CreateMutex();
+}
+
+/*
+==================
+BotImport_MutexDestroy
+==================
+*/
+static void BotImport_MutexDestroy( void *mutex ) {
+	Sys_DestroyMutex( (sysMutex_t *)mutex );
+}
+
+/*
+==================
+BotImport_MutexLock
+==================
+*/
+static void BotImport_MutexLock( void *mutex ) {
+	Sys_LockMutex( (sysMutex_t *)mutex );
+}
+
+/*
+==================
+BotImport_MutexUnlock
+==================
+*/
+static void BotImport_MutexUnlock( void *mutex ) {
+	Sys_UnlockMutex( (sysMutex_t *)mutex );
+}
+
 /*
 ==================
 SV_BotFrame
@@ -475,6 +644,68 @@ int SV_BotLibShutdown( void ) {
 	return botlib_export->BotLibShutdown();
 }
 
+/*
+==================
+SV_BotPrecomputeRoutes_f
+
+Calculates the bot routing tables of the current map on the next bot frame
+and saves them with the routing cache
+==================
+*/
+void SV_BotPrecomputeRoutes_f( void ) {
+	if ( !botlib_export || !com_sv_running->integer ) {
+		Com_Printf( "Server is not running.\n" );
+		return;
+	}
+
+	botlib_export->BotLibVarSet( "precomputeroutes", "1" );
+}
+
+/*
+==================
+SV_BotAASBenchmark_f
+
+Times AAS point, trace and movement prediction queries on the current map
+with and without the AAS node grid on the next bot frame
+==================
+*/
+void SV_BotAASBenchmark_f( void ) {
+	if ( !botlib_export || !com_sv_running->integer ) {
+		Com_Printf( "Server is not running.\n" );
+		return;
+	}
+
+	botlib_export->BotLibVarSet( "aasbenchmark", "1" );
+}
+
+/*
+==================
+SV_BotAASEntityProfile_f
+
+Prints the cost of linking entities into the AAS areas averaged
+over the given number of bot frames
+==================
+*/
+void SV_BotAASEntityProfile_f( void ) {
+	int frames;
+
+	if ( !botlib_export || !com_sv_running->integer ) {
+		Com_Printf( "Server is not running.\n" );
+		return;
+	}
+
+	frames = 100;
+	if ( Cmd_Argc() > 1 ) {
+		frames = atoi( Cmd_Argv( 1 ) );
+		if ( frames <= 0 ) {
+			Com_Printf( "Usage: bot_aasentityprofile [frames]\n" );
+			return;
+		}
+	}
+
+	botlib_export->BotLibVarSet( "aasentityprofile", va( "%i", frames ) );
+}
+
 /*
 ==================
 SV_BotInitCvars
@@ -488,6 +719,7 @@ void SV_BotInitCvars(void) {
 	Cvar_Get("bot_maxdebugpolys", "2", 0);				//maximum number of debug polys
 	Cvar_Get("bot_groundonly", "1", 0);					//only show ground faces of areas
 	Cvar_Get("bot_reachability", "0", 0);				//show all reachabilities to other areas
+	bot_threads = Cvar_Get("bot_threads", "4", CVAR_ARCHIVE);	//threads used for bot route calculation
 	Cvar_Get("bot_visualizejumppads", "0", CVAR_CHEAT);	//show jumppads
 	Cvar_Get("bot_forceclustering", "0", 0);			//force cluster calculations
 	Cvar_Get("bot_forcereachability", "0", 0);			//force reachability calculations
@@ -557,6 +789,16 @@ void SV_BotInitBotLib(void) {
 	botlib_import.DebugPolygonCreate = BotImport_DebugPolygonCreate;
 	botlib_import.DebugPolygonDelete = BotImport_DebugPolygonDelete;
 
+	//worker threads
+	botlib_import.MutexCreate = BotImport_MutexCreate;
+	botlib_import.MutexDestroy = BotImport_MutexDestroy;
+	botlib_import.MutexLock = BotImport_MutexLock;
+	botlib_import.MutexUnlock = BotImport_MutexUnlock;
+	botlib_import.RunJobs = BotImport_RunJobs;
+
+	//profiling
+	botlib_import.Microseconds = Sys_Microseconds;
+
 	botlib_export = (botlib_export_t *)GetBotLibAPI( BOTLIB_API_VERSION, &botlib_import );
 	assert(botlib_export); 	// somehow we end up with a zero import.
 }
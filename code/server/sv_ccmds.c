@@ -1653,6 +1653,9 @@ void SV_AddOperatorCommands( void ) {
 	Cmd_AddCommand("bandel", SV_BanDel_f);
 	Cmd_AddCommand("exceptdel", SV_ExceptDel_f);
 	Cmd_AddCommand("flushbans", SV_FlushBans_f);
+	Cmd_AddCommand("bot_precomputeroutes", SV_BotPrecomputeRoutes_f);
+	Cmd_AddCommand("bot_aasbenchmark", SV_BotAASBenchmark_f);
+	Cmd_AddCommand("bot_aasentityprofile", SV_BotAASEntityProfile_f);
 #ifdef CMOD_MAP_SCRIPT
 	Cmd_AddCommand("_map", SV_Map_f);
 	Cmd_AddCommand("_devmap", SV_Map_f);
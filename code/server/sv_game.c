@@ -293,7 +293,11 @@ SV_GameSystemCalls
 The module is making a system call
 ====================
 */
+#ifdef CMOD_PROFILER
+static intptr_t SV_GameSystemCallsDispatch( intptr_t *args ) {
+#else
 intptr_t SV_GameSystemCalls( intptr_t *args ) {
+#endif
 #ifdef CMOD_VM_EXTENSIONS
 	intptr_t retval = 0;
 	if ( VMExt_HandleVMSyscall( args, VM_GAME, gvm, VM_ArgPtr, &retval ) ) {
@@ -973,6 +977,22 @@ intptr_t SV_GameSystemCalls( intptr_t *args ) {
 	return 0;
 }
 
+#ifdef CMOD_PROFILER
+/*
+====================
+SV_GameSystemCalls
+
+Times the system call dispatch for the profiler
+====================
+*/
+intptr_t SV_GameSystemCalls( intptr_t *args ) {
+	int64_t profileStart = CMPROFILE_START();
+	intptr_t retval = SV_GameSystemCallsDispatch( args );
+	CMPROFILE_END( PROFILE_GAME_SYSCALL, profileStart );
+	return retval;
+}
+#endif
+
 /*
 ===============
 SV_ShutdownGameProgs
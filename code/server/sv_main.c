@@ -1136,6 +1136,13 @@ happen before SV_Frame is called
 void SV_Frame( int msec ) {
 	int		frameMsec;
 	int		startTime;
+#ifdef CMOD_PROFILER
+	int64_t	profileStart;
+#endif
+#ifdef CMOD_HITCH_RECORDER
+	int64_t	frameStart = Sys_Microseconds();
+	int64_t	hitchStart;
+#endif
 
 	// the menu kills the server with this cvar
 	if ( sv_killserver->integer ) {
@@ -1175,7 +1182,13 @@ void SV_Frame( int msec ) {
 
 	sv.timeResidual += msec;
 
+#ifdef CMOD_HITCH_RECORDER
+	hitchStart = Sys_Microseconds();
+#endif
 	if (!com_dedicated->integer) SV_BotFrame (sv.time + sv.timeResidual);
+#ifdef CMOD_HITCH_RECORDER
+	cmod_hitch_phase( HITCH_PHASE_BOTS, hitchStart );
+#endif
 
 	// if time is about to hit the 32nd bit, kick all clients
 	// and clear sv.time, rather
@@ -1226,7 +1239,14 @@ void SV_Frame( int msec ) {
 	// update ping based on the all received frames
 	SV_CalcPings();
 
+#ifdef CMOD_HITCH_RECORDER
+	hitchStart = Sys_Microseconds();
+#endif
 	if (com_dedicated->integer) SV_BotFrame (sv.time);
+#ifdef CMOD_HITCH_RECORDER
+	// the game phase starts where the bot phase ends
+	hitchStart = cmod_hitch_phase( HITCH_PHASE_BOTS, hitchStart );
+#endif
 
 	// run the game simulation in chunks
 	while ( sv.timeResidual >= frameMsec ) {
@@ -1237,6 +1257,9 @@ void SV_Frame( int msec ) {
 		// let everything in the world think and move
 		VM_Call (gvm, GAME_RUN_FRAME, sv.time);
 	}
+#ifdef CMOD_HITCH_RECORDER
+	cmod_hitch_phase( HITCH_PHASE_GAME, hitchStart );
+#endif
 
 	if ( com_speeds->integer ) {
 		time_game = Sys_Milliseconds () - startTime;
@@ -1246,7 +1269,19 @@ void SV_Frame( int msec ) {
 	SV_CheckTimeouts();
 
 	// send messages back to the clients
+#ifdef CMOD_HITCH_RECORDER
+	hitchStart = Sys_Microseconds();
+#endif
+#ifdef CMOD_PROFILER
+	profileStart = CMPROFILE_START();
+#endif
 	SV_SendClientMessages();
+#ifdef CMOD_PROFILER
+	CMPROFILE_END( PROFILE_SEND_CLIENT_MESSAGES, profileStart );
+#endif
+#ifdef CMOD_HITCH_RECORDER
+	cmod_hitch_phase( HITCH_PHASE_SNAPSHOTS, hitchStart );
+#endif
 
 	// send a heartbeat to the master if needed
 	SV_MasterHeartbeat(HEARTBEAT_FOR_MASTER);
@@ -1254,6 +1289,9 @@ void SV_Frame( int msec ) {
 	trigger_exec_type(TRIGGER_TIMER);
 	trigger_exec_type(TRIGGER_REPEAT);
 #endif
+#ifdef CMOD_HITCH_RECORDER
+	cmod_hitch_server_frame( frameStart, msec, sv.time );
+#endif
 }
 
 /*
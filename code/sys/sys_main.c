@@ -865,6 +865,7 @@ int main( int argc, char **argv )
 
 	// Set the initial time base
 	Sys_Milliseconds( );
+	Sys_InitMicroseconds( );
 
 #ifdef __APPLE__
 	// This is passed if we are launched by double-clicking
@@ -33,6 +33,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include <unistd.h>
 #include <sys/mman.h>
 #include <sys/time.h>
+#include <time.h>
 #include <pwd.h>
 #include <libgen.h>
 #include <fcntl.h>
@@ -167,6 +168,38 @@ int Sys_Milliseconds (void)
 	return curtime;
 }
 
+/*
+================
+Sys_InitMicroseconds
+
+Sets the Sys_Microseconds origin; called once from main before any threads are started
+================
+*/
+static int64_t sys_microsecondBase;
+
+static int64_t Sys_MonotonicMicroseconds (void)
+{
+	struct timespec tp;
+
+	clock_gettime(CLOCK_MONOTONIC, &tp);
+	return (int64_t)tp.tv_sec * 1000000 + tp.tv_nsec / 1000;
+}
+
+void Sys_InitMicroseconds (void)
+{
+	sys_microsecondBase = Sys_MonotonicMicroseconds();
+}
+
+/*
+================
+Sys_Microseconds
+================
+*/
+int64_t Sys_Microseconds (void)
+{
+	return Sys_MonotonicMicroseconds() - sys_microsecondBase;
+}
+
 /*
 ==================
 Sys_RandomBytes
@@ -574,6 +607,184 @@ void Sys_Sleep( int msec )
 	}
 }
 
+/*
+==============================================================
+
+Threads
+
+==============================================================
+*/
+
+#include <pthread.h>
+
+struct sysMutex_s {
+	pthread_mutex_t mutex;
+};
+
+struct sysSignal_s {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	qboolean raised;
+};
+
+typedef struct {
+	void (*function)( void *arg );
+	void *arg;
+} sysThreadStart_t;
+
+static __thread qboolean sys_workerThread;
+
+static void *Sys_ThreadEntry( void *param )
+{
+	sysThreadStart_t start = *(sysThreadStart_t *)param;
+	free( param );
+	sys_workerThread = qtrue;
+	start.function( start.arg );
+	Z_FlushThreadCache();
+	return NULL;
+}
+
+/*
+==================
+Sys_CreateThread
+
+Starts a detached thread. Returns qfalse if the thread could not be created.
+==================
+*/
+qboolean Sys_CreateThread( void (*function)( void *arg ), void *arg )
+{
+	pthread_t thread;
+	sysThreadStart_t *start = malloc( sizeof( *start ) );
+
+	if( !start )
+		return qfalse;
+	start->function = function;
+	start->arg = arg;
+
+	if( pthread_create( &thread, NULL, Sys_ThreadEntry, start ) )
+	{
+		free( start );
+		return qfalse;
+	}
+
+	pthread_detach( thread );
+	return qtrue;
+}
+
+/*
+==================
+Sys_InWorkerThread
+
+Returns qtrue on threads started by Sys_CreateThread.
+==================
+*/
+qboolean Sys_InWorkerThread( void )
+{
+	return sys_workerThread;
+}
+
+/*
+==================
+Sys_CreateMutex
+==================
+*/
+sysMutex_t *Sys_CreateMutex( void )
+{
+	sysMutex_t *mutex = malloc( sizeof( *mutex ) );
+	if( !mutex )
+		Sys_Error( "Sys_CreateMutex: out of memory" );
+	pthread_mutex_init( &mutex->mutex, NULL );
+	return mutex;
+}
+
+/*
+==================
+Sys_DestroyMutex
+==================
+*/
+void Sys_DestroyMutex( sysMutex_t *mutex )
+{
+	pthread_mutex_destroy( &mutex->mutex );
+	free( mutex );
+}
+
+/*
+==================
+Sys_LockMutex
+==================
+*/
+void Sys_LockMutex( sysMutex_t *mutex )
+{
+	pthread_mutex_lock( &mutex->mutex );
+}
+
+/*
+==================
+Sys_UnlockMutex
+==================
+*/
+void Sys_UnlockMutex( sysMutex_t *mutex )
+{
+	pthread_mutex_unlock( &mutex->mutex );
+}
+
+/*
+==================
+Sys_CreateSignal
+==================
+*/
+sysSignal_t *Sys_CreateSignal( void )
+{
+	sysSignal_t *signal = malloc( sizeof( *signal ) );
+	if( !signal )
+		Sys_Error( "Sys_CreateSignal: out of memory" );
+	pthread_mutex_init( &signal->mutex, NULL );
+	pthread_cond_init( &signal->cond, NULL );
+	signal->raised = qfalse;
+	return signal;
+}
+
+/*
+==================
+Sys_DestroySignal
+==================
+*/
+void Sys_DestroySignal( sysSignal_t *signal )
+{
+	pthread_cond_destroy( &signal->cond );
+	pthread_mutex_destroy( &signal->mutex );
+	free( signal );
+}
+
+/*
+==================
+Sys_RaiseSignal
+==================
+*/
+void Sys_RaiseSignal( sysSignal_t *signal )
+{
+	pthread_mutex_lock( &signal->mutex );
+	signal->raised = qtrue;
+	pthread_cond_signal( &signal->cond );
+	pthread_mutex_unlock( &signal->mutex );
+}
+
+/*
+==================
+Sys_WaitSignal
+
+Blocks until the signal is raised, then resets it.
+==================
+*/
+void Sys_WaitSignal( sysSignal_t *signal )
+{
+	pthread_mutex_lock( &signal->mutex );
+	while( !signal->raised )
+		pthread_cond_wait( &signal->cond, &signal->mutex );
+	signal->raised = qfalse;
+	pthread_mutex_unlock( &signal->mutex );
+}
+
 /*
 ==============
 Sys_ErrorDialog
@@ -290,6 +290,36 @@ int Sys_Milliseconds (void)
 	return sys_curtime;
 }
 
+/*
+================
+Sys_InitMicroseconds
+
+Sets the Sys_Microseconds origin; called once from main before any threads are started
+================
+*/
+static LARGE_INTEGER sys_microsecondBase;
+static LARGE_INTEGER sys_microsecondFrequency;
+
+void Sys_InitMicroseconds (void)
+{
+	QueryPerformanceFrequency(&sys_microsecondFrequency);
+	QueryPerformanceCounter(&sys_microsecondBase);
+}
+
+/*
+================
+Sys_Microseconds
+================
+*/
+int64_t Sys_Microseconds (void)
+{
+	LARGE_INTEGER current;
+
+	QueryPerformanceCounter(&current);
+
+	return (current.QuadPart - sys_microsecondBase.QuadPart) * 1000000 / sys_microsecondFrequency.QuadPart;
+}
+
 /*
 ================
 Sys_RandomBytes
@@ -715,6 +745,177 @@ void Sys_Sleep( int msec )
 #endif
 }
 
+/*
+==============================================================
+
+Threads
+
+==============================================================
+*/
+
+struct sysMutex_s {
+	CRITICAL_SECTION cs;
+};
+
+struct sysSignal_s {
+	HANDLE event;
+};
+
+typedef struct {
+	void (*function)( void *arg );
+	void *arg;
+} sysThreadStart_t;
+
+#ifdef _MSC_VER
+static __declspec( thread ) qboolean sys_workerThread;
+#else
+static __thread qboolean sys_workerThread;
+#endif
+
+static DWORD WINAPI Sys_ThreadEntry( LPVOID param )
+{
+	sysThreadStart_t start = *(sysThreadStart_t *)param;
+	free( param );
+	sys_workerThread = qtrue;
+	start.function( start.arg );
+	Z_FlushThreadCache();
+	return 0;
+}
+
+/*
+==============
+Sys_CreateThread
+
+Starts a detached thread. Returns qfalse if the thread could not be created.
+==============
+*/
+qboolean Sys_CreateThread( void (*function)( void *arg ), void *arg )
+{
+	HANDLE thread;
+	sysThreadStart_t *start = malloc( sizeof( *start ) );
+
+	if( !start )
+		return qfalse;
+	start->function = function;
+	start->arg = arg;
+
+	thread = CreateThread( NULL, 0, Sys_ThreadEntry, start, 0, NULL );
+	if( !thread )
+	{
+		free( start );
+		return qfalse;
+	}
+
+	CloseHandle( thread );
+	return qtrue;
+}
+
+/*
+==============
+Sys_InWorkerThread
+
+Returns qtrue on threads started by Sys_CreateThread.
+==============
+*/
+qboolean Sys_InWorkerThread( void )
+{
+	return sys_workerThread;
+}
+
+/*
+==============
+Sys_CreateMutex
+==============
+*/
+sysMutex_t *Sys_CreateMutex( void )
+{
+	sysMutex_t *mutex = malloc( sizeof( *mutex ) );
+	if( !mutex )
+		Sys_Error( "Sys_CreateMutex: out of memory" );
+	InitializeCriticalSectionAndSpinCount( &mutex->cs, 0x00000400 );
+	return mutex;
+}
+
+/*
+==============
+Sys_DestroyMutex
+==============
+*/
+void Sys_DestroyMutex( sysMutex_t *mutex )
+{
+	DeleteCriticalSection( &mutex->cs );
+	free( mutex );
+}
+
+/*
+==============
+Sys_LockMutex
+==============
+*/
+void Sys_LockMutex( sysMutex_t *mutex )
+{
+	EnterCriticalSection( &mutex->cs );
+}
+
+/*
+==============
+Sys_UnlockMutex
+==============
+*/
+void Sys_UnlockMutex( sysMutex_t *mutex )
+{
+	LeaveCriticalSection( &mutex->cs );
+}
+
+/*
+==============
+Sys_CreateSignal
+==============
+*/
+sysSignal_t *Sys_CreateSignal( void )
+{
+	sysSignal_t *signal = malloc( sizeof( *signal ) );
+	if( !signal )
+		Sys_Error( "Sys_CreateSignal: out of memory" );
+	signal->event = CreateEvent( NULL, FALSE, FALSE, NULL );
+	if( !signal->event )
+		Sys_Error( "Sys_CreateSignal: CreateEvent failed" );
+	return signal;
+}
+
+/*
+==============
+Sys_DestroySignal
+==============
+*/
+void Sys_DestroySignal( sysSignal_t *signal )
+{
+	CloseHandle( signal->event );
+	free( signal );
+}
+
+/*
+==============
+Sys_RaiseSignal
+==============
+*/
+void Sys_RaiseSignal( sysSignal_t *signal )
+{
+	SetEvent( signal->event );
+}
+
+/*
+==============
+Sys_WaitSignal
+
+Blocks until the signal is raised, then resets it.
+==============
+*/
+void Sys_WaitSignal( sysSignal_t *signal )
+{
+	WaitForSingleObject( signal->event, INFINITE );
+}
+
 /*
 ==============
 Sys_ErrorDialog